@@ -0,0 +1,69 @@
+; memo-enter - Answer a `$ memo` word from the memo table
+; Emitted by the compiler at the start of a memoized word, followed by a
+; LIT cell holding its arity (inputs | outputs << 8)
+;
+; Hit:  ( inputs -- outputs ), then EXIT from the word
+; Miss: ( inputs -- inputs ) ( R: -- entry ), the body runs and
+;       memo-exit records its outputs
+
+section .data
+    align 8
+    memo_exit_cell: dq 0        ; XT 0 = EXIT
+
+section .text
+    global op_memo_enter
+    extern vm_dispatch
+    extern memo_enter
+
+op_memo_enter:
+    ; rsi = data stack pointer (inputs on top)
+    ; rdi = return stack pointer
+    ; rbx = IP (at the arity cell)
+
+    mov rdx, [rbx]              ; Arity (LIT)
+    sar rdx, 2
+    mov rcx, rbx                ; The word: address of its arity cell
+    add rbx, 8
+
+    ; Save VM registers and the arity across the C call
+    push rbp
+    push rdi
+    push rsi
+    push rdx
+    mov rbp, rsp
+    and rsp, -16
+
+    ; uint64_t memo_enter(uint64_t* dsp, const void* word, uint64_t arity)
+    mov rdi, rsi
+    mov rsi, rcx
+%ifdef PIC
+    call memo_enter wrt ..plt
+%else
+    call memo_enter
+%endif
+
+    mov rsp, rbp
+    pop rdx
+    pop rsi
+    pop rdi
+    pop rbp
+
+    cmp rax, 1                  ; MEMO_HIT
+    je .hit
+
+    ; Miss: keep the entry handle (0 = not recorded) for memo-exit
+    sub rdi, 8
+    mov [rdi], rax
+    jmp vm_dispatch
+
+.hit:
+    ; Outputs are in place: drop inputs - outputs cells
+    movzx eax, dl               ; Inputs
+    movzx ecx, dh               ; Outputs
+    sub rax, rcx
+    shl rax, 3
+    add rsi, rax
+
+    ; Continue at an EXIT cell: returns from the word like its own EXIT
+    lea rbx, [rel memo_exit_cell]
+    jmp vm_dispatch
@@ -0,0 +1,37 @@
+; memo-exit - Record a `$ memo` word's outputs in the memo table
+; Emitted by the compiler at the end of a memoized word
+;
+; Stack effect: ( outputs -- outputs ) ( R: entry -- )
+
+section .text
+    global op_memo_exit
+    extern vm_dispatch
+    extern memo_exit
+
+op_memo_exit:
+    ; rsi = data stack pointer (outputs on top)
+    ; rdi = return stack pointer (TOS is memo-enter's entry handle)
+
+    mov rax, [rdi]              ; Entry handle
+    add rdi, 8
+
+    push rbp
+    push rdi
+    push rsi
+    mov rbp, rsp
+    and rsp, -16
+
+    ; void memo_exit(uint64_t handle, const uint64_t* dsp)
+    mov rdi, rax
+%ifdef PIC
+    call memo_exit wrt ..plt
+%else
+    call memo_exit
+%endif
+
+    mov rsp, rbp
+    pop rsi
+    pop rdi
+    pop rbp
+
+    jmp vm_dispatch
@@ -0,0 +1,35 @@
+; tailcall - Call the next cell's word in place of the current frame
+; Emitted by the compiler before a word call in tail position
+;
+; Stack effect: ( -- ) ( R: ip -- )
+; Reads next cell (XT of the callee's DOCOL wrapper), performs the
+; current word's EXIT, then enters the callee: DOCOL pushes the caller's
+; IP again, so the return stack does not grow.
+
+section .text
+    global op_tailcall
+    extern vm_dispatch
+    extern return_stack_base
+
+op_tailcall:
+    ; rdi = return stack pointer (TOS is the caller's saved IP)
+    ; rbx = IP (already advanced past XT of tailcall)
+
+    ; Read callee XT (tag 00: the cell is the address)
+    mov rax, [rbx]
+    add rbx, 8                  ; IP now at the EXIT after the call
+
+    ; Outermost word: no frame to reuse, call normally
+    lea rcx, [rel return_stack_base]
+    add rcx, 8 * 1024
+    sub rcx, 8
+    cmp rdi, rcx
+    jge .call
+
+    ; EXIT: pop the caller's IP
+    mov rbx, [rdi]
+    add rdi, 8
+
+.call:
+    ; Callee's DOCOL wrapper saves rbx and runs its cells
+    jmp rax
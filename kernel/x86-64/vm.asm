@@ -33,6 +33,7 @@ section .text
     global vm_get_rsp
     global vm_dispatch          ; Export dispatch loop for DOCOL
     global data_stack_base
+    global return_stack_base    ; For tailcall's outermost-frame check
 
 ; ============================================================================
 ; vm_init - Initialize the VM
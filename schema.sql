@@ -100,10 +100,13 @@ CREATE TABLE defs (
     bytecode_version INTEGER NOT NULL DEFAULT 1,  -- Bytecode format version
     sig_cid         BLOB,              -- Type signature reference
     is_pure         INTEGER NOT NULL DEFAULT 0,   -- 1 if side-effect free
-    effects         INTEGER NOT NULL DEFAULT 0,   -- Effect flags: IO=1, ERR=2, etc.
+    effects         INTEGER NOT NULL DEFAULT 0,   -- Effect flags: IO=1, ERR=2, ALLOC=4, MEMORY=8, MAP=16, DYNAMIC=32, UNKNOWN=64
     escapes         INTEGER NOT NULL DEFAULT 0,   -- 1 if captures/escapes values
     source_text     TEXT,              -- Original source code (optional)
     source_hash     TEXT,              -- Hash of source (for change detection)
+    max_data_depth  INTEGER,           -- Deepest data stack above entry, callees included (-1 = unbounded)
+    data_effect     INTEGER,           -- Net data stack change (outputs - inputs)
+    max_return_depth INTEGER,          -- Deepest return stack, callees included (-1 = unbounded)
     compiled_at     INTEGER NOT NULL DEFAULT (unixepoch()),
 
     FOREIGN KEY (cid) REFERENCES blobs(cid) ON DELETE CASCADE,
@@ -122,7 +125,7 @@ CREATE TABLE defs (
 CREATE TABLE edges (
     from_cid    BLOB NOT NULL,     -- Source CID
     to_cid      BLOB NOT NULL,     -- Referenced CID
-    edge_type   TEXT NOT NULL,     -- Type of reference: 'call', 'literal', 'data'
+    edge_type   TEXT NOT NULL,     -- Type of reference: 'call', 'literal', 'data', 'inline'
 
     FOREIGN KEY (from_cid) REFERENCES blobs(cid) ON DELETE CASCADE,
     FOREIGN KEY (to_cid) REFERENCES blobs(cid) ON DELETE RESTRICT,
@@ -134,6 +137,32 @@ CREATE INDEX idx_edges_from ON edges(from_cid);
 CREATE INDEX idx_edges_to ON edges(to_cid);
 
 
+-- ============================================================================
+-- SPECIALIZATIONS: Persistent monomorphization cache
+-- ============================================================================
+-- Maps (word source hash, concrete input types) to the compiled blob, so an
+-- unchanged word is not recompiled on the next run. source_hash covers the
+-- word's tokens and its signature, not its callees: when a word changes, the
+-- rows reaching its old blob through edges are dropped (incremental builds).
+-- input_types holds one type id per byte. name/type_sig are the words binding
+-- to restore on a cache hit. Rows go with their blob on GC.
+
+CREATE TABLE specializations (
+    source_hash BLOB NOT NULL,     -- Word source hash (32 bytes)
+    input_types BLOB NOT NULL,     -- Concrete input type ids
+    cid         BLOB NOT NULL,     -- Compiled specialization
+    name        TEXT NOT NULL,     -- Word name
+    type_sig    TEXT,              -- Binding type signature (words.type_sig)
+
+    FOREIGN KEY (cid) REFERENCES blobs(cid) ON DELETE CASCADE,
+    CHECK (length(source_hash) = 32),
+
+    PRIMARY KEY (source_hash, input_types)
+) WITHOUT ROWID;
+
+CREATE INDEX idx_specializations_cid ON specializations(cid);
+
+
 -- ============================================================================
 -- MODULES: Program/library organization
 -- ============================================================================
@@ -257,7 +286,7 @@ CREATE TABLE metadata (
 );
 
 -- Initialize with schema version
-INSERT INTO metadata (key, value) VALUES ('schema_version', '1');
+INSERT INTO metadata (key, value) VALUES ('schema_version', '3');
 INSERT INTO metadata (key, value) VALUES ('created_at', unixepoch());
 INSERT INTO metadata (key, value) VALUES ('march_version', 'α₄');
 
@@ -0,0 +1,83 @@
+/*
+ * March Language - CID Hash Benchmark
+ * Throughput of single-buffer vs batched hashing for 16 B, 1 KB and 1 MB blobs
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "cidhash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BATCH 64
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Run one configuration for roughly 0.25s, print MB/s and hashes/s */
+static void bench(const char* label, cid_hash_t hash, bool batched,
+                  const uint8_t* const* data, const size_t* lens, size_t len) {
+    unsigned char out[BATCH * CID_SIZE];
+    size_t iters = 0;
+    double start = now_sec();
+    double elapsed = 0;
+
+    do {
+        if (batched) {
+            cid_hash_batch(hash, data, lens, BATCH, out);
+        } else {
+            for (size_t i = 0; i < BATCH; i++) {
+                cid_hash_into(hash, data[i], lens[i], out + i * CID_SIZE);
+            }
+        }
+        iters++;
+        elapsed = now_sec() - start;
+    } while (elapsed < 0.25);
+
+    double hashes = (double)iters * BATCH;
+    printf("  %-22s %10.1f MB/s %12.0f hashes/s\n", label,
+           hashes * len / elapsed / (1024.0 * 1024.0), hashes / elapsed);
+}
+
+int main(void) {
+    static const size_t sizes[] = {16, 1024, 1024 * 1024};
+
+    printf("CID hash benchmark (multi-buffer: %s)\n",
+           cid_hash_have_multibuffer() ? "avx2" : "unavailable");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        uint8_t* bufs[BATCH];
+        const uint8_t* data[BATCH];
+        size_t lens[BATCH];
+
+        for (size_t i = 0; i < BATCH; i++) {
+            bufs[i] = malloc(len);
+            if (!bufs[i]) {
+                fprintf(stderr, "Error: Out of memory\n");
+                return 1;
+            }
+            for (size_t j = 0; j < len; j++) {
+                bufs[i][j] = (uint8_t)(i + j * 13);
+            }
+            data[i] = bufs[i];
+            lens[i] = len;
+        }
+
+        printf("\n%zu bytes x %d:\n", len, BATCH);
+        bench("sha256 single", CID_HASH_SHA256, false, data, lens, len);
+        bench("sha256 batch", CID_HASH_SHA256, true, data, lens, len);
+        bench("blake2s single", CID_HASH_BLAKE2S, false, data, lens, len);
+
+        for (size_t i = 0; i < BATCH; i++) {
+            free(bufs[i]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * March Language - Compiler Scaling Benchmark
+ * Parse and specialize synthetic programs of 1k, 10k and 100k typed words;
+ * time per definition should stay roughly flat as the program grows
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "compiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Word i calls words i-1 and i/2, so every call site hits an earlier
+ * specialization and the name lookups span the whole program */
+static bool write_corpus(const char* path, int words) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "$ i64 -> i64 ;\n: w0 1 + ;\n");
+    for (int i = 1; i < words; i++) {
+        fprintf(f, "$ i64 -> i64 ;\n: w%d dup w%d swap w%d + ;\n", i, i - 1, i / 2);
+    }
+    return fclose(f) == 0;
+}
+
+static void remove_db(const char* path) {
+    char side[512];
+    unlink(path);
+    snprintf(side, sizeof(side), "%s-wal", path);
+    unlink(side);
+    snprintf(side, sizeof(side), "%s-shm", path);
+    unlink(side);
+}
+
+/* Returns seconds per definition, or a negative value on failure */
+static double bench(int words) {
+    char source[256], db_path[256];
+    snprintf(source, sizeof(source), "/tmp/bench_compile_%d.march", (int)getpid());
+    snprintf(db_path, sizeof(db_path), "/tmp/bench_compile_%d.db", (int)getpid());
+    remove_db(db_path);
+
+    if (!write_corpus(source, words)) {
+        fprintf(stderr, "Error: Cannot write %s\n", source);
+        return -1;
+    }
+
+    march_db_t* db = db_open(db_path);
+    dictionary_t* dict = dict_create();
+    compiler_t* comp = (db && dict) ? compiler_create(dict, db) : NULL;
+    double per_def = -1;
+
+    if (comp && db_init_schema(db, NULL)) {
+        compiler_register_primitives(comp);
+
+        double start = now_sec();
+        bool ok = compiler_compile_file(comp, source);
+        double parsed = now_sec();
+        ok = ok && compiler_compile_parallel(comp, 1);
+        double done = now_sec();
+
+        if (ok) {
+            per_def = (done - start) / words;
+            printf("  %7d words  parse %8.3f s  specialize %8.3f s  %8.1f us/word\n",
+                   words, parsed - start, done - parsed, per_def * 1e6);
+        } else {
+            fprintf(stderr, "Error: Compiling %d words failed\n", words);
+        }
+    }
+
+    if (comp) compiler_free(comp);
+    if (dict) dict_free(dict);
+    if (db) db_close(db);
+    remove_db(db_path);
+    unlink(source);
+    return per_def;
+}
+
+int main(int argc, char** argv) {
+    static const int default_sizes[] = {1000, 10000, 100000};
+    int count = argc > 1 ? argc - 1 : (int)(sizeof(default_sizes) / sizeof(default_sizes[0]));
+
+    printf("Compiler scaling benchmark (typed words, one thread)\n");
+
+    double base = 0;
+    for (int i = 0; i < count; i++) {
+        int words = argc > 1 ? atoi(argv[i + 1]) : default_sizes[i];
+        if (words < 1) continue;
+        double per_def = bench(words);
+        if (per_def < 0) return 1;
+        if (base == 0) {
+            base = per_def;
+        } else {
+            printf("  %7s        time per word x%.2f of the smallest program\n", "", per_def / base);
+        }
+    }
+    return 0;
+}
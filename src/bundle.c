@@ -0,0 +1,609 @@
+/*
+ * March Language - Deploy Bundle Implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bundle.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+/* ============================================================================ */
+/* Closure collection */
+/* ============================================================================ */
+
+/* Blob in the export closure */
+typedef struct {
+    unsigned char cid[CID_SIZE];
+    int kind;
+    unsigned char* sig_cid;         /* NULL if untyped */
+    uint8_t* data;
+    size_t len;
+} closure_blob_t;
+
+/* Export state: ordered blobs plus an open-addressing CID set */
+typedef struct {
+    march_db_t* db;
+    closure_blob_t* blobs;
+    size_t count;
+    size_t capacity;
+    int32_t* slots;                 /* Index into blobs, -1 = empty */
+    size_t slot_count;              /* Power of two */
+} closure_t;
+
+static size_t cid_slot(const unsigned char* cid, size_t slot_count) {
+    uint64_t h;
+    memcpy(&h, cid, sizeof(h));     /* CIDs are already uniformly distributed */
+    return (size_t)h & (slot_count - 1);
+}
+
+static bool closure_contains(closure_t* c, const unsigned char* cid) {
+    if (c->slot_count == 0) return false;
+    size_t i = cid_slot(cid, c->slot_count);
+    while (c->slots[i] >= 0) {
+        if (memcmp(c->blobs[c->slots[i]].cid, cid, CID_SIZE) == 0) return true;
+        i = (i + 1) & (c->slot_count - 1);
+    }
+    return false;
+}
+
+static bool closure_grow_slots(closure_t* c) {
+    size_t new_count = c->slot_count ? c->slot_count * 2 : 256;
+    int32_t* slots = malloc(new_count * sizeof(int32_t));
+    if (!slots) return false;
+    memset(slots, 0xff, new_count * sizeof(int32_t));
+
+    for (size_t b = 0; b < c->count; b++) {
+        size_t i = cid_slot(c->blobs[b].cid, new_count);
+        while (slots[i] >= 0) i = (i + 1) & (new_count - 1);
+        slots[i] = (int32_t)b;
+    }
+
+    free(c->slots);
+    c->slots = slots;
+    c->slot_count = new_count;
+    return true;
+}
+
+static bool closure_append(closure_t* c, closure_blob_t* blob) {
+    if ((c->count + 1) * 2 > c->slot_count && !closure_grow_slots(c)) return false;
+    if (c->count >= c->capacity) {
+        size_t cap = c->capacity ? c->capacity * 2 : 64;
+        closure_blob_t* blobs = realloc(c->blobs, cap * sizeof(closure_blob_t));
+        if (!blobs) return false;
+        c->blobs = blobs;
+        c->capacity = cap;
+    }
+
+    c->blobs[c->count] = *blob;
+    size_t i = cid_slot(blob->cid, c->slot_count);
+    while (c->slots[i] >= 0) i = (i + 1) & (c->slot_count - 1);
+    c->slots[i] = (int32_t)c->count;
+    c->count++;
+    return true;
+}
+
+/* Post-order DFS: children are appended before the blob that references them.
+ * Only BLOB_WORD/BLOB_QUOTATION references are code; BLOB_DATA is a leaf
+ * whatever kind it was stored with. */
+static bool closure_visit(closure_t* c, const unsigned char* cid, uint16_t ref_kind) {
+    if (closure_contains(c, cid)) return true;
+
+    closure_blob_t blob;
+    memcpy(blob.cid, cid, CID_SIZE);
+    if (!db_load_blob_ex(c->db, cid, &blob.kind, &blob.sig_cid, &blob.data, &blob.len)) {
+        char* hex = cid_to_hex(cid);
+        fprintf(stderr, "Error: Closure incomplete, blob %s not in database\n", hex ? hex : "?");
+        free(hex);
+        return false;
+    }
+
+    if (ref_kind == BLOB_WORD || ref_kind == BLOB_QUOTATION) {
+        const uint8_t* ptr = blob.data;
+        const uint8_t* end = blob.data + blob.len;
+        while (ptr + 2 <= end) {
+            uint16_t tag = ptr[0] | (ptr[1] << 8);
+            ptr += 2;
+            if (!(tag & 1)) {
+                if ((tag >> 1) == PRIM_LIT) ptr += 8;
+                continue;
+            }
+            if (ptr + CID_SIZE > end) break;
+            if (!closure_visit(c, ptr, tag >> 1)) {
+                free(blob.sig_cid);
+                free(blob.data);
+                return false;
+            }
+            ptr += CID_SIZE;
+        }
+    }
+
+    if (!closure_append(c, &blob)) {
+        free(blob.sig_cid);
+        free(blob.data);
+        return false;
+    }
+    return true;
+}
+
+static void closure_free(closure_t* c) {
+    for (size_t i = 0; i < c->count; i++) {
+        free(c->blobs[i].sig_cid);
+        free(c->blobs[i].data);
+    }
+    free(c->blobs);
+    free(c->slots);
+}
+
+/* ============================================================================ */
+/* Stream helpers */
+/* ============================================================================ */
+
+static bool put_bytes(gzFile gz, const void* data, size_t len) {
+    return len == 0 || gzwrite(gz, data, (unsigned)len) == (int)len;
+}
+
+static bool put_u8(gzFile gz, uint8_t v) {
+    return put_bytes(gz, &v, 1);
+}
+
+static bool put_u16(gzFile gz, uint16_t v) {
+    uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+    return put_bytes(gz, b, 2);
+}
+
+static bool put_u32(gzFile gz, uint32_t v) {
+    uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    return put_bytes(gz, b, 4);
+}
+
+static bool put_str16(gzFile gz, const char* s) {
+    size_t len = s ? strlen(s) : 0;
+    if (len > UINT16_MAX) return false;
+    return put_u16(gz, (uint16_t)len) && put_bytes(gz, s, len);
+}
+
+static bool get_bytes(gzFile gz, void* data, size_t len) {
+    return len == 0 || gzread(gz, data, (unsigned)len) == (int)len;
+}
+
+static bool get_u8(gzFile gz, uint8_t* v) {
+    return get_bytes(gz, v, 1);
+}
+
+static bool get_u16(gzFile gz, uint16_t* v) {
+    uint8_t b[2];
+    if (!get_bytes(gz, b, 2)) return false;
+    *v = (uint16_t)(b[0] | (b[1] << 8));
+    return true;
+}
+
+static bool get_u32(gzFile gz, uint32_t* v) {
+    uint8_t b[4];
+    if (!get_bytes(gz, b, 4)) return false;
+    *v = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return true;
+}
+
+/* Read u16-length string (caller must free) */
+static char* get_str16(gzFile gz) {
+    uint16_t len;
+    if (!get_u16(gz, &len)) return NULL;
+    char* s = malloc(len + 1);
+    if (!s) return NULL;
+    if (!get_bytes(gz, s, len)) {
+        free(s);
+        return NULL;
+    }
+    s[len] = '\0';
+    return s;
+}
+
+/* ============================================================================ */
+/* Export */
+/* ============================================================================ */
+
+/* Look up a type signature's strings (caller must free both) */
+static bool load_type_sig(march_db_t* db, const unsigned char* sig_cid,
+                          char** input_sig, char** output_sig) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db->db,
+            "SELECT input_sig, output_sig FROM type_signatures WHERE sig_cid = ?;",
+            -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_blob(stmt, 1, sig_cid, CID_SIZE, SQLITE_STATIC);
+
+    bool found = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* in = (const char*)sqlite3_column_text(stmt, 0);
+        const char* out = (const char*)sqlite3_column_text(stmt, 1);
+        *input_sig = strdup(in ? in : "");
+        *output_sig = strdup(out ? out : "");
+        found = *input_sig && *output_sig;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+bool bundle_export(march_db_t* db, const char* word, const char* type_sig,
+                   const char* path, bundle_stats_t* stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    /* The binding with that signature, or the only binding of the word */
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db->db,
+            "SELECT def_cid, type_sig FROM words "
+            "WHERE name = ?1 AND namespace = 'user' AND is_primitive = 0 "
+            "  AND (?2 IS NULL OR type_sig = ?2) "
+            "ORDER BY id LIMIT 2;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare word lookup: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, word, -1, SQLITE_STATIC);
+    if (type_sig) sqlite3_bind_text(stmt, 2, type_sig, -1, SQLITE_STATIC);
+
+    if (sqlite3_step(stmt) != SQLITE_ROW || sqlite3_column_bytes(stmt, 0) != CID_SIZE) {
+        fprintf(stderr, "Error: Word '%s'%s%s has no compiled definition in %s\n", word,
+                type_sig ? " with signature " : "",
+                type_sig ? type_sig : "", db->filename);
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    unsigned char root_cid[CID_SIZE];
+    memcpy(root_cid, sqlite3_column_blob(stmt, 0), CID_SIZE);
+    const char* sig_text = (const char*)sqlite3_column_text(stmt, 1);
+    char* root_sig = strdup(sig_text ? sig_text : "");
+    bool ambiguous = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+
+    if (ambiguous) {
+        fprintf(stderr, "Error: Word '%s' has several bindings (overloads or specializations);"
+                " choose one by its type signature\n", word);
+        free(root_sig);
+        return false;
+    }
+
+    closure_t c = {0};
+    c.db = db;
+    if (!root_sig || !closure_visit(&c, root_cid, BLOB_WORD)) {
+        free(root_sig);
+        closure_free(&c);
+        return false;
+    }
+
+    /* Distinct type signatures, in first-use order */
+    bundle_sig_t* sigs = calloc(c.count ? c.count : 1, sizeof(bundle_sig_t));
+    uint32_t sig_count = 0;
+    bool ok = sigs != NULL;
+    for (size_t i = 0; ok && i < c.count; i++) {
+        if (!c.blobs[i].sig_cid) continue;
+        bool seen = false;
+        for (uint32_t s = 0; s < sig_count && !seen; s++) {
+            seen = memcmp(sigs[s].sig_cid, c.blobs[i].sig_cid, CID_SIZE) == 0;
+        }
+        if (seen) continue;
+        memcpy(sigs[sig_count].sig_cid, c.blobs[i].sig_cid, CID_SIZE);
+        if (!load_type_sig(db, c.blobs[i].sig_cid, &sigs[sig_count].input_sig,
+                           &sigs[sig_count].output_sig)) {
+            fprintf(stderr, "Error: Type signature missing for blob in closure\n");
+            ok = false;
+            break;
+        }
+        sig_count++;
+    }
+
+    gzFile gz = ok ? gzopen(path, "wb9") : NULL;
+    if (ok && !gz) {
+        fprintf(stderr, "Error: Cannot write bundle: %s\n", path);
+        ok = false;
+    }
+
+    if (ok) {
+        gzbuffer(gz, 1 << 16);
+        uint8_t reserved[3] = {0};
+        ok = put_bytes(gz, BUNDLE_MAGIC, 8) &&
+             put_u32(gz, BUNDLE_VERSION) &&
+             put_u8(gz, (uint8_t)db->cid_hash) &&
+             put_bytes(gz, reserved, 3) &&
+             put_str16(gz, word) &&
+             put_str16(gz, root_sig) &&
+             put_bytes(gz, root_cid, CID_SIZE) &&
+             put_u32(gz, sig_count) &&
+             put_u32(gz, (uint32_t)c.count);
+
+        for (uint32_t s = 0; ok && s < sig_count; s++) {
+            ok = put_bytes(gz, sigs[s].sig_cid, CID_SIZE) &&
+                 put_str16(gz, sigs[s].input_sig) &&
+                 put_str16(gz, sigs[s].output_sig);
+        }
+
+        for (size_t i = 0; ok && i < c.count; i++) {
+            closure_blob_t* b = &c.blobs[i];
+            ok = put_bytes(gz, b->cid, CID_SIZE) &&
+                 put_u8(gz, (uint8_t)b->kind) &&
+                 put_u8(gz, b->sig_cid ? 1 : 0) &&
+                 (!b->sig_cid || put_bytes(gz, b->sig_cid, CID_SIZE)) &&
+                 put_u32(gz, (uint32_t)b->len) &&
+                 put_bytes(gz, b->data, b->len);
+            if (stats) stats->raw_bytes += b->len;
+        }
+
+        if (gzclose(gz) != Z_OK) ok = false;
+        if (!ok) fprintf(stderr, "Error: Failed writing bundle: %s\n", path);
+    }
+
+    if (ok && stats) {
+        stats->blob_count = (uint32_t)c.count;
+        stats->sig_count = sig_count;
+    }
+
+    for (uint32_t s = 0; sigs && s < sig_count; s++) {
+        free(sigs[s].input_sig);
+        free(sigs[s].output_sig);
+    }
+    free(sigs);
+    free(root_sig);
+    closure_free(&c);
+    return ok;
+}
+
+/* ============================================================================ */
+/* Reader */
+/* ============================================================================ */
+
+/* Check every type signature CID, H("input|output"), in one batch;
+ * returns the index of the first mismatch, sig_count if all match */
+static uint32_t verify_sigs(cid_hash_t hash, const bundle_sig_t* sigs, uint32_t sig_count) {
+    char** texts = calloc(sig_count, sizeof(char*));
+    size_t* lens = calloc(sig_count, sizeof(size_t));
+    unsigned char* cids = malloc((size_t)sig_count * CID_SIZE);
+    uint32_t bad = 0;
+    if (!texts || !lens || !cids) goto done;
+
+    for (uint32_t s = 0; s < sig_count; s++) {
+        size_t in_len = strlen(sigs[s].input_sig);
+        size_t out_len = strlen(sigs[s].output_sig);
+        texts[s] = malloc(in_len + 1 + out_len + 1);
+        if (!texts[s]) goto done;
+        sprintf(texts[s], "%s|%s", sigs[s].input_sig, sigs[s].output_sig);
+        lens[s] = in_len + 1 + out_len;
+    }
+
+    cid_hash_batch(hash, (const uint8_t* const*)texts, lens, sig_count, cids);
+    while (bad < sig_count && memcmp(cids + (size_t)bad * CID_SIZE, sigs[bad].sig_cid, CID_SIZE) == 0) {
+        bad++;
+    }
+
+done:
+    for (uint32_t s = 0; texts && s < sig_count; s++) {
+        free(texts[s]);
+    }
+    free(texts);
+    free(lens);
+    free(cids);
+    return bad;
+}
+
+bundle_reader_t* bundle_reader_open(const char* path) {
+    gzFile gz = gzopen(path, "rb");
+    if (!gz) {
+        fprintf(stderr, "Error: Cannot open bundle: %s\n", path);
+        return NULL;
+    }
+    gzbuffer(gz, 1 << 16);
+
+    bundle_reader_t* r = calloc(1, sizeof(bundle_reader_t));
+    if (!r) {
+        gzclose(gz);
+        return NULL;
+    }
+    r->gz = gz;
+
+    char magic[8];
+    uint32_t version = 0;
+    uint8_t hash_id = 0;
+    uint8_t reserved[3];
+    if (!get_bytes(gz, magic, 8) || memcmp(magic, BUNDLE_MAGIC, 8) != 0 ||
+        !get_u32(gz, &version) || version != BUNDLE_VERSION) {
+        fprintf(stderr, "Error: %s is not a March bundle (version %d)\n", path, BUNDLE_VERSION);
+        bundle_reader_close(r);
+        return NULL;
+    }
+
+    bool ok = get_u8(gz, &hash_id) && get_bytes(gz, reserved, 3) &&
+              (r->name = get_str16(gz)) != NULL &&
+              (r->type_sig = get_str16(gz)) != NULL &&
+              get_bytes(gz, r->root_cid, CID_SIZE) &&
+              get_u32(gz, &r->sig_count) &&
+              get_u32(gz, &r->blob_count);
+    r->cid_hash = (cid_hash_t)hash_id;
+    if (ok && strcmp(cid_hash_name(r->cid_hash), "unknown") == 0) {
+        fprintf(stderr, "Error: Bundle uses unknown CID hash %u\n", hash_id);
+        ok = false;
+    }
+
+    if (ok && r->sig_count) {
+        r->sigs = calloc(r->sig_count, sizeof(bundle_sig_t));
+        ok = r->sigs != NULL;
+    }
+    for (uint32_t s = 0; ok && s < r->sig_count; s++) {
+        bundle_sig_t* sig = &r->sigs[s];
+        ok = get_bytes(gz, sig->sig_cid, CID_SIZE) &&
+             (sig->input_sig = get_str16(gz)) != NULL &&
+             (sig->output_sig = get_str16(gz)) != NULL;
+    }
+    if (ok && r->sig_count) {
+        uint32_t bad = verify_sigs(r->cid_hash, r->sigs, r->sig_count);
+        if (bad < r->sig_count) {
+            fprintf(stderr, "Error: Bundle type signature %u fails verification\n", bad);
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: Corrupt bundle header: %s\n", path);
+        bundle_reader_close(r);
+        return NULL;
+    }
+
+    return r;
+}
+
+/* Read the next blobs into the window and recompute their CIDs together
+ * (verified as each is returned, so errors surface in stream order) */
+static bool fill_window(bundle_reader_t* r) {
+    gzFile gz = r->gz;
+    size_t offsets[BUNDLE_READ_BATCH];
+    size_t used = 0;
+    uint32_t n = 0;
+
+    while (n < BUNDLE_READ_BATCH && r->blobs_read + n < r->blob_count &&
+           (n == 0 || used < BUNDLE_READ_BATCH_BYTES)) {
+        bundle_blob_t* blob = &r->window[n];
+        uint8_t kind, has_sig;
+        uint32_t len;
+        if (!get_bytes(gz, blob->cid, CID_SIZE) || !get_u8(gz, &kind) || !get_u8(gz, &has_sig) ||
+            (has_sig && !get_bytes(gz, blob->sig_cid, CID_SIZE)) || !get_u32(gz, &len)) {
+            r->truncated = true;
+            break;
+        }
+
+        if (used + len > r->buffer_capacity) {
+            size_t capacity = r->buffer_capacity ? r->buffer_capacity * 2 : 1 << 16;
+            while (capacity < used + len) capacity *= 2;
+            uint8_t* buffer = realloc(r->buffer, capacity);
+            if (!buffer) return false;
+            r->buffer = buffer;
+            r->buffer_capacity = capacity;
+        }
+        if (!get_bytes(gz, r->buffer + used, len)) {
+            r->truncated = true;
+            break;
+        }
+
+        blob->kind = kind;
+        blob->has_sig = has_sig != 0;
+        blob->len = len;
+        offsets[n++] = used;
+        used += len;
+    }
+
+    const uint8_t* data[BUNDLE_READ_BATCH];
+    size_t lens[BUNDLE_READ_BATCH];
+    for (uint32_t i = 0; i < n; i++) {
+        r->window[i].data = r->buffer + offsets[i];
+        data[i] = r->window[i].data;
+        lens[i] = r->window[i].len;
+    }
+    cid_hash_batch(r->cid_hash, data, lens, n, r->window_cids);
+
+    r->window_count = n;
+    r->window_next = 0;
+    return true;
+}
+
+bool bundle_reader_next(bundle_reader_t* r, bundle_blob_t* blob) {
+    if (r->blobs_read >= r->blob_count) return false;
+
+    if (r->window_next == r->window_count) {
+        if (!r->truncated && !fill_window(r)) return false;
+        if (r->window_next == r->window_count) {
+            fprintf(stderr, "Error: Truncated bundle at blob %u\n", r->blobs_read);
+            return false;
+        }
+    }
+
+    /* Content verification */
+    uint32_t i = r->window_next;
+    if (memcmp(r->window_cids + (size_t)i * CID_SIZE, r->window[i].cid, CID_SIZE) != 0) {
+        char* hex = cid_to_hex(r->window[i].cid);
+        fprintf(stderr, "Error: Bundle blob %s fails verification\n", hex ? hex : "?");
+        free(hex);
+        return false;
+    }
+
+    *blob = r->window[i];
+    r->window_next++;
+    r->blobs_read++;
+
+    /* The root word is the last blob */
+    if (r->blobs_read == r->blob_count && memcmp(blob->cid, r->root_cid, CID_SIZE) != 0) {
+        fprintf(stderr, "Error: Bundle root CID mismatch\n");
+        return false;
+    }
+    return true;
+}
+
+bool bundle_reader_done(const bundle_reader_t* r) {
+    return r->blobs_read == r->blob_count;
+}
+
+void bundle_reader_close(bundle_reader_t* r) {
+    if (!r) return;
+    if (r->gz) gzclose((gzFile)r->gz);
+    for (uint32_t s = 0; r->sigs && s < r->sig_count; s++) {
+        free(r->sigs[s].input_sig);
+        free(r->sigs[s].output_sig);
+    }
+    free(r->sigs);
+    free(r->name);
+    free(r->type_sig);
+    free(r->buffer);
+    free(r);
+}
+
+/* ============================================================================ */
+/* Import */
+/* ============================================================================ */
+
+bool bundle_import(march_db_t* db, const char* path, bundle_stats_t* stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    bundle_reader_t* r = bundle_reader_open(path);
+    if (!r) return false;
+
+    /* CIDs are only meaningful under the hash they were made with */
+    if (r->cid_hash != db->cid_hash && !db_set_cid_hash(db, r->cid_hash)) {
+        bundle_reader_close(r);
+        return false;
+    }
+
+    sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    bool ok = true;
+
+    for (uint32_t s = 0; ok && s < r->sig_count; s++) {
+        const char* in = r->sigs[s].input_sig;
+        unsigned char* sig_cid = db_store_type_sig(db, in[0] ? in : NULL, r->sigs[s].output_sig);
+        ok = sig_cid != NULL;
+        free(sig_cid);
+    }
+
+    bundle_blob_t blob;
+    while (ok && bundle_reader_next(r, &blob)) {
+        unsigned char cid[CID_SIZE];
+        ok = db_store_blob_into(db, blob.kind, blob.has_sig ? blob.sig_cid : NULL,
+                                blob.data, blob.len, cid);
+        if (ok && (blob.kind == BLOB_WORD || blob.kind == BLOB_QUOTATION)) {
+            ok = db_store_edges(db, cid, blob.data, blob.len);
+        }
+        if (stats) stats->raw_bytes += blob.len;
+    }
+    ok = ok && bundle_reader_done(r);
+    ok = ok && db_bind_word(db, r->name, NULL, r->root_cid, r->type_sig[0] ? r->type_sig : NULL);
+
+    sqlite3_exec(db->db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+
+    if (ok && stats) {
+        stats->blob_count = r->blob_count;
+        stats->sig_count = r->sig_count;
+    }
+    DEBUG_DB("Imported bundle %s: %u blobs", path, r->blob_count);
+
+    bundle_reader_close(r);
+    return ok;
+}
@@ -0,0 +1,96 @@
+/*
+ * March Language - Deploy Bundles
+ * A word's transitive CID closure in one compressed, content-verified file
+ */
+
+#ifndef MARCH_BUNDLE_H
+#define MARCH_BUNDLE_H
+
+#include "types.h"
+#include "database.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Bundle format (gzip stream, integers little-endian):
+ *
+ *   header  "MARCHBDL" u32 version u8 cid_hash u8 reserved[3]
+ *           u16 name_len name  u16 sig_len type_sig  root_cid[32]
+ *           u32 sig_count  u32 blob_count
+ *   sigs    sig_cid[32] u16 in_len input_sig u16 out_len output_sig
+ *   blobs   cid[32] u8 kind u8 has_sig [sig_cid[32]] u32 len data
+ *
+ * Blobs are in dependency order (every CID a blob references precedes it,
+ * the root word is last), so a reader can link them in one forward pass.
+ * Every CID is recomputed and checked on read.
+ */
+#define BUNDLE_MAGIC   "MARCHBDL"
+#define BUNDLE_VERSION 1
+
+/* One blob read from a bundle (data owned by the reader, valid until next read) */
+typedef struct {
+    unsigned char cid[CID_SIZE];
+    int kind;
+    bool has_sig;
+    unsigned char sig_cid[CID_SIZE];
+    const uint8_t* data;
+    size_t len;
+} bundle_blob_t;
+
+/* Type signature carried in a bundle */
+typedef struct {
+    unsigned char sig_cid[CID_SIZE];
+    char* input_sig;
+    char* output_sig;
+} bundle_sig_t;
+
+/* The reader reads up to this many blobs (and, past the first, bytes)
+ * ahead and verifies their CIDs in one cid_hash_batch call */
+#define BUNDLE_READ_BATCH 64
+#define BUNDLE_READ_BATCH_BYTES (1 << 20)
+
+/* Streaming reader (header and signatures are read on open) */
+typedef struct bundle_reader bundle_reader_t;
+
+struct bundle_reader {
+    void* gz;                       /* gzFile */
+    cid_hash_t cid_hash;
+    char* name;                     /* Root word name */
+    char* type_sig;                 /* Root word type signature */
+    unsigned char root_cid[CID_SIZE];
+    bundle_sig_t* sigs;
+    uint32_t sig_count;
+    uint32_t blob_count;
+    uint32_t blobs_read;
+    uint8_t* buffer;                /* Data of the blobs in window */
+    size_t buffer_capacity;
+    bundle_blob_t window[BUNDLE_READ_BATCH];     /* Blobs read ahead */
+    unsigned char window_cids[BUNDLE_READ_BATCH * CID_SIZE];    /* Their recomputed CIDs */
+    uint32_t window_count;
+    uint32_t window_next;
+    bool truncated;                 /* Reading ahead hit the end of the file */
+};
+
+/* Export statistics */
+typedef struct {
+    uint32_t blob_count;
+    uint32_t sig_count;
+    uint64_t raw_bytes;             /* Sum of blob payloads */
+} bundle_stats_t;
+
+/* Write the closure of word to path. type_sig selects the binding in
+ * words; with NULL the word must have exactly one. */
+bool bundle_export(march_db_t* db, const char* word, const char* type_sig,
+                   const char* path, bundle_stats_t* stats);
+
+/* Store every blob of a bundle and bind its root word */
+bool bundle_import(march_db_t* db, const char* path, bundle_stats_t* stats);
+
+/* Reader API */
+bundle_reader_t* bundle_reader_open(const char* path);
+/* Returns true and fills blob, false at end or on error (check bundle_reader_done) */
+bool bundle_reader_next(bundle_reader_t* reader, bundle_blob_t* blob);
+bool bundle_reader_done(const bundle_reader_t* reader);
+void bundle_reader_close(bundle_reader_t* reader);
+
+#endif /* MARCH_BUNDLE_H */
@@ -0,0 +1,378 @@
+/*
+ * March Language - CID Hashing Implementation
+ *
+ * Single-blob hashing goes through OpenSSL with a per-thread digest context
+ * that is reused across calls and freed when the thread exits (OpenSSL
+ * picks SHA-NI itself when present).
+ * Batches of small SHA-256 blobs use an 8-lane AVX2 multi-buffer
+ * compression function: each lane carries one blob, lanes with fewer
+ * blocks are masked out once they finish.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "cidhash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <openssl/evp.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#include <cpuid.h>
+#define CID_HASH_HAVE_AVX2_IMPL 1
+#endif
+
+/* ============================================================================ */
+/* Names */
+/* ============================================================================ */
+
+const char* cid_hash_name(cid_hash_t hash) {
+    switch (hash) {
+        case CID_HASH_SHA256:  return "sha256";
+        case CID_HASH_BLAKE2S: return "blake2s";
+        default: return "unknown";
+    }
+}
+
+bool cid_hash_parse(const char* name, cid_hash_t* hash) {
+    if (!name) return false;
+    if (strcmp(name, "sha256") == 0) {
+        *hash = CID_HASH_SHA256;
+        return true;
+    }
+    if (strcmp(name, "blake2s") == 0) {
+        *hash = CID_HASH_BLAKE2S;
+        return true;
+    }
+    return false;
+}
+
+/* ============================================================================ */
+/* Single-buffer path (OpenSSL, reused context) */
+/* ============================================================================ */
+
+/* Digest context and fetched digests, allocated on a thread's first hash
+ * and freed when it exits */
+typedef struct {
+    EVP_MD_CTX* ctx;
+    EVP_MD* md[2];
+} hash_state_t;
+
+static _Thread_local hash_state_t* tls_state;
+static pthread_key_t hash_state_key;
+static pthread_once_t hash_state_once = PTHREAD_ONCE_INIT;
+
+static void hash_state_free(void* p) {
+    hash_state_t* state = p;
+    EVP_MD_CTX_free(state->ctx);
+    for (int i = 0; i < 2; i++) {
+        EVP_MD_free(state->md[i]);
+    }
+    free(state);
+}
+
+static void hash_state_key_create(void) {
+    pthread_key_create(&hash_state_key, hash_state_free);
+}
+
+static hash_state_t* get_state(void) {
+    if (!tls_state) {
+        pthread_once(&hash_state_once, hash_state_key_create);
+        tls_state = calloc(1, sizeof(hash_state_t));
+        if (!tls_state || !(tls_state->ctx = EVP_MD_CTX_new())) {
+            fprintf(stderr, "Error: Failed to allocate digest context\n");
+            abort();
+        }
+        pthread_setspecific(hash_state_key, tls_state);
+    }
+    return tls_state;
+}
+
+static const EVP_MD* get_md(hash_state_t* state, cid_hash_t hash) {
+    if (!state->md[hash]) {
+        state->md[hash] = EVP_MD_fetch(NULL, hash == CID_HASH_BLAKE2S ? "BLAKE2S-256" : "SHA256", NULL);
+        if (!state->md[hash]) {
+            fprintf(stderr, "Error: digest %s not available\n", cid_hash_name(hash));
+            abort();
+        }
+    }
+    return state->md[hash];
+}
+
+void cid_hash_into(cid_hash_t hash, const uint8_t* data, size_t len, unsigned char* out) {
+    hash_state_t* state = get_state();
+    unsigned int out_len = 0;
+    EVP_DigestInit_ex2(state->ctx, get_md(state, hash), NULL);
+    EVP_DigestUpdate(state->ctx, data, len);
+    EVP_DigestFinal_ex(state->ctx, out, &out_len);
+}
+
+/* ============================================================================ */
+/* Multi-buffer SHA-256 (AVX2, 8 lanes) */
+/* ============================================================================ */
+
+#ifdef CID_HASH_HAVE_AVX2_IMPL
+
+#define MB_LANES 8
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define MB_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/* Compress one 64-byte block per lane; lanes outside 'active' keep their state */
+__attribute__((target("avx2")))
+static void sha256_mb_compress(__m256i state[8], const uint8_t* const blocks[MB_LANES], __m256i active) {
+    /* Load 8 words per lane, byte-swap to big-endian and transpose so that
+     * w[t] holds word t of every lane */
+    const __m256i bswap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i w[16];
+    for (int half = 0; half < 2; half++) {
+        __m256i r[8];
+        for (int lane = 0; lane < MB_LANES; lane++) {
+            r[lane] = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i*)(blocks[lane] + 32 * half)), bswap);
+        }
+        __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+        __m256i* dst = w + 8 * half;
+        dst[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        dst[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        dst[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        dst[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        dst[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        dst[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        dst[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        dst[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+    __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int t = 0; t < 64; t++) {
+        __m256i wt;
+        if (t < 16) {
+            wt = w[t];
+        } else {
+            __m256i w15 = w[(t - 15) & 15];
+            __m256i w2 = w[(t - 2) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(w15, 7), MB_ROR(w15, 18)),
+                                          _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(w2, 17), MB_ROR(w2, 19)),
+                                          _mm256_srli_epi32(w2, 10));
+            wt = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0),
+                                  _mm256_add_epi32(w[(t - 7) & 15], s1));
+            w[t & 15] = wt;
+        }
+
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(e, 6), MB_ROR(e, 11)), MB_ROR(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1),
+                                      _mm256_add_epi32(ch, _mm256_add_epi32(
+                                          _mm256_set1_epi32((int)sha256_k[t]), wt)));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(a, 2), MB_ROR(a, 13)), MB_ROR(a, 22));
+        __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                       _mm256_and_si256(b, c));
+        __m256i t2 = _mm256_add_epi32(S0, maj);
+
+        h = g; g = f; f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    __m256i out[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; i++) {
+        __m256i next = _mm256_add_epi32(state[i], out[i]);
+        state[i] = _mm256_blendv_epi8(state[i], next, active);
+    }
+}
+
+/* Hash up to 8 blobs (each <= CID_HASH_MB_MAX_LEN) in parallel lanes */
+__attribute__((target("avx2")))
+static void sha256_mb_lanes(const uint8_t* const* data, const size_t* lens, size_t n,
+                            unsigned char* out) {
+    static const uint8_t zero_block[64] = {0};
+    uint8_t tail[MB_LANES][128];           /* Padded final block(s) per lane */
+    size_t full_blocks[MB_LANES];
+    size_t total_blocks[MB_LANES];
+    size_t max_blocks = 0;
+
+    for (size_t i = 0; i < MB_LANES; i++) {
+        if (i >= n) {
+            full_blocks[i] = 0;
+            total_blocks[i] = 0;
+            continue;
+        }
+
+        size_t len = lens[i];
+        size_t rem = len % 64;
+        full_blocks[i] = len / 64;
+
+        /* Standard SHA-256 padding: 0x80, zeros, 64-bit big-endian bit length */
+        memset(tail[i], 0, sizeof(tail[i]));
+        if (rem) memcpy(tail[i], data[i] + full_blocks[i] * 64, rem);
+        tail[i][rem] = 0x80;
+        size_t tail_blocks = (rem + 1 + 8 <= 64) ? 1 : 2;
+        uint64_t bit_len = (uint64_t)len * 8;
+        for (int k = 0; k < 8; k++) {
+            tail[i][tail_blocks * 64 - 1 - k] = (uint8_t)(bit_len >> (8 * k));
+        }
+
+        total_blocks[i] = full_blocks[i] + tail_blocks;
+        if (total_blocks[i] > max_blocks) max_blocks = total_blocks[i];
+    }
+
+    __m256i state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm256_set1_epi32((int)sha256_iv[i]);
+    }
+
+    for (size_t blk = 0; blk < max_blocks; blk++) {
+        const uint8_t* blocks[MB_LANES];
+        int32_t mask[MB_LANES];
+        for (size_t i = 0; i < MB_LANES; i++) {
+            if (blk < full_blocks[i]) {
+                blocks[i] = data[i] + blk * 64;
+                mask[i] = -1;
+            } else if (blk < total_blocks[i]) {
+                blocks[i] = tail[i] + (blk - full_blocks[i]) * 64;
+                mask[i] = -1;
+            } else {
+                blocks[i] = zero_block;
+                mask[i] = 0;
+            }
+        }
+        __m256i active = _mm256_loadu_si256((const __m256i*)mask);
+        sha256_mb_compress(state, blocks, active);
+    }
+
+    uint32_t words[8][MB_LANES];
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i*)words[i], state[i]);
+    }
+    for (size_t lane = 0; lane < n; lane++) {
+        unsigned char* dst = out + lane * CID_SIZE;
+        for (int i = 0; i < 8; i++) {
+            uint32_t v = words[i][lane];
+            dst[4 * i + 0] = (uint8_t)(v >> 24);
+            dst[4 * i + 1] = (uint8_t)(v >> 16);
+            dst[4 * i + 2] = (uint8_t)(v >> 8);
+            dst[4 * i + 3] = (uint8_t)v;
+        }
+    }
+}
+
+bool cid_hash_have_multibuffer(void) {
+    static int have = -1;
+    if (have < 0) {
+        __builtin_cpu_init();
+        have = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return have == 1;
+}
+
+/* Largest blob worth a lane. With SHA-NI the scalar path catches up with
+ * 8 AVX2 lanes at a few hundred bytes, so only tiny blobs are batched. */
+static size_t mb_max_len(void) {
+    static size_t max_len = 0;
+    if (max_len == 0) {
+        unsigned int eax, ebx, ecx, edx;
+        bool sha_ni = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29));
+        max_len = sha_ni ? CID_HASH_MB_SHANI_MAX_LEN : CID_HASH_MB_MAX_LEN;
+    }
+    return max_len;
+}
+
+#else
+
+bool cid_hash_have_multibuffer(void) {
+    return false;
+}
+
+#endif /* CID_HASH_HAVE_AVX2_IMPL */
+
+/* ============================================================================ */
+/* Batch entry point */
+/* ============================================================================ */
+
+void cid_hash_batch(cid_hash_t hash, const uint8_t* const* data, const size_t* lens,
+                    size_t count, unsigned char* out) {
+#ifdef CID_HASH_HAVE_AVX2_IMPL
+    if (hash == CID_HASH_SHA256 && count > 1 && cid_hash_have_multibuffer()) {
+        /* Gather small blobs into lanes; large ones go through OpenSSL */
+        const uint8_t* lane_data[MB_LANES];
+        size_t lane_lens[MB_LANES];
+        size_t lane_index[MB_LANES];
+        unsigned char lane_out[MB_LANES * CID_SIZE];
+        size_t lanes = 0;
+        size_t max_len = mb_max_len();
+
+        for (size_t i = 0; i < count; i++) {
+            if (lens[i] > max_len) {
+                cid_hash_into(hash, data[i], lens[i], out + i * CID_SIZE);
+                continue;
+            }
+
+            lane_data[lanes] = data[i];
+            lane_lens[lanes] = lens[i];
+            lane_index[lanes] = i;
+            lanes++;
+
+            if (lanes == MB_LANES) {
+                sha256_mb_lanes(lane_data, lane_lens, lanes, lane_out);
+                for (size_t l = 0; l < lanes; l++) {
+                    memcpy(out + lane_index[l] * CID_SIZE, lane_out + l * CID_SIZE, CID_SIZE);
+                }
+                lanes = 0;
+            }
+        }
+
+        /* A single leftover lane is cheaper on the scalar path */
+        if (lanes == 1) {
+            cid_hash_into(hash, lane_data[0], lane_lens[0], out + lane_index[0] * CID_SIZE);
+        } else if (lanes > 1) {
+            sha256_mb_lanes(lane_data, lane_lens, lanes, lane_out);
+            for (size_t l = 0; l < lanes; l++) {
+                memcpy(out + lane_index[l] * CID_SIZE, lane_out + l * CID_SIZE, CID_SIZE);
+            }
+        }
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+        cid_hash_into(hash, data[i], lens[i], out + i * CID_SIZE);
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * March Language - CID Hashing
+ * Selectable content hash for CIDs with allocation-free and batched entry points
+ */
+
+#ifndef MARCH_CIDHASH_H
+#define MARCH_CIDHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+
+/* CID hash functions (recorded per database in metadata 'cid_hash').
+ * IDs are stable - never renumber, a database is only readable with the
+ * hash it was created with. */
+typedef enum {
+    CID_HASH_SHA256  = 0,   /* SHA-256 (default; SHA-NI via OpenSSL) */
+    CID_HASH_BLAKE2S = 1,   /* BLAKE2s-256 (faster without SHA extensions) */
+} cid_hash_t;
+
+#define CID_HASH_DEFAULT CID_HASH_SHA256
+
+/* Blobs at or below this size are eligible for the multi-buffer path
+ * (the lower limit applies on CPUs with SHA extensions) */
+#define CID_HASH_MB_MAX_LEN 4096
+#define CID_HASH_MB_SHANI_MAX_LEN 256
+
+/* Name <-> ID ("sha256", "blake2s") */
+const char* cid_hash_name(cid_hash_t hash);
+bool cid_hash_parse(const char* name, cid_hash_t* hash);
+
+/* Hash one blob into out[CID_SIZE] (no allocation) */
+void cid_hash_into(cid_hash_t hash, const uint8_t* data, size_t len, unsigned char* out);
+
+/* Hash count blobs into out[count * CID_SIZE] (no allocation).
+ * Small SHA-256 blobs are hashed 8 at a time with AVX2 when available. */
+void cid_hash_batch(cid_hash_t hash, const uint8_t* const* data, const size_t* lens,
+                    size_t count, unsigned char* out);
+
+/* True if the SIMD multi-buffer SHA-256 path is usable on this CPU */
+bool cid_hash_have_multibuffer(void);
+
+#endif /* MARCH_CIDHASH_H */
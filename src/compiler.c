@@ -6,6 +6,10 @@
 
 #include "compiler.h"
 #include "primitives.h"
+#include "threadpool.h"
+#include "effects.h"
+#include "evaluator.h"
+#include "memo.h"
 #include "debug.h"
 #include <stdlib.h>
 #include <string.h>
@@ -23,6 +27,7 @@ static bool compile_times_until(compiler_t* comp);
 static bool compile_true(compiler_t* comp);
 static bool compile_false(compiler_t* comp);
 static bool materialize_quotations(compiler_t* comp);
+static void quotation_cache_clear(spec_cache_t* specs);
 
 /* Stack primitive immediate handlers */
 static bool compile_drop(compiler_t* comp);
@@ -31,37 +36,50 @@ static bool compile_swap(compiler_t* comp);
 static bool compile_over(compiler_t* comp);
 static bool compile_rot(compiler_t* comp);
 
-/* Create compiler */
-compiler_t* compiler_create(dictionary_t* dict, march_db_t* db) {
+/* Allocate compiler state around a (possibly shared) specialization cache */
+static compiler_t* compiler_alloc(dictionary_t* dict, march_db_t* db, spec_cache_t* specs) {
     compiler_t* comp = malloc(sizeof(compiler_t));
     if (!comp) return NULL;
 
     comp->dict = dict;
     comp->db = db;
+    comp->parent = NULL;
+    comp->specs = specs;
     comp->type_stack_depth = 0;
-    comp->cells = cell_buffer_create();
-    comp->blob = blob_buffer_create();  /* CID-based encoding buffer */
+    comp->ir = ir_buffer_create();
     comp->ref_graph = NULL;  /* Created per-word, not global */
     comp->verbose = false;
+    comp->opt_level = OPT_NONE;
+    memset(&comp->opt_stats, 0, sizeof(comp->opt_stats));
+    memset(&comp->inlined, 0, sizeof(comp->inlined));
+    comp->effects = 0;
+    memset(&comp->depth, 0, sizeof(comp->depth));
+    comp->frame = NULL;
+    comp->whole_program = false;
     comp->pending_type_sig = NULL;
+    comp->pending_memo = false;
     comp->quot_stack_depth = 0;
     comp->buffer_stack_depth = 0;
-    comp->blob_stack_depth = 0;
     comp->quot_counter = 0;
+    comp->pending_quot_cids = NULL;
     comp->pending_quot_count = 0;
+    comp->pending_quot_capacity = 0;
     comp->array_marker_depth = 0;
+    comp->word_defs = NULL;
     comp->word_def_count = 0;
-    comp->specialization_count = 0;
-
-    /* Initialize slot allocation */
+    comp->word_def_capacity = 0;
+    comp->word_by_sym = NULL;
+    comp->word_by_sym_size = 0;
+    comp->save_area = NULL;
+    comp->save_used = 0;
+    comp->save_capacity = 0;
+
+    /* Initialize slot allocation (grown on demand) */
+    comp->slot_used = NULL;
+    comp->slot_capacity = 0;
     comp->slot_count = 0;
-    for (int i = 0; i < MAX_SLOTS; i++) {
-        comp->slot_used[i] = false;
-    }
 
-    if (!comp->cells || !comp->blob) {
-        if (comp->cells) cell_buffer_free(comp->cells);
-        if (comp->blob) blob_buffer_free(comp->blob);
+    if (!comp->ir) {
         free(comp);
         return NULL;
     }
@@ -69,22 +87,39 @@ compiler_t* compiler_create(dictionary_t* dict, march_db_t* db) {
     return comp;
 }
 
+/* Create compiler */
+compiler_t* compiler_create(dictionary_t* dict, march_db_t* db) {
+    spec_cache_t* specs = calloc(1, sizeof(spec_cache_t));
+    if (!specs) return NULL;
+    pthread_mutex_init(&specs->lock, NULL);
+
+    compiler_t* comp = compiler_alloc(dict, db, specs);
+    if (!comp) {
+        pthread_mutex_destroy(&specs->lock);
+        free(specs);
+    }
+    return comp;
+}
+
+/* Create job context sharing parent's dictionary, database and caches */
+compiler_t* compiler_create_job(compiler_t* parent) {
+    compiler_t* comp = compiler_alloc(parent->dict, parent->db, parent->specs);
+    if (!comp) return NULL;
+    comp->parent = parent;
+    comp->verbose = parent->verbose;
+    comp->opt_level = parent->opt_level;
+    return comp;
+}
+
 /* Free word definition */
 static void word_definition_free(word_definition_t* def) {
     if (def) {
         free(def->name);
-        /* Free tokens */
-        if (def->tokens) {
-            for (int i = 0; i < def->token_count; i++) {
-                if (def->tokens[i].text) {
-                    free(def->tokens[i].text);
-                }
-            }
-            free(def->tokens);
-        }
+        free(def->tokens);      /* Token text is interned */
         if (def->type_sig) {
             free(def->type_sig);
         }
+        free(def->source_text);
         free(def);
     }
 }
@@ -99,6 +134,12 @@ static word_definition_t* word_definition_create(const char* name) {
     def->token_count = 0;
     def->tokens = malloc(sizeof(token_t) * def->token_capacity);
     def->type_sig = NULL;
+    def->source_text = NULL;
+    memset(def->source_hash, 0, CID_SIZE);
+    def->reachable = false;
+    def->memo = false;
+    def->name_sym = 0;
+    def->next_overload = NULL;
 
     if (!def->name || !def->tokens) {
         word_definition_free(def);
@@ -122,109 +163,438 @@ static bool word_def_append_token(word_definition_t* def, const token_t* tok) {
         def->token_capacity = new_capacity;
     }
 
-    /* Deep copy the token */
-    def->tokens[def->token_count] = *tok;
-    if (tok->text) {
-        def->tokens[def->token_count].text = strdup(tok->text);
-        if (!def->tokens[def->token_count].text) {
+    /* Tokens reference interned text, so a copy is all it takes */
+    def->tokens[def->token_count++] = *tok;
+    return true;
+}
+
+/* Latest definition of an interned name (earlier ones follow next_overload) */
+static word_definition_t* find_word_definition(compiler_t* comp, uint32_t name_sym) {
+    return name_sym < comp->word_by_sym_size ? comp->word_by_sym[name_sym] : NULL;
+}
+
+static bool same_type_sig(const type_sig_t* a, const type_sig_t* b) {
+    if (!a || !b) return a == b;
+    if (a->input_count != b->input_count || a->output_count != b->output_count) return false;
+    return memcmp(a->inputs, b->inputs, sizeof(type_id_t) * (size_t)a->input_count) == 0 &&
+           memcmp(a->outputs, b->outputs, sizeof(type_id_t) * (size_t)a->output_count) == 0;
+}
+
+/* Append to the definition list and make it the latest of its name */
+static bool add_word_definition(compiler_t* comp, word_definition_t* def) {
+    if (comp->word_def_count >= comp->word_def_capacity) {
+        int capacity = comp->word_def_capacity ? comp->word_def_capacity * 2 : 256;
+        word_definition_t** defs = realloc(comp->word_defs, sizeof(word_definition_t*) * (size_t)capacity);
+        if (!defs) return false;
+        comp->word_defs = defs;
+        comp->word_def_capacity = capacity;
+    }
+    if (def->name_sym >= comp->word_by_sym_size) {
+        size_t size = comp->word_by_sym_size ? comp->word_by_sym_size : 1024;
+        while (size <= def->name_sym) size *= 2;
+        word_definition_t** by_sym = realloc(comp->word_by_sym, sizeof(word_definition_t*) * size);
+        if (!by_sym) return false;
+        memset(by_sym + comp->word_by_sym_size, 0,
+               sizeof(word_definition_t*) * (size - comp->word_by_sym_size));
+        comp->word_by_sym = by_sym;
+        comp->word_by_sym_size = size;
+    }
+    def->next_overload = comp->word_by_sym[def->name_sym];
+    comp->word_by_sym[def->name_sym] = def;
+
+    /* A cached quotation calling this name may now dispatch differently */
+    if (def->next_overload) {
+        quotation_cache_clear(comp->specs);
+    }
+    comp->word_defs[comp->word_def_count++] = def;
+    return true;
+}
+
+/* Save area: state of enclosing compilations, restored in reverse order */
+static bool save_state(compiler_t* comp, const void* data, size_t size) {
+    if (comp->save_used + size > comp->save_capacity) {
+        size_t capacity = comp->save_capacity ? comp->save_capacity : 4096;
+        while (capacity < comp->save_used + size) capacity *= 2;
+        unsigned char* area = realloc(comp->save_area, capacity);
+        if (!area) {
+            fprintf(stderr, "Failed to save compiler state\n");
             return false;
         }
+        comp->save_area = area;
+        comp->save_capacity = capacity;
     }
+    memcpy(comp->save_area + comp->save_used, data, size);
+    comp->save_used += size;
+    return true;
+}
+
+static void restore_state(compiler_t* comp, void* data, size_t size) {
+    comp->save_used -= size;
+    memcpy(data, comp->save_area + comp->save_used, size);
+}
 
-    def->token_count++;
+/* Specialization cache: hash index bucket for (source_hash, input_types) */
+static int specialization_bucket(const unsigned char* source_hash,
+                                 const type_id_t* input_types, int input_count,
+                                 int index_size) {
+    uint64_t h;
+    memcpy(&h, source_hash, sizeof(h));  /* Already a cryptographic hash */
+    for (int i = 0; i < input_count; i++) {
+        h = (h ^ (uint64_t)input_types[i]) * 0x100000001b3ULL;
+    }
+    h = (h ^ (uint64_t)input_count) * 0x100000001b3ULL;
+    return (int)((h >> 32) & (uint64_t)(index_size - 1));
+}
+
+static bool specialization_matches(const specialization_t* spec, const unsigned char* source_hash,
+                                   const type_id_t* input_types, int input_count) {
+    if (spec->input_count != input_count) return false;
+    if (memcmp(spec->source_hash, source_hash, CID_SIZE) != 0) return false;
+    for (int i = 0; i < input_count; i++) {
+        if (spec->input_types[i] != input_types[i]) return false;
+    }
     return true;
 }
 
-/* Find word definition in cache */
-static word_definition_t* find_word_definition(compiler_t* comp, const char* name) {
-    for (int i = 0; i < comp->word_def_count; i++) {
-        if (strcmp(comp->word_defs[i]->name, name) == 0) {
-            return comp->word_defs[i];
-        }
+/* Specialization cache: make room for one more entry (lock held) */
+static bool specialization_cache_grow(spec_cache_t* specs) {
+    if (specs->count >= specs->capacity) {
+        int capacity = specs->capacity ? specs->capacity * 2 : 256;
+        specialization_t* entries = realloc(specs->entries, sizeof(specialization_t) * (size_t)capacity);
+        if (!entries) return false;
+        specs->entries = entries;
+        specs->capacity = capacity;
+    }
+    if ((specs->count + 1) * 2 <= specs->index_size) return true;
+
+    int size = specs->index_size ? specs->index_size * 2 : 1024;
+    int* index = calloc((size_t)size, sizeof(int));
+    if (!index) return false;
+    for (int i = 0; i < specs->count; i++) {
+        const specialization_t* spec = &specs->entries[i];
+        int bucket = specialization_bucket(spec->source_hash, spec->input_types,
+                                           spec->input_count, size);
+        while (index[bucket] != 0) bucket = (bucket + 1) & (size - 1);
+        index[bucket] = i + 1;
+    }
+    free(specs->index);
+    specs->index = index;
+    specs->index_size = size;
+    return true;
+}
+
+/* Specialization cache: forget this process's entries (the database
+ * keeps the persisted ones, invalidated by source hash) */
+static void specialization_cache_clear(spec_cache_t* specs) {
+    pthread_mutex_lock(&specs->lock);
+    for (int i = 0; i < specs->count; i++) {
+        free(specs->entries[i].word_name);
+        free(specs->entries[i].cid);
+    }
+    specs->count = 0;
+    if (specs->index) {
+        memset(specs->index, 0, sizeof(int) * (size_t)specs->index_size);
     }
-    return NULL;
+    pthread_mutex_unlock(&specs->lock);
 }
 
-/* Specialization cache: Look up compiled version by (word_name, input_types)
- * Returns cached CID if found, NULL otherwise */
-static unsigned char* specialization_lookup(compiler_t* comp, const char* word_name,
-                                             type_id_t* input_types, int input_count) {
-    for (int i = 0; i < comp->specialization_count; i++) {
-        specialization_t* spec = &comp->specializations[i];
+/* Specialization cache: Add an entry to the in-memory table and index.
+ * Returns 1 if added, 0 if another job stored the key first, -1 on error. */
+static int specialization_cache_put(spec_cache_t* specs, word_definition_t* word_def,
+                                    type_id_t* input_types, int input_count,
+                                    const unsigned char* cid) {
+    if (input_count > 8) {
+        return -1;
+    }
 
-        /* Check if word name matches */
-        if (strcmp(spec->word_name, word_name) != 0) {
-            continue;
-        }
+    pthread_mutex_lock(&specs->lock);
 
-        /* Check if input count matches */
-        if (spec->input_count != input_count) {
-            continue;
-        }
+    /* Grow first so the probe below ends at a bucket of the final index */
+    if (!specialization_cache_grow(specs)) {
+        pthread_mutex_unlock(&specs->lock);
+        fprintf(stderr, "Failed to grow specialization cache\n");
+        return -1;
+    }
 
-        /* Check if all input types match */
-        bool types_match = true;
-        for (int j = 0; j < input_count; j++) {
-            if (spec->input_types[j] != input_types[j]) {
-                types_match = false;
-                break;
-            }
+    int bucket = specialization_bucket(word_def->source_hash, input_types, input_count,
+                                       specs->index_size);
+    while (specs->index[bucket] != 0) {
+        specialization_t* spec = &specs->entries[specs->index[bucket] - 1];
+        if (specialization_matches(spec, word_def->source_hash, input_types, input_count)) {
+            pthread_mutex_unlock(&specs->lock);
+            return 0;
         }
+        bucket = (bucket + 1) & (specs->index_size - 1);
+    }
+
+    specialization_t* spec = &specs->entries[specs->count];
 
-        if (types_match) {
-            return spec->cid;  /* Cache hit! */
+    /* Store word name and CID (copy 32 bytes) */
+    spec->word_name = strdup(word_def->name);
+    spec->cid = malloc(CID_SIZE);
+    if (!spec->word_name || !spec->cid) {
+        free(spec->word_name);
+        free(spec->cid);
+        pthread_mutex_unlock(&specs->lock);
+        return -1;
+    }
+    memcpy(spec->cid, cid, CID_SIZE);
+
+    /* Store key: source hash and input types */
+    memcpy(spec->source_hash, word_def->source_hash, CID_SIZE);
+    spec->input_count = input_count;
+    for (int i = 0; i < input_count; i++) {
+        spec->input_types[i] = input_types[i];
+    }
+
+    /* Index it in the free bucket the probe stopped at */
+    specs->index[bucket] = ++specs->count;
+
+    pthread_mutex_unlock(&specs->lock);
+    return 1;
+}
+
+/* Specialization cache: Look up compiled version by (source_hash, input_types)
+ * in memory, falling back to the specializations table */
+unsigned char* specialization_lookup(compiler_t* comp, word_definition_t* word_def,
+                                     type_id_t* input_types, int input_count, bool* from_db) {
+    if (from_db) *from_db = false;
+    if (!word_def || input_count > 8) {
+        return NULL;
+    }
+
+    unsigned char* cid = malloc(CID_SIZE);
+    if (!cid) {
+        return NULL;
+    }
+
+    spec_cache_t* specs = comp->specs;
+    pthread_mutex_lock(&specs->lock);
+    int bucket = specialization_bucket(word_def->source_hash, input_types, input_count,
+                                       specs->index_size);
+    while (specs->index_size && specs->index[bucket] != 0) {
+        specialization_t* spec = &specs->entries[specs->index[bucket] - 1];
+        if (specialization_matches(spec, word_def->source_hash, input_types, input_count)) {
+            memcpy(cid, spec->cid, CID_SIZE);
+            pthread_mutex_unlock(&specs->lock);
+            return cid;  /* Cache hit! */
         }
+        bucket = (bucket + 1) & (specs->index_size - 1);
     }
+    pthread_mutex_unlock(&specs->lock);
 
-    return NULL;  /* Cache miss */
+    /* Compiled by a previous run? */
+    uint8_t key[8];
+    for (int i = 0; i < input_count; i++) {
+        key[i] = (uint8_t)input_types[i];
+    }
+    if (!db_lookup_specialization(comp->db, word_def->source_hash, key, (size_t)input_count, cid) ||
+        db_get_blob_kind(comp->db, cid) != BLOB_WORD) {
+        free(cid);
+        return NULL;  /* Cache miss */
+    }
+
+    specialization_cache_put(specs, word_def, input_types, input_count, cid);
+    if (from_db) *from_db = true;
+    return cid;
 }
 
 /* Specialization cache: Store compiled version */
-static bool specialization_store(compiler_t* comp, const char* word_name,
-                                  type_id_t* input_types, int input_count,
-                                  const unsigned char* cid) {
-    if (comp->specialization_count >= MAX_SPECIALIZATIONS) {
-        fprintf(stderr, "Warning: Specialization cache full (max %d)\n", MAX_SPECIALIZATIONS);
-        return false;
+bool specialization_store(compiler_t* comp, word_definition_t* word_def,
+                          type_id_t* input_types, int input_count,
+                          const unsigned char* cid, const char* type_sig) {
+    int added = specialization_cache_put(comp->specs, word_def, input_types, input_count, cid);
+    if (added <= 0) {
+        return added == 0;  /* Already stored by a concurrent job */
     }
 
-    specialization_t* spec = &comp->specializations[comp->specialization_count];
+    uint8_t key[8];
+    for (int i = 0; i < input_count; i++) {
+        key[i] = (uint8_t)input_types[i];
+    }
+    db_store_specialization(comp->db, word_def->source_hash, key, (size_t)input_count,
+                            cid, word_def->name, type_sig);
 
-    /* Store word name */
-    spec->word_name = strdup(word_name);
-    if (!spec->word_name) {
-        return false;
+    /* defs.source_hash is what the next run compares against */
+    char* hash_hex = cid_to_hex(word_def->source_hash);
+    if (hash_hex) {
+        db_store_def_source(comp->db, cid, word_def->source_text, hash_hex);
+        free(hash_hex);
     }
 
-    /* Store input types */
-    spec->input_count = input_count;
-    for (int i = 0; i < input_count; i++) {
-        spec->input_types[i] = input_types[i];
+    if (comp->verbose) {
+        printf("  Cached specialization: %s with %d input types\n",
+               word_def->name, input_count);
     }
 
-    /* Store CID (copy 32 bytes) */
-    spec->cid = malloc(CID_SIZE);
-    if (!spec->cid) {
-        free(spec->word_name);
+    return true;
+}
+
+/* Quotation cache: hash of (tokens, input types), or false if the body
+ * names a word being compiled (that is a recursive call, an error that
+ * must not be answered from another context's blob) */
+static bool quotation_key_hash(compiler_t* comp, const quotation_t* quot, uint64_t* out) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < quot->token_count; i++) {
+        const token_t* tok = &quot->tokens[i];
+        if (tok->type == TOK_WORD) {
+            for (compile_frame_t* f = comp->frame; f; f = f->outer) {
+                if (f->word_def->name_sym == tok->sym) return false;
+            }
+        }
+        h = (h ^ (uint64_t)tok->type) * 0x100000001b3ULL;
+        h = (h ^ (uint64_t)(uintptr_t)tok->text) * 0x100000001b3ULL;
+        h = (h ^ (uint64_t)tok->number) * 0x100000001b3ULL;
+    }
+    for (int i = 0; i < quot->input_count; i++) {
+        h = (h ^ (uint64_t)quot->inputs[i]) * 0x100000001b3ULL;
+    }
+    *out = (h ^ (uint64_t)quot->input_count) * 0x100000001b3ULL;
+    return true;
+}
+
+static bool quotation_matches(const quot_cache_entry_t* entry, const quotation_t* quot,
+                              uint64_t hash) {
+    if (entry->hash != hash || entry->token_count != quot->token_count ||
+        entry->input_count != quot->input_count) {
         return false;
     }
-    memcpy(spec->cid, cid, CID_SIZE);
+    for (int i = 0; i < quot->token_count; i++) {
+        const token_t* a = &entry->tokens[i];
+        const token_t* b = &quot->tokens[i];
+        if (a->type != b->type || a->text != b->text || a->number != b->number) return false;
+    }
+    return memcmp(entry->input_types, quot->inputs,
+                  sizeof(type_id_t) * (size_t)quot->input_count) == 0;
+}
 
-    comp->specialization_count++;
+static void quotation_entry_free(quot_cache_entry_t* entry) {
+    free(entry->tokens);
+    free(entry->input_types);
+    inline_deps_free(&entry->evaluated);
+}
 
-    if (comp->verbose) {
-        printf("  Cached specialization #%d: %s with %d input types\n",
-               comp->specialization_count, word_name, input_count);
+/* Quotation cache: forget every entry (lock taken here) */
+static void quotation_cache_clear(spec_cache_t* specs) {
+    pthread_mutex_lock(&specs->lock);
+    for (int i = 0; i < specs->quot_count; i++) {
+        quotation_entry_free(&specs->quots[i]);
+    }
+    specs->quot_count = 0;
+    if (specs->quot_index) {
+        memset(specs->quot_index, 0, sizeof(int) * (size_t)specs->quot_index_size);
     }
+    pthread_mutex_unlock(&specs->lock);
+}
 
+/* Quotation cache: make room for one more entry (lock held) */
+static bool quotation_cache_grow(spec_cache_t* specs) {
+    if (specs->quot_count >= specs->quot_capacity) {
+        int capacity = specs->quot_capacity ? specs->quot_capacity * 2 : 64;
+        quot_cache_entry_t* quots = realloc(specs->quots, sizeof(quot_cache_entry_t) * (size_t)capacity);
+        if (!quots) return false;
+        specs->quots = quots;
+        specs->quot_capacity = capacity;
+    }
+    if ((specs->quot_count + 1) * 2 <= specs->quot_index_size) return true;
+
+    int size = specs->quot_index_size ? specs->quot_index_size * 2 : 256;
+    int* index = calloc((size_t)size, sizeof(int));
+    if (!index) return false;
+    for (int i = 0; i < specs->quot_count; i++) {
+        int bucket = (int)((specs->quots[i].hash >> 32) & (uint64_t)(size - 1));
+        while (index[bucket] != 0) bucket = (bucket + 1) & (size - 1);
+        index[bucket] = i + 1;
+    }
+    free(specs->quot_index);
+    specs->quot_index = index;
+    specs->quot_index_size = size;
     return true;
 }
 
+/* Quotation cache: CID of an identical quotation materialized before, or
+ * NULL. The calls its compilation evaluated are credited to this word too. */
+static unsigned char* quotation_cache_lookup(compiler_t* comp, const quotation_t* quot,
+                                             uint64_t hash) {
+    spec_cache_t* specs = comp->specs;
+    unsigned char* cid = NULL;
+
+    pthread_mutex_lock(&specs->lock);
+    int bucket = (int)((hash >> 32) & (uint64_t)(specs->quot_index_size - 1));
+    while (specs->quot_index_size && specs->quot_index[bucket] != 0) {
+        const quot_cache_entry_t* entry = &specs->quots[specs->quot_index[bucket] - 1];
+        if (quotation_matches(entry, quot, hash)) {
+            cid = malloc(CID_SIZE);
+            bool ok = cid != NULL;
+            if (ok) memcpy(cid, entry->cid, CID_SIZE);
+            for (size_t i = 0; ok && comp->frame && i < entry->evaluated.count; i++) {
+                ok = inline_deps_add(&comp->frame->evaluated, entry->evaluated.cids[i]);
+            }
+            if (ok) {
+                specs->quot_hits++;
+            } else {
+                free(cid);
+                cid = NULL;
+            }
+            break;
+        }
+        bucket = (bucket + 1) & (specs->quot_index_size - 1);
+    }
+    pthread_mutex_unlock(&specs->lock);
+    return cid;
+}
+
+/* Quotation cache: remember a materialized quotation (best effort) */
+static void quotation_cache_put(compiler_t* comp, const quotation_t* quot, uint64_t hash,
+                                const unsigned char* cid, const inline_deps_t* evaluated,
+                                size_t evaluated_from) {
+    spec_cache_t* specs = comp->specs;
+    pthread_mutex_lock(&specs->lock);
+
+    if (!quotation_cache_grow(specs)) {
+        pthread_mutex_unlock(&specs->lock);
+        return;
+    }
+
+    int bucket = (int)((hash >> 32) & (uint64_t)(specs->quot_index_size - 1));
+    while (specs->quot_index[bucket] != 0) {
+        if (quotation_matches(&specs->quots[specs->quot_index[bucket] - 1], quot, hash)) {
+            pthread_mutex_unlock(&specs->lock);
+            return;  /* Another job stored it first */
+        }
+        bucket = (bucket + 1) & (specs->quot_index_size - 1);
+    }
+
+    quot_cache_entry_t* entry = &specs->quots[specs->quot_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->hash = hash;
+    entry->token_count = quot->token_count;
+    entry->input_count = quot->input_count;
+    entry->tokens = malloc(sizeof(token_t) * (size_t)(quot->token_count + 1));
+    entry->input_types = malloc(sizeof(type_id_t) * (size_t)(quot->input_count + 1));
+    bool ok = entry->tokens && entry->input_types;
+    if (ok) {
+        memcpy(entry->tokens, quot->tokens, sizeof(token_t) * (size_t)quot->token_count);
+        memcpy(entry->input_types, quot->inputs, sizeof(type_id_t) * (size_t)quot->input_count);
+        memcpy(entry->cid, cid, CID_SIZE);
+    }
+    for (size_t i = evaluated_from; ok && evaluated && i < evaluated->count; i++) {
+        ok = inline_deps_add(&entry->evaluated, evaluated->cids[i]);
+    }
+
+    if (ok) {
+        specs->quot_index[bucket] = ++specs->quot_count;
+    } else {
+        quotation_entry_free(entry);
+    }
+    pthread_mutex_unlock(&specs->lock);
+}
+
 /* Free compiler */
 void compiler_free(compiler_t* comp) {
     if (comp) {
-        cell_buffer_free(comp->cells);
-        blob_buffer_free(comp->blob);
+        ir_buffer_free(comp->ir);
+        inline_deps_free(&comp->inlined);
         /* Free reference graph if still allocated */
         if (comp->ref_graph) {
             ref_graph_free(comp->ref_graph);
@@ -237,80 +607,48 @@ void compiler_free(compiler_t* comp) {
         for (int i = 0; i < comp->pending_quot_count; i++) {
             free(comp->pending_quot_cids[i]);
         }
+        free(comp->pending_quot_cids);
         /* Free word definitions */
         for (int i = 0; i < comp->word_def_count; i++) {
             word_definition_free(comp->word_defs[i]);
         }
-        /* Free specialization cache */
-        for (int i = 0; i < comp->specialization_count; i++) {
-            free(comp->specializations[i].word_name);
-            free(comp->specializations[i].cid);
+        free(comp->word_defs);
+        free(comp->word_by_sym);
+        free(comp->slot_used);
+        free(comp->save_area);
+        /* Free specialization cache (owned by the root compiler) */
+        if (!comp->parent && comp->specs) {
+            for (int i = 0; i < comp->specs->count; i++) {
+                free(comp->specs->entries[i].word_name);
+                free(comp->specs->entries[i].cid);
+            }
+            free(comp->specs->entries);
+            free(comp->specs->index);
+            for (int i = 0; i < comp->specs->quot_count; i++) {
+                quotation_entry_free(&comp->specs->quots[i]);
+            }
+            free(comp->specs->quots);
+            free(comp->specs->quot_index);
+            pthread_mutex_destroy(&comp->specs->lock);
+            free(comp->specs);
         }
         free(comp);
     }
 }
 
 /* Register primitives */
-void compiler_register_primitives(compiler_t* comp) {
-    type_sig_t sig;
+/* Primitives and immediate words of primitives.def, parsed and
+ * perfect-hashed at build time (gen_primtab) */
+#define PRIMTAB_COMPILER
+#include "primtab.h"
 
+void compiler_register_primitives(compiler_t* comp) {
     DEBUG_COMPILER("Registering primitives...");
 
-    /* Register assembly primitives */
-    register_primitives(comp->dict);
-
-    /* Register immediate (compile-time) words */
-
-    /* if: ( flag quot_true quot_false -- ... ) */
-    /* Type checking handled dynamically based on quotations */
-    parse_type_sig("->", &sig);  /* Minimal signature - real checking in handler */
-    dict_add(comp->dict, "if", NULL, NULL, 0, &sig, false, true,
-             (immediate_handler_t)compile_if, NULL);
-
-    /* true: ( -- -1 ) */
-    parse_type_sig("-> i64", &sig);
-    dict_add(comp->dict, "true", NULL, NULL, 0, &sig, false, true,
-             (immediate_handler_t)compile_true, NULL);
-
-    /* false: ( -- 0 ) */
-    parse_type_sig("-> i64", &sig);
-    dict_add(comp->dict, "false", NULL, NULL, 0, &sig, false, true,
-             (immediate_handler_t)compile_false, NULL);
-
-    /* times: Polymorphic - dispatches based on quotation stack depth
-     *   1 quotation:  count ( body ) times - counted loop
-     *   2 quotations: ( cond ) ( body ) times - until-style loop */
-    parse_type_sig("i64 ->", &sig);
-    dict_add(comp->dict, "times", NULL, NULL, 0, &sig, false, true,
-             (immediate_handler_t)compile_times_dispatch, NULL);
-
-    /* Stack manipulation primitives with compile-time RC tracking */
-    /* These override the runtime primitives registered by register_primitives() */
-
-    /* drop: ( a -- ) */
-    parse_type_sig("a ->", &sig);
-    dict_add(comp->dict, "drop", NULL, NULL, PRIM_DROP, &sig, false, true,
-             (immediate_handler_t)compile_drop, NULL);
-
-    /* dup: ( a -- a a ) */
-    parse_type_sig("a -> a a", &sig);
-    dict_add(comp->dict, "dup", NULL, NULL, PRIM_DUP, &sig, false, true,
-             (immediate_handler_t)compile_dup, NULL);
-
-    /* swap: ( a b -- b a ) */
-    parse_type_sig("a b -> b a", &sig);
-    dict_add(comp->dict, "swap", NULL, NULL, PRIM_SWAP, &sig, false, true,
-             (immediate_handler_t)compile_swap, NULL);
-
-    /* over: ( a b -- a b a ) */
-    parse_type_sig("a b -> a b a", &sig);
-    dict_add(comp->dict, "over", NULL, NULL, PRIM_OVER, &sig, false, true,
-             (immediate_handler_t)compile_over, NULL);
-
-    /* rot: ( a b c -- b c a ) */
-    parse_type_sig("a b c -> b c a", &sig);
-    dict_add(comp->dict, "rot", NULL, NULL, PRIM_ROT, &sig, false, true,
-             (immediate_handler_t)compile_rot, NULL);
+    /* Assembly primitives, then the immediate (compile-time) words; the
+     * stack words among them override the runtime primitives to track
+     * reference counts at compile time */
+    dict_use_builtins(comp->dict, &compiler_builtins);
 
     debug_dump_dict_stats(comp->dict);
 }
@@ -338,22 +676,31 @@ static void push_type(compiler_t* comp, type_id_t type) {
 /* Allocate a slot for heap allocation tracking */
 static int allocate_slot(compiler_t* comp) {
     /* Find first free slot */
-    for (int i = 0; i < MAX_SLOTS; i++) {
-        if (!comp->slot_used[i]) {
-            comp->slot_used[i] = true;
-            if (i >= comp->slot_count) {
-                comp->slot_count = i + 1;  /* Track peak usage */
-            }
-            return i;
+    int i = 0;
+    while (i < comp->slot_capacity && comp->slot_used[i]) i++;
+
+    if (i == comp->slot_capacity) {
+        int capacity = comp->slot_capacity ? comp->slot_capacity * 2 : 64;
+        bool* used = realloc(comp->slot_used, sizeof(bool) * (size_t)capacity);
+        if (!used) {
+            fprintf(stderr, "Error: Cannot grow allocation slots\n");
+            return -1;
         }
+        memset(used + comp->slot_capacity, 0, sizeof(bool) * (size_t)(capacity - comp->slot_capacity));
+        comp->slot_used = used;
+        comp->slot_capacity = capacity;
     }
-    fprintf(stderr, "Error: Too many allocation slots (max %d)\n", MAX_SLOTS);
-    return -1;
+
+    comp->slot_used[i] = true;
+    if (i >= comp->slot_count) {
+        comp->slot_count = i + 1;  /* Track peak usage */
+    }
+    return i;
 }
 
 /* Free a slot (mark as available for reuse) */
 static void free_slot(compiler_t* comp, int slot_id) {
-    if (slot_id >= 0 && slot_id < MAX_SLOTS) {
+    if (slot_id >= 0 && slot_id < comp->slot_capacity) {
         comp->slot_used[slot_id] = false;
     }
 }
@@ -412,6 +759,34 @@ static type_stack_entry_t pop_type_entry(compiler_t* comp) {
  * Slots are only freed at word end if they're not on the return stack.
  */
 
+/* Emit a primitive call */
+static bool emit_prim(compiler_t* comp, dict_entry_t* entry) {
+    return ir_emit_prim(comp->ir, entry->prim_id, entry->addr);
+}
+
+/* Emit an i64 literal as a BLOB_DATA reference */
+static bool emit_data_literal(compiler_t* comp, int64_t value) {
+    unsigned char* cid = db_store_literal(comp->db, value, "i64");
+    if (!cid) {
+        fprintf(stderr, "Error: Failed to store literal %ld\n", value);
+        return false;
+    }
+    bool ok = ir_emit_ref(comp->ir, BLOB_DATA, cid, TYPE_I64, value);
+    free(cid);
+    return ok;
+}
+
+/* Optimizer passes for comp->opt_level over a word or quotation body;
+ * inlined callees are added to deps */
+static void optimize_code(compiler_t* comp, ir_buffer_t* ir, inline_deps_t* deps) {
+    if (comp->opt_level >= OPT_INLINE) {
+        inline_ir(ir, comp->db, comp->dict, deps, &comp->opt_stats);
+    }
+    if (comp->opt_level > OPT_NONE) {
+        optimize_ir(ir, comp->dict, comp->opt_level, &comp->opt_stats);
+    }
+}
+
 /* Recursive mark function for liveness analysis */
 static void mark_node(ref_graph_t* graph, node_id_t node_id, bool* marked) {
     if (node_id == NODE_ID_INVALID) return;
@@ -430,19 +805,14 @@ static void mark_node(ref_graph_t* graph, node_id_t node_id, bool* marked) {
 
 /* Perform liveness analysis and emit FREE instructions for dead nodes */
 static void emit_free_for_dead_nodes(compiler_t* comp) {
-    fprintf(stderr, "TRACE: emit_free_for_dead_nodes entry, comp=%p, ref_graph=%p\n",
-            (void*)comp, (void*)(comp ? comp->ref_graph : NULL));
-    if (comp && comp->ref_graph) {
-        fprintf(stderr, "TRACE: ref_graph has %zu nodes\n", comp->ref_graph->node_count);
-    }
-    fflush(stderr);
+    TRACE_WORD(DEBUG_COMPILER, "emit_free_for_dead_nodes: ref_graph=%p nodes=%zu",
+               (void*)(comp ? comp->ref_graph : NULL),
+               comp && comp->ref_graph ? comp->ref_graph->node_count : (size_t)0);
 
     if (!comp || !comp->ref_graph || comp->ref_graph->node_count == 0) {
         if (comp && comp->verbose && !comp->ref_graph) {
             printf("  (No ref_graph - skipping liveness analysis)\n");
         }
-        fprintf(stderr, "TRACE: Skipping liveness analysis (no nodes)\n");
-        fflush(stderr);
         return;  /* No heap allocations in this word */
     }
 
@@ -496,10 +866,8 @@ static void emit_free_for_dead_nodes(compiler_t* comp) {
                     printf("    FREE node=%u slot=%d (dead, not reachable)\n",
                            node->node_id, node->slot_id);
                 }
-                cell_buffer_append(comp->cells, encode_lit(node->slot_id));
-                encode_inline_literal(comp->blob, node->slot_id);
-                cell_buffer_append(comp->cells, encode_xt(free_prim->addr));
-                encode_primitive(comp->blob, free_prim->prim_id);
+                ir_emit_lit(comp->ir, node->slot_id);
+                emit_prim(comp, free_prim);
             }
         }
     }
@@ -588,17 +956,10 @@ static bool compile_number(compiler_t* comp, int64_t num) {
                             comp->quot_stack_depth,
                             comp->buffer_stack_depth);
 
-    /* Legacy: Emit LIT cell */
-    cell_buffer_append(comp->cells, encode_lit(num));
-
-    /* CID-based: Store literal and encode reference */
-    unsigned char* cid = db_store_literal(comp->db, num, "i64");
-    if (!cid) {
-        fprintf(stderr, "Error: Failed to store literal %ld\n", num);
+    /* Store literal and emit its reference */
+    if (!emit_data_literal(comp, num)) {
         return false;
     }
-    encode_cid_ref(comp->blob, BLOB_DATA, cid);
-    free(cid);
 
     /* Push i64 type */
     push_type(comp, TYPE_I64);
@@ -658,9 +1019,11 @@ static bool compile_string(compiler_t* comp, const char* str) {
     }
 
     /* Emit: CID reference only (loader will cache the blob, return pointer) */
-    cell_buffer_append(comp->cells, encode_lit(0));  /* Placeholder for legacy */
-    encode_cid_ref(comp->blob, BLOB_DATA, str_cid);
+    bool emitted = ir_emit_ref(comp->ir, BLOB_DATA, str_cid, TYPE_STR, 0);
     free(str_cid);
+    if (!emitted) {
+        return false;
+    }
 
     /* Stack: [str_ptr] - immutable pointer to cached blob */
     push_type(comp, TYPE_STR);
@@ -672,10 +1035,228 @@ static bool compile_string(compiler_t* comp, const char* str) {
     return true;
 }
 
+/* Type signature string of a specialization: concrete inputs, then the
+ * type stack at the call site (trailing space trimmed) */
+static const char* sig_type_name(type_id_t t) {
+    switch (t) {
+        case TYPE_I64: return "i64";
+        case TYPE_U64: return "u64";
+        case TYPE_F64: return "f64";
+        case TYPE_PTR: return "ptr";
+        case TYPE_BOOL: return "bool";
+        case TYPE_STR: return "str";
+        case TYPE_ARRAY: return "array";
+        default: return "?";
+    }
+}
+
+static void format_specialization_sig(compiler_t* comp, const type_id_t* inputs, int input_count,
+                                      char* out, size_t out_size) {
+    size_t len = 0;
+    out[0] = '\0';
+    for (int i = 0; i < input_count + 1 + comp->type_stack_depth; i++) {
+        const char* name;
+        if (i == input_count) {
+            name = "->";
+        } else {
+            name = sig_type_name(i < input_count ? inputs[i]
+                                                 : comp->type_stack[i - input_count - 1].type);
+        }
+        int n = snprintf(out + len, out_size - len, "%s%s", len ? " " : "", name);
+        if (n < 0 || (size_t)n >= out_size - len) break;
+        len += (size_t)n;
+    }
+}
+
+/* Specialized version of a token-based word for concrete input types:
+ * from the cache, or compiled, stored and bound (returns CID, caller must free) */
+static unsigned char* specialization_get(compiler_t* comp, const char* name, dict_entry_t* entry,
+                                         type_id_t* concrete_inputs, int input_count) {
+    /* Phase 3: Check specialization cache (this run, then earlier runs) */
+    bool from_db = false;
+    unsigned char* cid = specialization_lookup(comp, entry->word_def, concrete_inputs,
+                                               input_count, &from_db);
+
+    if (cid) {
+        /* Cache hit! Reuse existing specialization */
+        if (comp->verbose) {
+            printf("  Cache HIT: Reusing specialization of '%s'%s\n", name,
+                   from_db ? " (from database)" : "");
+        }
+        /* From an earlier run: its callees were not compiled (or bound) either */
+        if (from_db) {
+            db_rebind_specializations(comp->db, cid);
+        }
+    } else {
+        /* Cache miss - compile the word with concrete types */
+        if (comp->verbose) {
+            printf("  Cache MISS: Compiling specialization of '%s'\n", name);
+        }
+
+        blob_buffer_t* compiled_blob = word_compile_with_context(comp, entry->word_def,
+                                                                  concrete_inputs, input_count);
+        if (!compiled_blob) {
+            fprintf(stderr, "Failed to compile word '%s' with concrete types\n", name);
+            return NULL;
+        }
+
+        /* Store the compiled blob in database */
+        char type_sig_str[256];
+        format_specialization_sig(comp, concrete_inputs, input_count,
+                                  type_sig_str, sizeof(type_sig_str));
+
+        unsigned char* sig_cid = db_store_type_sig(comp->db, NULL, type_sig_str);
+        if (!sig_cid) {
+            fprintf(stderr, "Failed to store type signature for specialization\n");
+            blob_buffer_free(compiled_blob);
+            return NULL;
+        }
+
+        cid = db_store_blob(comp->db, BLOB_WORD, sig_cid,
+                            compiled_blob->data, compiled_blob->size);
+        free(sig_cid);
+
+        if (!cid) {
+            blob_buffer_free(compiled_blob);
+            fprintf(stderr, "Failed to store compiled specialization\n");
+            return NULL;
+        }
+
+        /* Record references (GC edges) and bind the specialization as a root */
+        db_store_edges(comp->db, cid, compiled_blob->data, compiled_blob->size);
+        inline_deps_store(comp->db, cid, &comp->inlined);
+        blob_buffer_free(compiled_blob);
+        db_bind_word(comp->db, name, NULL, cid, type_sig_str);
+
+        /* Phase 3: Store in specialization cache for future reuse */
+        specialization_store(comp, entry->word_def, concrete_inputs, input_count,
+                             cid, type_sig_str);
+        db_store_def_effects(comp->db, cid, comp->effects, effects_pure(comp->effects));
+        db_store_def_depth(comp->db, cid, comp->depth.data_max, comp->depth.data_effect,
+                           comp->depth.return_max);
+    }
+
+    return cid;
+}
+
+/* `$ memo` word body: memo-enter <arity> body memo-exit. A hit in the
+ * table returns from memo-enter, so only pure words are memoized. */
+static bool wrap_memo(compiler_t* comp, ir_buffer_t* ir, const word_definition_t* word_def) {
+    const type_sig_t* sig = word_def->type_sig;
+    if (!effects_pure(comp->effects)) {
+        fprintf(stderr, "Warning: memo word '%s' has side effects, not memoized\n",
+                word_def->name);
+        return true;
+    }
+    if (sig->input_count + sig->output_count > MEMO_MAX_CELLS) {
+        fprintf(stderr, "Warning: memo word '%s' has more than %d inputs and outputs, "
+                "not memoized\n", word_def->name, MEMO_MAX_CELLS);
+        return true;
+    }
+    dict_entry_t* enter = dict_lookup(comp->dict, "memo-enter");
+    dict_entry_t* exit = dict_lookup(comp->dict, "memo-exit");
+    if (!enter || !enter->is_primitive || enter->prim_id != PRIM_MEMO_ENTER ||
+        !exit || !exit->is_primitive || exit->prim_id != PRIM_MEMO_EXIT) {
+        return true;
+    }
+
+    ir_buffer_t* out = ir_buffer_create();
+    if (!out) return false;
+    bool ok = ir_emit_prim(out, PRIM_MEMO_ENTER, enter->addr) &&
+              ir_emit_lit(out, (int64_t)memo_arity(sig->input_count, sig->output_count)) &&
+              ir_append(out, ir) &&
+              ir_emit_prim(out, PRIM_MEMO_EXIT, exit->addr);
+    if (ok) {
+        ir_instr_t* instrs = ir->instrs;
+        ir->instrs = out->instrs;
+        ir->count = out->count;
+        ir->capacity = out->capacity;
+        ir->label_count = out->label_count;
+        out->instrs = instrs;
+    }
+    ir_buffer_free(out);
+
+    if (ok && comp->verbose) {
+        printf("  Memoized: %s\n", word_def->name);
+    }
+    return ok;
+}
+
+/* Call of a word from inside its own compilation. Only direct recursion
+ * with unchanged input types can be compiled: eliminate_tail_calls turns
+ * a tail call into a branch to the start, others link to the word itself. */
+static bool compile_recursion(compiler_t* comp, const char* name, dict_entry_t* entry,
+                              compile_frame_t* frame, const type_id_t* inputs, int input_count) {
+    if (frame != comp->frame) {
+        fprintf(stderr, "Error: mutual recursion through '%s' is not supported\n", name);
+        return false;
+    }
+    if (!entry->word_def->type_sig) {
+        fprintf(stderr, "Error: recursive word '%s' needs a $ type signature\n", name);
+        return false;
+    }
+    bool same_inputs = input_count == frame->input_count;
+    for (int i = 0; same_inputs && i < input_count; i++) {
+        same_inputs = inputs[i] == frame->inputs[i];
+    }
+    if (!same_inputs) {
+        fprintf(stderr, "Error: recursive call of '%s' with different input types\n", name);
+        return false;
+    }
+
+    if (!apply_signature(comp, &entry->signature)) {
+        fprintf(stderr, "Type error in word: %s\n", name);
+        return false;
+    }
+
+    if (comp->verbose) {
+        printf("  Recursive call of '%s'\n", name);
+    }
+    return ir_emit_recurse(comp->ir);
+}
+
+/* At -O 1 and above, run a call of a pure word whose inputs are all
+ * literals in the sandbox evaluator. On success the literals have been
+ * dropped from comp->ir and results holds the word's outputs. */
+static bool evaluate_call(compiler_t* comp, dict_entry_t* entry, const unsigned char* cid,
+                          int64_t* results) {
+    int input_count = entry->signature.input_count;
+    int output_count = entry->signature.output_count;
+    if (comp->opt_level == OPT_NONE || output_count > MAX_EVAL_RESULTS ||
+        input_count > MAX_EVAL_RESULTS || (size_t)input_count > comp->ir->count) {
+        return false;
+    }
+
+    uint32_t effects;
+    if (!db_load_def_effects(comp->db, cid, &effects) || !effects_pure(effects)) {
+        return false;
+    }
+
+    int64_t args[MAX_EVAL_RESULTS];
+    size_t first = comp->ir->count - (size_t)input_count;
+    for (int i = 0; i < input_count; i++) {
+        if (!optimizer_const_value(&comp->ir->instrs[first + i], &args[i])) return false;
+    }
+
+    if (!evaluate_word(comp->db, cid, args, input_count, results, output_count)) {
+        return false;
+    }
+    for (int i = 0; i < output_count; i++) {
+        if (results[i] < LIT_MIN || results[i] > LIT_MAX) return false;
+    }
+
+    comp->ir->count = first;
+    comp->opt_stats.evaluated++;
+    if (comp->verbose) {
+        printf("  Evaluated pure call of '%s' at compile time\n", entry->name);
+    }
+    return true;
+}
+
 /* Compile a word reference */
 static bool compile_word(compiler_t* comp, const char* name) {
-    fprintf(stderr, "TRACE: compile_word('%s') entry\n", name);
-    fflush(stderr);
+    TRACE_TOKEN(DEBUG_COMPILER, "compile_word '%s' type_depth=%d quot_depth=%d buffer_depth=%d",
+                name, comp->type_stack_depth, comp->quot_stack_depth, comp->buffer_stack_depth);
 
     /* Update crash context */
     crash_context_set_token(name);
@@ -683,53 +1264,43 @@ static bool compile_word(compiler_t* comp, const char* name) {
                             comp->quot_stack_depth,
                             comp->buffer_stack_depth);
 
-    fprintf(stderr, "TRACE: Looking up word '%s'\n", name);
-    fflush(stderr);
-
-    /* Lookup word (may be immediate, primitive, or user word) */
-    dict_entry_t* entry = dict_lookup(comp->dict, name);
-
-    fprintf(stderr, "TRACE: Lookup result: %s\n", entry ? "found" : "not found");
-    fflush(stderr);
+    /* Lookup word (may be immediate, primitive, or user word): one probe
+     * finds every overload of the name */
+    dict_group_t* group = dict_lookup_group(comp->dict, name);
 
-    if (!entry) {
+    if (!group) {
         fprintf(stderr, "Unknown word: %s\n", name);
         return false;
     }
 
     /* Check if immediate */
-    bool is_immediate = entry->is_immediate;
-
-    fprintf(stderr, "TRACE: is_immediate=%d, quot_depth=%d buffer_depth=%d\n",
-            is_immediate, comp->quot_stack_depth, comp->buffer_stack_depth);
-    fflush(stderr);
+    bool is_immediate = group->latest->is_immediate;
 
     /* Materialize any pending quotations ONLY for non-immediate words */
     /* Immediate words (like 'times', 'if') consume quotations directly */
     if (!is_immediate && comp->quot_stack_depth > 0 && comp->buffer_stack_depth == 0) {
-        fprintf(stderr, "TRACE: Materializing quotations\n");
-        fflush(stderr);
+        TRACE_TOKEN(DEBUG_COMPILER, "materializing %d quotations before '%s'",
+                    comp->quot_stack_depth, name);
         if (!materialize_quotations(comp)) {
             return false;
         }
     }
 
-    fprintf(stderr, "TRACE: Doing type-aware lookup for '%s'\n", name);
-    fflush(stderr);
-
-    /* Extract types for type-aware lookup */
-    type_id_t types[MAX_TYPE_STACK];
-    for (int i = 0; i < comp->type_stack_depth; i++) {
-        types[i] = comp->type_stack[i].type;
+    /* Extract types for type-aware lookup: no signature has more than 8
+     * inputs, so only the top 8 entries can affect the match */
+    int depth = comp->type_stack_depth < 8 ? comp->type_stack_depth : 8;
+    int base = comp->type_stack_depth - depth;
+    type_id_t types[8];
+    for (int i = 0; i < depth; i++) {
+        types[i] = comp->type_stack[base + i].type;
     }
 
     /* Do type-aware lookup for overload resolution (works for both immediate and regular) */
-    entry = dict_lookup_typed(comp->dict, name,
-                             types,
-                             comp->type_stack_depth);
+    dict_entry_t* entry = dict_group_select(group, types, depth);
 
-    fprintf(stderr, "TRACE: Type-aware lookup result: %s\n", entry ? "found" : "not found");
-    fflush(stderr);
+    TRACE_TOKEN(DEBUG_COMPILER, "'%s': %d overloads, selected %s", name, group->count,
+                entry ? (entry->is_immediate ? "immediate" : entry->is_primitive ? "primitive" : "word")
+                      : "none");
 
     if (!entry) {
         DEBUG_COMPILER("Failed to find match for word: %s", name);
@@ -740,8 +1311,6 @@ static bool compile_word(compiler_t* comp, const char* name) {
 
     /* If immediate word, call its handler (after type-aware selection!) */
     if (entry->is_immediate) {
-        fprintf(stderr, "TRACE: Calling immediate handler for '%s'\n", name);
-        fflush(stderr);
         if (!entry->handler) {
             fprintf(stderr, "Internal error: immediate word '%s' has no handler\n", name);
             return false;
@@ -771,83 +1340,33 @@ static bool compile_word(compiler_t* comp, const char* name) {
             concrete_inputs[i] = comp->type_stack[start_idx + i].type;
         }
 
-        /* Phase 3: Check specialization cache */
-        unsigned char* cached_cid = specialization_lookup(comp, name, concrete_inputs, input_count);
-
-        unsigned char* cid;
-        if (cached_cid) {
-            /* Cache hit! Reuse existing specialization */
-            if (comp->verbose) {
-                printf("  Cache HIT: Reusing specialization of '%s'\n", name);
-            }
-            cid = malloc(CID_SIZE);
-            if (!cid) {
-                return false;
-            }
-            memcpy(cid, cached_cid, CID_SIZE);
-        } else {
-            /* Cache miss - compile the word with concrete types */
-            if (comp->verbose) {
-                printf("  Cache MISS: Compiling specialization of '%s'\n", name);
+        /* Recursion: the callee's CID depends on this very body */
+        for (compile_frame_t* f = comp->frame; f; f = f->outer) {
+            if (f->word_def == entry->word_def) {
+                return compile_recursion(comp, name, entry, f, concrete_inputs, input_count);
             }
+        }
 
-            blob_buffer_t* compiled_blob = word_compile_with_context(comp, entry->word_def,
-                                                                      concrete_inputs, input_count);
-            if (!compiled_blob) {
-                fprintf(stderr, "Failed to compile word '%s' with concrete types\n", name);
-                return false;
-            }
+        unsigned char* cid = specialization_get(comp, name, entry, concrete_inputs, input_count);
+        if (!cid) {
+            return false;
+        }
 
-            /* Store the compiled blob in database */
-            /* Build type signature string for this specialization */
-            char type_sig_str[256];
-            char *p = type_sig_str;
-            for (int i = 0; i < input_count; i++) {
-                switch (concrete_inputs[i]) {
-                    case TYPE_I64: p += sprintf(p, "i64 "); break;
-                    case TYPE_U64: p += sprintf(p, "u64 "); break;
-                    case TYPE_F64: p += sprintf(p, "f64 "); break;
-                    case TYPE_PTR: p += sprintf(p, "ptr "); break;
-                    case TYPE_BOOL: p += sprintf(p, "bool "); break;
-                    case TYPE_STR: p += sprintf(p, "str "); break;
-                    case TYPE_ARRAY: p += sprintf(p, "array "); break;
-                    default: p += sprintf(p, "? "); break;
-                }
-            }
-            p += sprintf(p, "-> ");
-            for (int i = 0; i < comp->type_stack_depth; i++) {
-                type_id_t t = comp->type_stack[i].type;
-                switch (t) {
-                    case TYPE_I64: p += sprintf(p, "i64 "); break;
-                    case TYPE_U64: p += sprintf(p, "u64 "); break;
-                    case TYPE_F64: p += sprintf(p, "f64 "); break;
-                    case TYPE_PTR: p += sprintf(p, "ptr "); break;
-                    case TYPE_BOOL: p += sprintf(p, "bool "); break;
-                    case TYPE_STR: p += sprintf(p, "str "); break;
-                    case TYPE_ARRAY: p += sprintf(p, "array "); break;
-                    default: p += sprintf(p, "? "); break;
-                }
+        /* Pure word on literal inputs: its results replace the call */
+        int64_t results[MAX_EVAL_RESULTS];
+        if (evaluate_call(comp, entry, cid, results)) {
+            bool folded = apply_signature(comp, &entry->signature);
+            for (int i = 0; folded && i < entry->signature.output_count; i++) {
+                folded = ir_emit_lit(comp->ir, results[i]);
             }
-
-            unsigned char* sig_cid = db_store_type_sig(comp->db, NULL, type_sig_str);
-            if (!sig_cid) {
-                fprintf(stderr, "Failed to store type signature for specialization\n");
-                blob_buffer_free(compiled_blob);
-                return false;
+            if (folded && comp->frame) {
+                folded = inline_deps_add(&comp->frame->evaluated, cid);
             }
-
-            cid = db_store_blob(comp->db, BLOB_WORD, sig_cid,
-                                compiled_blob->data, compiled_blob->size);
-            free(sig_cid);
-            blob_buffer_free(compiled_blob);
-
-            if (!cid) {
-                fprintf(stderr, "Failed to store compiled specialization\n");
-                return false;
+            free(cid);
+            if (!folded) {
+                fprintf(stderr, "Type error in word: %s\n", name);
             }
-
-            /* Phase 3: Store in specialization cache for future reuse */
-            specialization_store(comp, name, concrete_inputs, input_count, cid);
+            return folded;
         }
 
         /* Apply type signature to update type stack */
@@ -858,9 +1377,11 @@ static bool compile_word(compiler_t* comp, const char* name) {
         }
 
         /* Emit call to the specialized version */
-        cell_buffer_append(comp->cells, encode_xt(NULL));
-        encode_cid_ref(comp->blob, BLOB_WORD, cid);
+        bool emitted = ir_emit_ref(comp->ir, BLOB_WORD, cid, TYPE_UNKNOWN, 0);
         free(cid);
+        if (!emitted) {
+            return false;
+        }
 
         if (comp->verbose) {
             printf("  Compiled and stored specialization of '%s'\n", name);
@@ -878,19 +1399,16 @@ static bool compile_word(compiler_t* comp, const char* name) {
 
     /* Emit XT cell */
     if (entry->is_primitive) {
-        /* Legacy: Emit XT with address */
-        cell_buffer_append(comp->cells, encode_xt(entry->addr));
-
-        /* CID-based: Emit primitive ID (2 bytes) */
-        encode_primitive(comp->blob, entry->prim_id);
+        if (!emit_prim(comp, entry)) {
+            return false;
+        }
     } else {
-        /* Legacy: Emit placeholder */
-        cell_buffer_append(comp->cells, encode_xt(NULL));
-
-        /* CID-based: Emit CID reference */
+        /* Emit CID reference */
         if (entry->cid) {
             DEBUG_COMPILER("Encoding call to user word '%s'", name);
-            encode_cid_ref(comp->blob, BLOB_WORD, entry->cid);
+            if (!ir_emit_ref(comp->ir, BLOB_WORD, entry->cid, TYPE_UNKNOWN, 0)) {
+                return false;
+            }
         } else {
             fprintf(stderr, "Error: user word '%s' has no CID\n", name);
             return false;
@@ -906,14 +1424,9 @@ static bool compile_word(compiler_t* comp, const char* name) {
     return true;
 }
 
-/* Free quotation tokens and their strings (for QUOT_LITERAL) */
+/* Free quotation tokens (for QUOT_LITERAL; their text is interned) */
 static void quot_free_tokens(quotation_t* quot) {
     if (quot->tokens) {
-        for (int i = 0; i < quot->token_count; i++) {
-            if (quot->tokens[i].text) {
-                free(quot->tokens[i].text);
-            }
-        }
         free(quot->tokens);
         quot->tokens = NULL;
         quot->token_count = 0;
@@ -935,16 +1448,8 @@ static bool quot_append_token(quotation_t* quot, const token_t* tok) {
         quot->token_capacity = new_capacity;
     }
 
-    /* Deep copy the token */
-    quot->tokens[quot->token_count] = *tok;
-    if (tok->text) {
-        quot->tokens[quot->token_count].text = strdup(tok->text);
-        if (!quot->tokens[quot->token_count].text) {
-            fprintf(stderr, "Failed to copy token text\n");
-            return false;
-        }
-    }
-    quot->token_count++;
+    /* Tokens reference interned text, so a copy is all it takes */
+    quot->tokens[quot->token_count++] = *tok;
 
     return true;
 }
@@ -968,27 +1473,23 @@ static bool quot_compile_with_context(
                quot->token_count, type_stack_depth);
     }
 
-    /* Create compilation buffers */
-    quot->cells = cell_buffer_create();
-    quot->blob = blob_buffer_create();
-    if (!quot->cells || !quot->blob) {
-        if (quot->cells) cell_buffer_free(quot->cells);
-        if (quot->blob) blob_buffer_free(quot->blob);
+    /* Create instruction buffer */
+    quot->ir = ir_buffer_create();
+    if (!quot->ir) {
         return false;
     }
 
     /* Save compiler state */
-    cell_buffer_t* saved_cells = comp->cells;
-    blob_buffer_t* saved_blob = comp->blob;
+    ir_buffer_t* saved_ir = comp->ir;
     int saved_type_depth = comp->type_stack_depth;
-    type_stack_entry_t saved_type_stack[MAX_TYPE_STACK];
-    for (int i = 0; i < saved_type_depth; i++) {
-        saved_type_stack[i] = comp->type_stack[i];
+    if (!save_state(comp, comp->type_stack, sizeof(type_stack_entry_t) * (size_t)saved_type_depth)) {
+        ir_buffer_free(quot->ir);
+        quot->ir = NULL;
+        return false;
     }
 
     /* Set up quotation compilation context */
-    comp->cells = quot->cells;
-    comp->blob = quot->blob;
+    comp->ir = quot->ir;
     comp->type_stack_depth = type_stack_depth;
     for (int i = 0; i < type_stack_depth; i++) {
         /* Convert type_id_t input to type_stack_entry_t (no heap tracking for inputs) */
@@ -1027,9 +1528,6 @@ static bool quot_compile_with_context(
     }
 
     if (success) {
-        /* Emit EXIT */
-        cell_buffer_append(quot->cells, encode_exit());
-
         /* Capture output types */
         quot->output_count = comp->type_stack_depth;
         for (int i = 0; i < comp->type_stack_depth; i++) {
@@ -1048,17 +1546,14 @@ static bool quot_compile_with_context(
             for (int i = 0; i < quot->output_count; i++) {
                 printf("%d ", quot->outputs[i]);
             }
-            printf("(%zu cells, %zu blob bytes)\n", quot->cells->count, quot->blob->size);
+            printf("(%zu instructions, %zu cells)\n", quot->ir->count, ir_cell_count(quot->ir));
         }
     }
 
     /* Restore compiler state */
-    comp->cells = saved_cells;
-    comp->blob = saved_blob;
+    comp->ir = saved_ir;
     comp->type_stack_depth = saved_type_depth;
-    for (int i = 0; i < saved_type_depth; i++) {
-        comp->type_stack[i] = saved_type_stack[i];
-    }
+    restore_state(comp, comp->type_stack, sizeof(type_stack_entry_t) * (size_t)saved_type_depth);
 
     return success;
 }
@@ -1068,8 +1563,8 @@ static bool quot_compile_with_context(
  * Phase 5: Made public for on-demand compilation in runner */
 blob_buffer_t* word_compile_with_context(compiler_t* comp, word_definition_t* word_def,
                                           type_id_t* input_types, int input_count) {
-    fprintf(stderr, "TRACE: word_compile_with_context() entry for '%s'\n", word_def ? word_def->name : "NULL");
-    fflush(stderr);
+    TRACE_WORD(DEBUG_COMPILER, "word_compile_with_context '%s' inputs=%d",
+               word_def ? word_def->name : "NULL", input_count);
 
     if (!word_def) {
         fprintf(stderr, "word_compile_with_context: NULL word_def\n");
@@ -1085,54 +1580,67 @@ blob_buffer_t* word_compile_with_context(compiler_t* comp, word_definition_t* wo
     }
 
     /* Save current compiler state */
-    cell_buffer_t* saved_cells = comp->cells;
-    blob_buffer_t* saved_blob = comp->blob;
+    ir_buffer_t* saved_ir = comp->ir;
     ref_graph_t* saved_ref_graph = comp->ref_graph;  /* Save ref_graph too! */
     int saved_type_depth = comp->type_stack_depth;
-    type_stack_entry_t saved_type_stack[MAX_TYPE_STACK];
-    for (int i = 0; i < saved_type_depth; i++) {
-        saved_type_stack[i] = comp->type_stack[i];
-    }
     int saved_slot_count = comp->slot_count;
-    bool saved_slots[MAX_SLOTS];
-    memcpy(saved_slots, comp->slot_used, sizeof(saved_slots));
 
-    /* Create fresh buffers for this compilation */
-    cell_buffer_t* fresh_cells = cell_buffer_create();
-    blob_buffer_t* fresh_blob = blob_buffer_create();
-    if (!fresh_cells || !fresh_blob) {
+    /* Create a fresh instruction buffer and reference graph for this compilation */
+    ir_buffer_t* fresh_ir = ir_buffer_create();
+    ref_graph_t* fresh_ref_graph = ref_graph_create();
+    if (!fresh_ir || !fresh_ref_graph) {
         fprintf(stderr, "Failed to create compilation buffers\n");
-        if (fresh_cells) cell_buffer_free(fresh_cells);
-        if (fresh_blob) blob_buffer_free(fresh_blob);
+        ir_buffer_free(fresh_ir);
+        if (fresh_ref_graph) ref_graph_free(fresh_ref_graph);
         return NULL;
     }
 
-    comp->cells = fresh_cells;
-    comp->blob = fresh_blob;
+    /* Live type stack entries and slots only (slots past slot_count are free) */
+    if (!save_state(comp, comp->type_stack, sizeof(type_stack_entry_t) * (size_t)saved_type_depth)) {
+        ir_buffer_free(fresh_ir);
+        ref_graph_free(fresh_ref_graph);
+        return NULL;
+    }
+    if (!save_state(comp, comp->slot_used, sizeof(bool) * (size_t)saved_slot_count)) {
+        restore_state(comp, comp->type_stack, sizeof(type_stack_entry_t) * (size_t)saved_type_depth);
+        ir_buffer_free(fresh_ir);
+        ref_graph_free(fresh_ref_graph);
+        return NULL;
+    }
+
+    comp->ir = fresh_ir;
+    comp->ref_graph = fresh_ref_graph;
 
     /* Initialize type stack with concrete input types */
     comp->type_stack_depth = 0;
     comp->slot_count = 0;
-    memset(comp->slot_used, 0, sizeof(comp->slot_used));
-
-    /* Initialize reference graph for this word compilation */
-    comp->ref_graph = ref_graph_create();
-    if (!comp->ref_graph) {
-        fprintf(stderr, "Failed to create reference graph\n");
-        cell_buffer_free(fresh_cells);
-        blob_buffer_free(fresh_blob);
-        return NULL;
+    if (comp->slot_used) {
+        memset(comp->slot_used, 0, sizeof(bool) * (size_t)comp->slot_capacity);
     }
 
     for (int i = 0; i < input_count; i++) {
         push_type(comp, input_types[i]);
     }
 
+    compile_frame_t frame = {word_def, input_types, input_count, {0}, comp->frame};
+    comp->frame = &frame;
+
     /* Compile each token in the word definition */
     bool success = true;
+    int nested_parens = 0;      /* Inside a captured quotation */
     for (int i = 0; i < word_def->token_count && success; i++) {
         token_t* tok = &word_def->tokens[i];
 
+        /* Tokens inside a quotation are captured, as at top level */
+        if (comp->buffer_stack_depth > 0 &&
+            !(tok->type == TOK_RPAREN && nested_parens == 0)) {
+            if (tok->type == TOK_LPAREN) nested_parens++;
+            if (tok->type == TOK_RPAREN) nested_parens--;
+            quotation_t* quot = comp->quot_stack[comp->quot_stack_depth - 1];
+            success = quot_append_token(quot, tok);
+            continue;
+        }
+
         /* Compile based on token type */
         switch (tok->type) {
             case TOK_NUMBER:
@@ -1173,31 +1681,42 @@ blob_buffer_t* word_compile_with_context(compiler_t* comp, word_definition_t* wo
     }
 
     if (success) {
-        fprintf(stderr, "TRACE: About to call emit_free_for_dead_nodes\n");
-        fflush(stderr);
-
         /* Emit FREE for dead nodes via liveness analysis */
         /* TEMPORARILY DISABLED FOR TESTING */
         // emit_free_for_dead_nodes(comp);
 
-        fprintf(stderr, "TRACE: emit_free_for_dead_nodes SKIPPED (disabled for testing)\n");
-        fflush(stderr);
-
-        /* Emit EXIT */
-        cell_buffer_append(comp->cells, encode_exit());
+        inline_deps_clear(&comp->inlined);
+        optimize_code(comp, fresh_ir, &comp->inlined);
+        for (size_t i = 0; i < frame.evaluated.count; i++) {
+            inline_deps_add(&comp->inlined, frame.evaluated.cids[i]);
+        }
 
-        /* Return the compiled blob (transfer ownership) */
-        result = comp->blob;
-        comp->blob = NULL;  /* Prevent double-free */
+        /* Recursive tail calls loop; others jump when optimizing (except
+         * in memo words: the body must return through memo-exit) */
+        if (!eliminate_tail_calls(fresh_ir, comp->dict, true,
+                                  comp->opt_level > OPT_NONE && !word_def->memo,
+                                  &comp->opt_stats)) {
+            success = false;
+        }
+        comp->effects = effects_of_ir(fresh_ir, comp->db);
+        if (success && word_def->memo) {
+            success = wrap_memo(comp, fresh_ir, word_def);
+        }
+        stack_depth_of_ir(fresh_ir, comp->db, &comp->depth);
+    }
 
-        /* Clean up cells (not needed - we only return blob) */
-        cell_buffer_free(comp->cells);
-        comp->cells = NULL;
-    } else {
-        /* Compilation failed - clean up */
-        cell_buffer_free(fresh_cells);
-        blob_buffer_free(fresh_blob);
+    if (success) {
+        /* Lower to the blob encoding (caller owns it) */
+        result = blob_buffer_create();
+        if (result && !ir_lower_blob(fresh_ir, result)) {
+            fprintf(stderr, "Failed to lower word '%s'\n", word_def->name);
+            blob_buffer_free(result);
+            result = NULL;
+        }
     }
+    ir_buffer_free(fresh_ir);
+    inline_deps_free(&frame.evaluated);
+    comp->frame = frame.outer;
 
     /* Cleanup reference graph */
     if (comp->ref_graph) {
@@ -1205,15 +1724,15 @@ blob_buffer_t* word_compile_with_context(compiler_t* comp, word_definition_t* wo
     }
 
     /* Restore compiler state */
-    comp->cells = saved_cells;
-    comp->blob = saved_blob;
+    comp->ir = saved_ir;
     comp->ref_graph = saved_ref_graph;  /* Restore ref_graph! */
     comp->type_stack_depth = saved_type_depth;
-    for (int i = 0; i < saved_type_depth; i++) {
-        comp->type_stack[i] = saved_type_stack[i];
+    if (comp->slot_used) {
+        memset(comp->slot_used, 0, sizeof(bool) * (size_t)comp->slot_capacity);
     }
+    restore_state(comp, comp->slot_used, sizeof(bool) * (size_t)saved_slot_count);
+    restore_state(comp, comp->type_stack, sizeof(type_stack_entry_t) * (size_t)saved_type_depth);
     comp->slot_count = saved_slot_count;
-    memcpy(comp->slot_used, saved_slots, sizeof(saved_slots));
 
     return result;
 }
@@ -1244,9 +1763,8 @@ static bool compile_lparen(compiler_t* comp) {
         return false;
     }
 
-    /* No cells/blob buffers for QUOT_LITERAL - compiled later at use site */
-    quot->cells = NULL;
-    quot->blob = NULL;
+    /* No instructions for QUOT_LITERAL - compiled later at use site */
+    quot->ir = NULL;
 
     /* Capture current type stack as quotation inputs */
     quot->input_count = comp->type_stack_depth;
@@ -1307,18 +1825,14 @@ static bool compile_rparen(compiler_t* comp) {
         }
     } else {
         /* QUOT_TYPED: compile immediately (future feature) */
-        /* Emit EXIT */
-        cell_buffer_append(quot->cells, encode_exit());
-
         /* Capture output types */
         quot->output_count = comp->type_stack_depth;
         for (int i = 0; i < comp->type_stack_depth; i++) {
             quot->outputs[i] = comp->type_stack[i].type;
         }
 
-        /* Restore parent buffers */
-        comp->cells = comp->buffer_stack[--comp->buffer_stack_depth];
-        comp->blob = comp->blob_stack[--comp->blob_stack_depth];
+        /* Restore parent buffer */
+        comp->ir = comp->ir_stack[--comp->buffer_stack_depth];
 
         /* Restore type stack (quotation inputs + outputs become new stack) */
         comp->type_stack_depth = quot->input_count;
@@ -1336,7 +1850,7 @@ static bool compile_rparen(compiler_t* comp) {
             for (int i = 0; i < quot->output_count; i++) {
                 printf("%d ", quot->outputs[i]);
             }
-            printf(" (%zu cells, %zu blob bytes)\n", quot->cells->count, quot->blob->size);
+            printf(" (%zu instructions)\n", quot->ir->count);
         }
     }
 
@@ -1359,6 +1873,7 @@ static bool compile_lbracket(compiler_t* comp) {
 
     /* Record current stack depth as the marker boundary */
     comp->array_marker_stack[comp->array_marker_depth] = comp->type_stack_depth;
+    comp->array_marker_ir[comp->array_marker_depth] = comp->ir->count;
     comp->array_marker_depth++;
 
     if (comp->verbose) {
@@ -1368,6 +1883,79 @@ static bool compile_lbracket(compiler_t* comp) {
     return true;
 }
 
+/* All elements of the array literal being closed are literals pushed
+ * since its [ (one IR instruction each) of one type */
+static bool array_is_constant(compiler_t* comp, int marker_depth, size_t marker_ir,
+                              int elem_count) {
+    if (comp->ir->count < marker_ir || comp->ir->count - marker_ir != (size_t)elem_count) {
+        return false;   /* Elements computed, or a call consumed values from before [ */
+    }
+    for (int i = 0; i < elem_count; i++) {
+        if (!optimizer_const_value(&comp->ir->instrs[marker_ir + i], NULL) ||
+            comp->type_stack[marker_depth + i].type != comp->type_stack[marker_depth].type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Constant array literal: store the array as the runtime would lay it out
+ * (32-byte header, then the elements) in a BLOB_DATA and replace the
+ * element literals with a BLOB_STATIC reference. The loader links it once,
+ * read-only; `mut` copies it to the heap for writing. */
+static bool emit_static_array(compiler_t* comp, int marker_depth, size_t marker_ir,
+                              int elem_count) {
+    /* Layout: [count: u64][elem_size: u8=8][padding: 7][elem_type: u64][reserved: u64][data...] */
+    size_t total_size = 32 + (size_t)elem_count * 8;
+    uint8_t* buffer = calloc(1, total_size);
+    if (!buffer) {
+        fprintf(stderr, "Error: Failed to allocate array buffer\n");
+        return false;
+    }
+
+    uint64_t count = (uint64_t)elem_count;
+    uint64_t elem_type = elem_count > 0 ? comp->type_stack[marker_depth].type : TYPE_ANY;
+    memcpy(buffer + 0, &count, 8);
+    buffer[8] = 8;
+    memcpy(buffer + 16, &elem_type, 8);
+    for (int i = 0; i < elem_count; i++) {
+        int64_t value = 0;
+        optimizer_const_value(&comp->ir->instrs[marker_ir + i], &value);
+        memcpy(buffer + 32 + (size_t)i * 8, &value, 8);
+    }
+
+    unsigned char* sig_cid = db_store_type_sig(comp->db, NULL, "array");
+    if (!sig_cid) {
+        fprintf(stderr, "Error: Failed to store array type signature\n");
+        free(buffer);
+        return false;
+    }
+    unsigned char* array_cid = db_store_blob(comp->db, BLOB_DATA, sig_cid, buffer, total_size);
+    free(sig_cid);
+    free(buffer);
+    if (!array_cid) {
+        fprintf(stderr, "Error: Failed to store array literal in database\n");
+        return false;
+    }
+
+    comp->ir->count = marker_ir;
+    bool emitted = ir_emit_ref(comp->ir, BLOB_STATIC, array_cid, TYPE_ARRAY, 0);
+    free(array_cid);
+    if (!emitted) {
+        return false;
+    }
+
+    comp->type_stack_depth = marker_depth;
+    push_type(comp, TYPE_ARRAY);
+
+    if (comp->verbose) {
+        printf("  ] constant array of %d elements (%zu bytes) → array [read-only]\n",
+               elem_count, total_size);
+    }
+
+    return true;
+}
+
 /* End array literal ] - collect items and create array */
 static bool compile_rbracket(compiler_t* comp) {
     crash_context_set_token("]");
@@ -1383,12 +1971,18 @@ static bool compile_rbracket(compiler_t* comp) {
     /* Get marker depth */
     comp->array_marker_depth--;
     int marker_depth = comp->array_marker_stack[comp->array_marker_depth];
+    size_t marker_ir = comp->array_marker_ir[comp->array_marker_depth];
     int elem_count = comp->type_stack_depth - marker_depth;
 
     if (comp->verbose) {
         printf("  ] collect %d array elements from depth %d\n", elem_count, marker_depth);
     }
 
+    /* Every element a literal: link the laid-out array once instead */
+    if (array_is_constant(comp, marker_depth, marker_ir, elem_count)) {
+        return emit_static_array(comp, marker_depth, marker_ir, elem_count);
+    }
+
     /* Handle empty array case - runtime allocated (semantically immutable) */
     if (elem_count == 0) {
         /* Empty array: allocate header (32 bytes) with count=0 */
@@ -1399,33 +1993,20 @@ static bool compile_rbracket(compiler_t* comp) {
             return false;
         }
 
-        /* Allocate 32 bytes for header */
-        cell_buffer_append(comp->cells, encode_lit(32));
-        unsigned char* size_cid = db_store_literal(comp->db, 32, "i64");
-        if (!size_cid) {
-            fprintf(stderr, "Error: Failed to store array header size\n");
+        /* Allocate 32 bytes for header, then ALLOC - stack: [ptr] */
+        if (!emit_data_literal(comp, 32) || !emit_prim(comp, alloc_prim)) {
             return false;
         }
-        encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-        free(size_cid);
-
-        /* Call ALLOC - stack: [ptr] */
-        cell_buffer_append(comp->cells, encode_xt(alloc_prim->addr));
-        encode_primitive(comp->blob, alloc_prim->prim_id);
 
         /* Write header: [count=0][elem_size=8][padding][elem_type=TYPE_ANY] */
         /* Store count=0 at offset 0 */
         dict_entry_t* dup_prim = dict_lookup(comp->dict, "dup");
         if (!dup_prim) return false;
 
-        cell_buffer_append(comp->cells, encode_xt(dup_prim->addr));
-        encode_primitive(comp->blob, dup_prim->prim_id);
-        cell_buffer_append(comp->cells, encode_lit(0));
-        size_cid = db_store_literal(comp->db, 0, "i64");
-        encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-        free(size_cid);
-        cell_buffer_append(comp->cells, encode_xt(store_prim->addr));
-        encode_primitive(comp->blob, store_prim->prim_id);
+        if (!emit_prim(comp, dup_prim) || !emit_data_literal(comp, 0) ||
+            !emit_prim(comp, store_prim)) {
+            return false;
+        }
 
         /* Update type stack: push array pointer */
         /* Note: Arrays are semantically immutable - use 'mut' for mutable copy */
@@ -1473,21 +2054,9 @@ static bool compile_rbracket(compiler_t* comp) {
     int64_t total_size = 32 + data_size;
 
     /* Emit size literal and ALLOC call */
-    /* Legacy: Emit LIT cell */
-    cell_buffer_append(comp->cells, encode_lit(total_size));
-
-    /* CID-based: Store literal and encode reference */
-    unsigned char* size_cid = db_store_literal(comp->db, total_size, "i64");
-    if (!size_cid) {
-        fprintf(stderr, "Error: Failed to store array size literal\n");
+    if (!emit_data_literal(comp, total_size) || !emit_prim(comp, alloc_prim)) {
         return false;
     }
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
-
-    /* Call ALLOC primitive */
-    cell_buffer_append(comp->cells, encode_xt(alloc_prim->addr));
-    encode_primitive(comp->blob, alloc_prim->prim_id);
 
     /* Now we have: elem[0] elem[1] ... elem[n-1] array_ptr on runtime stack */
     /* Strategy: Write header, then move ptr to return stack, store elements, restore ptr */
@@ -1513,56 +2082,28 @@ static bool compile_rbracket(compiler_t* comp) {
     /* Stack currently: elem[0] elem[1] ... elem[n-1] ptr */
 
     /* Write count at offset 0 */
-    cell_buffer_append(comp->cells, encode_xt(dup_prim->addr));
-    encode_primitive(comp->blob, dup_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_lit(elem_count));
-    size_cid = db_store_literal(comp->db, elem_count, "i64");
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
-    cell_buffer_append(comp->cells, encode_xt(store_prim->addr));
-    encode_primitive(comp->blob, store_prim->prim_id);
+    bool ok = emit_prim(comp, dup_prim) && emit_data_literal(comp, elem_count) &&
+              emit_prim(comp, store_prim);
 
     /* Write elem_size=8 at offset 8 using c! */
-    cell_buffer_append(comp->cells, encode_xt(dup_prim->addr));
-    encode_primitive(comp->blob, dup_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_lit(8));
-    size_cid = db_store_literal(comp->db, 8, "i64");
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
-    cell_buffer_append(comp->cells, encode_xt(add_prim->addr));
-    encode_primitive(comp->blob, add_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_lit(8));
-    size_cid = db_store_literal(comp->db, 8, "i64");
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
     dict_entry_t* swap_prim = dict_lookup(comp->dict, "swap");
     if (!swap_prim) return false;
-    cell_buffer_append(comp->cells, encode_xt(swap_prim->addr));
-    encode_primitive(comp->blob, swap_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_xt(cstore_prim->addr));
-    encode_primitive(comp->blob, cstore_prim->prim_id);
+    ok = ok && emit_prim(comp, dup_prim) && emit_data_literal(comp, 8) &&
+         emit_prim(comp, add_prim) && emit_data_literal(comp, 8) &&
+         emit_prim(comp, swap_prim) && emit_prim(comp, cstore_prim);
 
     /* Write elem_type at offset 16 */
-    cell_buffer_append(comp->cells, encode_xt(dup_prim->addr));
-    encode_primitive(comp->blob, dup_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_lit(16));
-    size_cid = db_store_literal(comp->db, 16, "i64");
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
-    cell_buffer_append(comp->cells, encode_xt(add_prim->addr));
-    encode_primitive(comp->blob, add_prim->prim_id);
-    cell_buffer_append(comp->cells, encode_lit(elem_type));
-    size_cid = db_store_literal(comp->db, elem_type, "i64");
-    encode_cid_ref(comp->blob, BLOB_DATA, size_cid);
-    free(size_cid);
-    cell_buffer_append(comp->cells, encode_xt(store_prim->addr));
-    encode_primitive(comp->blob, store_prim->prim_id);
+    ok = ok && emit_prim(comp, dup_prim) && emit_data_literal(comp, 16) &&
+         emit_prim(comp, add_prim) && emit_data_literal(comp, elem_type) &&
+         emit_prim(comp, store_prim);
 
     /* Move array pointer to return stack: >r */
     /* Stack: elem[0] elem[1] ... elem[n-1] */
     /* R-stack: ptr */
-    cell_buffer_append(comp->cells, encode_xt(tor_prim->addr));
-    encode_primitive(comp->blob, tor_prim->prim_id);
+    ok = ok && emit_prim(comp, tor_prim);
+    if (!ok) {
+        return false;
+    }
 
     /* Store each element in reverse order (from TOS down) */
     /* elem[n-1] is on TOS and should go to offset 32 + (n-1)*8 */
@@ -1571,25 +2112,18 @@ static bool compile_rbracket(compiler_t* comp) {
 
         /* Fetch array pointer from return stack: r@ */
         /* Stack: elem[0] ... elem[i] ptr */
-        cell_buffer_append(comp->cells, encode_xt(rfetch_prim->addr));
-        encode_primitive(comp->blob, rfetch_prim->prim_id);
-
         /* Push offset literal */
-        cell_buffer_append(comp->cells, encode_lit(offset));
-        unsigned char* offset_cid = db_store_literal(comp->db, offset, "i64");
-        if (!offset_cid) {
-            fprintf(stderr, "Error: Failed to store offset literal\n");
+        if (!emit_prim(comp, rfetch_prim) || !emit_data_literal(comp, offset)) {
             return false;
         }
-        encode_cid_ref(comp->blob, BLOB_DATA, offset_cid);
-        free(offset_cid);
 
         /* Stack: elem[0] ... elem[i] ptr offset */
 
         /* Add offset to pointer: + */
         /* Stack: elem[0] ... elem[i] (ptr+offset) */
-        cell_buffer_append(comp->cells, encode_xt(add_prim->addr));
-        encode_primitive(comp->blob, add_prim->prim_id);
+        if (!emit_prim(comp, add_prim)) {
+            return false;
+        }
 
         /* Stack: elem[0] ... elem[i] (ptr+offset) */
         /* We need: elem[0] ... elem[i-1] elem[i] (ptr+offset) for store */
@@ -1600,15 +2134,17 @@ static bool compile_rbracket(compiler_t* comp) {
             fprintf(stderr, "Internal error: SWAP primitive not found\n");
             return false;
         }
-        cell_buffer_append(comp->cells, encode_xt(swap_prim->addr));
-        encode_primitive(comp->blob, swap_prim->prim_id);
+        if (!emit_prim(comp, swap_prim)) {
+            return false;
+        }
 
         /* Stack: elem[0] ... elem[i-1] elem[i] (ptr+offset) */
 
         /* Store: ! (consumes value and address) */
         /* Stack: elem[0] ... elem[i-1] */
-        cell_buffer_append(comp->cells, encode_xt(store_prim->addr));
-        encode_primitive(comp->blob, store_prim->prim_id);
+        if (!emit_prim(comp, store_prim)) {
+            return false;
+        }
 
         if (comp->verbose) {
             printf("    Store element %d at offset %ld\n", i, offset);
@@ -1617,17 +2153,15 @@ static bool compile_rbracket(compiler_t* comp) {
 
     /* Restore array pointer from return stack: r> */
     /* Stack: ptr */
-    cell_buffer_append(comp->cells, encode_xt(fromr_prim->addr));
-    encode_primitive(comp->blob, fromr_prim->prim_id);
+    if (!emit_prim(comp, fromr_prim)) {
+        return false;
+    }
 
     /* Update type stack: remove all elements, push array pointer */
     /* First, collect node_ids from array elements (for parent→child edges) */
     node_id_t child_nodes[MAX_TYPE_STACK];
     int child_count = 0;
 
-    fprintf(stderr, "TRACE: compile_rbracket collecting child nodes, ref_graph=%p\n", (void*)comp->ref_graph);
-    fflush(stderr);
-
     if (comp->ref_graph) {
         for (int i = marker_depth; i < comp->type_stack_depth; i++) {
             node_id_t child_node = comp->type_stack[i].node_id;
@@ -1635,25 +2169,17 @@ static bool compile_rbracket(compiler_t* comp) {
                 child_nodes[child_count++] = child_node;
             }
         }
-        fprintf(stderr, "TRACE: collected %d child nodes\n", child_count);
-        fflush(stderr);
     }
 
-    fprintf(stderr, "TRACE: compile_rbracket resetting stack depth from %d to %d\n", comp->type_stack_depth, marker_depth);
-    fflush(stderr);
+    TRACE_TOKEN(DEBUG_COMPILER, "]: %d elements, %d child nodes, stack depth %d -> %d",
+                elem_count, child_count, comp->type_stack_depth, marker_depth);
 
     comp->type_stack_depth = marker_depth;
 
-    fprintf(stderr, "TRACE: compile_rbracket calling push_heap_value\n");
-    fflush(stderr);
-
     /* TEMPORARILY REVERT TO ORIGINAL push_type FOR TESTING */
     push_type(comp, TYPE_ARRAY);
     // push_heap_value(comp, TYPE_ARRAY);
 
-    fprintf(stderr, "TRACE: compile_rbracket push_type returned\n");
-    fflush(stderr);
-
     /* Establish parent→child edges for nested structures */
     if (comp->ref_graph && child_count > 0) {
         node_id_t array_node = comp->type_stack[marker_depth].node_id;
@@ -1671,18 +2197,104 @@ static bool compile_rbracket(compiler_t* comp) {
         printf("  ] created array of %d elements → array\n", elem_count);
     }
 
-    fprintf(stderr, "TRACE: compile_rbracket returning true\n");
-    fflush(stderr);
-
-    return true;
-}
+    return true;
+}
+
+/* Pop quotation from stack (for use by immediate words) */
+static quotation_t* pop_quotation(compiler_t* comp) {
+    if (comp->quot_stack_depth == 0) {
+        return NULL;
+    }
+    return comp->quot_stack[--comp->quot_stack_depth];
+}
+
+/* Format quotation types as a signature side ("i64 ptr") */
+static void format_quotation_types(const type_id_t* types, int count, char* out) {
+    char* p = out;
+    *p = '\0';
+    for (int i = 0; i < count; i++) {
+        switch (types[i]) {
+            case TYPE_I64: p += sprintf(p, "i64 "); break;
+            case TYPE_U64: p += sprintf(p, "u64 "); break;
+            case TYPE_F64: p += sprintf(p, "f64 "); break;
+            case TYPE_PTR: p += sprintf(p, "ptr "); break;
+            case TYPE_BOOL: p += sprintf(p, "bool "); break;
+            default: p += sprintf(p, "? "); break;
+        }
+    }
+    /* Trim trailing space */
+    if (p > out && p[-1] == ' ') p[-1] = '\0';
+}
+
+/* Compile a quotation (if still literal), optimize it and store it as a
+ * BLOB_QUOTATION. Returns its CID, or NULL. */
+static unsigned char* store_quotation(compiler_t* comp, quotation_t* quot) {
+    /* Compile QUOT_LITERAL with empty type context before materializing */
+    if (quot->kind == QUOT_LITERAL) {
+        if (comp->verbose) {
+            printf("  Materializing QUOT_LITERAL: compiling with empty context\n");
+        }
+        /* Empty context - no types needed */
+        if (!quot_compile_with_context(comp, quot, NULL, 0)) {
+            fprintf(stderr, "Failed to compile QUOT_LITERAL for materialization\n");
+            return NULL;
+        }
+    }
+
+    /* Build type signature strings: inputs -> outputs */
+    char input_sig[128];
+    char output_sig[128];
+    format_quotation_types(quot->inputs, quot->input_count, input_sig);
+    format_quotation_types(quot->outputs, quot->output_count, output_sig);
+
+    /* Store type signature and get sig_cid */
+    unsigned char* sig_cid = db_store_type_sig(comp->db,
+                                                input_sig[0] ? input_sig : NULL,
+                                                output_sig);
+    if (!sig_cid) {
+        fprintf(stderr, "Failed to store quotation type signature\n");
+        return NULL;
+    }
+
+    if (comp->verbose) {
+        printf("  Materializing quotation: %s -> %s\n",
+               input_sig[0] ? input_sig : "(none)", output_sig);
+    }
+
+    inline_deps_t inlined = {0};
+    optimize_code(comp, quot->ir, &inlined);
+    if (comp->opt_level > OPT_NONE) {
+        eliminate_tail_calls(quot->ir, comp->dict, false, true, &comp->opt_stats);
+    }
+
+    /* A self call in a quotation blob would link to the quotation */
+    for (size_t i = 0; i < quot->ir->count; i++) {
+        if (quot->ir->instrs[i].op == IR_RECURSE) {
+            fprintf(stderr, "Error: recursive call inside a quotation is not supported\n");
+            inline_deps_free(&inlined);
+            free(sig_cid);
+            return NULL;
+        }
+    }
+
+    /* Store quotation as anonymous blob with BLOB_QUOTATION kind */
+    unsigned char* cid = NULL;
+    blob_buffer_t* blob = blob_buffer_create();
+    if (blob && ir_lower_blob(quot->ir, blob)) {
+        cid = db_store_blob(comp->db, BLOB_QUOTATION, sig_cid, blob->data, blob->size);
+        if (cid) {
+            db_store_edges(comp->db, cid, blob->data, blob->size);
+            inline_deps_store(comp->db, cid, &inlined);
+        }
+    }
+    blob_buffer_free(blob);
+    inline_deps_free(&inlined);
+    free(sig_cid);
 
-/* Pop quotation from stack (for use by immediate words) */
-static quotation_t* pop_quotation(compiler_t* comp) {
-    if (comp->quot_stack_depth == 0) {
-        return NULL;
+    if (!cid) {
+        fprintf(stderr, "Failed to store quotation blob\n");
     }
-    return comp->quot_stack[--comp->quot_stack_depth];
+    return cid;
 }
 
 /* Materialize pending quotations as runtime values */
@@ -1691,117 +2303,58 @@ static bool materialize_quotations(compiler_t* comp) {
         quotation_t* quot = pop_quotation(comp);
         if (!quot) return false;
 
-        /* Compile QUOT_LITERAL with empty type context before materializing */
-        if (quot->kind == QUOT_LITERAL) {
+        /* The same body over the same input types is the same blob: reuse
+         * it without compiling, hashing or storing it again */
+        uint64_t key = 0;
+        bool cacheable = quot->kind == QUOT_LITERAL && quotation_key_hash(comp, quot, &key);
+        unsigned char* cid = cacheable ? quotation_cache_lookup(comp, quot, key) : NULL;
+
+        if (cid) {
             if (comp->verbose) {
-                printf("  Materializing QUOT_LITERAL: compiling with empty context\n");
+                printf("  Quotation cache hit: %d tokens\n", quot->token_count);
             }
-            /* Empty context - no types needed */
-            if (!quot_compile_with_context(comp, quot, NULL, 0)) {
-                fprintf(stderr, "Failed to compile QUOT_LITERAL for materialization\n");
-                return false;
+        } else {
+            size_t evaluated_from = comp->frame ? comp->frame->evaluated.count : 0;
+            cid = store_quotation(comp, quot);
+            if (cid && cacheable) {
+                quotation_cache_put(comp, quot, key, cid,
+                                    comp->frame ? &comp->frame->evaluated : NULL, evaluated_from);
             }
         }
 
-        /* Build type signature strings: inputs -> outputs */
-        char input_sig[128] = "";
-        char output_sig[128] = "";
-        char* p;
-
-        /* Input types */
-        p = input_sig;
-        for (int i = 0; i < quot->input_count; i++) {
-            switch (quot->inputs[i]) {
-                case TYPE_I64: p += sprintf(p, "i64 "); break;
-                case TYPE_U64: p += sprintf(p, "u64 "); break;
-                case TYPE_F64: p += sprintf(p, "f64 "); break;
-                case TYPE_PTR: p += sprintf(p, "ptr "); break;
-                case TYPE_BOOL: p += sprintf(p, "bool "); break;
-                default: p += sprintf(p, "? "); break;
-            }
-        }
-        /* Trim trailing space */
-        if (p > input_sig && p[-1] == ' ') p[-1] = '\0';
-
-        /* Output types */
-        p = output_sig;
-        for (int i = 0; i < quot->output_count; i++) {
-            switch (quot->outputs[i]) {
-                case TYPE_I64: p += sprintf(p, "i64 "); break;
-                case TYPE_U64: p += sprintf(p, "u64 "); break;
-                case TYPE_F64: p += sprintf(p, "f64 "); break;
-                case TYPE_PTR: p += sprintf(p, "ptr "); break;
-                case TYPE_BOOL: p += sprintf(p, "bool "); break;
-                default: p += sprintf(p, "? "); break;
+        /* Track CID for linking */
+        if (cid && comp->pending_quot_count >= comp->pending_quot_capacity) {
+            int capacity = comp->pending_quot_capacity ? comp->pending_quot_capacity * 2 : 64;
+            unsigned char** cids = realloc(comp->pending_quot_cids,
+                                           sizeof(unsigned char*) * (size_t)capacity);
+            if (cids) {
+                comp->pending_quot_cids = cids;
+                comp->pending_quot_capacity = capacity;
+            } else {
+                fprintf(stderr, "Failed to grow quotation reference list\n");
+                free(cid);
+                cid = NULL;
             }
         }
-        /* Trim trailing space */
-        if (p > output_sig && p[-1] == ' ') p[-1] = '\0';
-
-        /* Store type signature and get sig_cid */
-        unsigned char* sig_cid = db_store_type_sig(comp->db,
-                                                    input_sig[0] ? input_sig : NULL,
-                                                    output_sig);
-        if (!sig_cid) {
-            fprintf(stderr, "Failed to store quotation type signature\n");
-            cell_buffer_free(quot->cells);
-            blob_buffer_free(quot->blob);
-            quot_free_tokens(quot);
-            free(quot);
-            return false;
-        }
 
-        if (comp->verbose) {
-            printf("  Materializing quotation: %s -> %s\n",
-                   input_sig[0] ? input_sig : "(none)", output_sig);
-        }
-
-        /* Store quotation as anonymous blob with BLOB_QUOTATION kind */
-        /* Use blob data (CID sequence), not cells */
-        unsigned char* cid = db_store_blob(comp->db, BLOB_QUOTATION, sig_cid,
-                                           quot->blob->data,
-                                           quot->blob->size);
-        free(sig_cid);
-
-        if (!cid) {
-            fprintf(stderr, "Failed to store quotation blob\n");
-            cell_buffer_free(quot->cells);
-            blob_buffer_free(quot->blob);
-            quot_free_tokens(quot);
-            free(quot);
-            return false;
-        }
+        bool ok = cid != NULL;
+        if (ok) {
+            comp->pending_quot_cids[comp->pending_quot_count++] = cid;
 
-        /* Track CID for linking */
-        if (comp->pending_quot_count >= MAX_QUOT_REFS) {
-            fprintf(stderr, "Too many quotation references in word (max %d)\n", MAX_QUOT_REFS);
-            free(cid);
-            cell_buffer_free(quot->cells);
-            blob_buffer_free(quot->blob);
-            quot_free_tokens(quot);
-            free(quot);
-            return false;
-        }
-        comp->pending_quot_cids[comp->pending_quot_count++] = cid;
+            if (comp->verbose) {
+                printf("  Quotation CID: %s (index %d)\n", cid, comp->pending_quot_count - 1);
+            }
 
-        if (comp->verbose) {
-            printf("  Quotation CID: %s (index %d)\n", cid, comp->pending_quot_count - 1);
+            /* Emit quotation reference, typed as a pointer for now */
+            ok = ir_emit_ref(comp->ir, BLOB_QUOTATION, cid, TYPE_PTR, 0);
+            if (ok) push_type(comp, TYPE_PTR);
         }
 
-        /* Legacy: Emit [LIT 0] placeholder */
-        cell_buffer_append(comp->cells, encode_lit(0));
-
-        /* CID-based: Emit quotation reference */
-        encode_cid_ref(comp->blob, BLOB_QUOTATION, cid);
-
-        /* Push quotation type onto stack (as pointer for now) */
-        push_type(comp, TYPE_PTR);
-
         /* Free quotation buffers */
-        cell_buffer_free(quot->cells);
-        blob_buffer_free(quot->blob);
+        ir_buffer_free(quot->ir);
         quot_free_tokens(quot);
         free(quot);
+        if (!ok) return false;
     }
 
     return true;
@@ -1862,8 +2415,7 @@ static bool compile_times(compiler_t* comp) {
     }
 
     if (comp->verbose) {
-        printf("  TIMES compiling with body=%zu cells (%zu blob bytes)\n",
-               body_quot->cells->count, body_quot->blob->size);
+        printf("  TIMES compiling with body=%zu instructions\n", body_quot->ir->count);
     }
 
     /* Look up primitives we need */
@@ -1882,94 +2434,35 @@ static bool compile_times(compiler_t* comp) {
         return false;
     }
 
-    /* ===== Legacy cell encoding ===== */
-
-    /* Move count to return stack */
-    cell_buffer_append(comp->cells, encode_xt(tor_entry->addr));
-
-    /* Loop start */
-    size_t loop_start_pos = comp->cells->count;
-
-    /* Check if count is zero: r@ */
-    cell_buffer_append(comp->cells, encode_xt(rfetch_entry->addr));
-
-    /* If zero, branch to done */
-    cell_buffer_append(comp->cells, encode_xt(zbranch_entry->addr));
-    size_t exit_branch_pos = comp->cells->count;
-    cell_buffer_append(comp->cells, encode_lit(0));  /* Placeholder */
-
-    /* Decrement counter: r> 1 - >r */
-    cell_buffer_append(comp->cells, encode_xt(fromr_entry->addr));
-    cell_buffer_append(comp->cells, encode_lit(1));
-    cell_buffer_append(comp->cells, encode_xt(sub_entry->addr));
-    cell_buffer_append(comp->cells, encode_xt(tor_entry->addr));
-
-    /* Inline quotation body (minus EXIT) - can access counter via i0 */
-    for (size_t i = 0; i < body_quot->cells->count - 1; i++) {
-        cell_buffer_append(comp->cells, body_quot->cells->cells[i]);
-    }
-
-    /* Branch back to loop start */
-    cell_buffer_append(comp->cells, encode_xt(branch_entry->addr));
-    int64_t loop_offset = (int64_t)(loop_start_pos - comp->cells->count - 1);
-    cell_buffer_append(comp->cells, encode_lit(loop_offset));
-
-    /* Done: calculate exit branch offset */
-    int64_t exit_offset = (int64_t)(comp->cells->count - exit_branch_pos - 1);
-    comp->cells->cells[exit_branch_pos] = encode_lit(exit_offset);
-
-    /* Clean up return stack */
-    cell_buffer_append(comp->cells, encode_xt(rdrop_entry->addr));
-
-    /* ===== CID-based blob encoding ===== */
-
     /* Move count to return stack */
-    encode_primitive(comp->blob, tor_entry->prim_id);
-
-    /* Check if count is zero: r@ */
-    encode_primitive(comp->blob, rfetch_entry->prim_id);
+    int loop_label = ir_new_label(comp->ir);
+    int done_label = ir_new_label(comp->ir);
+    bool ok = emit_prim(comp, tor_entry);
 
-    /* 0branch to exit */
-    encode_primitive(comp->blob, zbranch_entry->prim_id);
-
-    /* We need to know the offset in cells, not bytes! */
-    /* Calculate: body cells + decrement(4) + branch_back(2) */
-    int64_t exit_cells_offset = (int64_t)(body_quot->cells->count - 1 + 6);
-    encode_inline_literal(comp->blob, exit_cells_offset);
+    /* Loop start: if count is zero (r@), branch to done */
+    ok = ok && ir_emit_label(comp->ir, loop_label) &&
+         emit_prim(comp, rfetch_entry) &&
+         ir_emit_branch(comp->ir, zbranch_entry->prim_id, zbranch_entry->addr, done_label);
 
     /* Decrement counter: r> 1 - >r */
-    encode_primitive(comp->blob, fromr_entry->prim_id);
-    encode_inline_literal(comp->blob, 1);
-    encode_primitive(comp->blob, sub_entry->prim_id);
-    encode_primitive(comp->blob, tor_entry->prim_id);
+    ok = ok && emit_prim(comp, fromr_entry) && ir_emit_lit(comp->ir, 1) &&
+         emit_prim(comp, sub_entry) && emit_prim(comp, tor_entry);
 
     /* Inline quotation body - can access counter via i0 */
-    if (comp->verbose) {
-        printf("  TIMES inlining body: %zu blob bytes\n", body_quot->blob->size);
-    }
-    blob_buffer_append_bytes(comp->blob, body_quot->blob->data, body_quot->blob->size);
+    ok = ok && ir_append(comp->ir, body_quot->ir);
 
     /* Branch back to loop start */
-    encode_primitive(comp->blob, branch_entry->prim_id);
-
-    /* Calculate backward offset in cells */
-    /* From after the branch offset LIT back to loop_start */
-    /* We've emitted: r@ 0branch offset r> 1 - >r <body> branch */
-    /* Loop start is at: r@ (first check) */
-    /* Current position (after branch prim): need to count cells */
-    int64_t back_cells = -(int64_t)(1 + 1 + 1 + 1 + 1 + 1 + 1 + (body_quot->cells->count - 1) + 1 + 1);
-    encode_inline_literal(comp->blob, back_cells);
+    ok = ok && ir_emit_branch(comp->ir, branch_entry->prim_id, branch_entry->addr, loop_label);
 
-    /* Clean up return stack */
-    encode_primitive(comp->blob, rdrop_entry->prim_id);
+    /* Done: clean up return stack */
+    ok = ok && ir_emit_label(comp->ir, done_label) && emit_prim(comp, rdrop_entry);
 
     /* Apply quotation output types */
     /* Quotation body can access loop counter via i0, but doesn't take it as input */
     /* Type stack effect depends on what the quotation body does */
 
     /* Free quotation */
-    cell_buffer_free(body_quot->cells);
-    blob_buffer_free(body_quot->blob);
+    ir_buffer_free(body_quot->ir);
     quot_free_tokens(body_quot);
     free(body_quot);
 
@@ -1977,7 +2470,7 @@ static bool compile_times(compiler_t* comp) {
         printf("  TIMES compiled\n");
     }
 
-    return true;
+    return ok;
 }
 
 /* Immediate word: times (quotation-based) - compile until-style loop */
@@ -2020,8 +2513,8 @@ static bool compile_times_until(compiler_t* comp) {
     }
 
     if (comp->verbose) {
-        printf("  TIMES-UNTIL compiling with cond=%zu cells, body=%zu cells\n",
-               cond_quot->cells->count, body_quot->cells->count);
+        printf("  TIMES-UNTIL compiling with cond=%zu instructions, body=%zu instructions\n",
+               cond_quot->ir->count, body_quot->ir->count);
     }
 
     /* Look up branch primitives */
@@ -2033,59 +2526,20 @@ static bool compile_times_until(compiler_t* comp) {
         return false;
     }
 
-    /* ===== Legacy cell encoding ===== */
-    /* Loop start */
-    size_t loop_start_pos = comp->cells->count;
-
-    /* Inline body quotation (minus EXIT) */
-    for (size_t i = 0; i < body_quot->cells->count - 1; i++) {
-        cell_buffer_append(comp->cells, body_quot->cells->cells[i]);
-    }
-
-    /* Inline condition quotation (minus EXIT) */
-    for (size_t i = 0; i < cond_quot->cells->count - 1; i++) {
-        cell_buffer_append(comp->cells, cond_quot->cells->cells[i]);
-    }
+    /* Loop start: inline body, then condition */
+    int loop_label = ir_new_label(comp->ir);
+    bool ok = ir_emit_label(comp->ir, loop_label) &&
+              ir_append(comp->ir, body_quot->ir) &&
+              ir_append(comp->ir, cond_quot->ir);
 
     /* 0branch back to loop start if condition is false (0) */
-    cell_buffer_append(comp->cells, encode_xt(zbranch_entry->addr));
-    int64_t loop_offset = (int64_t)(loop_start_pos - comp->cells->count - 1);
-    cell_buffer_append(comp->cells, encode_lit(loop_offset));
-
-    /* ===== CID-based blob encoding ===== */
-    /* Loop start marker */
-    size_t blob_loop_start = comp->blob->size;
-
-    /* Inline body quotation */
-    if (comp->verbose) {
-        printf("  TIMES-UNTIL inlining body: %zu blob bytes\n", body_quot->blob->size);
-    }
-    blob_buffer_append_bytes(comp->blob, body_quot->blob->data, body_quot->blob->size);
-
-    /* Inline condition quotation */
-    if (comp->verbose) {
-        printf("  TIMES-UNTIL inlining condition: %zu blob bytes\n", cond_quot->blob->size);
-    }
-    blob_buffer_append_bytes(comp->blob, cond_quot->blob->data, cond_quot->blob->size);
-
-    /* 0branch back to loop start if condition is false */
-    encode_primitive(comp->blob, zbranch_entry->prim_id);
-
-    /* Calculate backward offset in cells */
-    /* From after the branch offset back to loop_start */
-    /* We've emitted: <body> <cond> 0branch */
-    int64_t back_cells = -(int64_t)((body_quot->cells->count - 1) +
-                                    (cond_quot->cells->count - 1) +
-                                    1 + 1);  /* 0branch prim + offset */
-    encode_inline_literal(comp->blob, back_cells);
+    ok = ok && ir_emit_branch(comp->ir, zbranch_entry->prim_id, zbranch_entry->addr, loop_label);
 
     /* Free quotations */
-    cell_buffer_free(body_quot->cells);
-    blob_buffer_free(body_quot->blob);
+    ir_buffer_free(body_quot->ir);
     quot_free_tokens(body_quot);
     free(body_quot);
-    cell_buffer_free(cond_quot->cells);
-    blob_buffer_free(cond_quot->blob);
+    ir_buffer_free(cond_quot->ir);
     quot_free_tokens(cond_quot);
     free(cond_quot);
 
@@ -2093,10 +2547,42 @@ static bool compile_times_until(compiler_t* comp) {
         printf("  TIMES-UNTIL compiled\n");
     }
 
-    return true;
+    return ok;
 }
 
 /* Immediate word: if - compile conditional branch with inlined quotations */
+static void quot_free(quotation_t* quot) {
+    ir_buffer_free(quot->ir);
+    quot_free_tokens(quot);
+    free(quot);
+}
+
+/* if with a literal flag (at -O 1 and above): drop the flag and emit
+ * only the arm it selects */
+static bool compile_if_constant(compiler_t* comp, quotation_t* live, quotation_t* dead,
+                                type_id_t* types) {
+    comp->ir->count--;
+    bool ok = true;
+    if (live->kind == QUOT_LITERAL) {
+        ok = quot_compile_with_context(comp, live, types, comp->type_stack_depth);
+        if (!ok) fprintf(stderr, "Failed to compile if quotation with context\n");
+    }
+    if (ok) {
+        ok = ir_append(comp->ir, live->ir);
+        for (int i = 0; i < live->output_count; i++) {
+            push_type(comp, live->outputs[i]);
+        }
+        comp->opt_stats.dead_arms++;
+        if (comp->verbose) {
+            printf("  IF with literal flag: %zu instructions, other arm dropped\n",
+                   live->ir->count);
+        }
+    }
+    quot_free(live);
+    quot_free(dead);
+    return ok;
+}
+
 static bool compile_if(compiler_t* comp) {
     /* Stack should be: flag ( true ) ( false ) if */
     /* Pop two quotations (in reverse order: false, then true) */
@@ -2129,6 +2615,15 @@ static bool compile_if(compiler_t* comp) {
         types[i] = comp->type_stack[i].type;
     }
 
+    /* A literal flag picks the arm now: the other one is never compiled,
+     * so nothing it calls is specialized or stored */
+    int64_t flag;
+    if (comp->opt_level > OPT_NONE && comp->ir->count > 0 &&
+        optimizer_const_value(&comp->ir->instrs[comp->ir->count - 1], &flag)) {
+        return compile_if_constant(comp, flag ? true_quot : false_quot,
+                                   flag ? false_quot : true_quot, types);
+    }
+
     /* Compile QUOT_LITERAL quotations with current type context (after popping flag) */
     if (true_quot->kind == QUOT_LITERAL) {
         if (!quot_compile_with_context(comp, true_quot, types, comp->type_stack_depth)) {
@@ -2145,9 +2640,8 @@ static bool compile_if(compiler_t* comp) {
     }
 
     if (comp->verbose) {
-        printf("  IF compiling with true=%zu cells (%zu blob bytes), false=%zu cells (%zu blob bytes)\n",
-               true_quot->cells->count, true_quot->blob->size,
-               false_quot->cells->count, false_quot->blob->size);
+        printf("  IF compiling with true=%zu instructions, false=%zu instructions\n",
+               true_quot->ir->count, false_quot->ir->count);
     }
 
     /* Look up branch primitives */
@@ -2159,66 +2653,16 @@ static bool compile_if(compiler_t* comp) {
         return false;
     }
 
-    /* Emit 0BRANCH primitive XT and placeholder offset */
-    /* Pattern: [XT: 0branch] [LIT: offset] */
-    cell_buffer_append(comp->cells, encode_xt(zbranch_entry->addr));
-    size_t zbranch_offset_pos = comp->cells->count;
-    cell_buffer_append(comp->cells, encode_lit(0));  /* Placeholder offset */
-
-    /* Inline true quotation cells (minus EXIT) */
-    for (size_t i = 0; i < true_quot->cells->count - 1; i++) {  /* -1 to skip EXIT */
-        cell_buffer_append(comp->cells, true_quot->cells->cells[i]);
-    }
-
-    /* Emit BRANCH primitive XT and placeholder offset */
-    /* Pattern: [XT: branch] [LIT: offset] */
-    cell_buffer_append(comp->cells, encode_xt(branch_entry->addr));
-    size_t branch_offset_pos = comp->cells->count;
-    cell_buffer_append(comp->cells, encode_lit(0));  /* Placeholder offset */
-
-    /* Calculate 0BRANCH offset: points to start of false branch */
-    /* Offset is in cells from the cell AFTER the offset LIT */
-    int64_t zbranch_offset = (int64_t)(comp->cells->count - zbranch_offset_pos - 1);
-    comp->cells->cells[zbranch_offset_pos] = encode_lit(zbranch_offset);
-
-    /* Inline false quotation cells (minus EXIT) */
-    for (size_t i = 0; i < false_quot->cells->count - 1; i++) {  /* -1 to skip EXIT */
-        cell_buffer_append(comp->cells, false_quot->cells->cells[i]);
-    }
-
-    /* Calculate BRANCH offset: points past end of false branch */
-    /* Offset is in cells from the cell AFTER the offset LIT */
-    int64_t branch_offset = (int64_t)(comp->cells->count - branch_offset_pos - 1);
-    comp->cells->cells[branch_offset_pos] = encode_lit(branch_offset);
-
-    /* ===== CID-based blob encoding ===== */
-    /* Emit 0BRANCH primitive */
-    encode_primitive(comp->blob, zbranch_entry->prim_id);
-
-    /* Calculate and emit 0branch offset */
-    /* Offset = true branch size + 2 (for BRANCH primitive + its offset) */
-    int64_t zbranch_offset_blob = (int64_t)(true_quot->cells->count - 1 + 2);
-    encode_inline_literal(comp->blob, zbranch_offset_blob);
-
-    /* Inline true quotation blob data */
-    if (comp->verbose) {
-        printf("  IF inlining true branch: %zu blob bytes\n", true_quot->blob->size);
-    }
-    blob_buffer_append_bytes(comp->blob, true_quot->blob->data, true_quot->blob->size);
-
-    /* Emit BRANCH primitive */
-    encode_primitive(comp->blob, branch_entry->prim_id);
-
-    /* Calculate and emit branch offset */
-    /* Offset = false branch size */
-    int64_t branch_offset_blob = (int64_t)(false_quot->cells->count - 1);
-    encode_inline_literal(comp->blob, branch_offset_blob);
-
-    /* Inline false quotation blob data */
-    if (comp->verbose) {
-        printf("  IF inlining false branch: %zu blob bytes\n", false_quot->blob->size);
-    }
-    blob_buffer_append_bytes(comp->blob, false_quot->blob->data, false_quot->blob->size);
+    /* 0branch to the false branch; the true branch ends with a branch
+     * past it. Offsets are resolved from the labels when lowering. */
+    int false_label = ir_new_label(comp->ir);
+    int end_label = ir_new_label(comp->ir);
+    bool ok = ir_emit_branch(comp->ir, zbranch_entry->prim_id, zbranch_entry->addr, false_label) &&
+              ir_append(comp->ir, true_quot->ir) &&
+              ir_emit_branch(comp->ir, branch_entry->prim_id, branch_entry->addr, end_label) &&
+              ir_emit_label(comp->ir, false_label) &&
+              ir_append(comp->ir, false_quot->ir) &&
+              ir_emit_label(comp->ir, end_label);
 
     /* Apply quotation output types to current stack */
     /* Both branches should have same output types - use true_quot */
@@ -2227,36 +2671,25 @@ static bool compile_if(compiler_t* comp) {
     }
 
     /* Free quotations */
-    cell_buffer_free(true_quot->cells);
-    blob_buffer_free(true_quot->blob);
+    ir_buffer_free(true_quot->ir);
     quot_free_tokens(true_quot);
     free(true_quot);
-    cell_buffer_free(false_quot->cells);
-    blob_buffer_free(false_quot->blob);
+    ir_buffer_free(false_quot->ir);
     quot_free_tokens(false_quot);
     free(false_quot);
 
     if (comp->verbose) {
-        printf("  IF compiled: 0branch offset=%lld, branch offset=%lld\n",
-               (long long)zbranch_offset, (long long)branch_offset);
+        printf("  IF compiled\n");
     }
 
-    return true;
+    return ok;
 }
 
 /* Immediate word: true - emit literal -1 */
 static bool compile_true(compiler_t* comp) {
-    /* Legacy: Emit LIT cell */
-    cell_buffer_append(comp->cells, encode_lit(-1));
-
-    /* CID-based: Store literal and encode reference */
-    unsigned char* cid = db_store_literal(comp->db, -1, "i64");
-    if (!cid) {
-        fprintf(stderr, "Error: Failed to store true literal\n");
+    if (!emit_data_literal(comp, -1)) {
         return false;
     }
-    encode_cid_ref(comp->blob, BLOB_DATA, cid);
-    free(cid);
 
     push_type(comp, TYPE_I64);
 
@@ -2269,17 +2702,9 @@ static bool compile_true(compiler_t* comp) {
 
 /* Immediate word: false - emit literal 0 */
 static bool compile_false(compiler_t* comp) {
-    /* Legacy: Emit LIT cell */
-    cell_buffer_append(comp->cells, encode_lit(0));
-
-    /* CID-based: Store literal and encode reference */
-    unsigned char* cid = db_store_literal(comp->db, 0, "i64");
-    if (!cid) {
-        fprintf(stderr, "Error: Failed to store false literal\n");
+    if (!emit_data_literal(comp, 0)) {
         return false;
     }
-    encode_cid_ref(comp->blob, BLOB_DATA, cid);
-    free(cid);
 
     push_type(comp, TYPE_I64);
 
@@ -2310,22 +2735,15 @@ static bool compile_false(compiler_t* comp) {
  *   then ;
  */
 static bool compile_drop(compiler_t* comp) {
-    fprintf(stderr, "TRACE: compile_drop() entry\n");
-    fflush(stderr);
-
     if (comp->type_stack_depth < 1) {
         fprintf(stderr, "drop: stack underflow\n");
         return false;
     }
 
-    fprintf(stderr, "TRACE: compile_drop() about to pop\n");
-    fflush(stderr);
-
     /* Pop compile-time stack entry (just removes from type stack) */
     pop_type_entry(comp);
 
-    fprintf(stderr, "TRACE: compile_drop() popped, looking up primitive\n");
-    fflush(stderr);
+    TRACE_TOKEN(DEBUG_COMPILER, "drop: type stack depth %d", comp->type_stack_depth);
 
     /* Note: In slot model, we don't free here. Slots stay allocated
      * until word end and are freed if not returned. */
@@ -2337,19 +2755,14 @@ static bool compile_drop(compiler_t* comp) {
         return false;
     }
 
-    fprintf(stderr, "TRACE: compile_drop() emitting code\n");
-    fflush(stderr);
-
-    cell_buffer_append(comp->cells, encode_xt(drop_prim->addr));
-    encode_primitive(comp->blob, drop_prim->prim_id);
+    if (!emit_prim(comp, drop_prim)) {
+        return false;
+    }
 
     if (comp->verbose) {
         printf("  XT drop\n");
     }
 
-    fprintf(stderr, "TRACE: compile_drop() success\n");
-    fflush(stderr);
-
     return true;
 }
 
@@ -2381,8 +2794,9 @@ static bool compile_dup(compiler_t* comp) {
         return false;
     }
 
-    cell_buffer_append(comp->cells, encode_xt(dup_prim->addr));
-    encode_primitive(comp->blob, dup_prim->prim_id);
+    if (!emit_prim(comp, dup_prim)) {
+        return false;
+    }
 
     if (comp->verbose) {
         printf("  XT dup\n");
@@ -2417,8 +2831,9 @@ static bool compile_swap(compiler_t* comp) {
         return false;
     }
 
-    cell_buffer_append(comp->cells, encode_xt(swap_prim->addr));
-    encode_primitive(comp->blob, swap_prim->prim_id);
+    if (!emit_prim(comp, swap_prim)) {
+        return false;
+    }
 
     if (comp->verbose) {
         printf("  XT swap\n");
@@ -2455,8 +2870,9 @@ static bool compile_over(compiler_t* comp) {
         return false;
     }
 
-    cell_buffer_append(comp->cells, encode_xt(over_prim->addr));
-    encode_primitive(comp->blob, over_prim->prim_id);
+    if (!emit_prim(comp, over_prim)) {
+        return false;
+    }
 
     if (comp->verbose) {
         printf("  XT over\n");
@@ -2493,8 +2909,9 @@ static bool compile_rot(compiler_t* comp) {
         return false;
     }
 
-    cell_buffer_append(comp->cells, encode_xt(rot_prim->addr));
-    encode_primitive(comp->blob, rot_prim->prim_id);
+    if (!emit_prim(comp, rot_prim)) {
+        return false;
+    }
 
     if (comp->verbose) {
         printf("  XT rot\n");
@@ -2509,6 +2926,7 @@ static bool compile_type_sig_decl(compiler_t* comp, token_stream_t* stream) {
     char sig_buffer[256];
     sig_buffer[0] = '\0';
     size_t sig_len = 0;
+    bool memo = false;
 
     token_t tok;
     while (token_stream_next(stream, &tok)) {
@@ -2517,6 +2935,13 @@ static bool compile_type_sig_decl(compiler_t* comp, token_stream_t* stream) {
             break;
         }
 
+        /* Leading annotation: results are kept in the run-time memo table */
+        if (sig_len == 0 && strcmp(tok.text, "memo") == 0) {
+            memo = true;
+            token_free(&tok);
+            continue;
+        }
+
         /* Append token text to signature (with space separator) */
         if (sig_len > 0 && sig_len < 255) {
             sig_buffer[sig_len++] = ' ';
@@ -2557,6 +2982,7 @@ static bool compile_type_sig_decl(compiler_t* comp, token_stream_t* stream) {
         comp->pending_type_sig = NULL;
         return false;
     }
+    comp->pending_memo = memo;
 
     return true;
 }
@@ -2577,6 +3003,7 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
     }
 
     char* word_name = strdup(name_tok.text);
+    uint32_t name_sym = name_tok.sym;
     token_free(&name_tok);
 
     /* Track current word in crash context */
@@ -2592,10 +3019,10 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
         free(word_name);
         return false;
     }
+    word_def->name_sym = name_sym;
 
     /* Reset buffers and type stack for new definition */
-    cell_buffer_clear(comp->cells);
-    blob_buffer_clear(comp->blob);
+    ir_buffer_clear(comp->ir);
     comp->type_stack_depth = 0;
 
     /* If there's a pending type signature, store it with the word definition */
@@ -2604,14 +3031,17 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
         if (word_def->type_sig) {
             memcpy(word_def->type_sig, comp->pending_type_sig, sizeof(type_sig_t));
         }
+        word_def->memo = comp->pending_memo;
         if (comp->verbose) {
-            printf("  Stored type signature with %d inputs → %d outputs\n",
+            printf("  Stored type signature with %d inputs → %d outputs%s\n",
                    comp->pending_type_sig->input_count,
-                   comp->pending_type_sig->output_count);
+                   comp->pending_type_sig->output_count,
+                   word_def->memo ? " (memo)" : "");
         }
         /* Clear pending signature */
         free(comp->pending_type_sig);
         comp->pending_type_sig = NULL;
+        comp->pending_memo = false;
     }
 
     /* Build source text as we compile */
@@ -2620,6 +3050,38 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
         free(word_name);
         return false;
     }
+
+    /* Source hash input: format version, signature, then each token's type
+     * and text, and whether it names a user word (so shadowing a primitive
+     * changes the hash; edits to the user word itself are tracked by edges) */
+    blob_buffer_t* hash_input = blob_buffer_create();
+    if (!hash_input) {
+        free(source_text);
+        free(word_name);
+        return false;
+    }
+    blob_buffer_append_bytes(hash_input, (const uint8_t*)SPEC_FORMAT_VERSION,
+                             sizeof(SPEC_FORMAT_VERSION));
+    if (comp->opt_level > OPT_NONE) {
+        /* Optimized code differs for the same tokens */
+        blob_buffer_append_u16(hash_input, 0xFF00 | (uint16_t)comp->opt_level);
+    }
+    if (word_def->type_sig) {
+        const type_sig_t* sig = word_def->type_sig;
+        blob_buffer_append_u16(hash_input, (uint16_t)sig->input_count);
+        for (int i = 0; i < sig->input_count; i++) {
+            blob_buffer_append_u16(hash_input, (uint16_t)sig->inputs[i]);
+        }
+        blob_buffer_append_u16(hash_input, (uint16_t)sig->output_count);
+        for (int i = 0; i < sig->output_count; i++) {
+            blob_buffer_append_u16(hash_input, (uint16_t)sig->outputs[i]);
+        }
+        if (word_def->memo) {
+            blob_buffer_append_u16(hash_input, 0xFE00);
+        }
+    } else {
+        blob_buffer_append_u16(hash_input, 0xFFFF);  /* No explicit signature */
+    }
     source_text[0] = '\0';
     size_t source_len = 0;
     size_t source_cap = 4096;
@@ -2627,9 +3089,8 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
     /* Compile tokens until ';' */
     token_t tok;
     while (token_stream_next(stream, &tok)) {
-        fprintf(stderr, "TRACE: In word '%s', token type=%d text='%s'\n",
-                word_name, tok.type, tok.text ? tok.text : "NULL");
-        fflush(stderr);
+        TRACE_TOKEN(DEBUG_COMPILER, "in '%s': token type=%d text='%s' line=%d",
+                    word_name, tok.type, tok.text ? tok.text : "NULL", tok.line);
 
         if (tok.type == TOK_SEMICOLON) {
             token_free(&tok);
@@ -2645,6 +3106,7 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
             if (!new_buf) {
                 free(source_text);
                 free(word_name);
+                blob_buffer_free(hash_input);
                 token_free(&tok);
                 return false;
             }
@@ -2656,32 +3118,21 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
         strcpy(source_text + source_len, tok.text);
         source_len += tok_len;
 
-        bool success = false;
-
-        /* Handle quotation delimiters specially */
-        if (tok.type == TOK_LPAREN) {
-            success = compile_lparen(comp);
-        } else if (tok.type == TOK_RPAREN) {
-            success = compile_rparen(comp);
+        blob_buffer_append_u16(hash_input, (uint16_t)tok.type);
+        blob_buffer_append_bytes(hash_input, (const uint8_t*)tok.text, tok_len + 1);
+        if (tok.type == TOK_WORD) {
+            dict_entry_t* callee = dict_lookup(comp->dict, tok.text);
+            uint8_t is_user_word = (callee && callee->word_def) ? 1 : 0;
+            blob_buffer_append_bytes(hash_input, &is_user_word, 1);
         }
-        /* If inside a quotation, capture tokens to quotation */
-        else if (comp->buffer_stack_depth > 0) {
-            quotation_t* quot = comp->quot_stack[comp->quot_stack_depth - 1];
-            success = quot_append_token(quot, &tok);
 
-            if (comp->verbose && success) {
-                printf("    captured to quotation: type=%d text='%s'\n",
-                       tok.type, tok.text ? tok.text : "NULL");
-            }
-        }
-        /* Design B: Collect all other tokens to word definition */
-        else {
-            success = word_def_append_token(word_def, &tok);
+        /* Design B: Collect all tokens, quotation delimiters included, to
+         * the word definition; quotations are captured when it is compiled */
+        bool success = word_def_append_token(word_def, &tok);
 
-            if (comp->verbose && success) {
-                printf("    captured to word: type=%d text='%s'\n",
-                       tok.type, tok.text ? tok.text : "NULL");
-            }
+        if (comp->verbose && success) {
+            printf("    captured to word: type=%d text='%s'\n",
+                   tok.type, tok.text ? tok.text : "NULL");
         }
 
         token_free(&tok);
@@ -2689,21 +3140,69 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
         if (!success) {
             free(source_text);
             free(word_name);
+            blob_buffer_free(hash_input);
             return false;
         }
     }
 
+    db_compute_cid(comp->db, hash_input->data, hash_input->size, word_def->source_hash);
+    blob_buffer_free(hash_input);
+
+    /* Compiled again by a long-lived compiler (marchc --serve): an
+     * unchanged definition keeps its entry and specializations. A changed
+     * one makes this process's specializations of its callers stale, and
+     * only the database records which those are. */
+    for (word_definition_t* prev = find_word_definition(comp, name_sym); prev;
+         prev = prev->next_overload) {
+        if (!same_type_sig(prev->type_sig, word_def->type_sig)) continue;
+        if (memcmp(prev->source_hash, word_def->source_hash, CID_SIZE) == 0) {
+            word_definition_free(word_def);
+            free(source_text);
+            free(word_name);
+            crash_context_set_word(NULL);
+            return true;
+        }
+        specialization_cache_clear(comp->specs);
+        break;
+    }
+
+    /* Incremental compilation: if this word changed since it was last
+     * compiled, its persisted dependents must be recompiled too. Bindings
+     * carry call-site signatures, so a replaced definition is recognized by
+     * its source hash: not the new one, nor any overload still defined. */
+    char* hashes[32];
+    int hash_count = 0;
+    hashes[hash_count++] = cid_to_hex(word_def->source_hash);
+    for (word_definition_t* def = find_word_definition(comp, name_sym);
+         def && hash_count < 32; def = def->next_overload) {
+        bool shadowed = same_type_sig(def->type_sig, word_def->type_sig);
+        for (word_definition_t* later = find_word_definition(comp, name_sym);
+             later != def && !shadowed; later = later->next_overload) {
+            shadowed = same_type_sig(later->type_sig, def->type_sig);
+        }
+        if (!shadowed) hashes[hash_count++] = cid_to_hex(def->source_hash);
+    }
+    bool hashed = true;
+    for (int i = 0; i < hash_count; i++) hashed &= hashes[i] != NULL;
+    if (hashed) {
+        int dropped = db_invalidate_dependents(comp->db, word_name,
+                                               (const char* const*)hashes, hash_count);
+        if (dropped > 0 && comp->verbose) {
+            printf("  Changed since last build: %d dependent specializations invalidated\n",
+                   dropped);
+        }
+    }
+    for (int i = 0; i < hash_count; i++) free(hashes[i]);
+
     /* Design B: Store word definition in compiler cache for later compilation */
-    if (comp->word_def_count >= MAX_WORD_DEFS) {
-        fprintf(stderr, "Too many word definitions (max %d)\n", MAX_WORD_DEFS);
+    if (!add_word_definition(comp, word_def)) {
+        fprintf(stderr, "Failed to grow word definition cache\n");
         word_definition_free(word_def);
         free(source_text);
         free(word_name);
         return false;
     }
 
-    comp->word_defs[comp->word_def_count++] = word_def;
-
     if (comp->verbose) {
         printf("  Stored %d tokens in word definition cache\n", word_def->token_count);
     }
@@ -2731,7 +3230,7 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
     /* Add dict entry with NULL addr (indicates uncompiled word) */
     dict_add(comp->dict, word_name, NULL, NULL, 0, &placeholder_sig, false, false, NULL, word_def);
 
-    free(source_text);
+    word_def->source_text = source_text;  /* Recorded in defs when compiled */
     free(word_name);
 
     /* Clear pending type signature after using it */
@@ -2748,8 +3247,7 @@ static bool compile_definition(compiler_t* comp, token_stream_t* stream) {
 
 /* Compile a file */
 bool compiler_compile_file(compiler_t* comp, const char* filename) {
-    fprintf(stderr, "TRACE: compiler_compile_file entry\n");
-    fflush(stderr);
+    TRACE_PHASE(DEBUG_COMPILER, "compiling file %s", filename);
 
     token_stream_t* stream = token_stream_create(filename);
     if (!stream) {
@@ -2757,19 +3255,17 @@ bool compiler_compile_file(compiler_t* comp, const char* filename) {
         return false;
     }
 
-    fprintf(stderr, "TRACE: Token stream created\n");
-    fflush(stderr);
-
     if (comp->verbose) {
         printf("Compiling: %s\n", filename);
     }
 
+    /* One transaction for the file: definitions and their invalidations
+     * are written per word, and committing each would sync the disk */
+    db_begin(comp->db);
+
     DEBUG_COMPILER("Starting token loop");
     token_t tok;
     while (token_stream_next(stream, &tok)) {
-        fprintf(stderr, "TRACE: Token type=%d text='%s'\n", tok.type, tok.text ? tok.text : "NULL");
-        fflush(stderr);
-
         DEBUG_COMPILER("Processing token type=%d text='%s'", tok.type, tok.text ? tok.text : "NULL");
         bool success = true;
 
@@ -2778,8 +3274,7 @@ bool compiler_compile_file(compiler_t* comp, const char* filename) {
             success = compile_type_sig_decl(comp, stream);
         } else if (tok.type == TOK_COLON) {
             /* Start word definition */
-            fprintf(stderr, "TRACE: Starting word definition\n");
-            fflush(stderr);
+            TRACE_WORD(DEBUG_COMPILER, "definition at line %d", tok.line);
             DEBUG_COMPILER("Calling compile_definition");
             success = compile_definition(comp, stream);
         } else if (tok.type == TOK_NUMBER || tok.type == TOK_WORD) {
@@ -2791,11 +3286,274 @@ bool compiler_compile_file(compiler_t* comp, const char* filename) {
         token_free(&tok);
 
         if (!success) {
+            db_commit(comp->db);
             token_stream_free(stream);
             return false;
         }
     }
 
     token_stream_free(stream);
+    return db_commit(comp->db);
+}
+
+/* Queue the not yet reachable definitions of an interned name */
+static bool mark_name(compiler_t* comp, uint32_t name_sym,
+                      word_definition_t** work, int* top, int* marked) {
+    word_definition_t* def = find_word_definition(comp, name_sym);
+    bool found = (def != NULL);
+    for (; def; def = def->next_overload) {
+        if (!def->reachable) {
+            def->reachable = true;
+            work[(*top)++] = def;
+            (*marked)++;
+        }
+    }
+    return found;
+}
+
+/* Whole-program mode: mark definitions named, directly or through
+ * quotations, by the entries. Overloads are matched by name only. */
+int compiler_mark_reachable(compiler_t* comp, const char* const* entries, int count) {
+    /* Each definition is queued at most once */
+    word_definition_t** work = malloc(sizeof(word_definition_t*) * ((size_t)comp->word_def_count + 1));
+    if (!work) return -1;
+    int top = 0;
+    int marked = 0;
+
+    for (int i = 0; i < comp->word_def_count; i++) {
+        comp->word_defs[i]->reachable = false;
+    }
+    for (int e = 0; e < count; e++) {
+        if (!mark_name(comp, token_intern(entries[e], strlen(entries[e])), work, &top, &marked)) {
+            fprintf(stderr, "Entry word not defined: %s\n", entries[e]);
+            free(work);
+            return -1;
+        }
+    }
+    while (top > 0) {
+        word_definition_t* def = work[--top];
+        for (int i = 0; i < def->token_count; i++) {
+            if (def->tokens[i].type == TOK_WORD) {
+                mark_name(comp, def->tokens[i].sym, work, &top, &marked);
+            }
+        }
+    }
+    free(work);
+
+    comp->whole_program = true;
+    return marked;
+}
+
+void compiler_forget_entries(compiler_t* comp) {
+    size_t count = dict_entry_count(comp->dict);
+    for (size_t i = 0; i < count; i++) {
+        dict_entry_t* entry = dict_entry_at(comp->dict, i);
+        if (entry->word_def) entry->cid = NULL;
+    }
+}
+
+/* Compile a word called with nothing on the stack (an entry point),
+ * unless it already has code, and set entry->cid */
+bool compiler_compile_entry(compiler_t* comp, dict_entry_t* entry) {
+    if (!entry->word_def || entry->cid) {
+        return true;
+    }
+    const char* name = entry->name;
+
+    if (comp->verbose) {
+        printf("\nOn-demand compilation: %s\n", name);
+    }
+
+    /* Declared inputs, if any, stand in for the caller's stack */
+    type_id_t inputs[MAX_TYPE_STACK];
+    int input_count = entry->signature.input_count;
+    for (int i = 0; i < input_count; i++) {
+        inputs[i] = entry->signature.inputs[i];
+    }
+
+    /* Build type signature string from word's signature */
+    char type_sig_str[256] = "-> ";  /* Top-level words have no inputs */
+    char* p = type_sig_str + 3;
+    for (int i = 0; i < entry->signature.output_count; i++) {
+        type_id_t t = entry->signature.outputs[i];
+        switch (t) {
+            case TYPE_I64: p += sprintf(p, "i64 "); break;
+            case TYPE_U64: p += sprintf(p, "u64 "); break;
+            case TYPE_F64: p += sprintf(p, "f64 "); break;
+            case TYPE_PTR: p += sprintf(p, "ptr "); break;
+            case TYPE_BOOL: p += sprintf(p, "bool "); break;
+            case TYPE_STR: p += sprintf(p, "str "); break;
+            case TYPE_STR_MUT: p += sprintf(p, "str! "); break;
+            case TYPE_ARRAY: p += sprintf(p, "array "); break;
+            case TYPE_ARRAY_MUT: p += sprintf(p, "array! "); break;
+            default: p += sprintf(p, "? "); break;
+        }
+    }
+    if (p > type_sig_str) p[-1] = '\0';  /* Trim trailing space */
+
+    /* Compiled by an earlier run with the same source? */
+    unsigned char* cid = NULL;
+    if (input_count == 0) {
+        cid = specialization_lookup(comp, entry->word_def, inputs, 0, NULL);
+    }
+
+    if (cid) {
+        if (comp->verbose) {
+            printf("  Reusing cached compilation\n");
+        }
+        db_rebind_specializations(comp->db, cid);
+    } else {
+        /* Compile the word with its defined signature */
+        blob_buffer_t* compiled_blob = word_compile_with_context(comp, entry->word_def,
+                                                                 inputs, input_count);
+        if (!compiled_blob) {
+            fprintf(stderr, "Error: Failed to compile word '%s' on-demand\n", name);
+            return false;
+        }
+
+        /* Store the compiled blob in database */
+        unsigned char* sig_cid = db_store_type_sig(comp->db, NULL, type_sig_str);
+        if (!sig_cid) {
+            fprintf(stderr, "Error: Failed to store type signature for on-demand compilation\n");
+            blob_buffer_free(compiled_blob);
+            return false;
+        }
+
+        cid = db_store_blob(comp->db, BLOB_WORD, sig_cid,
+                            compiled_blob->data, compiled_blob->size);
+        free(sig_cid);
+
+        if (!cid) {
+            blob_buffer_free(compiled_blob);
+            fprintf(stderr, "Error: Failed to store compiled word\n");
+            return false;
+        }
+
+        /* Record references (GC edges) and bind the word as a GC root */
+        db_store_edges(comp->db, cid, compiled_blob->data, compiled_blob->size);
+        inline_deps_store(comp->db, cid, &comp->inlined);
+        blob_buffer_free(compiled_blob);
+        db_bind_word(comp->db, name, NULL, cid, type_sig_str);
+        if (input_count == 0) {
+            specialization_store(comp, entry->word_def, inputs, 0, cid, type_sig_str);
+            db_store_def_effects(comp->db, cid, comp->effects, effects_pure(comp->effects));
+            db_store_def_depth(comp->db, cid, comp->depth.data_max, comp->depth.data_effect,
+                               comp->depth.return_max);
+        }
+    }
+
+    dict_set_cid(entry, cid);
+    free(cid);
+
+    if (comp->verbose) {
+        printf("  Stored compiled version in database\n");
+    }
     return true;
 }
+
+/* Parallel compilation: one job per concretely typed word */
+typedef struct {
+    compiler_t* parent;
+    dict_entry_t* entry;
+    bool ok;
+    optimizer_stats_t opt_stats;
+} parallel_job_t;
+
+static void parallel_compile_job(void* arg) {
+    parallel_job_t* job = arg;
+    job->ok = false;
+
+    compiler_t* comp = compiler_create_job(job->parent);
+    if (!comp) {
+        fprintf(stderr, "Cannot create compile job for '%s'\n", job->entry->name);
+        return;
+    }
+    crash_context_set_phase("compile (parallel)");
+    crash_context_set_word(job->entry->name);
+
+    /* Compile as if called with exactly the declared inputs on the stack */
+    type_sig_t* sig = &job->entry->signature;
+    type_id_t inputs[8];
+    for (int i = 0; i < sig->input_count; i++) {
+        inputs[i] = sig->inputs[i];
+        push_type(comp, inputs[i]);
+    }
+
+    unsigned char* cid = specialization_get(comp, job->entry->name, job->entry,
+                                            inputs, sig->input_count);
+    job->ok = (cid != NULL);
+    free(cid);
+    job->opt_stats = comp->opt_stats;
+
+    crash_context_set_word(NULL);
+    compiler_free(comp);
+}
+
+/* Word specializable ahead of its call sites: latest definition of its
+ * name with a $ signature naming only concrete input types */
+static dict_entry_t* parallel_candidate(compiler_t* comp, word_definition_t* def) {
+    dict_entry_t* entry = dict_lookup(comp->dict, def->name);
+    if (!entry || entry->word_def != def || !def->type_sig) return NULL;
+    if (comp->whole_program && !def->reachable) return NULL;
+    if (entry->signature.input_count > 8) return NULL;
+    for (int i = 0; i < entry->signature.input_count; i++) {
+        type_id_t t = entry->signature.inputs[i];
+        if (t == TYPE_UNKNOWN || t >= TYPE_ANY) return NULL;
+    }
+    return entry;
+}
+
+/* Compile concretely typed words on a thread pool */
+bool compiler_compile_parallel(compiler_t* comp, int jobs) {
+    parallel_job_t* work = calloc((size_t)comp->word_def_count + 1, sizeof(parallel_job_t));
+    if (!work) return false;
+
+    int count = 0;
+    for (int i = 0; i < comp->word_def_count; i++) {
+        dict_entry_t* entry = parallel_candidate(comp, comp->word_defs[i]);
+        if (entry) {
+            work[count].parent = comp;
+            work[count].entry = entry;
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        free(work);
+        return true;
+    }
+    if (jobs > count) jobs = count;
+
+    thread_pool_t* pool = thread_pool_create(jobs);
+    if (!pool) {
+        free(work);
+        return false;
+    }
+
+    if (comp->verbose) {
+        printf("Compiling %d words on %d threads\n", count, pool->thread_count);
+    }
+
+    /* One transaction for the whole batch; jobs share the handle's lock */
+    db_begin(comp->db);
+    for (int i = 0; i < count; i++) {
+        /* Definition order: callees are queued before their callers */
+        if (!thread_pool_submit(pool, parallel_compile_job, &work[i])) {
+            parallel_compile_job(&work[i]);
+        }
+    }
+    thread_pool_free(pool);
+    bool committed = db_commit(comp->db);
+
+    bool ok = committed;
+    for (int i = 0; i < count; i++) {
+        optimizer_stats_add(&comp->opt_stats, &work[i].opt_stats);
+        if (!work[i].ok) {
+            fprintf(stderr, "Failed to compile '%s'\n", work[i].entry->name);
+            ok = false;
+        }
+    }
+
+    free(work);
+    return ok;
+}
@@ -10,6 +10,11 @@
 #include "tokens.h"
 #include "dictionary.h"
 #include "database.h"
+#include "ir.h"
+#include "optimizer.h"
+#include "inliner.h"
+#include "depth.h"
+#include <pthread.h>
 
 /* Maximum quotation nesting depth */
 #define MAX_QUOT_DEPTH 16
@@ -17,17 +22,12 @@
 /* Maximum array literal nesting depth */
 #define MAX_ARRAY_DEPTH 16
 
-/* Maximum pending quotation references in a single word */
-#define MAX_QUOT_REFS 64
+/* Most inputs or outputs of a word evaluated at compile time */
+#define MAX_EVAL_RESULTS 8
 
-/* Maximum allocation slots per word */
-#define MAX_SLOTS 256
-
-/* Maximum cached word definitions */
-#define MAX_WORD_DEFS 256
-
-/* Maximum specialization cache entries */
-#define MAX_SPECIALIZATIONS 512
+/* Folded into every word source hash; bump when the blob encoding emitted
+ * for the same tokens changes, so persisted specializations are not reused */
+#define SPEC_FORMAT_VERSION "march-spec-1"
 
 /* Quotation kind */
 typedef enum {
@@ -40,8 +40,7 @@ typedef struct {
     quot_kind_t kind;              /* Literal vs Typed */
 
     /* For QUOT_TYPED: compiled form */
-    cell_buffer_t* cells;          /* Legacy: runtime cells */
-    blob_buffer_t* blob;           /* CID-based: blob encoding */
+    ir_buffer_t* ir;               /* Instructions (inlined or lowered to a blob) */
 
     /* For QUOT_LITERAL: token storage */
     token_t* tokens;               /* Array of captured tokens */
@@ -62,78 +61,186 @@ typedef struct word_definition {
     int token_count;
     int token_capacity;
     type_sig_t* type_sig;          /* Optional explicit type signature */
+    char* source_text;             /* Space-joined tokens (defs.source_text) */
+    unsigned char source_hash[CID_SIZE];  /* Token stream hash (defs.source_hash) */
+    bool reachable;                /* Named from a whole-program entry */
+    bool memo;                     /* `$ memo ...`: calls go through the memo table */
+    uint32_t name_sym;             /* Interned name (tokens.h) */
+    struct word_definition* next_overload;  /* Earlier definition of the same name */
 } word_definition_t;
 
-/* Specialization cache entry - stores compiled versions by concrete types */
+/* A word specialization being compiled (word_compile_with_context),
+ * innermost first: a call matching the innermost frame is recursion */
+typedef struct compile_frame {
+    word_definition_t* word_def;
+    const type_id_t* inputs;
+    int input_count;
+    inline_deps_t evaluated;       /* Calls replaced by their results */
+    struct compile_frame* outer;
+} compile_frame_t;
+
+/* Specialization cache entry - stores compiled versions by concrete types.
+ * Keyed by the word's token hash: a changed callee is not part of the key,
+ * compile_definition drops persisted dependents of changed words instead. */
 typedef struct {
-    char* word_name;               /* Name of the word */
+    char* word_name;               /* Name of the word (diagnostics) */
+    unsigned char source_hash[CID_SIZE];  /* Word source hash (cache key) */
     type_id_t input_types[8];      /* Concrete input types (cache key) */
     int input_count;
     unsigned char* cid;            /* CID of compiled specialization (32 bytes) */
 } specialization_t;
 
-/* Compiler state */
+/* Quotation cache entry - a materialized quotation blob by its tokens and
+ * the input types captured with it. Tokens own nothing (interned text), so
+ * the key is a plain copy of them. */
+typedef struct {
+    uint64_t hash;                 /* Of the key below */
+    token_t* tokens;               /* Quotation body (cache key) */
+    int token_count;
+    type_id_t* input_types;        /* Types under the quotation (cache key) */
+    int input_count;
+    unsigned char cid[CID_SIZE];   /* Stored BLOB_QUOTATION */
+    inline_deps_t evaluated;       /* Calls its compilation evaluated into the enclosing word */
+} quot_cache_entry_t;
+
+/* Specialization cache, shared by a compiler and its parallel jobs.
+ * Cache key: (source_hash, input_types[]) → CID, backed by the
+ * specializations table so unchanged words are not recompiled next run. */
+typedef struct {
+    pthread_mutex_t lock;
+    specialization_t* entries;     /* Grown by doubling; only used under lock */
+    int count;
+    int capacity;
+    int* index;                    /* Open addressing: entry index + 1, 0 = empty */
+    int index_size;                /* Power of two, kept at most half full */
+
+    /* Quotations materialized so far (same lock): a repeated body with
+     * the same input types reuses the blob instead of being recompiled */
+    quot_cache_entry_t* quots;
+    int quot_count;
+    int quot_capacity;
+    int* quot_index;               /* Open addressing, as index above */
+    int quot_index_size;
+    int quot_hits;                 /* Lookups answered from quots */
+} spec_cache_t;
+
+/* Compiler state. Everything but dict, db, word_defs and specs is the
+ * state of one compilation; compiler_create_job gives each parallel job
+ * its own copy of it. dict and word_defs are read-only once parsing is done. */
 typedef struct compiler {
     dictionary_t* dict;
     march_db_t* db;
+    struct compiler* parent;       /* Set for job contexts */
     type_stack_entry_t type_stack[MAX_TYPE_STACK];
     int type_stack_depth;
-    cell_buffer_t* cells;          /* Legacy: runtime cells (deprecated) */
-    blob_buffer_t* blob;           /* CID-based blob encoding (LINKING.md) */
+    ir_buffer_t* ir;               /* Instructions being emitted (lowered once at the end) */
     ref_graph_t* ref_graph;        /* Reference graph for memory management */
     bool verbose;
+    int opt_level;                 /* OPT_NONE, OPT_PEEPHOLE or OPT_INLINE (marchc -O) */
+    optimizer_stats_t opt_stats;   /* Totals for words compiled by this context */
+    inline_deps_t inlined;         /* Callees inlined (or evaluated) into the blob
+                                    * last returned by word_compile_with_context */
+    uint32_t effects;              /* Effect flags of that blob (effects.h) */
+    stack_depth_t depth;           /* Its stack depth (depth.h) */
+    compile_frame_t* frame;        /* Innermost word being compiled, or NULL */
+    bool whole_program;            /* Only reachable words are compiled ahead */
 
     /* Compile-time slot allocation (like register allocation for heap ptrs) */
-    bool slot_used[MAX_SLOTS];        /* Which slots are currently in use */
+    bool* slot_used;                  /* Which slots are currently in use */
+    int slot_capacity;
     int slot_count;                   /* Number of slots allocated (peak usage) */
 
+    /* Type stacks and slots of the enclosing compilations, saved LIFO
+     * (live entries only) while a quotation or callee is compiled */
+    unsigned char* save_area;
+    size_t save_used;
+    size_t save_capacity;
+
     /* Type signature for next word definition (from $ declaration) */
     type_sig_t* pending_type_sig;
+    bool pending_memo;
 
     /* Quotation compilation support */
     quotation_t* quot_stack[MAX_QUOT_DEPTH];
     int quot_stack_depth;
 
-    /* Buffer stack for nested quotations */
-    cell_buffer_t* buffer_stack[MAX_QUOT_DEPTH + 1];  /* +1 for root */
+    /* Instruction buffer stack for nested quotations */
+    ir_buffer_t* ir_stack[MAX_QUOT_DEPTH + 1];  /* +1 for root */
     int buffer_stack_depth;
 
-    /* Blob buffer stack for nested quotations (CID-based) */
-    blob_buffer_t* blob_stack[MAX_QUOT_DEPTH + 1];    /* +1 for root */
-    int blob_stack_depth;
-
     /* Runtime quotation counter for generating unique names (deprecated) */
     int quot_counter;
 
     /* Pending quotation CID references (for linking) */
-    unsigned char* pending_quot_cids[MAX_QUOT_REFS];
+    unsigned char** pending_quot_cids;
     int pending_quot_count;
+    int pending_quot_capacity;
 
     /* Array literal compilation support */
     int array_marker_stack[MAX_ARRAY_DEPTH];  /* Stack depth at each [ */
+    size_t array_marker_ir[MAX_ARRAY_DEPTH];  /* IR count at each [ */
     int array_marker_depth;                    /* Number of nested [ ] */
 
     /* Word definition cache (compile-time only) */
     /* Words are named quotations - stored as tokens, compiled at call site */
-    word_definition_t* word_defs[MAX_WORD_DEFS];
+    word_definition_t** word_defs;       /* Definition order */
     int word_def_count;
+    int word_def_capacity;
+    word_definition_t** word_by_sym;     /* Latest definition by interned name */
+    size_t word_by_sym_size;
 
     /* Specialization cache - stores compiled versions by concrete types */
-    /* Cache key: (word_name, input_types[]) → CID */
-    specialization_t specializations[MAX_SPECIALIZATIONS];
-    int specialization_count;
+    spec_cache_t* specs;
 } compiler_t;
 
 /* Create/free compiler */
 compiler_t* compiler_create(dictionary_t* dict, march_db_t* db);
 void compiler_free(compiler_t* comp);
 
+/* Job context for compiling on another thread: fresh per-compilation
+ * state sharing parent's dictionary, database and specialization cache */
+compiler_t* compiler_create_job(compiler_t* parent);
+
+/* Compile every word whose $ signature has only concrete input types,
+ * on jobs threads, inside one database transaction. Words used with
+ * other types are still specialized on demand. */
+bool compiler_compile_parallel(compiler_t* comp, int jobs);
+
 /* Compile a file */
 bool compiler_compile_file(compiler_t* comp, const char* filename);
 
+/* Whole-program mode: mark the definitions reachable from the entry
+ * words; compiler_compile_parallel then skips the rest, so code no entry
+ * can reach is never compiled or stored. Returns the number of reachable
+ * definitions, or -1 if an entry is not defined. */
+int compiler_mark_reachable(compiler_t* comp, const char* const* entries, int count);
+
+/* Compile a word as an entry point (called with an empty stack, or its
+ * declared inputs), store and bind it, and set entry->cid. Words that
+ * already have code are left alone. */
+bool compiler_compile_entry(compiler_t* comp, dict_entry_t* entry);
+
+/* Forget the code of every compiled definition, so the next
+ * compiler_compile_entry looks it up again: a long-lived compiler after a
+ * redefinition, when a caller's code may call the old callee. Unchanged
+ * words come back from the specialization cache. */
+void compiler_forget_entries(compiler_t* comp);
+
 /* Register primitives */
 void compiler_register_primitives(compiler_t* comp);
 
+/* Specialization cache: look up (word source hash, input types) in memory,
+ * then in the database. Returns the CID (caller must free) or NULL; sets
+ * *from_db when the entry was loaded from a previous run. */
+unsigned char* specialization_lookup(compiler_t* comp, word_definition_t* word_def,
+                                     type_id_t* input_types, int input_count, bool* from_db);
+
+/* Specialization cache: remember a compiled version (bound in words with
+ * type_sig) in memory and database */
+bool specialization_store(compiler_t* comp, word_definition_t* word_def,
+                          type_id_t* input_types, int input_count,
+                          const unsigned char* cid, const char* type_sig);
+
 /* Phase 5: On-demand compilation for token-based words */
 blob_buffer_t* word_compile_with_context(compiler_t* comp, word_definition_t* word_def,
                                           type_id_t* input_types, int input_count);
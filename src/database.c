@@ -10,14 +10,90 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <openssl/sha.h>
+
+/* Embedded schema (schema_sql.c, generated from ../schema.sql) */
+extern const char march_schema_sql[];
+extern const char march_schema_hash[];
+
+/* Read everything open needs from metadata in one query: the CID hash and
+ * the schema hash/version db_init_schema compares against */
+static void load_metadata(march_db_t* db) {
+    sqlite3_stmt* stmt = NULL;
+    int rc = sqlite3_prepare_v2(db->db,
+        "SELECT key, value FROM metadata "
+        "WHERE key IN ('cid_hash', 'schema_hash', 'schema_version');",
+        -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        /* New or pre-metadata database */
+        return;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* key = (const char*)sqlite3_column_text(stmt, 0);
+        const char* value = (const char*)sqlite3_column_text(stmt, 1);
+        if (!key || !value) continue;
+
+        if (strcmp(key, "cid_hash") == 0) {
+            if (!cid_hash_parse(value, &db->cid_hash)) {
+                fprintf(stderr, "Warning: Unknown cid_hash '%s' in metadata, using %s\n",
+                        value, cid_hash_name(CID_HASH_DEFAULT));
+                db->cid_hash = CID_HASH_DEFAULT;
+            }
+        } else if (strcmp(key, "schema_hash") == 0) {
+            db->schema_hash = strdup(value);
+        } else if (strcmp(key, "schema_version") == 0) {
+            db->schema_version = atoi(value);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    DEBUG_DB("CID hash: %s, schema version %d", cid_hash_name(db->cid_hash), db->schema_version);
+}
+
+/* Build "file:<path>?immutable=1" URI (percent-encoding URI metacharacters) */
+static char* readonly_uri(const char* filename) {
+    size_t len = strlen(filename);
+    char* uri = malloc(len * 3 + sizeof("file:?immutable=1"));
+    if (!uri) return NULL;
+
+    char* p = uri + sprintf(uri, "file:");
+    for (const char* c = filename; *c; c++) {
+        if (*c == '?' || *c == '#' || *c == '%') {
+            p += sprintf(p, "%%%02X", (unsigned char)*c);
+        } else {
+            *p++ = *c;
+        }
+    }
+    strcpy(p, "?immutable=1");
+    return uri;
+}
 
 /* Open database */
 march_db_t* db_open(const char* filename) {
+    return db_open_ex(filename, DB_OPEN_READWRITE);
+}
+
+/* Open database with explicit mode */
+march_db_t* db_open_ex(const char* filename, db_open_mode_t mode) {
     march_db_t* db = malloc(sizeof(march_db_t));
     if (!db) return NULL;
 
-    int rc = sqlite3_open(filename, &db->db);
+    int rc;
+    if (mode == DB_OPEN_READONLY) {
+        char* uri = readonly_uri(filename);
+        if (!uri) {
+            free(db);
+            return NULL;
+        }
+        rc = sqlite3_open_v2(uri, &db->db,
+                             SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_FULLMUTEX, NULL);
+        free(uri);
+    } else {
+        rc = sqlite3_open_v2(filename, &db->db,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                             NULL);
+    }
+
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db->db));
         sqlite3_close(db->db);
@@ -26,45 +102,321 @@ march_db_t* db_open(const char* filename) {
     }
 
     db->filename = strdup(filename);
+    db->cid_hash = CID_HASH_DEFAULT;
+    db->readonly = (mode == DB_OPEN_READONLY);
+    db->schema_hash = NULL;
+    db->schema_version = 0;
+    db->stmt_count = 0;
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&db->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    if (db->readonly) {
+        /* Nothing is written, so foreign keys are irrelevant; map the file
+         * so concurrent runners share the OS page cache */
+        char pragma[64];
+        snprintf(pragma, sizeof(pragma), "PRAGMA mmap_size = %lld;", DB_READONLY_MMAP_SIZE);
+        sqlite3_exec(db->db, pragma, NULL, NULL, NULL);
+    } else {
+        /* Enable foreign keys */
+        sqlite3_exec(db->db, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
+        char pragma[64];
+        snprintf(pragma, sizeof(pragma), "PRAGMA cache_size = -%d;", DB_CACHE_SIZE_KB);
+        sqlite3_exec(db->db, pragma, NULL, NULL, NULL);
+    }
 
-    /* Enable foreign keys */
-    sqlite3_exec(db->db, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
+    /* Existing database: CID hash and schema state */
+    load_metadata(db);
 
+    DEBUG_DB("Opened %s (%s)", filename, db->readonly ? "read-only" : "read-write");
     return db;
 }
 
 /* Close database */
 void db_close(march_db_t* db) {
     if (db) {
+        for (int i = 0; i < db->stmt_count; i++) {
+            sqlite3_finalize(db->stmts[i].stmt);
+            free(db->stmts[i].sql);
+        }
         sqlite3_close(db->db);
+        pthread_mutex_destroy(&db->lock);
         free(db->filename);
+        free(db->schema_hash);
         free(db);
     }
 }
 
-/* Initialize schema from SQL file */
-bool db_init_schema(march_db_t* db, const char* schema_file) {
-    /* Check if schema already exists */
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db->db,
-        "SELECT name FROM sqlite_master WHERE type='table' AND name='words';",
-        -1, &stmt, NULL);
+/* Handle lock. The storage and lookup calls used while compiling are thin
+ * public wrappers that take it around a static *_locked implementation. */
+void db_lock(march_db_t* db) {
+    if (db) pthread_mutex_lock(&db->lock);
+}
 
-    if (rc == SQLITE_OK) {
-        rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+void db_unlock(march_db_t* db) {
+    if (db) pthread_mutex_unlock(&db->lock);
+}
+
+/* Statement cache. Compiling a word runs the same dozen statements, and
+ * preparing one costs more than running it, so each SQL text is prepared
+ * once per handle. A statement still in use (the same query issued from
+ * inside its own row loop) gets a fresh one that db_release finalizes. */
+static int db_prepare(march_db_t* db, const char* sql, sqlite3_stmt** stmt) {
+    db_lock(db);
+    int free_slot = -1;
+    for (int i = 0; i < db->stmt_count; i++) {
+        if (strcmp(db->stmts[i].sql, sql) != 0) continue;
+        if (!db->stmts[i].in_use) {
+            db->stmts[i].in_use = true;
+            *stmt = db->stmts[i].stmt;
+            db_unlock(db);
+            return SQLITE_OK;
+        }
+        free_slot = -2;     /* Busy: do not cache a second copy */
+    }
+    if (free_slot == -1 && db->stmt_count < DB_STMT_CACHE_SIZE) {
+        free_slot = db->stmt_count;
+    }
+
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, stmt, NULL);
+    if (rc == SQLITE_OK && free_slot >= 0) {
+        char* copy = strdup(sql);
+        if (copy) {
+            db->stmts[free_slot].sql = copy;
+            db->stmts[free_slot].stmt = *stmt;
+            db->stmts[free_slot].in_use = true;
+            db->stmt_count++;
+        }
+    }
+    db_unlock(db);
+    return rc;
+}
 
-        if (rc == SQLITE_ROW) {
-            /* Schema already exists */
-            return true;
+/* Done with a db_prepare statement: reset it for the next call */
+static void db_release(march_db_t* db, sqlite3_stmt* stmt) {
+    if (!stmt) return;
+    db_lock(db);
+    for (int i = 0; i < db->stmt_count; i++) {
+        if (db->stmts[i].stmt == stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+            db->stmts[i].in_use = false;
+            db_unlock(db);
+            return;
         }
     }
+    db_unlock(db);
+    sqlite3_finalize(stmt);
+}
+
+/* Explicit transactions */
+bool db_begin(march_db_t* db) {
+    if (!db || db->readonly) return true;
+    db_lock(db);
+    int rc = sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    db_unlock(db);
+    return rc == SQLITE_OK;
+}
+
+bool db_commit(march_db_t* db) {
+    if (!db || db->readonly) return true;
+    db_lock(db);
+    int rc = sqlite3_exec(db->db, "COMMIT;", NULL, NULL, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Commit failed: %s\n", sqlite3_errmsg(db->db));
+    }
+    db_unlock(db);
+    return rc == SQLITE_OK;
+}
+
+/* ============================================================================ */
+/* Schema initialization and migration */
+/* ============================================================================ */
 
-    /* Schema doesn't exist, create it */
+/* Whether an existing table has a column */
+static bool table_has_column(march_db_t* db, const char* table, const char* column) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db->db, "SELECT 1 FROM pragma_table_info(?1) WHERE name = ?2;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, table, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, column, -1, SQLITE_STATIC);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+/* Databases created from the old simplified src/schema.sql have no
+ * metadata or edges tables, a words table keyed by (name, namespace) with
+ * no id (so overloads replace each other) and a defs table without the
+ * effect columns. Tables cannot change their keys in place: build the
+ * version 1 tables, copy the rows that still reference stored blobs, and
+ * swap them in. */
+static bool migrate_0_to_1(march_db_t* db) {
+    char* err_msg = NULL;
+    int rc = sqlite3_exec(db->db,
+        "CREATE TABLE IF NOT EXISTS metadata ("
+        "    key TEXT PRIMARY KEY,"
+        "    value TEXT NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS edges ("
+        "    from_cid BLOB NOT NULL,"
+        "    to_cid BLOB NOT NULL,"
+        "    edge_type TEXT NOT NULL,"
+        "    FOREIGN KEY (from_cid) REFERENCES blobs(cid) ON DELETE CASCADE,"
+        "    FOREIGN KEY (to_cid) REFERENCES blobs(cid) ON DELETE RESTRICT,"
+        "    PRIMARY KEY (from_cid, to_cid, edge_type));"
+        "CREATE INDEX IF NOT EXISTS idx_edges_from ON edges(from_cid);"
+        "CREATE INDEX IF NOT EXISTS idx_edges_to ON edges(to_cid);",
+        NULL, NULL, &err_msg);
+
+    if (rc == SQLITE_OK && !table_has_column(db, "words", "id")) {
+        rc = sqlite3_exec(db->db,
+            "CREATE TABLE words_v1 ("
+            "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "    name TEXT NOT NULL,"
+            "    namespace TEXT DEFAULT 'user',"
+            "    def_cid BLOB NOT NULL,"
+            "    type_sig TEXT,"
+            "    is_primitive INTEGER NOT NULL DEFAULT 0,"
+            "    architecture TEXT,"
+            "    is_immediate INTEGER NOT NULL DEFAULT 0,"
+            "    doc TEXT,"
+            "    created_at INTEGER NOT NULL DEFAULT (unixepoch()),"
+            "    FOREIGN KEY (def_cid) REFERENCES blobs(cid) ON DELETE RESTRICT,"
+            "    CHECK (is_primitive IN (0, 1)),"
+            "    CHECK (is_immediate IN (0, 1)),"
+            "    CHECK ((is_primitive = 0 AND architecture IS NULL) OR"
+            "           (is_primitive = 1 AND architecture IS NOT NULL)),"
+            "    UNIQUE (name, namespace, type_sig));"
+            "INSERT INTO words_v1 (name, namespace, def_cid, type_sig, is_primitive, architecture)"
+            "    SELECT name, namespace, def_cid, type_sig, is_primitive = 1,"
+            "           CASE WHEN is_primitive = 1 THEN 'x86-64' END"
+            "    FROM words WHERE def_cid IN (SELECT cid FROM blobs) ORDER BY rowid;"
+            "DROP TABLE words;"
+            "ALTER TABLE words_v1 RENAME TO words;"
+            "CREATE INDEX idx_words_name ON words(name, namespace);"
+            "CREATE INDEX idx_words_namespace ON words(namespace);"
+            "CREATE INDEX idx_words_def_cid ON words(def_cid);"
+            "CREATE INDEX idx_words_type ON words(type_sig);",
+            NULL, NULL, &err_msg);
+    }
+
+    if (rc == SQLITE_OK && !table_has_column(db, "defs", "effects")) {
+        rc = sqlite3_exec(db->db,
+            "CREATE TABLE defs_v1 ("
+            "    cid BLOB PRIMARY KEY,"
+            "    bytecode_version INTEGER NOT NULL DEFAULT 1,"
+            "    sig_cid BLOB,"
+            "    is_pure INTEGER NOT NULL DEFAULT 0,"
+            "    effects INTEGER NOT NULL DEFAULT 0,"
+            "    escapes INTEGER NOT NULL DEFAULT 0,"
+            "    source_text TEXT,"
+            "    source_hash TEXT,"
+            "    compiled_at INTEGER NOT NULL DEFAULT (unixepoch()),"
+            "    FOREIGN KEY (cid) REFERENCES blobs(cid) ON DELETE CASCADE,"
+            "    FOREIGN KEY (sig_cid) REFERENCES type_signatures(sig_cid) ON DELETE RESTRICT,"
+            "    CHECK (is_pure IN (0, 1)),"
+            "    CHECK (escapes IN (0, 1)));"
+            "INSERT INTO defs_v1 (cid, bytecode_version, sig_cid, source_text, source_hash)"
+            "    SELECT cid, COALESCE(bytecode_version, 1), sig_cid, source_text, source_hash"
+            "    FROM defs WHERE cid IN (SELECT cid FROM blobs);"
+            "DROP TABLE defs;"
+            "ALTER TABLE defs_v1 RENAME TO defs;",
+            NULL, NULL, &err_msg);
+    }
+
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Migration 0->1 failed: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+/* Persistent specialization cache */
+static bool migrate_1_to_2(march_db_t* db) {
+    char* err_msg = NULL;
+    int rc = sqlite3_exec(db->db,
+        "CREATE TABLE IF NOT EXISTS specializations ("
+        "    source_hash BLOB NOT NULL,"
+        "    input_types BLOB NOT NULL,"
+        "    cid BLOB NOT NULL,"
+        "    name TEXT NOT NULL,"
+        "    type_sig TEXT,"
+        "    FOREIGN KEY (cid) REFERENCES blobs(cid) ON DELETE CASCADE,"
+        "    CHECK (length(source_hash) = 32),"
+        "    PRIMARY KEY (source_hash, input_types)) WITHOUT ROWID;"
+        "CREATE INDEX IF NOT EXISTS idx_specializations_cid ON specializations(cid);",
+        NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Migration 1->2 failed: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+/* Stack depth per definition (NULL = never analyzed) */
+static bool migrate_2_to_3(march_db_t* db) {
+    char* err_msg = NULL;
+    int rc = sqlite3_exec(db->db,
+        "ALTER TABLE defs ADD COLUMN max_data_depth INTEGER;"
+        "ALTER TABLE defs ADD COLUMN data_effect INTEGER;"
+        "ALTER TABLE defs ADD COLUMN max_return_depth INTEGER;",
+        NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Migration 2->3 failed: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+/* migrations[v] upgrades schema version v to v + 1.
+ * Bumping MARCH_SCHEMA_VERSION: update schema.sql (including its
+ * schema_version row) and append the step that brings old databases there. */
+static const db_migration_fn migrations[MARCH_SCHEMA_VERSION] = {
+    migrate_0_to_1,
+    migrate_1_to_2,
+    migrate_2_to_3,
+};
+
+/* Upgrade database from from_version to MARCH_SCHEMA_VERSION */
+bool db_migrate(march_db_t* db, int from_version) {
+    if (from_version > MARCH_SCHEMA_VERSION) {
+        fprintf(stderr, "Error: Database %s has schema version %d, newer than supported (%d)\n",
+                db->filename, from_version, MARCH_SCHEMA_VERSION);
+        return false;
+    }
+
+    sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    for (int v = from_version; v < MARCH_SCHEMA_VERSION; v++) {
+        DEBUG_DB("Migrating schema %d -> %d", v, v + 1);
+        if (!migrations[v](db)) {
+            sqlite3_exec(db->db, "ROLLBACK;", NULL, NULL, NULL);
+            return false;
+        }
+    }
+
+    char version[16];
+    snprintf(version, sizeof(version), "%d", MARCH_SCHEMA_VERSION);
+    bool ok = db_set_metadata(db, "schema_version", version);
+    sqlite3_exec(db->db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+
+    if (ok) db->schema_version = MARCH_SCHEMA_VERSION;
+    return ok;
+}
+
+/* Read schema file (caller must free) */
+static char* read_schema_file(const char* schema_file) {
     FILE* f = fopen(schema_file, "r");
     if (!f) {
         fprintf(stderr, "Cannot open schema file: %s\n", schema_file);
-        return false;
+        return NULL;
     }
 
     /* Read entire file */
@@ -75,34 +427,177 @@ bool db_init_schema(march_db_t* db, const char* schema_file) {
     char* sql = malloc(size + 1);
     if (!sql) {
         fclose(f);
-        return false;
+        return NULL;
     }
 
-    fread(sql, 1, size, f);
-    sql[size] = '\0';
+    size_t n = fread(sql, 1, size, f);
+    sql[n] = '\0';
     fclose(f);
+    return sql;
+}
 
-    /* Execute SQL */
-    char* err_msg = NULL;
-    rc = sqlite3_exec(db->db, sql, NULL, NULL, &err_msg);
-    free(sql);
+/* Initialize or upgrade schema (schema_file NULL = embedded schema) */
+bool db_init_schema(march_db_t* db, const char* schema_file) {
+    /* Read-only databases are used as-is */
+    if (db->readonly) return true;
+
+    const char* sql = march_schema_sql;
+    char* file_sql = NULL;
+    char file_hash[2 * CID_SIZE + 1];
+    const char* hash = march_schema_hash;
+
+    if (schema_file) {
+        file_sql = read_schema_file(schema_file);
+        if (!file_sql) return false;
+
+        unsigned char digest[CID_SIZE];
+        cid_hash_into(CID_HASH_SHA256, (const uint8_t*)file_sql, strlen(file_sql), digest);
+        for (int i = 0; i < CID_SIZE; i++) {
+            sprintf(file_hash + 2 * i, "%02x", digest[i]);
+        }
+        sql = file_sql;
+        hash = file_hash;
+    }
 
+    /* Fast path: the metadata read at open already says we are current */
+    if (db->schema_hash && strcmp(db->schema_hash, hash) == 0) {
+        free(file_sql);
+        return true;
+    }
+
+    /* Schema doesn't exist yet: create it */
+    bool fresh = false;
+    if (!db->schema_hash) {
+        sqlite3_stmt* stmt;
+        fresh = true;
+        if (sqlite3_prepare_v2(db->db,
+                "SELECT 1 FROM sqlite_master WHERE type='table' AND name='words';",
+                -1, &stmt, NULL) == SQLITE_OK) {
+            fresh = sqlite3_step(stmt) != SQLITE_ROW;
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    if (fresh) {
+        char* err_msg = NULL;
+        int rc = sqlite3_exec(db->db, sql, NULL, NULL, &err_msg);
+        free(file_sql);
+
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", err_msg);
+            sqlite3_free(err_msg);
+            return false;
+        }
+
+        /* Record which hash this database's CIDs use */
+        db_set_metadata(db, "cid_hash", cid_hash_name(db->cid_hash));
+        db->schema_version = MARCH_SCHEMA_VERSION;
+    } else {
+        free(file_sql);
+
+        /* Existing database built from another schema revision */
+        if (db->schema_version != MARCH_SCHEMA_VERSION && !db_migrate(db, db->schema_version)) {
+            return false;
+        }
+    }
+
+    if (!db_set_metadata(db, "schema_hash", hash)) return false;
+    free(db->schema_hash);
+    db->schema_hash = strdup(hash);
+
+    return true;
+}
+
+/* Get metadata value (caller must free, NULL if missing) */
+char* db_get_metadata(march_db_t* db, const char* key) {
+    if (!db || !key) return NULL;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = sqlite3_prepare_v2(db->db,
+        "SELECT value FROM metadata WHERE key = ?;", -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
+        /* No metadata table (older database) */
+        return NULL;
+    }
+
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+
+    char* value = NULL;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* text = (const char*)sqlite3_column_text(stmt, 0);
+        if (text) value = strdup(text);
+    }
+    sqlite3_finalize(stmt);
+
+    return value;
+}
+
+/* Set metadata value (insert or replace) */
+bool db_set_metadata(march_db_t* db, const char* key, const char* value) {
+    if (!db || !key || !value) return false;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = sqlite3_prepare_v2(db->db,
+        "INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?);", -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare metadata update: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, value, -1, SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update metadata: %s\n", sqlite3_errmsg(db->db));
         return false;
     }
 
     return true;
 }
 
+/* Select CID hash (refuses to mix hashes within one database) */
+bool db_set_cid_hash(march_db_t* db, cid_hash_t hash) {
+    if (!db) return false;
+    if (db->cid_hash == hash) return true;
+
+    sqlite3_stmt* stmt = NULL;
+    bool has_blobs = false;
+    if (sqlite3_prepare_v2(db->db, "SELECT 1 FROM blobs LIMIT 1;", -1, &stmt, NULL) == SQLITE_OK) {
+        has_blobs = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+
+    if (has_blobs) {
+        fprintf(stderr, "Error: Database %s already uses cid_hash %s, cannot switch to %s\n",
+                db->filename, cid_hash_name(db->cid_hash), cid_hash_name(hash));
+        return false;
+    }
+
+    db->cid_hash = hash;
+    return db_set_metadata(db, "cid_hash", cid_hash_name(hash));
+}
+
+/* Compute CID with the database's hash (no allocation) */
+void db_compute_cid(march_db_t* db, const uint8_t* data, size_t len, unsigned char* out) {
+    cid_hash_into(db ? db->cid_hash : CID_HASH_DEFAULT, data, len, out);
+
+    if (debug_enabled(DEBUG_CID)) {
+        char* hex = cid_to_hex(out);
+        DEBUG_CID("Computed CID: %.16s... (len=%zu)", hex ? hex : "ERROR", len);
+        free(hex);
+    }
+}
+
 /* Compute SHA256 hash of data */
 /* Compute SHA256 and return raw 32-byte binary hash */
 unsigned char* compute_sha256(const uint8_t* data, size_t len) {
-    unsigned char* hash = malloc(SHA256_DIGEST_LENGTH);
+    unsigned char* hash = malloc(CID_SIZE);
     if (!hash) return NULL;
 
-    SHA256(data, len, hash);
+    cid_hash_into(CID_HASH_SHA256, data, len, hash);
 
     if (debug_enabled(DEBUG_CID)) {
         char* hex = cid_to_hex(hash);
@@ -127,30 +622,33 @@ char* cid_to_hex(const unsigned char* cid) {
 }
 
 /* Store type signature in database (returns binary sig_cid, caller must free) */
-unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const char* output_sig) {
+static unsigned char* store_type_sig_locked(march_db_t* db, const char* input_sig, const char* output_sig) {
     if (!db || !output_sig) return NULL;
 
     /* Default empty input_sig if NULL */
     if (!input_sig) input_sig = "";
 
-    /* Compute sig_cid = SHA256("input_sig|output_sig") */
+    /* Compute sig_cid = H("input_sig|output_sig") with the database hash */
     size_t sig_str_len = strlen(input_sig) + 1 + strlen(output_sig);
     char* sig_str = malloc(sig_str_len + 1);
     if (!sig_str) return NULL;
 
     sprintf(sig_str, "%s|%s", input_sig, output_sig);
-    unsigned char* sig_cid = compute_sha256((uint8_t*)sig_str, sig_str_len);
+    unsigned char* sig_cid = malloc(CID_SIZE);
+    if (!sig_cid) {
+        free(sig_str);
+        return NULL;
+    }
+    db_compute_cid(db, (uint8_t*)sig_str, sig_str_len, sig_cid);
     free(sig_str);
 
-    if (!sig_cid) return NULL;
-
     /* Insert into type_signatures (ignore if exists) */
     const char* sql =
         "INSERT OR IGNORE INTO type_signatures (sig_cid, input_sig, output_sig) "
         "VALUES (?, ?, ?);";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare type_sig insert: %s\n", sqlite3_errmsg(db->db));
         free(sig_cid);
@@ -162,7 +660,7 @@ unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const ch
     sqlite3_bind_text(stmt, 3, output_sig, -1, SQLITE_STATIC);
 
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert type_sig: %s\n", sqlite3_errmsg(db->db));
@@ -173,14 +671,34 @@ unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const ch
     return sig_cid;  /* Caller must free */
 }
 
+unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const char* output_sig) {
+    db_lock(db);
+    unsigned char* result = store_type_sig_locked(db, input_sig, output_sig);
+    db_unlock(db);
+    return result;
+}
+
 /* Store blob directly in database (returns binary cid, caller must free) */
 unsigned char* db_store_blob(march_db_t* db, int kind, const unsigned char* sig_cid,
                               const uint8_t* data, size_t data_len) {
-    if (!db || !data) return NULL;
+    unsigned char* cid = malloc(CID_SIZE);
+    if (!cid) return NULL;
+
+    if (!db_store_blob_into(db, kind, sig_cid, data, data_len, cid)) {
+        free(cid);
+        return NULL;
+    }
+
+    return cid;  /* Caller must free */
+}
+
+/* Store blob directly in database, CID written to out_cid */
+static bool store_blob_into_locked(march_db_t* db, int kind, const unsigned char* sig_cid,
+                                   const uint8_t* data, size_t data_len, unsigned char* out_cid) {
+    if (!db || !data || !out_cid) return false;
 
     /* Compute CID */
-    unsigned char* cid = compute_sha256(data, data_len);
-    if (!cid) return NULL;
+    db_compute_cid(db, data, data_len, out_cid);
 
     /* Insert blob (ignore if exists) */
     const char* sql =
@@ -188,14 +706,13 @@ unsigned char* db_store_blob(march_db_t* db, int kind, const unsigned char* sig_
         "VALUES (?, ?, ?, 0, ?, ?);";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare blob insert: %s\n", sqlite3_errmsg(db->db));
-        free(cid);
-        return NULL;
+        return false;
     }
 
-    sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 1, out_cid, CID_SIZE, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 2, kind);
     if (sig_cid) {
         sqlite3_bind_blob(stmt, 3, sig_cid, CID_SIZE, SQLITE_STATIC);
@@ -206,17 +723,24 @@ unsigned char* db_store_blob(march_db_t* db, int kind, const unsigned char* sig_
     sqlite3_bind_blob(stmt, 5, data, data_len, SQLITE_STATIC);
 
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert blob: %s\n", sqlite3_errmsg(db->db));
-        free(cid);
-        return NULL;
+        return false;
     }
 
     DEBUG_DB("Stored blob: kind=%d len=%zu", kind, data_len);
 
-    return cid;  /* Caller must free */
+    return true;
+}
+
+bool db_store_blob_into(march_db_t* db, int kind, const unsigned char* sig_cid,
+                        const uint8_t* data, size_t data_len, unsigned char* out_cid) {
+    db_lock(db);
+    bool result = store_blob_into_locked(db, kind, sig_cid, data, data_len, out_cid);
+    db_unlock(db);
+    return result;
 }
 
 /* Store compiled word in database */
@@ -225,8 +749,9 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
                    const char* source_text) {
     /* Compute CID */
     size_t byte_count = cell_count * sizeof(uint64_t);
-    unsigned char* cid = compute_sha256(cells, byte_count);
+    unsigned char* cid = malloc(CID_SIZE);
     if (!cid) return false;
+    db_compute_cid(db, cells, byte_count, cid);
 
     /* Parse type signature into input/output parts */
     unsigned char* sig_cid = NULL;
@@ -283,7 +808,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
         "VALUES (?, ?, ?, 0, ?, ?);";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, blob_sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, blob_sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare blob insert: %s\n", sqlite3_errmsg(db->db));
         sqlite3_exec(db->db, "ROLLBACK;", NULL, NULL, NULL);
@@ -304,7 +829,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
     sqlite3_bind_blob(stmt, 5, cells, byte_count, SQLITE_STATIC);
 
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert blob: %s\n", sqlite3_errmsg(db->db));
@@ -320,7 +845,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
         "INSERT OR REPLACE INTO words (name, namespace, def_cid, type_sig, is_primitive) "
         "VALUES (?, ?, ?, ?, 0);";
 
-    rc = sqlite3_prepare_v2(db->db, word_sql, -1, &stmt, NULL);
+    rc = db_prepare(db, word_sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare word insert: %s\n", sqlite3_errmsg(db->db));
         sqlite3_exec(db->db, "ROLLBACK;", NULL, NULL, NULL);
@@ -336,7 +861,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
     sqlite3_bind_text(stmt, 4, type_sig, -1, SQLITE_STATIC);
 
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert word: %s\n", sqlite3_errmsg(db->db));
@@ -354,7 +879,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
             "(cid, bytecode_version, sig_cid, source_text, source_hash) "
             "VALUES (?, 1, ?, ?, ?);";
 
-        rc = sqlite3_prepare_v2(db->db, defs_sql, -1, &stmt, NULL);
+        rc = db_prepare(db, defs_sql, &stmt);
         if (rc != SQLITE_OK) {
             fprintf(stderr, "Failed to prepare defs insert: %s\n", sqlite3_errmsg(db->db));
             sqlite3_exec(db->db, "ROLLBACK;", NULL, NULL, NULL);
@@ -374,7 +899,7 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
         sqlite3_bind_blob(stmt, 4, source_hash, CID_SIZE, SQLITE_STATIC);
 
         rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
 
         if (rc != SQLITE_DONE) {
             fprintf(stderr, "Failed to insert defs: %s\n", sqlite3_errmsg(db->db));
@@ -404,7 +929,7 @@ uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
         "WHERE w.name = ? AND w.namespace = ?;";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare load query: %s\n", sqlite3_errmsg(db->db));
         return NULL;
@@ -416,7 +941,7 @@ uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
     rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
         fprintf(stderr, "Word not found: %s:%s\n", namespace ? namespace : "user", name);
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
         return NULL;
     }
 
@@ -426,7 +951,7 @@ uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
 
     if (len % sizeof(uint64_t) != 0) {
         fprintf(stderr, "Invalid blob size: %d\n", len);
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
         return NULL;
     }
 
@@ -435,12 +960,12 @@ uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
     /* Allocate and copy */
     uint64_t* cells = malloc(len);
     if (!cells) {
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
         return NULL;
     }
 
     memcpy(cells, blob, len);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     return cells;
 }
@@ -450,7 +975,7 @@ uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
 /* ============================================================================ */
 
 /* Store literal data, return CID (caller must free) */
-unsigned char* db_store_literal(march_db_t* db, int64_t value, const char* type_sig) {
+static unsigned char* store_literal_locked(march_db_t* db, int64_t value, const char* type_sig) {
     if (!db) return NULL;
 
     /* Serialize value as little-endian int64 */
@@ -472,6 +997,13 @@ unsigned char* db_store_literal(march_db_t* db, int64_t value, const char* type_
     return cid;
 }
 
+unsigned char* db_store_literal(march_db_t* db, int64_t value, const char* type_sig) {
+    db_lock(db);
+    unsigned char* result = store_literal_locked(db, value, type_sig);
+    db_unlock(db);
+    return result;
+}
+
 /* Load any blob by CID */
 bool db_load_blob_ex(march_db_t* db, const unsigned char* cid,
                      int* kind, unsigned char** sig_cid,
@@ -482,7 +1014,7 @@ bool db_load_blob_ex(march_db_t* db, const unsigned char* cid,
         "SELECT kind, sig_cid, data, len FROM blobs WHERE cid = ?;";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, sql, &stmt);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare blob load: %s\n", sqlite3_errmsg(db->db));
         return false;
@@ -492,7 +1024,7 @@ bool db_load_blob_ex(march_db_t* db, const unsigned char* cid,
 
     rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
         return false;
     }
 
@@ -525,18 +1057,18 @@ bool db_load_blob_ex(march_db_t* db, const unsigned char* cid,
         }
     }
 
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
     return true;
 }
 
 /* Get just the blob kind (fast lookup) */
-int db_get_blob_kind(march_db_t* db, const unsigned char* cid) {
+static int get_blob_kind_locked(march_db_t* db, const unsigned char* cid) {
     if (!db || !cid) return -1;
 
     const char* sql = "SELECT kind FROM blobs WHERE cid = ?;";
 
     sqlite3_stmt* stmt = NULL;
-    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    int rc = db_prepare(db, sql, &stmt);
     if (rc != SQLITE_OK) {
         return -1;
     }
@@ -545,12 +1077,574 @@ int db_get_blob_kind(march_db_t* db, const unsigned char* cid) {
 
     rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
+        db_release(db, stmt);
         return -1;
     }
 
     int kind = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    db_release(db, stmt);
 
     return kind;
 }
+
+int db_get_blob_kind(march_db_t* db, const unsigned char* cid) {
+    db_lock(db);
+    int result = get_blob_kind_locked(db, cid);
+    db_unlock(db);
+    return result;
+}
+
+/* ============================================================================ */
+/* Dependency edges and word bindings (GC roots) */
+/* ============================================================================ */
+
+/* Edge type for a reference of the given kind (see schema.sql edges) */
+static const char* edge_type_for_kind(uint16_t kind) {
+    switch (kind) {
+        case BLOB_WORD:      return "call";
+        case BLOB_QUOTATION: return "literal";
+        default:             return "data";
+    }
+}
+
+/* Record CID references of a code blob */
+static bool store_edges_locked(march_db_t* db, const unsigned char* from_cid,
+                               const uint8_t* data, size_t data_len) {
+    if (!db || !from_cid || !data) return false;
+
+    /* Only reference existing blobs: edges.to_cid is a foreign key */
+    const char* sql =
+        "INSERT OR IGNORE INTO edges (from_cid, to_cid, edge_type) "
+        "SELECT ?1, ?2, ?3 WHERE EXISTS (SELECT 1 FROM blobs WHERE cid = ?2);";
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db, sql, &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare edge insert: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_blob(stmt, 1, from_cid, CID_SIZE, SQLITE_STATIC);
+
+    /* Walk the CID sequence (bounds-checked: data may be malformed) */
+    const uint8_t* ptr = data;
+    const uint8_t* end = data + data_len;
+    size_t edge_count = 0;
+    bool ok = true;
+
+    while (ptr + 2 <= end) {
+        uint16_t tag = ptr[0] | (ptr[1] << 8);
+        ptr += 2;
+
+        if (!(tag & 1)) {
+            /* Primitive; inline literal carries 8 bytes */
+            if ((tag >> 1) == PRIM_LIT) ptr += 8;
+            continue;
+        }
+
+        if (ptr + CID_SIZE > end) break;
+
+        sqlite3_bind_blob(stmt, 2, ptr, CID_SIZE, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, edge_type_for_kind(tag >> 1), -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+
+        if (rc != SQLITE_DONE) {
+            fprintf(stderr, "Failed to insert edge: %s\n", sqlite3_errmsg(db->db));
+            ok = false;
+            break;
+        }
+        edge_count++;
+        ptr += CID_SIZE;
+    }
+
+    db_release(db, stmt);
+
+    DEBUG_DB("Stored %zu edges", edge_count);
+    return ok;
+}
+
+bool db_store_edges(march_db_t* db, const unsigned char* from_cid,
+                    const uint8_t* data, size_t data_len) {
+    db_lock(db);
+    bool result = store_edges_locked(db, from_cid, data, data_len);
+    db_unlock(db);
+    return result;
+}
+
+bool db_store_edge(march_db_t* db, const unsigned char* from_cid,
+                   const unsigned char* to_cid, const char* edge_type) {
+    if (!db || !from_cid || !to_cid || !edge_type) return false;
+
+    db_lock(db);
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "INSERT OR IGNORE INTO edges (from_cid, to_cid, edge_type) "
+        "SELECT ?1, ?2, ?3 WHERE EXISTS (SELECT 1 FROM blobs WHERE cid = ?2);", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare edge insert: %s\n", sqlite3_errmsg(db->db));
+        db_unlock(db);
+        return false;
+    }
+
+    sqlite3_bind_blob(stmt, 1, from_cid, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, to_cid, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, edge_type, -1, SQLITE_STATIC);
+    rc = sqlite3_step(stmt);
+    db_release(db, stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to insert edge: %s\n", sqlite3_errmsg(db->db));
+    }
+    db_unlock(db);
+    return rc == SQLITE_DONE;
+}
+
+/* Bind word name to definition CID (one row per name/namespace/type_sig) */
+static bool bind_word_locked(march_db_t* db, const char* name, const char* namespace,
+                             const unsigned char* def_cid, const char* type_sig) {
+    if (!db || !name || !def_cid) return false;
+    if (!namespace) namespace = "user";
+
+    /* Update in place first so the row id (module_exports) stays stable */
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "UPDATE words SET def_cid = ? "
+        "WHERE name = ? AND namespace = ? AND type_sig IS ? AND is_primitive = 0;", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare word update: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_blob(stmt, 1, def_cid, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, namespace, -1, SQLITE_STATIC);
+    if (type_sig) {
+        sqlite3_bind_text(stmt, 4, type_sig, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 4);
+    }
+
+    rc = sqlite3_step(stmt);
+    db_release(db, stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update word: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+    if (sqlite3_changes(db->db) > 0) return true;
+
+    rc = db_prepare(db,
+        "INSERT OR REPLACE INTO words (name, namespace, def_cid, type_sig, is_primitive) "
+        "VALUES (?, ?, ?, ?, 0);", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare word insert: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, namespace, -1, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 3, def_cid, CID_SIZE, SQLITE_STATIC);
+    if (type_sig) {
+        sqlite3_bind_text(stmt, 4, type_sig, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 4);
+    }
+
+    rc = sqlite3_step(stmt);
+    db_release(db, stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to insert word: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    DEBUG_DB("Bound word %s:%s", namespace, name);
+    return true;
+}
+
+bool db_bind_word(march_db_t* db, const char* name, const char* namespace,
+                  const unsigned char* def_cid, const char* type_sig) {
+    db_lock(db);
+    bool result = bind_word_locked(db, name, namespace, def_cid, type_sig);
+    db_unlock(db);
+    return result;
+}
+
+/* Look up a persisted specialization */
+static bool lookup_specialization_locked(march_db_t* db, const unsigned char* source_hash,
+                                         const uint8_t* input_types, size_t input_len,
+                                         unsigned char* out_cid) {
+    if (!db || !source_hash) return false;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "SELECT cid FROM specializations WHERE source_hash = ? AND input_types = ?;", &stmt);
+    if (rc != SQLITE_OK) {
+        DEBUG_DB("Specialization lookup unavailable: %s", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    static const uint8_t no_inputs[1] = {0};
+    sqlite3_bind_blob(stmt, 1, source_hash, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, input_len ? input_types : no_inputs, (int)input_len, SQLITE_STATIC);
+
+    bool found = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_bytes(stmt, 0) == CID_SIZE) {
+        memcpy(out_cid, sqlite3_column_blob(stmt, 0), CID_SIZE);
+        found = true;
+    }
+    db_release(db, stmt);
+    return found;
+}
+
+bool db_lookup_specialization(march_db_t* db, const unsigned char* source_hash,
+                              const uint8_t* input_types, size_t input_len,
+                              unsigned char* out_cid) {
+    db_lock(db);
+    bool result = lookup_specialization_locked(db, source_hash, input_types, input_len, out_cid);
+    db_unlock(db);
+    return result;
+}
+
+/* Persist a specialization (no-op on read-only databases) */
+static bool store_specialization_locked(march_db_t* db, const unsigned char* source_hash,
+                                        const uint8_t* input_types, size_t input_len,
+                                        const unsigned char* cid, const char* name,
+                                        const char* type_sig) {
+    if (!db || !source_hash || !cid || !name) return false;
+    if (db->readonly) return true;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "INSERT OR REPLACE INTO specializations "
+        "(source_hash, input_types, cid, name, type_sig) VALUES (?, ?, ?, ?, ?);", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare specialization insert: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    static const uint8_t no_inputs[1] = {0};
+    sqlite3_bind_blob(stmt, 1, source_hash, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, input_len ? input_types : no_inputs, (int)input_len, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 3, cid, CID_SIZE, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, name, -1, SQLITE_STATIC);
+    if (type_sig) {
+        sqlite3_bind_text(stmt, 5, type_sig, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 5);
+    }
+
+    rc = sqlite3_step(stmt);
+    db_release(db, stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to store specialization: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+    return true;
+}
+
+bool db_store_specialization(march_db_t* db, const unsigned char* source_hash,
+                             const uint8_t* input_types, size_t input_len,
+                             const unsigned char* cid, const char* name,
+                             const char* type_sig) {
+    db_lock(db);
+    bool result = store_specialization_locked(db, source_hash, input_types, input_len, cid, name, type_sig);
+    db_unlock(db);
+    return result;
+}
+
+/* Record source text and token hash of a compiled definition */
+static bool store_def_source_locked(march_db_t* db, const unsigned char* cid,
+                                    const char* source_text, const char* source_hash) {
+    if (!db || !cid || !source_hash) return false;
+    if (db->readonly) return true;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "INSERT INTO defs (cid, bytecode_version, sig_cid, source_text, source_hash) "
+        "SELECT cid, 1, sig_cid, ?2, ?3 FROM blobs WHERE cid = ?1 "
+        "ON CONFLICT (cid) DO UPDATE SET "
+        "source_text = excluded.source_text, source_hash = excluded.source_hash;", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare defs upsert: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+    if (source_text) {
+        sqlite3_bind_text(stmt, 2, source_text, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 2);
+    }
+    sqlite3_bind_text(stmt, 3, source_hash, -1, SQLITE_STATIC);
+
+    rc = sqlite3_step(stmt);
+    db_release(db, stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to store defs source: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+    return true;
+}
+
+bool db_store_def_source(march_db_t* db, const unsigned char* cid,
+                         const char* source_text, const char* source_hash) {
+    db_lock(db);
+    bool result = store_def_source_locked(db, cid, source_text, source_hash);
+    db_unlock(db);
+    return result;
+}
+
+bool db_store_def_effects(march_db_t* db, const unsigned char* cid, uint32_t effects,
+                          bool is_pure) {
+    if (!db || !cid) return false;
+    if (db->readonly) return true;
+
+    db_lock(db);
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "UPDATE defs SET effects = ?2, is_pure = ?3 WHERE cid = ?1;", &stmt);
+    if (rc == SQLITE_OK) {
+        sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, (sqlite3_int64)effects);
+        sqlite3_bind_int(stmt, 3, is_pure ? 1 : 0);
+        rc = sqlite3_step(stmt);
+        db_release(db, stmt);
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to store defs effects: %s\n", sqlite3_errmsg(db->db));
+    }
+    db_unlock(db);
+    return rc == SQLITE_DONE;
+}
+
+bool db_load_def_effects(march_db_t* db, const unsigned char* cid, uint32_t* effects) {
+    if (!db || !cid) return false;
+
+    db_lock(db);
+    sqlite3_stmt* stmt = NULL;
+    bool found = false;
+    if (db_prepare(db, "SELECT effects, is_pure FROM defs WHERE cid = ?;", &stmt) == SQLITE_OK) {
+        sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            /* Column defaults (0, 0) mean the effects were never inferred */
+            *effects = (uint32_t)sqlite3_column_int64(stmt, 0);
+            found = *effects != 0 || sqlite3_column_int(stmt, 1) != 0;
+        }
+        db_release(db, stmt);
+    }
+    db_unlock(db);
+    return found;
+}
+
+bool db_store_def_depth(march_db_t* db, const unsigned char* cid, int max_data_depth,
+                        int data_effect, int max_return_depth) {
+    if (!db || !cid) return false;
+    if (db->readonly) return true;
+
+    db_lock(db);
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "UPDATE defs SET max_data_depth = ?2, data_effect = ?3, max_return_depth = ?4 "
+        "WHERE cid = ?1;", &stmt);
+    if (rc == SQLITE_OK) {
+        sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, max_data_depth);
+        sqlite3_bind_int(stmt, 3, data_effect);
+        sqlite3_bind_int(stmt, 4, max_return_depth);
+        rc = sqlite3_step(stmt);
+        db_release(db, stmt);
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to store defs stack depth: %s\n", sqlite3_errmsg(db->db));
+    }
+    db_unlock(db);
+    return rc == SQLITE_DONE;
+}
+
+bool db_load_def_depth(march_db_t* db, const unsigned char* cid, int* max_data_depth,
+                       int* data_effect, int* max_return_depth) {
+    if (!db || !cid) return false;
+
+    db_lock(db);
+    sqlite3_stmt* stmt = NULL;
+    bool found = false;
+    if (db_prepare(db,
+            "SELECT max_data_depth, data_effect, max_return_depth FROM defs "
+            "WHERE cid = ? AND max_data_depth IS NOT NULL;", &stmt) == SQLITE_OK) {
+        sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            *max_data_depth = sqlite3_column_int(stmt, 0);
+            *data_effect = sqlite3_column_int(stmt, 1);
+            *max_return_depth = sqlite3_column_int(stmt, 2);
+            found = true;
+        }
+        db_release(db, stmt);
+    }
+    db_unlock(db);
+    return found;
+}
+
+/* Drop persisted specializations depending on a changed definition */
+static int invalidate_dependents_locked(march_db_t* db, const char* name,
+                                        const char* const* source_hashes, int hash_count) {
+    if (!db || !name || !source_hashes || hash_count < 1) return -1;
+    if (db->readonly) return 0;
+
+    /* Bindings of name that no current definition accounts for */
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "SELECT d.cid, d.source_hash FROM words w JOIN defs d ON d.cid = w.def_cid "
+        "WHERE w.name = ?1 AND w.namespace = 'user' AND w.is_primitive = 0;", &stmt);
+    if (rc != SQLITE_OK) {
+        DEBUG_DB("Dependent invalidation unavailable: %s", sqlite3_errmsg(db->db));
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+
+    unsigned char (*stale)[CID_SIZE] = NULL;
+    int stale_count = 0;
+    bool unchanged = false;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* hash = (const char*)sqlite3_column_text(stmt, 1);
+        if (sqlite3_column_bytes(stmt, 0) != CID_SIZE) continue;
+        if (hash && strcmp(hash, source_hashes[0]) == 0) {
+            unchanged = true;
+            break;
+        }
+        bool current = false;
+        for (int i = 1; hash && i < hash_count && !current; i++) {
+            current = strcmp(hash, source_hashes[i]) == 0;
+        }
+        if (current) continue;
+        unsigned char (*grown)[CID_SIZE] = realloc(stale, (size_t)(stale_count + 1) * CID_SIZE);
+        if (!grown) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        stale = grown;
+        memcpy(stale[stale_count++], sqlite3_column_blob(stmt, 0), CID_SIZE);
+    }
+    db_release(db, stmt);
+
+    if (unchanged || rc == SQLITE_NOMEM || stale_count == 0) {
+        free(stale);
+        if (rc == SQLITE_NOMEM) {
+            fprintf(stderr, "Failed to invalidate dependents of '%s': out of memory\n", name);
+            return -1;
+        }
+        return 0;
+    }
+
+    rc = db_prepare(db,
+        "WITH RECURSIVE dependents(cid) AS ("
+        "  SELECT from_cid FROM edges WHERE to_cid = ?1"
+        "  UNION"
+        "  SELECT e.from_cid FROM edges e JOIN dependents d ON e.to_cid = d.cid"
+        ") "
+        "DELETE FROM specializations WHERE cid IN (SELECT cid FROM dependents);", &stmt);
+    if (rc != SQLITE_OK) {
+        free(stale);
+        DEBUG_DB("Dependent invalidation unavailable: %s", sqlite3_errmsg(db->db));
+        return -1;
+    }
+
+    int dropped = 0;
+    for (int i = 0; i < stale_count; i++) {
+        sqlite3_bind_blob(stmt, 1, stale[i], CID_SIZE, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE) break;
+        dropped += sqlite3_changes(db->db);
+        sqlite3_reset(stmt);
+    }
+    db_release(db, stmt);
+    free(stale);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to invalidate dependents of '%s': %s\n",
+                name, sqlite3_errmsg(db->db));
+        return -1;
+    }
+    return dropped;
+}
+
+int db_invalidate_dependents(march_db_t* db, const char* name,
+                             const char* const* source_hashes, int hash_count) {
+    if (!db) return -1;
+    db_lock(db);
+    int result = invalidate_dependents_locked(db, name, source_hashes, hash_count);
+    db_unlock(db);
+    return result;
+}
+
+/* Re-bind persisted specializations reachable from cid */
+static bool rebind_specializations_locked(march_db_t* db, const unsigned char* cid) {
+    if (!db || !cid) return false;
+    if (db->readonly) return true;
+
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "WITH RECURSIVE reach(cid) AS ("
+        "  SELECT ?1"
+        "  UNION"
+        "  SELECT e.to_cid FROM edges e JOIN reach r ON e.from_cid = r.cid"
+        ") "
+        "SELECT s.name, s.type_sig, s.cid FROM specializations s "
+        "JOIN reach r ON s.cid = r.cid;", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare specialization rebind: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_blob(stmt, 1, cid, CID_SIZE, SQLITE_STATIC);
+
+    bool ok = true;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* name = (const char*)sqlite3_column_text(stmt, 0);
+        const char* type_sig = (const char*)sqlite3_column_text(stmt, 1);
+        if (sqlite3_column_bytes(stmt, 2) != CID_SIZE) continue;
+        ok &= db_bind_word(db, name, NULL, sqlite3_column_blob(stmt, 2), type_sig);
+    }
+    db_release(db, stmt);
+    return ok && rc == SQLITE_DONE;
+}
+
+bool db_rebind_specializations(march_db_t* db, const unsigned char* cid) {
+    db_lock(db);
+    bool result = rebind_specializations_locked(db, cid);
+    db_unlock(db);
+    return result;
+}
+
+/* Visit the user word bindings, oldest first */
+static bool foreach_word_locked(march_db_t* db, db_word_fn fn, void* ctx) {
+    sqlite3_stmt* stmt = NULL;
+    int rc = db_prepare(db,
+        "SELECT name, namespace, def_cid, type_sig FROM words "
+        "WHERE is_primitive = 0 ORDER BY id;", &stmt);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare word listing: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    bool ok = true;
+    while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* name = (const char*)sqlite3_column_text(stmt, 0);
+        const char* namespace = (const char*)sqlite3_column_text(stmt, 1);
+        const char* type_sig = (const char*)sqlite3_column_text(stmt, 3);
+        if (!name || sqlite3_column_bytes(stmt, 2) != CID_SIZE) continue;
+        ok = fn(ctx, name, namespace ? namespace : "user", sqlite3_column_blob(stmt, 2), type_sig);
+    }
+    db_release(db, stmt);
+    return ok && rc == SQLITE_DONE;
+}
+
+bool db_foreach_word(march_db_t* db, db_word_fn fn, void* ctx) {
+    db_lock(db);
+    bool result = foreach_word_locked(db, fn, ctx);
+    db_unlock(db);
+    return result;
+}
@@ -9,20 +9,76 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <pthread.h>
+#include "cidhash.h"
+
+/* Open modes */
+typedef enum {
+    DB_OPEN_READWRITE = 0,      /* Create if missing, foreign keys on */
+    DB_OPEN_READONLY  = 1,      /* SQLITE_OPEN_READONLY + immutable=1 + large mmap:
+                                 * no locking, pages shared through the OS cache.
+                                 * The file must not change while open. */
+} db_open_mode_t;
+
+/* Schema version of schema.sql (metadata 'schema_version') */
+#define MARCH_SCHEMA_VERSION 3
+
+/* mmap window for read-only databases */
+#define DB_READONLY_MMAP_SIZE (1LL << 30)
+
+/* Page cache of read-write handles, in KiB: a large program's index pages
+ * stay resident while every word is stored */
+#define DB_CACHE_SIZE_KB 65536
+
+/* Prepared statements kept per handle (compile-path queries; see db_prepare) */
+#define DB_STMT_CACHE_SIZE 64
+
+typedef struct {
+    char* sql;
+    sqlite3_stmt* stmt;
+    bool in_use;                /* Between db_prepare and db_release */
+} db_cached_stmt_t;
 
 /* Database handle */
 typedef struct {
     sqlite3* db;
     char* filename;
+    cid_hash_t cid_hash;        /* Hash used for every CID in this database */
+    bool readonly;              /* Opened with DB_OPEN_READONLY */
+    char* schema_hash;          /* metadata 'schema_hash' read at open (NULL if none) */
+    int schema_version;         /* metadata 'schema_version' read at open (0 if none) */
+    pthread_mutex_t lock;       /* Recursive; serializes the compiler-facing calls */
+    db_cached_stmt_t stmts[DB_STMT_CACHE_SIZE];
+    int stmt_count;
 } march_db_t;
 
+/* Schema migration step (upgrades one version) */
+typedef bool (*db_migration_fn)(march_db_t* db);
+
 /* Open/close database */
 march_db_t* db_open(const char* filename);
+march_db_t* db_open_ex(const char* filename, db_open_mode_t mode);
 void db_close(march_db_t* db);
 
-/* Initialize schema if needed */
+/* Hold the handle's lock across several calls (recursive). The storage
+ * and lookup calls made while compiling take it themselves, so parallel
+ * compile jobs can share one handle. */
+void db_lock(march_db_t* db);
+void db_unlock(march_db_t* db);
+
+/* Explicit transaction, e.g. around a batch of parallel compile jobs */
+bool db_begin(march_db_t* db);
+bool db_commit(march_db_t* db);
+
+/* Initialize schema if needed (no-op for read-only databases).
+ * schema_file NULL uses the schema compiled into the binary. When the
+ * schema hash recorded in metadata matches, no DDL or file I/O happens;
+ * an older schema_version is upgraded with db_migrate. */
 bool db_init_schema(march_db_t* db, const char* schema_file);
 
+/* Run migration steps from from_version up to MARCH_SCHEMA_VERSION */
+bool db_migrate(march_db_t* db, int from_version);
+
 /* Store type signature (returns binary sig_cid, caller must free) */
 unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const char* output_sig);
 
@@ -30,6 +86,21 @@ unsigned char* db_store_type_sig(march_db_t* db, const char* input_sig, const ch
 unsigned char* db_store_blob(march_db_t* db, int kind, const unsigned char* sig_cid,
                               const uint8_t* data, size_t data_len);
 
+/* Store blob, writing its CID into out_cid[CID_SIZE] (no allocation) */
+bool db_store_blob_into(march_db_t* db, int kind, const unsigned char* sig_cid,
+                        const uint8_t* data, size_t data_len, unsigned char* out_cid);
+
+/* Compute a CID with this database's hash into out[CID_SIZE] */
+void db_compute_cid(march_db_t* db, const uint8_t* data, size_t len, unsigned char* out);
+
+/* Metadata key/value access (db_get_metadata: caller must free) */
+char* db_get_metadata(march_db_t* db, const char* key);
+bool db_set_metadata(march_db_t* db, const char* key, const char* value);
+
+/* Select the CID hash for this database and record it in metadata.
+ * Fails if the database already holds blobs hashed with a different function. */
+bool db_set_cid_hash(march_db_t* db, cid_hash_t hash);
+
 /* Store compiled word */
 bool db_store_word(march_db_t* db, const char* name, const char* namespace,
                    const uint8_t* cells, size_t cell_count, const char* type_sig,
@@ -39,7 +110,8 @@ bool db_store_word(march_db_t* db, const char* name, const char* namespace,
 uint64_t* db_load_word(march_db_t* db, const char* name, const char* namespace,
                        size_t* cell_count);
 
-/* Compute SHA256 CID (returns 32-byte binary hash, caller must free) */
+/* Compute SHA256 CID (returns 32-byte binary hash, caller must free).
+ * Independent of the database's selected hash - prefer db_compute_cid. */
 unsigned char* compute_sha256(const uint8_t* data, size_t len);
 
 /* Convert binary CID to hex string for display (caller must free) */
@@ -67,4 +139,70 @@ bool db_load_blob_ex(march_db_t* db, const unsigned char* cid,
 /* Get just the blob kind (fast lookup) */
 int db_get_blob_kind(march_db_t* db, const unsigned char* cid);
 
+/* Record the CID references of a code blob (BLOB_WORD/BLOB_QUOTATION) in
+ * the edges table. References to CIDs not in blobs are skipped. */
+bool db_store_edges(march_db_t* db, const unsigned char* from_cid,
+                    const uint8_t* data, size_t data_len);
+
+/* Record one dependency the blob data does not show (e.g. an inlined
+ * callee, edge_type 'inline'); skipped if to_cid is not in blobs */
+bool db_store_edge(march_db_t* db, const unsigned char* from_cid,
+                   const unsigned char* to_cid, const char* edge_type);
+
+/* Bind name (+ type signature) to a compiled definition in the words table */
+bool db_bind_word(march_db_t* db, const char* name, const char* namespace,
+                  const unsigned char* def_cid, const char* type_sig);
+
+/* Persistent specialization cache: (source_hash, input type ids, one per
+ * byte) -> CID of the compiled word. Lookup writes out_cid[CID_SIZE]. */
+bool db_lookup_specialization(march_db_t* db, const unsigned char* source_hash,
+                              const uint8_t* input_types, size_t input_len,
+                              unsigned char* out_cid);
+bool db_store_specialization(march_db_t* db, const unsigned char* source_hash,
+                             const uint8_t* input_types, size_t input_len,
+                             const unsigned char* cid, const char* name,
+                             const char* type_sig);
+
+/* Record a compiled definition's source and token hash (hex) in defs */
+bool db_store_def_source(march_db_t* db, const unsigned char* cid,
+                         const char* source_text, const char* source_hash);
+
+/* Record a compiled definition's effect flags (effects.h) and whether
+ * they make it pure, in defs (the row is made by db_store_def_source) */
+bool db_store_def_effects(march_db_t* db, const unsigned char* cid, uint32_t effects,
+                          bool is_pure);
+
+/* Effect flags recorded for cid; false if none were (defs rows written
+ * before effects were inferred have the column defaults) */
+bool db_load_def_effects(march_db_t* db, const unsigned char* cid, uint32_t* effects);
+
+/* Stack depth of a definition (depth.h; -1 = unbounded) */
+bool db_store_def_depth(march_db_t* db, const unsigned char* cid, int max_data_depth,
+                        int data_effect, int max_return_depth);
+
+/* Stack depth recorded for cid; false if it was never analyzed */
+bool db_load_def_depth(march_db_t* db, const unsigned char* cid, int* max_data_depth,
+                       int* data_effect, int* max_return_depth);
+
+/* Incremental compilation: source_hashes are the hex token hashes of
+ * name's current definitions, the one just compiled first. If that one is
+ * already bound to name nothing changed; otherwise every binding of name
+ * whose defs.source_hash is none of them belongs to a replaced definition,
+ * and the persisted specializations that reach it through edges are
+ * dropped so they are recompiled. Returns the number dropped, -1 on error. */
+int db_invalidate_dependents(march_db_t* db, const char* name,
+                             const char* const* source_hashes, int hash_count);
+
+/* Re-bind the words of every persisted specialization reachable from cid
+ * (a cache hit from an earlier run skips compiling, and binding, its callees) */
+bool db_rebind_specializations(march_db_t* db, const unsigned char* cid);
+
+/* Word binding visitor: return false to stop */
+typedef bool (*db_word_fn)(void* ctx, const char* name, const char* namespace,
+                           const unsigned char* def_cid, const char* type_sig);
+
+/* Visit every user word binding (name, namespace, CID, type signature) in
+ * the order the bindings were made. False on error or if fn stopped. */
+bool db_foreach_word(march_db_t* db, db_word_fn fn, void* ctx);
+
 #endif /* MARCH_DATABASE_H */
@@ -13,6 +13,7 @@
 #include <ctype.h>
 #include <signal.h>
 #include <unistd.h>
+#include <pthread.h>
 
 /* Global debug flags */
 unsigned int debug_flags = 0;
@@ -116,27 +117,217 @@ void debug_dump_dict_stats(void* dict_ptr) {
     int word_count = 0;
     int immediate_count = 0;
 
-    for (size_t i = 0; i < dict->bucket_count; i++) {
-        dict_entry_t* entry = dict->buckets[i];
-        while (entry) {
-            total_entries++;
-            if (entry->is_primitive) primitive_count++;
-            else word_count++;
-            if (entry->is_immediate) immediate_count++;
-            entry = entry->next;
-        }
+    size_t builtin_count = dict->builtins ? dict->builtins->entry_count : 0;
+    for (size_t i = 0; i < builtin_count + dict->entry_count; i++) {
+        dict_entry_t* entry = i < builtin_count ? &dict->builtins->entries[i]
+                                                : dict->entries[i - builtin_count];
+        total_entries++;
+        if (entry->is_primitive) primitive_count++;
+        else word_count++;
+        if (entry->is_immediate) immediate_count++;
     }
 
     fprintf(stderr, "[DEBUG_DICT] Dictionary stats: %d total (%d primitives, %d words, %d immediate)\n",
             total_entries, primitive_count, word_count, immediate_count);
 }
 
+/* ============================================================================ */
+/* Trace Ring Buffers */
+/* ============================================================================ */
+
+#define TRACE_MAX_ARGS  6
+#define TRACE_TEXT_SIZE 48
+
+/* One trace: the format string (a literal) and its arguments as values */
+typedef struct {
+    const char* fmt;
+    uint64_t args[TRACE_MAX_ARGS];   /* %s: offset into text */
+    char text[TRACE_TEXT_SIZE];      /* %s arguments, NUL-separated */
+    debug_category_t category;
+    uint8_t level;
+    uint8_t argc;                    /* Arguments captured */
+} trace_record_t;
+
+typedef struct {
+    uint64_t count;                  /* Records ever written */
+    trace_record_t records[TRACE_RING_SIZE];
+} trace_ring_t;
+
+/* Allocated on a thread's first record, freed when it exits */
+static _Thread_local trace_ring_t* trace_ring;
+static pthread_key_t trace_ring_key;
+static pthread_once_t trace_ring_once = PTHREAD_ONCE_INIT;
+
+static void trace_ring_key_create(void) {
+    pthread_key_create(&trace_ring_key, free);
+}
+
+static const char* category_name(debug_category_t category) {
+    switch (category) {
+        case DEBUG_COMPILER: return "DEBUG_COMPILER";
+        case DEBUG_DICT: return "DEBUG_DICT";
+        case DEBUG_TYPES: return "DEBUG_TYPES";
+        case DEBUG_CID: return "DEBUG_CID";
+        case DEBUG_LOADER: return "DEBUG_LOADER";
+        case DEBUG_RUNTIME: return "DEBUG_RUNTIME";
+        case DEBUG_DB: return "DEBUG_DB";
+        default: return "DEBUG";
+    }
+}
+
+/* Skip flags, width and precision of the conversion starting at p[-1] */
+static const char* skip_spec(const char* p) {
+    while (*p && strchr("-+ #0123456789.", *p)) p++;
+    return p;
+}
+
+void trace_record(debug_category_t category, int level, const char* fmt, ...) {
+    if (!trace_ring) {
+        pthread_once(&trace_ring_once, trace_ring_key_create);
+        trace_ring = calloc(1, sizeof(trace_ring_t));
+        if (!trace_ring) return;
+        pthread_setspecific(trace_ring_key, trace_ring);
+    }
+
+    trace_record_t* rec = &trace_ring->records[trace_ring->count++ & (TRACE_RING_SIZE - 1)];
+    rec->fmt = fmt;
+    rec->category = category;
+    rec->level = (uint8_t)level;
+    rec->text[TRACE_TEXT_SIZE - 1] = '\0';
+
+    size_t text_used = 0;
+    int argc = 0;
+    va_list args;
+    va_start(args, fmt);
+    for (const char* p = fmt; *p && argc < TRACE_MAX_ARGS; p++) {
+        if (*p != '%') continue;
+        p = skip_spec(p + 1);
+        if (*p == '%') continue;
+
+        bool wide = false;  /* l, ll, z, j, t: 64 bits on x86-64 */
+        while (*p && strchr("hlzjt", *p)) {
+            if (*p != 'h') wide = true;
+            p++;
+        }
+
+        uint64_t value = 0;
+        switch (*p) {
+            case 's': {
+                const char* str = va_arg(args, const char*);
+                if (!str) str = "(null)";
+                size_t room = TRACE_TEXT_SIZE - 1 - text_used;
+                size_t len = strnlen(str, room > 0 ? room - 1 : 0);
+                memcpy(rec->text + text_used, str, len);
+                rec->text[text_used + len] = '\0';
+                value = text_used;
+                text_used += len + (room > 0 ? 1 : 0);
+                break;
+            }
+            case 'p':
+                value = (uint64_t)(uintptr_t)va_arg(args, void*);
+                break;
+            case 'f': case 'e': case 'g': {
+                double d = va_arg(args, double);
+                memcpy(&value, &d, sizeof(value));
+                break;
+            }
+            case 'd': case 'i': case 'c':
+                value = wide ? va_arg(args, uint64_t) : (uint64_t)(int64_t)va_arg(args, int);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                value = wide ? va_arg(args, uint64_t) : va_arg(args, unsigned int);
+                break;
+            default:
+                /* Unsupported conversion: the dump stops here */
+                va_end(args);
+                rec->argc = (uint8_t)argc;
+                return;
+        }
+        rec->args[argc++] = value;
+    }
+    va_end(args);
+    rec->argc = (uint8_t)(argc < TRACE_MAX_ARGS ? argc : TRACE_MAX_ARGS);
+}
+
+/* Format a record as printf would have at the time it was written */
+static void trace_print_record(FILE* out, const trace_record_t* rec) {
+    int argc = 0;
+    for (const char* p = rec->fmt; *p; p++) {
+        if (*p != '%') {
+            fputc(*p, out);
+            continue;
+        }
+
+        const char* start = p;
+        p = skip_spec(p + 1);
+        if (*p == '%') {
+            fputc('%', out);
+            continue;
+        }
+        char spec[32];
+        size_t flags = (size_t)(p - start);
+        while (*p && strchr("hlzjt", *p)) p++;
+        if (!*p || argc >= rec->argc || flags > sizeof(spec) - 4) {
+            fputs(start, out);
+            return;
+        }
+        memcpy(spec, start, flags);
+
+        uint64_t value = rec->args[argc++];
+        switch (*p) {
+            case 's':
+                snprintf(spec + flags, 3, "s");
+                fprintf(out, spec, rec->text + (value < TRACE_TEXT_SIZE ? value : TRACE_TEXT_SIZE - 1));
+                break;
+            case 'p':
+                snprintf(spec + flags, 3, "p");
+                fprintf(out, spec, (void*)(uintptr_t)value);
+                break;
+            case 'f': case 'e': case 'g': {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                snprintf(spec + flags, 3, "%c", *p);
+                fprintf(out, spec, d);
+                break;
+            }
+            case 'c':
+                snprintf(spec + flags, 3, "c");
+                fprintf(out, spec, (int)value);
+                break;
+            case 'd': case 'i':
+                snprintf(spec + flags, 4, "ll%c", *p);
+                fprintf(out, spec, (long long)value);
+                break;
+            default:
+                snprintf(spec + flags, 4, "ll%c", *p);
+                fprintf(out, spec, (unsigned long long)value);
+                break;
+        }
+    }
+}
+
+void trace_ring_dump(FILE* out) {
+    if (!trace_ring || trace_ring->count == 0) return;
+
+    uint64_t count = trace_ring->count;
+    uint64_t shown = count < TRACE_RING_SIZE ? count : TRACE_RING_SIZE;
+    fprintf(out, "=== TRACE (last %llu of %llu records, this thread) ===\n",
+            (unsigned long long)shown, (unsigned long long)count);
+    for (uint64_t i = count - shown; i < count; i++) {
+        const trace_record_t* rec = &trace_ring->records[i & (TRACE_RING_SIZE - 1)];
+        fprintf(out, "[%s:%u] ", category_name(rec->category), rec->level);
+        trace_print_record(out, rec);
+        fputc('\n', out);
+    }
+    fflush(out);
+}
+
 /* ============================================================================ */
 /* Crash Handler */
 /* ============================================================================ */
 
-/* Global crash context */
-crash_context_t crash_context = {
+/* Crash context (per thread: the handler runs on the faulting thread) */
+_Thread_local crash_context_t crash_context = {
     .phase = "init",
     .current_file = NULL,
     .current_word = "",
@@ -179,6 +370,9 @@ static void crash_handler(int sig) {
     fprintf(stderr, "============================================\n");
     fflush(stderr);
 
+    /* What this thread recorded last (trace builds only) */
+    trace_ring_dump(stderr);
+
     /* Dump runtime trace if enabled */
     if (trace_enabled && trace_stack_depth > 0) {
         trace_dump();
@@ -235,12 +429,18 @@ trace_entry_t trace_stack[MAX_TRACE_DEPTH];
 int trace_stack_depth = 0;
 bool trace_enabled = false;
 
+/* Compiled-in traces of the main thread, for runs that don't crash */
+static void trace_ring_dump_at_exit(void) {
+    trace_ring_dump(stderr);
+}
+
 /* Initialize trace system */
 void trace_init(void) {
     const char* env = getenv("MARCH_TRACE");
     if (env && (strcmp(env, "1") == 0 || strcmp(env, "true") == 0)) {
         trace_enabled = true;
         fprintf(stderr, "[TRACE] Runtime trace enabled\n");
+        atexit(trace_ring_dump_at_exit);
     }
 }
 
@@ -49,6 +49,58 @@ bool debug_enabled(debug_category_t category);
 #define DEBUG_RUNTIME(fmt, ...)  DEBUG(DEBUG_RUNTIME, fmt, ##__VA_ARGS__)
 #define DEBUG_DB(fmt, ...)       DEBUG(DEBUG_DB, fmt, ##__VA_ARGS__)
 
+/* ============================================================================ */
+/* Compile-Time Gated Trace - Binary per-thread ring buffers */
+/* ============================================================================ */
+
+/* Trace levels. Build with -DMARCH_TRACE_LEVEL=n (make MARCH_TRACE_LEVEL=n)
+ * to compile in the traces up to level n; at the default 0 every TRACE_*
+ * compiles to nothing, arguments included. A compiled-in trace is kept
+ * only while its DEBUG_* category is enabled (MARCH_DEBUG). */
+#define TRACE_LEVEL_PHASE  1   /* Process and file phases */
+#define TRACE_LEVEL_WORD   2   /* Per definition and specialization */
+#define TRACE_LEVEL_TOKEN  3   /* Per token */
+
+#ifndef MARCH_TRACE_LEVEL
+#define MARCH_TRACE_LEVEL 0
+#endif
+
+/* Records per thread; older records are overwritten */
+#define TRACE_RING_SIZE 512
+
+/* Append to the calling thread's ring. Arguments are captured as values
+ * (%s text copied, truncated) and only formatted by trace_ring_dump. */
+void trace_record(debug_category_t category, int level, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/* Print the calling thread's ring, oldest record first */
+void trace_ring_dump(FILE* out);
+
+#define TRACE_AT(level, category, fmt, ...) \
+    do { \
+        if (debug_enabled(category)) { \
+            trace_record(category, level, fmt, ##__VA_ARGS__); \
+        } \
+    } while(0)
+
+#if MARCH_TRACE_LEVEL >= TRACE_LEVEL_PHASE
+#define TRACE_PHASE(category, fmt, ...) TRACE_AT(TRACE_LEVEL_PHASE, category, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_PHASE(category, fmt, ...) ((void)0)
+#endif
+
+#if MARCH_TRACE_LEVEL >= TRACE_LEVEL_WORD
+#define TRACE_WORD(category, fmt, ...) TRACE_AT(TRACE_LEVEL_WORD, category, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_WORD(category, fmt, ...) ((void)0)
+#endif
+
+#if MARCH_TRACE_LEVEL >= TRACE_LEVEL_TOKEN
+#define TRACE_TOKEN(category, fmt, ...) TRACE_AT(TRACE_LEVEL_TOKEN, category, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_TOKEN(category, fmt, ...) ((void)0)
+#endif
+
 /* Helper to dump type stack */
 void debug_dump_type_stack(const char* label, void* type_stack, int depth);
 
@@ -70,7 +122,7 @@ typedef struct {
     int buffer_stack_depth;
 } crash_context_t;
 
-extern crash_context_t crash_context;
+extern _Thread_local crash_context_t crash_context;
 
 /* Install signal handler for SIGSEGV */
 void crash_handler_install(void);
@@ -0,0 +1,177 @@
+/*
+ * March Language - Stack Depth Analysis Implementation
+ */
+
+#include "depth.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Signatures by primitive ID */
+static const char* const prim_sigs[] = {
+#define PRIMITIVE(id, value, name, op, sig) [value] = sig,
+#include "primitives.def"
+};
+
+#define PRIM_SIG_COUNT (sizeof(prim_sigs) / sizeof(prim_sigs[0]))
+
+bool stack_depth_of_prim(uint16_t prim_id, int* inputs, int* outputs) {
+    if (prim_id >= PRIM_SIG_COUNT || !prim_sigs[prim_id]) return false;
+
+    /* Count the type names on each side of "->" */
+    int side[2] = {0, 0};
+    int s = 0;
+    const char* p = prim_sigs[prim_id];
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        const char* start = p;
+        while (*p && *p != ' ') p++;
+        if (p - start == 2 && start[0] == '-' && start[1] == '>') {
+            s = 1;
+        } else {
+            side[s]++;
+        }
+    }
+    *inputs = side[0];
+    *outputs = side[1];
+    return true;
+}
+
+/* Return stack change of a primitive */
+static int return_effect(uint16_t prim_id) {
+    switch (prim_id) {
+        case PRIM_TOR: return 1;
+        case PRIM_TWOTOR: return 2;
+        case PRIM_FROMR: case PRIM_RDROP: return -1;
+        case PRIM_TWOFROMR: return -2;
+        case PRIM_MEMO_ENTER: return 1;     /* Entry handle for memo-exit */
+        case PRIM_MEMO_EXIT: return -1;
+        default: return 0;
+    }
+}
+
+void stack_depth_of_ir(const ir_buffer_t* ir, march_db_t* db, stack_depth_t* out) {
+    out->data_max = 0;
+    out->data_effect = 0;
+    out->return_max = 0;
+
+    /* Depth at each label, as the first branch to it (or fallthrough) left it */
+    int labels = ir->label_count > 0 ? ir->label_count : 1;
+    int* label_data = malloc(sizeof(int) * (size_t)labels);
+    int* label_return = malloc(sizeof(int) * (size_t)labels);
+    if (!label_data || !label_return) {
+        free(label_data);
+        free(label_return);
+        out->data_max = STACK_DEPTH_UNBOUNDED;
+        out->return_max = STACK_DEPTH_UNBOUNDED;
+        return;
+    }
+    for (int l = 0; l < labels; l++) label_data[l] = INT_MIN;
+
+    bool bounded = true;
+    bool live = true;              /* Reached by falling through */
+    bool tail = false;             /* Previous instruction was tailcall */
+    int d = 0, r = 0;
+
+    for (size_t i = 0; i < ir->count && bounded; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        int label = (int)in->value;
+        bool known_label = (in->op == IR_LABEL || in->op == IR_BRANCH) &&
+                           label >= 0 && label < ir->label_count;
+
+        if (in->op == IR_LABEL) {
+            if (!known_label) continue;
+            if (live && label_data[label] == INT_MIN) {
+                label_data[label] = d;
+                label_return[label] = r;
+            } else if (!live && label_data[label] != INT_MIN) {
+                d = label_data[label];
+                r = label_return[label];
+                live = true;
+            }
+            continue;
+        }
+        if (!live) continue;
+
+        switch (in->op) {
+            case IR_LIT:
+                d++;
+                break;
+
+            case IR_REF: {
+                if (in->ref_kind != BLOB_WORD) {
+                    d++;            /* Data and quotations push a value */
+                    break;
+                }
+                int callee_data, callee_effect, callee_return;
+                if (!db_load_def_depth(db, in->cid, &callee_data, &callee_effect,
+                                       &callee_return) ||
+                    callee_data == STACK_DEPTH_UNBOUNDED ||
+                    callee_return == STACK_DEPTH_UNBOUNDED) {
+                    bounded = false;
+                    break;
+                }
+                /* A call pushes its return address; a tail call reuses ours */
+                int call_return = r + (tail ? 0 : 1) + callee_return;
+                if (d + callee_data > out->data_max) out->data_max = d + callee_data;
+                if (call_return > out->return_max) out->return_max = call_return;
+                d += callee_effect;
+                if (tail) {
+                    out->data_effect = d;
+                    live = false;   /* Never returns here */
+                }
+                break;
+            }
+
+            case IR_RECURSE:
+                bounded = false;
+                break;
+
+            case IR_BRANCH:
+                if (in->prim_id == PRIM_0BRANCH) d--;
+                if (known_label && label_data[label] == INT_MIN) {
+                    label_data[label] = d;
+                    label_return[label] = r;
+                }
+                if (in->prim_id == PRIM_BRANCH) live = false;
+                break;
+
+            case IR_PRIM: {
+                if (in->prim_id == PRIM_EXECUTE) {
+                    bounded = false;    /* Whatever quotation is on the stack */
+                    break;
+                }
+                if (in->prim_id == PRIM_MEMO_ENTER && i + 1 < ir->count &&
+                    ir->instrs[i + 1].op == IR_LIT) {
+                    i++;                /* Its arity cell is read, not pushed */
+                }
+                int inputs, outputs;
+                if (!stack_depth_of_prim(in->prim_id, &inputs, &outputs)) {
+                    bounded = false;
+                    break;
+                }
+                d += outputs - inputs;
+                r += return_effect(in->prim_id);
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        tail = in->op == IR_PRIM && in->prim_id == PRIM_TAILCALL;
+        if (d > out->data_max) out->data_max = d;
+        if (r > out->return_max) out->return_max = r;
+    }
+
+    if (!bounded) {
+        out->data_max = STACK_DEPTH_UNBOUNDED;
+        out->return_max = STACK_DEPTH_UNBOUNDED;
+    } else if (live) {
+        out->data_effect = d;
+    }
+
+    free(label_data);
+    free(label_return);
+}
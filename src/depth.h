@@ -0,0 +1,37 @@
+/*
+ * March Language - Stack Depth Analysis
+ * Deepest data and return stack of compiled words, callees included
+ * (defs.max_data_depth, defs.data_effect, defs.max_return_depth)
+ */
+
+#ifndef MARCH_DEPTH_H
+#define MARCH_DEPTH_H
+
+#include "ir.h"
+#include "database.h"
+#include <stdbool.h>
+
+/* No bound: recursion, execute of a run-time quotation, or a callee whose
+ * depth was never recorded */
+#define STACK_DEPTH_UNBOUNDED (-1)
+
+typedef struct {
+    int data_max;       /* Cells pushed above the entry depth at the deepest point */
+    int data_effect;    /* Net change of the data stack (outputs - inputs) */
+    int return_max;     /* Return stack cells, nested calls' return addresses included */
+} stack_depth_t;
+
+static inline bool stack_depth_bounded(const stack_depth_t* depth) {
+    return depth->data_max != STACK_DEPTH_UNBOUNDED &&
+           depth->return_max != STACK_DEPTH_UNBOUNDED;
+}
+
+/* Data stack inputs and outputs of a primitive (from primitives.def);
+ * false for IDs that are not primitives */
+bool stack_depth_of_prim(uint16_t prim_id, int* inputs, int* outputs);
+
+/* Depth of compiled code: walks each path once (branch targets take the
+ * depth of the branch), adding the recorded depth of every word called */
+void stack_depth_of_ir(const ir_buffer_t* ir, march_db_t* db, stack_depth_t* out);
+
+#endif /* MARCH_DEPTH_H */
@@ -11,10 +11,19 @@
 #include <string.h>
 #include <stdio.h>
 
-#define INITIAL_BUCKETS 256
+#define INITIAL_GROUPS 256
+#define ARENA_CHUNK_SIZE 65536
+
+/* Arena chunk: entries and names are never freed one at a time */
+struct dict_chunk {
+    struct dict_chunk* prev;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+};
 
 /* Simple hash function (djb2) */
-static unsigned long hash_string(const char* str) {
+unsigned long dict_hash_name(const char* str) {
     unsigned long hash = 5381;
     int c;
     while ((c = *str++)) {
@@ -23,15 +32,48 @@ static unsigned long hash_string(const char* str) {
     return hash;
 }
 
+/* Second-level hash of a builtin name under its bucket's seed */
+size_t dict_builtin_slot(unsigned long hash, uint16_t seed, size_t slot_count) {
+    uint64_t h = (uint64_t)hash ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    return (size_t)h & (slot_count - 1);
+}
+
+static dict_group_t* builtin_group(const dict_builtins_t* builtins,
+                                   const char* name, unsigned long hash) {
+    uint16_t seed = builtins->seeds[hash & (builtins->seed_count - 1)];
+    dict_group_t* group = builtins->slots[dict_builtin_slot(hash, seed, builtins->slot_count)];
+    if (!group || group->hash != hash || strcmp(group->name, name) != 0) return NULL;
+    return group;
+}
+
+static void* arena_alloc(dictionary_t* dict, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    struct dict_chunk* chunk = dict->arena;
+    if (!chunk || chunk->used + size > chunk->size) {
+        size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(struct dict_chunk) + chunk_size);
+        if (!chunk) return NULL;
+        chunk->prev = dict->arena;
+        chunk->used = 0;
+        chunk->size = chunk_size;
+        dict->arena = chunk;
+    }
+    void* p = chunk->data + chunk->used;
+    chunk->used += size;
+    return p;
+}
+
 dictionary_t* dict_create(void) {
-    dictionary_t* dict = malloc(sizeof(dictionary_t));
+    dictionary_t* dict = calloc(1, sizeof(dictionary_t));
     if (!dict) return NULL;
 
-    dict->bucket_count = INITIAL_BUCKETS;
-    dict->entry_count = 0;
-    dict->buckets = calloc(INITIAL_BUCKETS, sizeof(dict_entry_t*));
+    dict->group_capacity = INITIAL_GROUPS;
+    dict->groups = calloc(INITIAL_GROUPS, sizeof(dict_group_t));
 
-    if (!dict->buckets) {
+    if (!dict->groups) {
         free(dict);
         return NULL;
     }
@@ -42,47 +84,137 @@ dictionary_t* dict_create(void) {
 void dict_free(dictionary_t* dict) {
     if (!dict) return;
 
-    for (size_t i = 0; i < dict->bucket_count; i++) {
-        dict_entry_t* entry = dict->buckets[i];
-        while (entry) {
-            dict_entry_t* next = entry->next;
-            free(entry->name);
-            free(entry->cid);
-            free(entry);
-            entry = next;
-        }
+    for (size_t i = 0; i < dict->group_capacity; i++) {
+        free(dict->groups[i].dispatch);
+    }
+    while (dict->arena) {
+        struct dict_chunk* prev = dict->arena->prev;
+        free(dict->arena);
+        dict->arena = prev;
     }
 
-    free(dict->buckets);
+    free(dict->groups);
+    free(dict->entries);
     free(dict);
 }
 
+/* Slot holding name, or the free slot where it would go */
+static dict_group_t* find_slot(dict_group_t* groups, size_t capacity,
+                               const char* name, unsigned long hash) {
+    size_t i = hash & (capacity - 1);
+    while (groups[i].name &&
+           (groups[i].hash != hash || strcmp(groups[i].name, name) != 0)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &groups[i];
+}
+
+static bool grow_groups(dictionary_t* dict) {
+    size_t capacity = dict->group_capacity * 2;
+    dict_group_t* groups = calloc(capacity, sizeof(dict_group_t));
+    if (!groups) return false;
+
+    for (size_t i = 0; i < dict->group_capacity; i++) {
+        dict_group_t* g = &dict->groups[i];
+        if (g->name) {
+            *find_slot(groups, capacity, g->name, g->hash) = *g;
+        }
+    }
+    free(dict->groups);
+    dict->groups = groups;
+    dict->group_capacity = capacity;
+    return true;
+}
+
+/* First definition of a builtin name: the new group starts from a copy
+ * of the static one, whose entries stay where they are */
+static bool group_copy_builtin(dict_group_t* group, const dict_group_t* builtin) {
+    group->dispatch = malloc(sizeof(dict_entry_t*) * (size_t)builtin->count);
+    if (!group->dispatch) return false;
+    memcpy(group->dispatch, builtin->dispatch, sizeof(dict_entry_t*) * (size_t)builtin->count);
+    group->count = builtin->count;
+    group->capacity = builtin->count;
+    memcpy(group->arity_end, builtin->arity_end, sizeof(group->arity_end));
+    group->latest = builtin->latest;
+    return true;
+}
+
+/* Add entry to its group as the latest definition of the name */
+static bool group_insert(dict_group_t* group, dict_entry_t* entry) {
+    if (group->count >= group->capacity) {
+        int capacity = group->capacity ? group->capacity * 2 : 4;
+        dict_entry_t** dispatch = realloc(group->dispatch, sizeof(dict_entry_t*) * (size_t)capacity);
+        if (!dispatch) return false;
+        group->dispatch = dispatch;
+        group->capacity = capacity;
+    }
+
+    /* Latest first among its input count: in front of the others */
+    int arity = entry->signature.input_count;
+    int pos = arity > 0 ? group->arity_end[arity - 1] : 0;
+    memmove(&group->dispatch[pos + 1], &group->dispatch[pos],
+            sizeof(dict_entry_t*) * (size_t)(group->count - pos));
+    group->dispatch[pos] = entry;
+    group->count++;
+    for (int n = arity; n <= 8; n++) {
+        group->arity_end[n]++;
+    }
+
+    entry->next = group->latest;
+    group->latest = entry;
+    return true;
+}
+
 bool dict_add(dictionary_t* dict, const char* name, void* addr,
               const unsigned char* cid, uint16_t prim_id, type_sig_t* sig, bool is_primitive,
               bool is_immediate, immediate_handler_t handler, word_definition_t* word_def) {
-    unsigned long hash = hash_string(name);
-    size_t bucket = hash % dict->bucket_count;
+    if (sig && (sig->input_count < 0 || sig->input_count > 8)) return false;
+
+    /* Keep the table at most half full */
+    if ((dict->group_count + 1) * 2 > dict->group_capacity && !grow_groups(dict)) {
+        return false;
+    }
+    if (dict->entry_count >= dict->entry_capacity) {
+        size_t capacity = dict->entry_capacity ? dict->entry_capacity * 2 : 256;
+        dict_entry_t** entries = realloc(dict->entries, sizeof(dict_entry_t*) * capacity);
+        if (!entries) return false;
+        dict->entries = entries;
+        dict->entry_capacity = capacity;
+    }
+
+    unsigned long hash = dict_hash_name(name);
+    dict_group_t* group = find_slot(dict->groups, dict->group_capacity, name, hash);
 
     /* Create new entry */
-    dict_entry_t* entry = malloc(sizeof(dict_entry_t));
+    dict_entry_t* entry = arena_alloc(dict, sizeof(dict_entry_t));
     if (!entry) return false;
 
-    entry->name = strdup(name);
+    if (!group->name) {
+        size_t len = strlen(name);
+        char* copy = arena_alloc(dict, len + 1);
+        if (!copy) return false;
+        memcpy(copy, name, len + 1);
+        memset(group, 0, sizeof(*group));
+        dict_group_t* builtin = dict->builtins ? builtin_group(dict->builtins, name, hash) : NULL;
+        if (builtin && !group_copy_builtin(group, builtin)) return false;
+        group->name = copy;
+        group->hash = hash;
+        dict->group_count++;
+    }
+
+    entry->name = (char*)group->name;
     entry->addr = addr;
     /* Copy binary CID if provided */
+    entry->cid = NULL;
     if (cid) {
-        entry->cid = malloc(CID_SIZE);
-        if (entry->cid) {
-            memcpy(entry->cid, cid, CID_SIZE);
-        }
-    } else {
-        entry->cid = NULL;
+        dict_set_cid(entry, cid);
     }
     entry->prim_id = prim_id;
     entry->is_primitive = is_primitive;
     entry->is_immediate = is_immediate;
     entry->handler = handler;
     entry->word_def = word_def;  /* Design B: Store uncompiled word definition */
+    entry->order = dict_entry_count(dict);
 
     if (sig) {
         memcpy(&entry->signature, sig, sizeof(type_sig_t));
@@ -100,10 +232,8 @@ bool dict_add(dictionary_t* dict, const char* name, void* addr,
         entry->priority = 0;
     }
 
-    /* Insert at head of chain */
-    entry->next = dict->buckets[bucket];
-    dict->buckets[bucket] = entry;
-    dict->entry_count++;
+    if (!group_insert(group, entry)) return false;
+    dict->entries[dict->entry_count++] = entry;
 
     /* Debug trace */
     DEBUG_DICT("Registered: %s %s prim_id=%u",
@@ -114,23 +244,45 @@ bool dict_add(dictionary_t* dict, const char* name, void* addr,
     return true;
 }
 
-dict_entry_t* dict_lookup(dictionary_t* dict, const char* name) {
-    unsigned long hash = hash_string(name);
-    size_t bucket = hash % dict->bucket_count;
+void dict_set_cid(dict_entry_t* entry, const unsigned char* cid) {
+    memcpy(entry->cid_storage, cid, CID_SIZE);
+    entry->cid = entry->cid_storage;
+}
 
-    dict_entry_t* entry = dict->buckets[bucket];
-    while (entry) {
-        if (strcmp(entry->name, name) == 0) {
-            return entry;
-        }
-        entry = entry->next;
+bool dict_use_builtins(dictionary_t* dict, const dict_builtins_t* builtins) {
+    if (dict->entry_count > 0) {
+        fprintf(stderr, "Error: Builtin words must be installed before other definitions\n");
+        return false;
     }
+    dict->builtins = builtins;
+    return true;
+}
 
-    return NULL;
+size_t dict_entry_count(const dictionary_t* dict) {
+    return (dict->builtins ? dict->builtins->entry_count : 0) + dict->entry_count;
+}
+
+dict_entry_t* dict_entry_at(const dictionary_t* dict, size_t index) {
+    size_t builtin_count = dict->builtins ? dict->builtins->entry_count : 0;
+    if (index < builtin_count) return &dict->builtins->entries[index];
+    index -= builtin_count;
+    return index < dict->entry_count ? dict->entries[index] : NULL;
+}
+
+dict_group_t* dict_lookup_group(dictionary_t* dict, const char* name) {
+    unsigned long hash = dict_hash_name(name);
+    dict_group_t* group = find_slot(dict->groups, dict->group_capacity, name, hash);
+    if (group->name) return group;
+    return dict->builtins ? builtin_group(dict->builtins, name, hash) : NULL;
+}
+
+dict_entry_t* dict_lookup(dictionary_t* dict, const char* name) {
+    dict_group_t* group = dict_lookup_group(dict, name);
+    return group ? group->latest : NULL;
 }
 
 /* Calculate match score for overload resolution */
-static int match_score(type_sig_t* sig, type_id_t* type_stack, int stack_depth) {
+static int match_score(const type_sig_t* sig, const type_id_t* type_stack, int stack_depth) {
     /* Check if stack has enough items */
     if (stack_depth < sig->input_count) {
         return -1;  /* Not enough items on stack */
@@ -178,47 +330,50 @@ static int match_score(type_sig_t* sig, type_id_t* type_stack, int stack_depth)
     return score;
 }
 
-dict_entry_t* dict_lookup_typed(dictionary_t* dict, const char* name,
-                                type_id_t* type_stack, int stack_depth) {
-    unsigned long hash = hash_string(name);
-    size_t bucket = hash % dict->bucket_count;
-
-    DEBUG_DICT("Looking up '%s' with stack depth=%d", name, stack_depth);
-    debug_dump_type_stack("Stack state", type_stack, stack_depth);
-
+dict_entry_t* dict_group_select(dict_group_t* group, const type_id_t* type_stack,
+                                int stack_depth) {
     dict_entry_t* best = NULL;
     int best_score = -1;
-    int candidates = 0;
-
-    /* Find all candidates and pick the best match */
-    dict_entry_t* entry = dict->buckets[bucket];
-    while (entry) {
-        if (strcmp(entry->name, name) == 0) {
-            candidates++;
-            int score = match_score(&entry->signature, type_stack, stack_depth);
-            DEBUG_TYPES("  Candidate '%s': score=%d (best=%d)", name, score, best_score);
-            if (score > best_score) {
-                best = entry;
-                best_score = score;
-            } else if (score == best_score && best) {
-                /* Tie-break by priority */
-                if (entry->priority > best->priority) {
-                    best = entry;
-                }
-            }
+
+    /* Only overloads the stack is deep enough for */
+    int candidates = group->arity_end[stack_depth < 8 ? stack_depth : 8];
+    for (int i = 0; i < candidates; i++) {
+        dict_entry_t* entry = group->dispatch[i];
+        int score = match_score(&entry->signature, type_stack, stack_depth);
+        DEBUG_TYPES("  Candidate '%s': score=%d (best=%d)", group->name, score, best_score);
+        if (score < 0) continue;
+        /* Best score, then priority, then the latest definition */
+        if (!best || score > best_score ||
+            (score == best_score && (entry->priority > best->priority ||
+                                     (entry->priority == best->priority &&
+                                      entry->order > best->order)))) {
+            best = entry;
+            best_score = score;
         }
-        entry = entry->next;
     }
 
     if (best) {
-        DEBUG_DICT("  Found match: '%s' score=%d", name, best_score);
+        DEBUG_DICT("  Found match: '%s' score=%d", group->name, best_score);
     } else {
-        DEBUG_DICT("  No match for '%s' (%d candidates checked)", name, candidates);
+        DEBUG_DICT("  No match for '%s' (%d candidates checked)", group->name, candidates);
     }
 
     return best;
 }
 
+dict_entry_t* dict_lookup_typed(dictionary_t* dict, const char* name,
+                                type_id_t* type_stack, int stack_depth) {
+    DEBUG_DICT("Looking up '%s' with stack depth=%d", name, stack_depth);
+    debug_dump_type_stack("Stack state", type_stack, stack_depth);
+
+    dict_group_t* group = dict_lookup_group(dict, name);
+    if (!group) {
+        DEBUG_DICT("  No match for '%s' (0 candidates checked)", name);
+        return NULL;
+    }
+    return dict_group_select(group, type_stack, stack_depth);
+}
+
 /* Parse type string (e.g., "i64", "u64", "any", "a", "b") */
 static type_id_t parse_type(const char* str) {
     /* Single-letter lowercase = type variable */
@@ -281,7 +436,7 @@ bool parse_type_sig(const char* str, type_sig_t* sig) {
 static const char* type_to_string(type_id_t type) {
     /* Handle type variables (a-z) */
     if (type >= TYPE_VAR_A && type <= TYPE_VAR_Z) {
-        static char buf[2];
+        static _Thread_local char buf[2];
         buf[0] = 'a' + (type - TYPE_VAR_A);
         buf[1] = '\0';
         return buf;
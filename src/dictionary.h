@@ -24,9 +24,10 @@ typedef bool (*immediate_handler_t)(compiler_t* comp);
 /* Forward declaration for word definition (Design B) */
 typedef struct word_definition word_definition_t;
 
-/* Dictionary entry (word definition) */
+/* Dictionary entry (word definition). Entries live in the dictionary's
+ * arena and are freed with it. */
 typedef struct dict_entry {
-    char* name;              /* Word name */
+    char* name;              /* Word name (shared by the entry's overload group) */
     void* addr;              /* Address (for primitives) or NULL */
     unsigned char* cid;      /* Binary Content ID (32 bytes, for user words or primitives) */
     uint16_t prim_id;        /* Primitive ID (LINKING.md design, 0 if not primitive) */
@@ -36,14 +37,47 @@ typedef struct dict_entry {
     immediate_handler_t handler; /* Handler for immediate words or NULL */
     word_definition_t* word_def; /* Design B: Stored tokens for lazy compilation (NULL if compiled) */
     int priority;            /* For overload resolution (higher = more specific) */
-    struct dict_entry* next; /* Hash table chain */
+    size_t order;            /* Definition order (later wins a full tie) */
+    struct dict_entry* next; /* Earlier definition of the same name */
+    unsigned char cid_storage[CID_SIZE];  /* cid points here when set */
 } dict_entry_t;
 
-/* Dictionary structure */
+/* Every definition of one name. dispatch holds the same entries ordered
+ * by input count (latest first within a count), so a typed lookup only
+ * scores the overloads the stack is deep enough for. */
 typedef struct {
-    dict_entry_t** buckets;
-    size_t bucket_count;
+    const char* name;        /* NULL = free slot */
+    unsigned long hash;
+    dict_entry_t* latest;    /* Latest definition; earlier ones follow next */
+    dict_entry_t** dispatch;
+    int count;
+    int capacity;
+    uint8_t arity_end[9];    /* dispatch[0, arity_end[n]) take at most n inputs */
+} dict_group_t;
+
+/* Words fixed at build time (see gen_primtab): static groups behind a
+ * perfect hash, so a dictionary needs no startup work to know them.
+ * A name's group is slots[dict_builtin_slot(hash, seeds[hash & (seed_count - 1)],
+ * slot_count)]; the tables are only ever read. */
+typedef struct {
+    dict_group_t* const* slots;  /* slot_count (power of two), NULL = unused */
+    const uint16_t* seeds;       /* seed_count (power of two) displacements */
+    size_t slot_count;
+    size_t seed_count;
+    dict_entry_t* entries;       /* Definition order */
+    size_t entry_count;
+} dict_builtins_t;
+
+/* Dictionary structure: open addressing on name, one group per name */
+typedef struct {
+    const dict_builtins_t* builtins; /* Consulted when a name has no group */
+    dict_group_t* groups;
+    size_t group_capacity;   /* Power of two, kept at most half full */
+    size_t group_count;
+    dict_entry_t** entries;  /* Every entry in definition order (for iteration) */
     size_t entry_count;
+    size_t entry_capacity;
+    struct dict_chunk* arena; /* Entries and names */
 } dictionary_t;
 
 /* Create/destroy dictionary */
@@ -55,13 +89,36 @@ bool dict_add(dictionary_t* dict, const char* name, void* addr,
               const unsigned char* cid, uint16_t prim_id, type_sig_t* sig, bool is_primitive,
               bool is_immediate, immediate_handler_t handler, word_definition_t* word_def);
 
-/* Lookup word by name (returns first match) */
+/* Make a build-time table the dictionary's oldest definitions. Must come
+ * before the first dict_add. */
+bool dict_use_builtins(dictionary_t* dict, const dict_builtins_t* builtins);
+
+/* Every entry, builtins first, in definition order */
+size_t dict_entry_count(const dictionary_t* dict);
+dict_entry_t* dict_entry_at(const dictionary_t* dict, size_t index);
+
+/* Name hash and builtin slot (shared with the table generator) */
+unsigned long dict_hash_name(const char* name);
+size_t dict_builtin_slot(unsigned long hash, uint16_t seed, size_t slot_count);
+
+/* Lookup word by name (returns the latest definition) */
 dict_entry_t* dict_lookup(dictionary_t* dict, const char* name);
 
 /* Lookup word by name + type signature (for overload resolution) */
 dict_entry_t* dict_lookup_typed(dictionary_t* dict, const char* name,
                                 type_id_t* type_stack, int stack_depth);
 
+/* All definitions of a name, or NULL. Valid until the next dict_add;
+ * a builtin group is shared and must not be modified. */
+dict_group_t* dict_lookup_group(dictionary_t* dict, const char* name);
+
+/* Overload of group best matching the stack (NULL if none matches) */
+dict_entry_t* dict_group_select(dict_group_t* group, const type_id_t* type_stack,
+                                int stack_depth);
+
+/* Record the CID of an entry's code */
+void dict_set_cid(dict_entry_t* entry, const unsigned char* cid);
+
 /* Parse type signature string (e.g., "i64 i64 -> i64") */
 bool parse_type_sig(const char* str, type_sig_t* sig);
 
@@ -0,0 +1,79 @@
+/*
+ * March Language - Effect Inference Implementation
+ */
+
+#include "effects.h"
+
+uint32_t effects_of_prim(uint16_t prim_id) {
+    switch (prim_id) {
+        /* Arithmetic, logic, shuffles and the return stack: pure */
+        case PRIM_LIT:
+        case PRIM_ADD: case PRIM_SUB: case PRIM_MUL:
+        case PRIM_DUP: case PRIM_DROP: case PRIM_SWAP: case PRIM_OVER: case PRIM_ROT:
+        case PRIM_EQ: case PRIM_NE: case PRIM_LT: case PRIM_GT: case PRIM_LE: case PRIM_GE:
+        case PRIM_AND: case PRIM_OR: case PRIM_XOR: case PRIM_NOT:
+        case PRIM_LSHIFT: case PRIM_RSHIFT: case PRIM_ARSHIFT:
+        case PRIM_LAND: case PRIM_LOR: case PRIM_LNOT:
+        case PRIM_ZEROP: case PRIM_ZEROGT: case PRIM_ZEROLT:
+        case PRIM_TOR: case PRIM_FROMR: case PRIM_RFETCH: case PRIM_RDROP:
+        case PRIM_TWOTOR: case PRIM_TWOFROMR:
+        case PRIM_BRANCH: case PRIM_0BRANCH:
+        case PRIM_I0:
+        case PRIM_IDENTITY:
+        case PRIM_TAILCALL:         /* The call that follows carries the effects */
+        case PRIM_RECURSE:
+        case PRIM_MEMO_ENTER:       /* A hit returns what the body would */
+        case PRIM_MEMO_EXIT:
+            return 0;
+
+        case PRIM_DIV:
+        case PRIM_MOD:
+            return EFFECT_ERR;
+
+        case PRIM_FETCH: case PRIM_STORE: case PRIM_CFETCH: case PRIM_CSTORE:
+        case PRIM_ARRAY_LEN: case PRIM_STR_LEN:
+        case PRIM_ARRAY_AT: case PRIM_ARRAY_SET: case PRIM_ARRAY_FILL: case PRIM_ARRAY_REV:
+            return EFFECT_MEMORY;
+
+        case PRIM_FREE: case PRIM_ALLOC: case PRIM_MUT: case PRIM_ARRAY_CONCAT:
+            return EFFECT_ALLOC;
+        case PRIM_MEMCPY:
+            return EFFECT_MEMORY | EFFECT_ALLOC;
+
+        case PRIM_MAP_NEW: case PRIM_MAP_GET: case PRIM_MAP_SET:
+        case PRIM_MAP_REMOVE: case PRIM_MAP_SIZE: case PRIM_MAP_FREE:
+            return EFFECT_MAP | EFFECT_ALLOC;
+
+        case PRIM_EXECUTE:
+            return EFFECT_DYNAMIC;
+
+        default:
+            return EFFECT_UNKNOWN;
+    }
+}
+
+uint32_t effects_of_ir(const ir_buffer_t* ir, march_db_t* db) {
+    uint32_t effects = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        switch (in->op) {
+            case IR_PRIM:
+            case IR_BRANCH:
+                effects |= effects_of_prim(in->prim_id);
+                break;
+            case IR_REF:
+                /* Data and quotation references only push a value */
+                if (in->ref_kind == BLOB_WORD) {
+                    uint32_t callee;
+                    if (!db_load_def_effects(db, in->cid, &callee)) {
+                        callee = EFFECT_UNKNOWN;
+                    }
+                    effects |= callee;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return effects;
+}
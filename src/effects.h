@@ -0,0 +1,37 @@
+/*
+ * March Language - Effect Inference
+ * Effect flags of primitives and compiled words (defs.effects, defs.is_pure)
+ */
+
+#ifndef MARCH_EFFECTS_H
+#define MARCH_EFFECTS_H
+
+#include "ir.h"
+#include "database.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Effect flags */
+#define EFFECT_IO       0x01    /* Observable outside the program */
+#define EFFECT_ERR      0x02    /* May trap (division by zero) */
+#define EFFECT_ALLOC    0x04    /* Allocates, copies or frees heap memory */
+#define EFFECT_MEMORY   0x08    /* Reads or writes memory through a pointer */
+#define EFFECT_MAP      0x10    /* HAMT map operations */
+#define EFFECT_DYNAMIC  0x20    /* Executes a quotation passed at run time */
+#define EFFECT_UNKNOWN  0x40    /* Calls code whose effects were never inferred */
+
+/* A trap depends only on the inputs, so a word that may trap is still pure */
+#define EFFECTS_IMPURE  (~(uint32_t)EFFECT_ERR)
+
+static inline bool effects_pure(uint32_t effects) {
+    return (effects & EFFECTS_IMPURE) == 0;
+}
+
+/* Effects of one primitive (EFFECT_UNKNOWN for IDs not listed) */
+uint32_t effects_of_prim(uint16_t prim_id);
+
+/* Effects of compiled code: its primitives plus the recorded effects of
+ * the words it calls. A recursive call (IR_RECURSE) adds nothing. */
+uint32_t effects_of_ir(const ir_buffer_t* ir, march_db_t* db);
+
+#endif /* MARCH_EFFECTS_H */
@@ -0,0 +1,279 @@
+/*
+ * March Language - Compile-Time Evaluator Implementation
+ *
+ * Code is decoded from stored blobs into IR and interpreted: the sandbox
+ * never runs machine code, so a word that misbehaves at compile time can
+ * only fail to evaluate.
+ */
+
+#include "evaluator.h"
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* A decoded word and where its labels are */
+typedef struct {
+    unsigned char cid[CID_SIZE];
+    ir_buffer_t* ir;
+    size_t* label_pos;
+} eval_code_t;
+
+typedef struct {
+    march_db_t* db;
+    eval_code_t* code;          /* Decoded words, reused across calls */
+    size_t code_count;
+    size_t code_capacity;
+    int64_t stack[EVAL_STACK_SIZE];
+    int sp;
+    int64_t rstack[EVAL_STACK_SIZE];
+    int rsp;
+    long steps;
+} eval_t;
+
+static eval_code_t* load_code(eval_t* ev, const unsigned char* cid) {
+    for (size_t i = 0; i < ev->code_count; i++) {
+        if (memcmp(ev->code[i].cid, cid, CID_SIZE) == 0) return &ev->code[i];
+    }
+
+    int kind = -1;
+    uint8_t* data = NULL;
+    size_t len = 0;
+    if (!db_load_blob_ex(ev->db, cid, &kind, NULL, &data, &len)) return NULL;
+
+    ir_buffer_t* ir = NULL;
+    if (kind == BLOB_WORD) {
+        ir = ir_buffer_create();
+        if (ir && !ir_decode_blob(ir, data ? data : (const uint8_t*)"", len)) {
+            ir_buffer_free(ir);
+            ir = NULL;
+        }
+    }
+    free(data);
+    if (!ir) return NULL;
+
+    size_t* label_pos = malloc(sizeof(size_t) * (ir->label_count > 0 ? ir->label_count : 1));
+    if (ev->code_count >= ev->code_capacity) {
+        size_t capacity = ev->code_capacity ? ev->code_capacity * 2 : 8;
+        eval_code_t* code = realloc(ev->code, sizeof(eval_code_t) * capacity);
+        if (code) {
+            ev->code = code;
+            ev->code_capacity = capacity;
+        }
+    }
+    if (!label_pos || ev->code_count >= ev->code_capacity) {
+        free(label_pos);
+        ir_buffer_free(ir);
+        return NULL;
+    }
+    for (size_t i = 0; i < ir->count; i++) {
+        if (ir->instrs[i].op == IR_LABEL) label_pos[ir->instrs[i].value] = i;
+    }
+
+    eval_code_t* code = &ev->code[ev->code_count++];
+    memcpy(code->cid, cid, CID_SIZE);
+    code->ir = ir;
+    code->label_pos = label_pos;
+    return code;
+}
+
+/* i64 data references are the only data the sandbox reads */
+static bool load_i64(eval_t* ev, const unsigned char* cid, int64_t* value) {
+    int kind = -1;
+    uint8_t* data = NULL;
+    size_t len = 0;
+    if (!db_load_blob_ex(ev->db, cid, &kind, NULL, &data, &len)) return false;
+
+    bool ok = kind == BLOB_DATA && len == 8 && data;
+    if (ok) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) {
+            v |= (uint64_t)data[i] << (i * 8);
+        }
+        *value = (int64_t)v;
+    }
+    free(data);
+    return ok;
+}
+
+#define NEED(n)   do { if (ev->sp < (n)) return false; } while (0)
+#define ROOM(n)   do { if (ev->sp + (n) > EVAL_STACK_SIZE) return false; } while (0)
+#define TOP(i)    (ev->stack[ev->sp - 1 - (i)])
+
+/* One primitive on the data and return stacks; rbase is the bottom of
+ * the current word's return-stack cells (below it are its callers') */
+static bool eval_prim(eval_t* ev, uint16_t prim_id, int rbase) {
+    int64_t a, b, result;
+    switch (prim_id) {
+        case PRIM_DUP:
+            NEED(1); ROOM(1);
+            ev->stack[ev->sp] = TOP(0);
+            ev->sp++;
+            return true;
+        case PRIM_DROP:
+            NEED(1);
+            ev->sp--;
+            return true;
+        case PRIM_SWAP:
+            NEED(2);
+            a = TOP(1);
+            TOP(1) = TOP(0);
+            TOP(0) = a;
+            return true;
+        case PRIM_OVER:
+            NEED(2); ROOM(1);
+            ev->stack[ev->sp] = TOP(1);
+            ev->sp++;
+            return true;
+        case PRIM_ROT:
+            NEED(3);
+            a = TOP(2);
+            TOP(2) = TOP(1);
+            TOP(1) = TOP(0);
+            TOP(0) = a;
+            return true;
+        case PRIM_IDENTITY:
+        case PRIM_TAILCALL:         /* The call that follows returns here */
+        case PRIM_MEMO_EXIT:        /* No table at compile time */
+            return true;
+
+        case PRIM_TOR:
+            NEED(1);
+            if (ev->rsp >= EVAL_STACK_SIZE) return false;
+            ev->rstack[ev->rsp++] = ev->stack[--ev->sp];
+            return true;
+        case PRIM_FROMR:
+            ROOM(1);
+            if (ev->rsp <= rbase) return false;
+            ev->stack[ev->sp++] = ev->rstack[--ev->rsp];
+            return true;
+        case PRIM_RFETCH:
+        case PRIM_I0:
+            ROOM(1);
+            if (ev->rsp <= rbase) return false;
+            ev->stack[ev->sp++] = ev->rstack[ev->rsp - 1];
+            return true;
+        case PRIM_RDROP:
+            if (ev->rsp <= rbase) return false;
+            ev->rsp--;
+            return true;
+        case PRIM_TWOTOR:
+            NEED(2);
+            if (ev->rsp + 2 > EVAL_STACK_SIZE) return false;
+            ev->rstack[ev->rsp++] = TOP(1);
+            ev->rstack[ev->rsp++] = TOP(0);
+            ev->sp -= 2;
+            return true;
+        case PRIM_TWOFROMR:
+            ROOM(2);
+            if (ev->rsp - 2 < rbase) return false;
+            ev->stack[ev->sp++] = ev->rstack[ev->rsp - 2];
+            ev->stack[ev->sp++] = ev->rstack[ev->rsp - 1];
+            ev->rsp -= 2;
+            return true;
+
+        default:
+            break;
+    }
+
+    /* Arithmetic, comparison and logic: the optimizer's folding rules */
+    if (ev->sp >= 1 && optimizer_fold_unary(prim_id, TOP(0), &result)) {
+        TOP(0) = result;
+        return true;
+    }
+    if (ev->sp >= 2) {
+        a = TOP(1);
+        b = TOP(0);
+        if (optimizer_fold_binary(prim_id, a, b, &result)) {
+            ev->sp--;
+            TOP(0) = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool eval_code(eval_t* ev, const unsigned char* cid, int depth) {
+    if (depth > EVAL_MAX_DEPTH) return false;
+    eval_code_t* code = load_code(ev, cid);
+    if (!code) return false;
+
+    /* code may move when callees are loaded: keep the IR itself */
+    ir_buffer_t* ir = code->ir;
+    size_t* label_pos = code->label_pos;
+    int rbase = ev->rsp;
+
+    for (size_t pc = 0; pc < ir->count; pc++) {
+        if (++ev->steps > EVAL_MAX_STEPS) return false;
+        const ir_instr_t* in = &ir->instrs[pc];
+        int64_t value;
+
+        switch (in->op) {
+            case IR_LABEL:
+                break;
+            case IR_LIT:
+                ROOM(1);
+                ev->stack[ev->sp++] = in->value;
+                break;
+            case IR_PRIM:
+                if (in->prim_id == PRIM_MEMO_ENTER) {
+                    pc++;               /* Skip the arity literal */
+                } else if (!eval_prim(ev, in->prim_id, rbase)) {
+                    return false;
+                }
+                break;
+            case IR_RECURSE:
+                if (!eval_code(ev, cid, depth + 1)) return false;
+                break;
+            case IR_BRANCH:
+                if (in->prim_id == PRIM_0BRANCH) {
+                    NEED(1);
+                    if (ev->stack[--ev->sp] != 0) break;
+                } else if (in->prim_id != PRIM_BRANCH) {
+                    return false;
+                }
+                pc = label_pos[in->value];  /* The label; the loop steps past it */
+                break;
+            case IR_REF:
+                if (in->ref_kind == BLOB_DATA) {
+                    ROOM(1);
+                    if (!load_i64(ev, in->cid, &value)) return false;
+                    ev->stack[ev->sp++] = value;
+                } else if (in->ref_kind == BLOB_WORD) {
+                    if (!eval_code(ev, in->cid, depth + 1)) return false;
+                } else {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    /* Like EXIT: the word must leave its return stack as it found it */
+    return ev->rsp == rbase;
+}
+
+bool evaluate_word(march_db_t* db, const unsigned char* cid,
+                   const int64_t* args, int arg_count,
+                   int64_t* results, int result_count) {
+    if (arg_count < 0 || arg_count > EVAL_STACK_SIZE) return false;
+
+    eval_t* ev = calloc(1, sizeof(eval_t));
+    if (!ev) return false;
+    ev->db = db;
+    memcpy(ev->stack, args, sizeof(int64_t) * (size_t)arg_count);
+    ev->sp = arg_count;
+
+    bool ok = eval_code(ev, cid, 0) && ev->sp == result_count;
+    if (ok) {
+        memcpy(results, ev->stack, sizeof(int64_t) * (size_t)result_count);
+    }
+
+    for (size_t i = 0; i < ev->code_count; i++) {
+        ir_buffer_free(ev->code[i].ir);
+        free(ev->code[i].label_pos);
+    }
+    free(ev->code);
+    free(ev);
+    return ok;
+}
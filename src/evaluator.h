@@ -0,0 +1,28 @@
+/*
+ * March Language - Compile-Time Evaluator
+ * Runs pure compiled words on constant inputs in a sandbox (marchc -O 1)
+ */
+
+#ifndef MARCH_EVALUATOR_H
+#define MARCH_EVALUATOR_H
+
+#include "ir.h"
+#include "database.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Sandbox limits: running out of any of them leaves the call to run time */
+#define EVAL_MAX_STEPS   1000000    /* Instructions executed */
+#define EVAL_STACK_SIZE  256        /* Data and return stack cells */
+#define EVAL_MAX_DEPTH   64         /* Nested calls */
+
+/* Run the word stored as cid with args on the stack (args[0] deepest).
+ * Only side-effect-free primitives, i64 data and calls to other stored
+ * words are interpreted. Succeeds if the word returns leaving exactly
+ * result_count cells, written to results (deepest first); false if it
+ * leaves the sandbox (any other primitive or reference, a trap, a limit). */
+bool evaluate_word(march_db_t* db, const unsigned char* cid,
+                   const int64_t* args, int arg_count,
+                   int64_t* results, int result_count);
+
+#endif /* MARCH_EVALUATOR_H */
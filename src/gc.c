@@ -0,0 +1,293 @@
+/*
+ * March Language - Blob Garbage Collector Implementation
+ *
+ * Mark: roots are every words.def_cid, the manifests of root modules (and
+ * the modules they import), and state/state_history values. Reachability
+ * follows the edges table with a recursive query into a temp table.
+ *
+ * Sweep: dead blobs are deleted in batches of opts->batch_size rows per
+ * transaction, edges first (a dead blob may still be referenced by another
+ * dead blob in a later batch), then defs, persisted specializations and
+ * blobs, then type signatures no longer used by any blob or def.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "gc.h"
+#include "types.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Execute SQL, report errors */
+static bool gc_exec(march_db_t* db, const char* sql) {
+    char* err_msg = NULL;
+    int rc = sqlite3_exec(db->db, sql, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "GC error: %s\n  in: %.80s\n", err_msg, sql);
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+/* Run a single-value query */
+static int64_t gc_query_int(march_db_t* db, const char* sql) {
+    sqlite3_stmt* stmt = NULL;
+    int64_t value = 0;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return value;
+}
+
+static bool table_exists(march_db_t* db, const char* name) {
+    sqlite3_stmt* stmt = NULL;
+    bool exists = false;
+    if (sqlite3_prepare_v2(db->db,
+            "SELECT 1 FROM sqlite_master WHERE type='table' AND name=?;",
+            -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+    return exists;
+}
+
+static int64_t db_file_bytes(march_db_t* db) {
+    return gc_query_int(db, "PRAGMA page_count;") * gc_query_int(db, "PRAGMA page_size;");
+}
+
+/* Code blobs stored before edges were recorded have no outgoing edges;
+ * derive them from the blob data so marking does not miss callees. */
+static bool backfill_edges(march_db_t* db) {
+    sqlite3_stmt* stmt = NULL;
+    int rc = sqlite3_prepare_v2(db->db,
+        "SELECT cid, data, len FROM blobs b "
+        "WHERE kind IN (?, ?) AND NOT EXISTS (SELECT 1 FROM edges e WHERE e.from_cid = b.cid);",
+        -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "GC error: %s\n", sqlite3_errmsg(db->db));
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, BLOB_WORD);
+    sqlite3_bind_int(stmt, 2, BLOB_QUOTATION);
+
+    int scanned = 0;
+    bool ok = true;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char* cid = sqlite3_column_blob(stmt, 0);
+        const uint8_t* data = sqlite3_column_blob(stmt, 1);
+        size_t len = (size_t)sqlite3_column_int64(stmt, 2);
+        if (!cid || sqlite3_column_bytes(stmt, 0) != CID_SIZE) continue;
+        if (!data) continue;
+
+        if (!db_store_edges(db, cid, data, len)) {
+            ok = false;
+            break;
+        }
+        scanned++;
+    }
+    sqlite3_finalize(stmt);
+
+    DEBUG_DB("GC: scanned %d code blobs without edges", scanned);
+    return ok;
+}
+
+/* Compute gc_live, gc_dead, gc_dead_sigs (temp tables) */
+static bool gc_mark(march_db_t* db, gc_stats_t* stats) {
+    if (!gc_exec(db,
+            "DROP TABLE IF EXISTS temp.gc_roots;"
+            "DROP TABLE IF EXISTS temp.gc_live;"
+            "DROP TABLE IF EXISTS temp.gc_live_modules;"
+            "DROP TABLE IF EXISTS temp.gc_live_sigs;"
+            "DROP TABLE IF EXISTS temp.gc_dead;"
+            "DROP TABLE IF EXISTS temp.gc_dead_sigs;"
+            "CREATE TEMP TABLE gc_roots (cid BLOB);"
+            "CREATE TEMP TABLE gc_live (cid BLOB PRIMARY KEY);"
+            "CREATE TEMP TABLE gc_live_modules (id INTEGER PRIMARY KEY);"
+            "CREATE TEMP TABLE gc_live_sigs (sig_cid BLOB PRIMARY KEY);"
+            "INSERT INTO gc_roots SELECT def_cid FROM words WHERE def_cid IS NOT NULL;")) {
+        return false;
+    }
+
+    /* Root modules and everything they import */
+    if (table_exists(db, "modules")) {
+        const char* live_modules = table_exists(db, "module_imports")
+            ? "WITH RECURSIVE m(id) AS ("
+              "  SELECT id FROM modules WHERE is_root = 1"
+              "  UNION SELECT mi.imported_id FROM module_imports mi JOIN m ON mi.importer_id = m.id)"
+              "INSERT INTO gc_live_modules SELECT id FROM m;"
+            : "INSERT INTO gc_live_modules SELECT id FROM modules WHERE is_root = 1;";
+        if (!gc_exec(db, live_modules) ||
+            !gc_exec(db, "INSERT INTO gc_roots SELECT manifest_cid FROM modules "
+                         "WHERE id IN (SELECT id FROM gc_live_modules);")) {
+            return false;
+        }
+        stats->dead_modules = gc_query_int(db,
+            "SELECT count(*) FROM modules WHERE id NOT IN (SELECT id FROM gc_live_modules);");
+    }
+
+    if (table_exists(db, "state") &&
+        !gc_exec(db, "INSERT INTO gc_roots SELECT value_cid FROM state;")) {
+        return false;
+    }
+    if (table_exists(db, "state_history") &&
+        !gc_exec(db, "INSERT INTO gc_roots SELECT value_cid FROM state_history;")) {
+        return false;
+    }
+
+    /* Transitive closure over edges */
+    if (!gc_exec(db,
+            "WITH RECURSIVE live(cid) AS ("
+            "  SELECT cid FROM gc_roots"
+            "  UNION SELECT e.to_cid FROM edges e JOIN live ON e.from_cid = live.cid)"
+            "INSERT OR IGNORE INTO gc_live SELECT cid FROM live;"
+            "CREATE TEMP TABLE gc_dead AS "
+            "  SELECT cid, len FROM blobs b "
+            "  WHERE NOT EXISTS (SELECT 1 FROM gc_live l WHERE l.cid = b.cid);"
+            "INSERT OR IGNORE INTO gc_live_sigs "
+            "  SELECT b.sig_cid FROM blobs b JOIN gc_live l ON b.cid = l.cid "
+            "  WHERE b.sig_cid IS NOT NULL;"
+            "INSERT OR IGNORE INTO gc_live_sigs "
+            "  SELECT d.sig_cid FROM defs d JOIN gc_live l ON d.cid = l.cid "
+            "  WHERE d.sig_cid IS NOT NULL;"
+            "CREATE TEMP TABLE gc_dead_sigs AS "
+            "  SELECT sig_cid FROM type_signatures t "
+            "  WHERE NOT EXISTS (SELECT 1 FROM gc_live_sigs s WHERE s.sig_cid = t.sig_cid);")) {
+        return false;
+    }
+
+    stats->live_blobs = gc_query_int(db,
+        "SELECT count(*) FROM blobs b JOIN gc_live l ON b.cid = l.cid;");
+    stats->dead_blobs = gc_query_int(db, "SELECT count(*) FROM gc_dead;");
+    stats->bytes_reclaimed = gc_query_int(db, "SELECT coalesce(sum(len), 0) FROM gc_dead;");
+    stats->dead_sigs = gc_query_int(db, "SELECT count(*) FROM gc_dead_sigs;");
+
+    return true;
+}
+
+/* Run each statement for rowid ranges of 'table' (batch_size rows per transaction) */
+static bool gc_sweep_batched(march_db_t* db, const char* table, const char* const* stmts,
+                             int stmt_count, int batch_size) {
+    char sql[256];
+    snprintf(sql, sizeof(sql), "SELECT coalesce(max(rowid), 0) FROM %s;", table);
+    int64_t max_rowid = gc_query_int(db, sql);
+
+    sqlite3_stmt* prepared[4] = {NULL};
+    if (stmt_count > 4) return false;
+    for (int i = 0; i < stmt_count; i++) {
+        if (sqlite3_prepare_v2(db->db, stmts[i], -1, &prepared[i], NULL) != SQLITE_OK) {
+            fprintf(stderr, "GC error: %s\n", sqlite3_errmsg(db->db));
+            for (int j = 0; j < i; j++) sqlite3_finalize(prepared[j]);
+            return false;
+        }
+    }
+
+    bool ok = true;
+    for (int64_t lo = 0; lo < max_rowid && ok; lo += batch_size) {
+        if (!gc_exec(db, "BEGIN;")) {
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < stmt_count; i++) {
+            sqlite3_bind_int64(prepared[i], 1, lo);
+            sqlite3_bind_int64(prepared[i], 2, lo + batch_size);
+            if (sqlite3_step(prepared[i]) != SQLITE_DONE) {
+                fprintf(stderr, "GC error: %s\n", sqlite3_errmsg(db->db));
+                ok = false;
+            }
+            sqlite3_reset(prepared[i]);
+            if (!ok) break;
+        }
+        gc_exec(db, ok ? "COMMIT;" : "ROLLBACK;");
+    }
+
+    for (int i = 0; i < stmt_count; i++) sqlite3_finalize(prepared[i]);
+    return ok;
+}
+
+void gc_options_init(gc_options_t* opts) {
+    opts->dry_run = false;
+    opts->vacuum = false;
+    opts->batch_size = GC_DEFAULT_BATCH_SIZE;
+}
+
+bool gc_collect(march_db_t* db, const gc_options_t* opts, gc_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!db) return false;
+
+    if (!table_exists(db, "edges")) {
+        fprintf(stderr, "Error: Database has no edges table, cannot collect\n");
+        return false;
+    }
+
+    int batch_size = opts->batch_size > 0 ? opts->batch_size : GC_DEFAULT_BATCH_SIZE;
+    stats->file_bytes_before = db_file_bytes(db);
+
+    /* Dry run: mark inside a transaction that is rolled back */
+    if (!gc_exec(db, "BEGIN;")) return false;
+    if (!backfill_edges(db) || !gc_mark(db, stats)) {
+        gc_exec(db, "ROLLBACK;");
+        return false;
+    }
+    if (opts->dry_run) {
+        gc_exec(db, "ROLLBACK;");
+        stats->file_bytes_after = stats->file_bytes_before;
+        return true;
+    }
+    if (!gc_exec(db, "COMMIT;")) return false;
+
+    DEBUG_DB("GC: %lld live, %lld dead blobs",
+             (long long)stats->live_blobs, (long long)stats->dead_blobs);
+
+    /* Unreachable modules (cascades to their exports/imports) */
+    if (stats->dead_modules > 0 &&
+        !gc_exec(db, "DELETE FROM modules WHERE id NOT IN (SELECT id FROM gc_live_modules);")) {
+        return false;
+    }
+
+    /* Edges out of dead blobs first, then the blobs themselves */
+    static const char* const edge_sweep[] = {
+        "DELETE FROM edges WHERE from_cid IN "
+        "(SELECT cid FROM gc_dead WHERE rowid > ?1 AND rowid <= ?2);",
+    };
+    static const char* const blob_sweep[] = {
+        "DELETE FROM defs WHERE cid IN "
+        "(SELECT cid FROM gc_dead WHERE rowid > ?1 AND rowid <= ?2);",
+        "DELETE FROM specializations WHERE cid IN "
+        "(SELECT cid FROM gc_dead WHERE rowid > ?1 AND rowid <= ?2);",
+        "DELETE FROM blobs WHERE cid IN "
+        "(SELECT cid FROM gc_dead WHERE rowid > ?1 AND rowid <= ?2);",
+    };
+    static const char* const sig_sweep[] = {
+        "DELETE FROM type_signatures WHERE sig_cid IN "
+        "(SELECT sig_cid FROM gc_dead_sigs WHERE rowid > ?1 AND rowid <= ?2);",
+    };
+
+    if (!gc_sweep_batched(db, "gc_dead", edge_sweep, 1, batch_size) ||
+        !gc_sweep_batched(db, "gc_dead", blob_sweep, 3, batch_size) ||
+        !gc_sweep_batched(db, "gc_dead_sigs", sig_sweep, 1, batch_size)) {
+        return false;
+    }
+
+    gc_exec(db,
+        "DROP TABLE IF EXISTS temp.gc_roots;"
+        "DROP TABLE IF EXISTS temp.gc_live;"
+        "DROP TABLE IF EXISTS temp.gc_live_modules;"
+        "DROP TABLE IF EXISTS temp.gc_live_sigs;"
+        "DROP TABLE IF EXISTS temp.gc_dead;"
+        "DROP TABLE IF EXISTS temp.gc_dead_sigs;");
+
+    if (opts->vacuum && !gc_exec(db, "VACUUM;")) {
+        return false;
+    }
+
+    stats->file_bytes_after = db_file_bytes(db);
+    return true;
+}
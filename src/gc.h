@@ -0,0 +1,40 @@
+/*
+ * March Language - Blob Garbage Collector
+ * Mark from roots (words, root modules, state) along the edges table,
+ * sweep unreachable blobs and type signatures
+ */
+
+#ifndef MARCH_GC_H
+#define MARCH_GC_H
+
+#include "database.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* GC options */
+typedef struct {
+    bool dry_run;        /* Mark and report only, delete nothing */
+    bool vacuum;         /* VACUUM after sweeping */
+    int batch_size;      /* Rows deleted per transaction */
+} gc_options_t;
+
+#define GC_DEFAULT_BATCH_SIZE 1000
+
+/* GC results */
+typedef struct {
+    int64_t live_blobs;
+    int64_t dead_blobs;
+    int64_t dead_sigs;
+    int64_t dead_modules;
+    int64_t bytes_reclaimed;     /* Blob payload bytes swept */
+    int64_t file_bytes_before;   /* Database file size (pages) */
+    int64_t file_bytes_after;
+} gc_stats_t;
+
+/* Fill options with defaults */
+void gc_options_init(gc_options_t* opts);
+
+/* Collect unreachable blobs. Returns false on database error. */
+bool gc_collect(march_db_t* db, const gc_options_t* opts, gc_stats_t* stats);
+
+#endif /* MARCH_GC_H */
@@ -0,0 +1,234 @@
+/*
+ * March Language - Primitive Table Generator
+ * Registers primitives.def in a real dictionary (the same dict_add and
+ * parse_type_sig the compiler would run at startup) and prints the result
+ * as static, perfect-hashed builtin tables:
+ *
+ *   PRIMTAB_RUNTIME  - primitive_builtins, the kernel primitives
+ *   PRIMTAB_COMPILER - compiler_builtins, primitives plus immediate words
+ *
+ * Usage: gen_primtab > primtab.h
+ */
+
+#include "dictionary.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SEED 65535
+
+typedef struct {
+    const char* name;
+    uint16_t prim_id;
+    const char* symbol;      /* Kernel op or immediate handler */
+    const char* sig;
+    bool is_immediate;
+} prim_decl_t;
+
+static const prim_decl_t decls[] = {
+#define PRIMITIVE(id, value, name, op, sig) { name, PRIM_##id, #op, sig, false },
+#define IMMEDIATE(name, id, handler, sig) { name, PRIM_##id, #handler, sig, true },
+#include "primitives.def"
+};
+
+#define DECL_COUNT (sizeof(decls) / sizeof(decls[0]))
+
+static size_t pow2_at_least(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static int entry_index(dictionary_t* dict, const dict_entry_t* entry) {
+    for (size_t i = 0; i < dict->entry_count; i++) {
+        if (dict->entries[i] == entry) return (int)i;
+    }
+    return -1;
+}
+
+/* Hash and displace: place the biggest buckets first, each under the
+ * first seed that sends all of its names to distinct free slots */
+static bool place_groups(dict_group_t** groups, size_t count, size_t slot_count,
+                         size_t seed_count, uint16_t* seeds, size_t* slot_of) {
+    size_t* bucket_size = calloc(seed_count, sizeof(size_t));
+    bool* taken = calloc(slot_count, sizeof(bool));
+    bool ok = bucket_size && taken;
+
+    for (size_t i = 0; ok && i < count; i++) {
+        bucket_size[groups[i]->hash & (seed_count - 1)]++;
+    }
+
+    for (size_t size = count; ok && size > 0; size--) {
+        for (size_t b = 0; ok && b < seed_count; b++) {
+            if (bucket_size[b] != size) continue;
+
+            bool placed = false;
+            for (unsigned seed = 0; seed <= MAX_SEED && !placed; seed++) {
+                placed = true;
+                for (size_t i = 0; i < count && placed; i++) {
+                    if ((groups[i]->hash & (seed_count - 1)) != b) continue;
+                    slot_of[i] = dict_builtin_slot(groups[i]->hash, (uint16_t)seed, slot_count);
+                    placed = !taken[slot_of[i]];
+                    for (size_t k = 0; k < i && placed; k++) {
+                        placed = (groups[k]->hash & (seed_count - 1)) != b ||
+                                 slot_of[k] != slot_of[i];
+                    }
+                }
+                if (placed) seeds[b] = (uint16_t)seed;
+            }
+            if (!placed) {
+                fprintf(stderr, "Error: No seed places bucket %zu\n", b);
+                ok = false;
+            }
+            for (size_t i = 0; ok && i < count; i++) {
+                if ((groups[i]->hash & (seed_count - 1)) == b) taken[slot_of[i]] = true;
+            }
+        }
+    }
+
+    free(bucket_size);
+    free(taken);
+    return ok;
+}
+
+static void print_types(const type_id_t* types, int count) {
+    printf("{");
+    for (int i = 0; i < count; i++) printf("%s%d", i ? ", " : "", types[i]);
+    printf("%s}", count ? "" : "0");
+}
+
+static void print_sig(const type_sig_t* sig) {
+    printf(".signature = { ");
+    print_types(sig->inputs, sig->input_count);
+    printf(", %d, ", sig->input_count);
+    print_types(sig->outputs, sig->output_count);
+    printf(", %d }", sig->output_count);
+}
+
+static bool emit_table(const char* guard, const char* prefix, const char* storage,
+                       bool with_immediates) {
+    dictionary_t* dict = dict_create();
+    if (!dict) return false;
+
+    /* Groups in order of first definition; the declaration of each entry */
+    const char** group_names = malloc(sizeof(char*) * DECL_COUNT);
+    dict_group_t** groups = malloc(sizeof(dict_group_t*) * DECL_COUNT);
+    const prim_decl_t** decl_of = malloc(sizeof(prim_decl_t*) * DECL_COUNT);
+    size_t group_count = 0;
+    bool ok = group_names && groups && decl_of;
+
+    for (size_t i = 0; ok && i < DECL_COUNT; i++) {
+        const prim_decl_t* d = &decls[i];
+        if (d->is_immediate && !with_immediates) continue;
+
+        type_sig_t sig;
+        if (!parse_type_sig(d->sig, &sig)) {
+            fprintf(stderr, "Error: Bad signature for '%s': %s\n", d->name, d->sig);
+            ok = false;
+            break;
+        }
+        if (!dict_lookup_group(dict, d->name)) group_names[group_count++] = d->name;
+        decl_of[dict->entry_count] = d;
+        ok = dict_add(dict, d->name, NULL, NULL, d->prim_id, &sig, !d->is_immediate,
+                      d->is_immediate, NULL, NULL);
+    }
+    for (size_t g = 0; ok && g < group_count; g++) {
+        groups[g] = dict_lookup_group(dict, group_names[g]);
+    }
+
+    size_t slot_count = pow2_at_least(group_count * 2);
+    size_t seed_count = pow2_at_least((group_count + 3) / 4);
+    uint16_t* seeds = calloc(seed_count, sizeof(uint16_t));
+    size_t* slot_of = calloc(group_count + 1, sizeof(size_t));
+    ok = ok && seeds && slot_of &&
+         place_groups(groups, group_count, slot_count, seed_count, seeds, slot_of);
+
+    if (ok) {
+        printf("\n#ifdef %s\n\n", guard);
+
+        /* Entries, in definition order */
+        printf("static dict_entry_t %s_entries[%zu] = {\n", prefix, dict->entry_count);
+        for (size_t i = 0; i < dict->entry_count; i++) {
+            dict_entry_t* e = dict->entries[i];
+            const prim_decl_t* d = decl_of[i];
+            printf("    { .name = (char*)\"%s\", ", e->name);
+            if (d->is_immediate) {
+                printf(".handler = (immediate_handler_t)%s, ", d->symbol);
+            } else {
+                printf(".addr = (void*)&%s, ", d->symbol);
+            }
+            printf(".prim_id = %u, ", e->prim_id);
+            print_sig(&e->signature);
+            printf(", .is_primitive = %s, .is_immediate = %s, .priority = %d, .order = %zu, ",
+                   e->is_primitive ? "true" : "false", e->is_immediate ? "true" : "false",
+                   e->priority, e->order);
+            if (e->next) {
+                printf(".next = &%s_entries[%d] },", prefix, entry_index(dict, e->next));
+            } else {
+                printf(".next = NULL },");
+            }
+            printf("  /* %s */\n", d->sig);
+        }
+        printf("};\n\n");
+
+        /* Dispatch arrays, one run per group */
+        printf("static dict_entry_t* %s_dispatch[%zu] = {\n", prefix, dict->entry_count);
+        for (size_t g = 0; g < group_count; g++) {
+            printf("   ");
+            for (int k = 0; k < groups[g]->count; k++) {
+                printf(" &%s_entries[%d],", prefix, entry_index(dict, groups[g]->dispatch[k]));
+            }
+            printf("  /* %s */\n", groups[g]->name);
+        }
+        printf("};\n\n");
+
+        printf("static dict_group_t %s_groups[%zu] = {\n", prefix, group_count);
+        size_t offset = 0;
+        for (size_t g = 0; g < group_count; g++) {
+            dict_group_t* grp = groups[g];
+            printf("    { .name = \"%s\", .hash = %luUL, .latest = &%s_entries[%d], "
+                   ".dispatch = &%s_dispatch[%zu], .count = %d, .capacity = %d, .arity_end = {",
+                   grp->name, grp->hash, prefix, entry_index(dict, grp->latest),
+                   prefix, offset, grp->count, grp->count);
+            for (int n = 0; n <= 8; n++) printf("%s%u", n ? ", " : "", grp->arity_end[n]);
+            printf("} },\n");
+            offset += (size_t)grp->count;
+        }
+        printf("};\n\n");
+
+        printf("static const uint16_t %s_seeds[%zu] = {", prefix, seed_count);
+        for (size_t b = 0; b < seed_count; b++) printf("%s%u", b ? ", " : "", seeds[b]);
+        printf("};\n\n");
+
+        printf("static dict_group_t* const %s_slots[%zu] = {\n", prefix, slot_count);
+        for (size_t g = 0; g < group_count; g++) {
+            printf("    [%zu] = &%s_groups[%zu],\n", slot_of[g], prefix, g);
+        }
+        printf("};\n\n");
+
+        printf("%sconst dict_builtins_t %s_builtins = {\n", storage, prefix);
+        printf("    .slots = %s_slots,\n    .seeds = %s_seeds,\n", prefix, prefix);
+        printf("    .slot_count = %zu,\n    .seed_count = %zu,\n", slot_count, seed_count);
+        printf("    .entries = %s_entries,\n    .entry_count = %zu,\n", prefix, dict->entry_count);
+        printf("};\n\n#endif /* %s */\n", guard);
+    }
+
+    free(group_names);
+    free(groups);
+    free(decl_of);
+    free(seeds);
+    free(slot_of);
+    dict_free(dict);
+    return ok;
+}
+
+int main(void) {
+    printf("/* Generated by gen_primtab from primitives.def - do not edit */\n");
+
+    if (!emit_table("PRIMTAB_RUNTIME", "primitive", "", false) ||
+        !emit_table("PRIMTAB_COMPILER", "compiler", "static ", true)) {
+        return 1;
+    }
+    return 0;
+}
@@ -187,6 +187,34 @@ uint64_t hamt_get(void* node, uint64_t key) {
 static void* hamt_set_impl(void* node, uint64_t key, uint64_t value,
                           uint64_t hash, int level, bool* inserted);
 
+// Nodes off the hash's path are shared by both roots; on the path, old
+// nodes are replaced down to the first one new_root still uses
+static void hamt_release_path(void* old_root, void* new_root, uint64_t hash, int level) {
+    for (; old_root && old_root != new_root; level++) {
+        int chunk = hamt_chunk(hash, level);
+        uint32_t bit = 1U << chunk;
+        void* old_child = NULL;
+        void* new_child = NULL;
+
+        hamt_header_t* header = hamt_get_header(old_root);
+        if (header->bitmap & bit) {
+            hamt_slot_t* slot = &hamt_get_slots(old_root)[hamt_slot_index(header->bitmap, chunk)];
+            if (hamt_is_child((void*)slot->value)) old_child = (void*)slot->value;
+        }
+        if (new_root) {
+            hamt_header_t* new_header = hamt_get_header(new_root);
+            if (new_header->bitmap & bit) {
+                hamt_slot_t* slot = &hamt_get_slots(new_root)[hamt_slot_index(new_header->bitmap, chunk)];
+                if (hamt_is_child((void*)slot->value)) new_child = (void*)slot->value;
+            }
+        }
+
+        free(header);
+        old_root = old_child;
+        new_root = new_child;
+    }
+}
+
 void* hamt_set(void* node, uint64_t key, uint64_t value) {
     trace_push_value(key, "hamt_set(node=%p, key=%lu, value=%lu)", node, key, value);
 
@@ -278,8 +306,9 @@ static void* hamt_set_impl(void* node, uint64_t key, uint64_t value,
             uint64_t old_hash = hamt_hash(old_key);
 
             // Create child node with both keys
-            void* child = hamt_set_impl(NULL, old_key, old_value, old_hash, level + 1, inserted);
-            child = hamt_set_impl(child, key, value, hash, level + 1, inserted);
+            void* first = hamt_set_impl(NULL, old_key, old_value, old_hash, level + 1, inserted);
+            void* child = hamt_set_impl(first, key, value, hash, level + 1, inserted);
+            hamt_release_path(first, child, hash, level + 1);
 
             // Clone current node and convert this slot to point to child (untagged)
             void* new_node = hamt_clone_node(node);
@@ -460,3 +489,7 @@ void hamt_free(void* node) {
     // Free this node (header is 32 bytes before slots)
     free(header);
 }
+
+void hamt_release(void* old_root, void* new_root, uint64_t key) {
+    hamt_release_path(old_root, new_root, hamt_hash(key), 0);
+}
@@ -76,6 +76,11 @@ uint64_t hamt_size(void* node);
 // WARNING: Does not free values if they are heap pointers!
 void hamt_free(void* node);
 
+// Free the nodes of old_root that were path-copied by the hamt_set or
+// hamt_remove of key that returned new_root. Only for an owner holding
+// the sole reference to old_root (e.g. a table updated in place).
+void hamt_release(void* old_root, void* new_root, uint64_t key);
+
 /*
  * Utility functions
  */
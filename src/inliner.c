@@ -0,0 +1,237 @@
+/*
+ * March Language - Inliner Implementation
+ *
+ * Callees are decoded from their stored blobs, so words compiled in an
+ * earlier run inline exactly like words compiled in this one. One level
+ * only: a callee compiled at -O 2 has already inlined its own callees.
+ */
+
+#include "inliner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PRIM_TABLE_SIZE 256
+
+typedef struct {
+    march_db_t* db;
+    dictionary_t* dict;
+    void* prim_addr[PRIM_TABLE_SIZE];   /* XT by primitive ID */
+    bool prim_table_ready;
+} inliner_t;
+
+void inline_deps_clear(inline_deps_t* deps) {
+    deps->count = 0;
+}
+
+void inline_deps_free(inline_deps_t* deps) {
+    free(deps->cids);
+    deps->cids = NULL;
+    deps->count = 0;
+    deps->capacity = 0;
+}
+
+bool inline_deps_add(inline_deps_t* deps, const unsigned char* cid) {
+    for (size_t i = 0; i < deps->count; i++) {
+        if (memcmp(deps->cids[i], cid, CID_SIZE) == 0) return true;
+    }
+    if (deps->count >= deps->capacity) {
+        size_t capacity = deps->capacity ? deps->capacity * 2 : 8;
+        void* cids = realloc(deps->cids, CID_SIZE * capacity);
+        if (!cids) return false;
+        deps->cids = cids;
+        deps->capacity = capacity;
+    }
+    memcpy(deps->cids[deps->count++], cid, CID_SIZE);
+    return true;
+}
+
+void inline_deps_store(march_db_t* db, const unsigned char* from_cid,
+                       const inline_deps_t* deps) {
+    for (size_t i = 0; i < deps->count; i++) {
+        db_store_edge(db, from_cid, deps->cids[i], "inline");
+    }
+}
+
+/* Decoded blobs carry primitive IDs only; cells lowering needs XTs */
+static void* prim_addr(inliner_t* in, uint16_t prim_id) {
+    if (!in->prim_table_ready) {
+        for (size_t i = 0; i < dict_entry_count(in->dict); i++) {
+            dict_entry_t* e = dict_entry_at(in->dict, i);
+            if (e->is_primitive && e->prim_id < PRIM_TABLE_SIZE && !in->prim_addr[e->prim_id]) {
+                in->prim_addr[e->prim_id] = e->addr;
+            }
+        }
+        in->prim_table_ready = true;
+    }
+    return prim_id < PRIM_TABLE_SIZE ? in->prim_addr[prim_id] : NULL;
+}
+
+/* Would see (or, for tailcall, pop) a different return stack once
+ * spliced into the caller. A memoized word keeps its table entry there,
+ * and must stay a call to be answered from the table at all. */
+static bool uses_return_stack(uint16_t prim_id) {
+    switch (prim_id) {
+        case PRIM_TOR:
+        case PRIM_FROMR:
+        case PRIM_RFETCH:
+        case PRIM_RDROP:
+        case PRIM_TWOTOR:
+        case PRIM_TWOFROMR:
+        case PRIM_I0:
+        case PRIM_TAILCALL:
+        case PRIM_MEMO_ENTER:
+        case PRIM_MEMO_EXIT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Data references: recover i64 literal values so the peephole can fold
+ * through the spliced code */
+static void resolve_data_ref(inliner_t* in, ir_instr_t* ref) {
+    int kind = -1;
+    uint8_t* data = NULL;
+    size_t len = 0;
+    if (!db_load_blob_ex(in->db, ref->cid, &kind, NULL, &data, &len)) return;
+
+    if (kind == BLOB_DATA && len == 8 && data) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= (uint64_t)data[i] << (i * 8);
+        }
+        ref->value = (int64_t)value;
+        ref->type = TYPE_I64;
+    } else if (kind == BLOB_STRING) {
+        ref->type = TYPE_STR;
+    }
+    free(data);
+}
+
+/* Decoded body of a small callee, or NULL if it should stay a call */
+static ir_buffer_t* load_callee(inliner_t* in, const unsigned char* cid, uint16_t expected_kind) {
+    int kind = -1;
+    uint8_t* data = NULL;
+    size_t len = 0;
+    if (!db_load_blob_ex(in->db, cid, &kind, NULL, &data, &len)) return NULL;
+
+    /* Cheap bound before decoding: no entry is larger than a CID reference */
+    ir_buffer_t* body = NULL;
+    if (kind == expected_kind && len <= INLINE_MAX_CELLS * (2 + CID_SIZE)) {
+        body = ir_buffer_create();
+        if (body && !ir_decode_blob(body, data ? data : (const uint8_t*)"", len)) {
+            ir_buffer_free(body);
+            body = NULL;
+        }
+    }
+    free(data);
+    if (!body) return NULL;
+
+    bool inlinable = ir_cell_count(body) <= INLINE_MAX_CELLS;
+    for (size_t i = 0; inlinable && i < body->count; i++) {
+        ir_instr_t* instr = &body->instrs[i];
+        switch (instr->op) {
+            case IR_PRIM:
+                inlinable = !uses_return_stack(instr->prim_id);
+                instr->addr = prim_addr(in, instr->prim_id);
+                break;
+            case IR_BRANCH:
+                instr->addr = prim_addr(in, instr->prim_id);
+                break;
+            case IR_RECURSE:
+                inlinable = false;      /* Would call the caller */
+                break;
+            case IR_REF:
+                if (instr->ref_kind == BLOB_DATA) {
+                    resolve_data_ref(in, instr);
+                } else if (instr->ref_kind == BLOB_QUOTATION) {
+                    instr->type = TYPE_PTR;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (!inlinable) {
+        ir_buffer_free(body);
+        return NULL;
+    }
+    return body;
+}
+
+bool inline_ir(ir_buffer_t* ir, march_db_t* db, dictionary_t* dict,
+               inline_deps_t* deps, optimizer_stats_t* stats) {
+    inliner_t in;
+    memset(&in, 0, sizeof(in));
+    in.db = db;
+    in.dict = dict;
+
+    ir_buffer_t* out = NULL;    /* Created at the first splice */
+    size_t copied = 0;          /* ir->instrs[0..copied) are in out */
+
+    for (size_t i = 0; i < ir->count; i++) {
+        const ir_instr_t* instr = &ir->instrs[i];
+        if (instr->op != IR_REF) continue;
+
+        ir_buffer_t* body = NULL;
+        size_t consumed = 1;
+        if (instr->ref_kind == BLOB_WORD) {
+            body = load_callee(&in, instr->cid, BLOB_WORD);
+        } else if (instr->ref_kind == BLOB_QUOTATION && i + 1 < ir->count &&
+                   ir->instrs[i + 1].op == IR_PRIM &&
+                   ir->instrs[i + 1].prim_id == PRIM_EXECUTE) {
+            body = load_callee(&in, instr->cid, BLOB_QUOTATION);
+            consumed = 2;
+        }
+        if (!body) continue;
+
+        if (!out) {
+            out = ir_buffer_create();
+            if (!out) {
+                ir_buffer_free(body);
+                return false;
+            }
+            out->label_count = ir->label_count;
+        }
+
+        /* Instructions since the last splice, then the callee body */
+        bool ok = true;
+        for (size_t j = copied; ok && j < i; j++) {
+            ok = ir_emit(out, &ir->instrs[j]);
+        }
+        ok = ok && ir_append(out, body);
+        if (ok && deps) {
+            ok = inline_deps_add(deps, instr->cid);
+        }
+        ir_buffer_free(body);
+        if (!ok) {
+            ir_buffer_free(out);
+            return false;
+        }
+
+        if (stats) stats->inlined++;
+        copied = i + consumed;
+        i = copied - 1;
+    }
+
+    if (!out) return true;
+
+    /* Tail, then swap the rewritten instructions into ir */
+    for (size_t j = copied; j < ir->count; j++) {
+        if (!ir_emit(out, &ir->instrs[j])) {
+            ir_buffer_free(out);
+            return false;
+        }
+    }
+
+    ir_instr_t* instrs = ir->instrs;
+    ir->instrs = out->instrs;
+    ir->count = out->count;
+    ir->capacity = out->capacity;
+    ir->label_count = out->label_count;
+    out->instrs = instrs;
+    ir_buffer_free(out);
+    return true;
+}
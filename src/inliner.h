@@ -0,0 +1,44 @@
+/*
+ * March Language - Inliner
+ * Splices small callee blobs into their call sites (marchc -O 2)
+ */
+
+#ifndef MARCH_INLINER_H
+#define MARCH_INLINER_H
+
+#include "ir.h"
+#include "optimizer.h"
+#include "dictionary.h"
+#include "database.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Largest callee body (in cells) spliced into a caller. A call costs two
+ * dispatches (the call and EXIT), so small bodies cost little code. */
+#define INLINE_MAX_CELLS 8
+
+/* Callee CIDs spliced into a blob: the blob no longer references them,
+ * so they are recorded as 'inline' edges (dependent invalidation follows
+ * edges, including through an inlined quotation to the words it inlined) */
+typedef struct {
+    unsigned char (*cids)[CID_SIZE];
+    size_t count;
+    size_t capacity;
+} inline_deps_t;
+
+void inline_deps_clear(inline_deps_t* deps);
+void inline_deps_free(inline_deps_t* deps);
+bool inline_deps_add(inline_deps_t* deps, const unsigned char* cid);
+
+/* Replace calls to small BLOB_WORD callees, and "quotation execute" where
+ * the quotation is a literal, with the stored callee code. Callees that
+ * touch the return stack are left as calls (they would see the caller's
+ * frame). deps and stats may be NULL. */
+bool inline_ir(ir_buffer_t* ir, march_db_t* db, dictionary_t* dict,
+               inline_deps_t* deps, optimizer_stats_t* stats);
+
+/* Record deps as 'inline' edges from the blob stored as from_cid */
+void inline_deps_store(march_db_t* db, const unsigned char* from_cid,
+                       const inline_deps_t* deps);
+
+#endif /* MARCH_INLINER_H */
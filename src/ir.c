@@ -0,0 +1,380 @@
+/*
+ * March Language - Compiler IR Implementation
+ */
+
+#include "ir.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+ir_buffer_t* ir_buffer_create(void) {
+    ir_buffer_t* ir = malloc(sizeof(ir_buffer_t));
+    if (!ir) return NULL;
+
+    ir->capacity = 64;
+    ir->count = 0;
+    ir->label_count = 0;
+    ir->instrs = malloc(sizeof(ir_instr_t) * ir->capacity);
+
+    if (!ir->instrs) {
+        free(ir);
+        return NULL;
+    }
+
+    return ir;
+}
+
+void ir_buffer_free(ir_buffer_t* ir) {
+    if (ir) {
+        free(ir->instrs);
+        free(ir);
+    }
+}
+
+void ir_buffer_clear(ir_buffer_t* ir) {
+    ir->count = 0;
+    ir->label_count = 0;
+}
+
+/* Append a zeroed instruction, growing the array */
+static ir_instr_t* ir_push(ir_buffer_t* ir, ir_op_t op) {
+    if (ir->count >= ir->capacity) {
+        size_t capacity = ir->capacity * 2;
+        ir_instr_t* instrs = realloc(ir->instrs, sizeof(ir_instr_t) * capacity);
+        if (!instrs) {
+            fprintf(stderr, "ir: out of memory\n");
+            return NULL;
+        }
+        ir->instrs = instrs;
+        ir->capacity = capacity;
+    }
+
+    ir_instr_t* in = &ir->instrs[ir->count++];
+    memset(in, 0, sizeof(*in));
+    in->op = op;
+    in->type = TYPE_UNKNOWN;
+    return in;
+}
+
+bool ir_emit_prim(ir_buffer_t* ir, uint16_t prim_id, void* addr) {
+    ir_instr_t* in = ir_push(ir, IR_PRIM);
+    if (!in) return false;
+    in->prim_id = prim_id;
+    in->addr = addr;
+    return true;
+}
+
+bool ir_emit_lit(ir_buffer_t* ir, int64_t value) {
+    ir_instr_t* in = ir_push(ir, IR_LIT);
+    if (!in) return false;
+    in->value = value;
+    in->type = TYPE_I64;
+    return true;
+}
+
+bool ir_emit_ref(ir_buffer_t* ir, uint16_t kind, const unsigned char* cid,
+                 type_id_t type, int64_t value) {
+    ir_instr_t* in = ir_push(ir, IR_REF);
+    if (!in) return false;
+    in->ref_kind = kind;
+    memcpy(in->cid, cid, CID_SIZE);
+    in->type = type;
+    in->value = value;
+    return true;
+}
+
+bool ir_emit_branch(ir_buffer_t* ir, uint16_t prim_id, void* addr, int label) {
+    ir_instr_t* in = ir_push(ir, IR_BRANCH);
+    if (!in) return false;
+    in->prim_id = prim_id;
+    in->addr = addr;
+    in->value = label;
+    return true;
+}
+
+bool ir_emit_label(ir_buffer_t* ir, int label) {
+    ir_instr_t* in = ir_push(ir, IR_LABEL);
+    if (!in) return false;
+    in->value = label;
+    return true;
+}
+
+bool ir_emit(ir_buffer_t* ir, const ir_instr_t* instr) {
+    ir_instr_t* in = ir_push(ir, instr->op);
+    if (!in) return false;
+    *in = *instr;
+    return true;
+}
+
+bool ir_emit_recurse(ir_buffer_t* ir) {
+    return ir_push(ir, IR_RECURSE) != NULL;
+}
+
+int ir_new_label(ir_buffer_t* ir) {
+    return ir->label_count++;
+}
+
+bool ir_append(ir_buffer_t* dst, const ir_buffer_t* src) {
+    int base = dst->label_count;
+    for (size_t i = 0; i < src->count; i++) {
+        if (!ir_emit(dst, &src->instrs[i])) return false;
+        ir_instr_t* in = &dst->instrs[dst->count - 1];
+        if (in->op == IR_BRANCH || in->op == IR_LABEL) {
+            in->value += base;
+        }
+    }
+    dst->label_count += src->label_count;
+    return true;
+}
+
+size_t ir_cell_count(const ir_buffer_t* ir) {
+    size_t cells = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        switch (ir->instrs[i].op) {
+            case IR_LABEL:  break;
+            case IR_BRANCH: cells += 2; break;
+            default:        cells += 1; break;
+        }
+    }
+    return cells;
+}
+
+/* Blob entry at data[pos]: 2-byte tag, then 8 literal bytes or a CID */
+static size_t ir_blob_entry_size(const uint8_t* data, size_t pos, size_t size) {
+    if (pos + 2 > size) return 0;
+    uint16_t tag = data[pos] | (data[pos + 1] << 8);
+    size_t len = 2;
+    if (tag & 1) {
+        len += CID_SIZE;
+    } else if ((tag >> 1) == PRIM_LIT) {
+        len += 8;
+    }
+    return pos + len <= size ? len : 0;
+}
+
+static int64_t ir_blob_literal(const uint8_t* data, size_t pos) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)data[pos + 2 + i] << (i * 8);
+    }
+    return (int64_t)value;
+}
+
+bool ir_decode_blob(ir_buffer_t* ir, const uint8_t* data, size_t size) {
+    /* Pass 1: count cells and collect branch targets (one label each) */
+    size_t branch_count = 0;
+    int64_t cells = 0;
+    for (size_t pos = 0, len; pos < size; pos += len) {
+        if ((len = ir_blob_entry_size(data, pos, size)) == 0) return false;
+        uint16_t prim = (data[pos] | (data[pos + 1] << 8)) >> 1;
+        if (!(data[pos] & 1) && (prim == PRIM_BRANCH || prim == PRIM_0BRANCH)) {
+            branch_count++;
+        }
+        cells++;
+    }
+
+    int64_t* targets = malloc(sizeof(int64_t) * (branch_count > 0 ? branch_count : 1));
+    int* labels = malloc(sizeof(int) * (branch_count > 0 ? branch_count : 1));
+    if (!targets || !labels) {
+        free(targets);
+        free(labels);
+        return false;
+    }
+
+    size_t label_count = 0;
+    bool ok = true;
+    int64_t cell = 0;
+    for (size_t pos = 0; ok && pos < size; cell++) {
+        size_t len = ir_blob_entry_size(data, pos, size);
+        uint16_t tag = data[pos] | (data[pos + 1] << 8);
+        if (!(tag & 1) && ((tag >> 1) == PRIM_BRANCH || (tag >> 1) == PRIM_0BRANCH)) {
+            /* Offset literal follows, counted from the cell after it */
+            size_t lit = pos + len;
+            size_t lit_len = ir_blob_entry_size(data, lit, size);
+            if (lit_len != 10 || data[lit] != (PRIM_LIT << 1) || data[lit + 1] != 0) {
+                ok = false;
+                break;
+            }
+            int64_t target = cell + 2 + ir_blob_literal(data, lit);
+            if (target < 0 || target > cells) {
+                ok = false;
+                break;
+            }
+            size_t i = 0;
+            while (i < label_count && targets[i] != target) i++;
+            if (i == label_count) {
+                targets[label_count] = target;
+                labels[label_count++] = ir_new_label(ir);
+            }
+            len += lit_len;
+            cell++;
+        }
+        pos += len;
+    }
+
+    /* Pass 2: emit, placing labels before the cell they target */
+    size_t placed = 0;
+    cell = 0;
+    for (size_t pos = 0; ok && pos <= size; cell++) {
+        for (size_t i = 0; ok && i < label_count; i++) {
+            if (targets[i] == cell) {
+                ok = ir_emit_label(ir, labels[i]);
+                placed++;
+            }
+        }
+        if (pos == size || !ok) break;
+
+        size_t len = ir_blob_entry_size(data, pos, size);
+        uint16_t tag = data[pos] | (data[pos + 1] << 8);
+        if (tag & 1) {
+            ok = ir_emit_ref(ir, tag >> 1, data + pos + 2, TYPE_UNKNOWN, 0);
+        } else if ((tag >> 1) == PRIM_LIT) {
+            ok = ir_emit_lit(ir, ir_blob_literal(data, pos));
+        } else if ((tag >> 1) == PRIM_BRANCH || (tag >> 1) == PRIM_0BRANCH) {
+            int64_t target = cell + 2 + ir_blob_literal(data, pos + len);
+            size_t i = 0;
+            while (targets[i] != target) i++;
+            ok = ir_emit_branch(ir, tag >> 1, NULL, labels[i]);
+            len += 10;
+            cell++;
+        } else if ((tag >> 1) == PRIM_RECURSE) {
+            ok = ir_emit_recurse(ir);
+        } else {
+            ok = ir_emit_prim(ir, tag >> 1, NULL);
+        }
+        pos += len;
+    }
+
+    free(targets);
+    free(labels);
+    /* A target inside a branch (its offset cell) has no label */
+    return ok && placed == label_count;
+}
+
+/* Cell position of every label (caller must free) */
+static int64_t* ir_resolve_labels(const ir_buffer_t* ir) {
+    int64_t* pos = malloc(sizeof(int64_t) * (ir->label_count > 0 ? ir->label_count : 1));
+    if (!pos) return NULL;
+    for (int i = 0; i < ir->label_count; i++) {
+        pos[i] = INT64_MIN;     /* Unplaced */
+    }
+
+    int64_t cell = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        if (in->op == IR_LABEL) {
+            pos[in->value] = cell;
+        } else {
+            cell += (in->op == IR_BRANCH) ? 2 : 1;
+        }
+    }
+    return pos;
+}
+
+/* Offset of a branch at cell position 'cell' to its label, in cells
+ * from the cell after the offset */
+static bool ir_branch_offset(const int64_t* labels, const ir_instr_t* in,
+                             int64_t cell, int64_t* offset) {
+    int64_t target = labels[in->value];
+    if (target == INT64_MIN) {
+        fprintf(stderr, "ir: branch to unplaced label %lld\n", (long long)in->value);
+        return false;
+    }
+    *offset = target - (cell + 2);
+    return true;
+}
+
+bool ir_lower_blob(const ir_buffer_t* ir, blob_buffer_t* buf) {
+    int64_t* labels = ir_resolve_labels(ir);
+    if (!labels) return false;
+
+    int64_t cell = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        switch (in->op) {
+            case IR_PRIM:
+                encode_primitive(buf, in->prim_id);
+                cell++;
+                break;
+            case IR_LIT:
+                encode_inline_literal(buf, in->value);
+                cell++;
+                break;
+            case IR_REF:
+                encode_cid_ref(buf, in->ref_kind, in->cid);
+                cell++;
+                break;
+            case IR_BRANCH: {
+                int64_t offset;
+                if (!ir_branch_offset(labels, in, cell, &offset)) {
+                    free(labels);
+                    return false;
+                }
+                encode_primitive(buf, in->prim_id);
+                encode_inline_literal(buf, offset);
+                cell += 2;
+                break;
+            }
+            case IR_LABEL:
+                break;
+            case IR_RECURSE:
+                /* The loader links it to the word's own XT */
+                encode_primitive(buf, PRIM_RECURSE);
+                cell++;
+                break;
+        }
+    }
+
+    free(labels);
+    return true;
+}
+
+bool ir_lower_cells(const ir_buffer_t* ir, cell_buffer_t* buf) {
+    int64_t* labels = ir_resolve_labels(ir);
+    if (!labels) return false;
+
+    int64_t cell = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        switch (in->op) {
+            case IR_PRIM:
+                cell_buffer_append(buf, encode_xt(in->addr));
+                cell++;
+                break;
+            case IR_LIT:
+                cell_buffer_append(buf, encode_lit(in->value));
+                cell++;
+                break;
+            case IR_REF:
+                /* Words are linked by CID; data and quotations by the loader */
+                if (in->ref_kind == BLOB_WORD) {
+                    cell_buffer_append(buf, encode_xt(NULL));
+                } else {
+                    cell_buffer_append(buf, encode_lit(in->value));
+                }
+                cell++;
+                break;
+            case IR_BRANCH: {
+                int64_t offset;
+                if (!ir_branch_offset(labels, in, cell, &offset)) {
+                    free(labels);
+                    return false;
+                }
+                cell_buffer_append(buf, encode_xt(in->addr));
+                cell_buffer_append(buf, encode_lit(offset));
+                cell += 2;
+                break;
+            }
+            case IR_LABEL:
+                break;
+            case IR_RECURSE:
+                fprintf(stderr, "ir: recursive call needs the blob encoding\n");
+                free(labels);
+                return false;
+        }
+    }
+
+    cell_buffer_append(buf, encode_exit());
+    free(labels);
+    return true;
+}
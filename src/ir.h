@@ -0,0 +1,82 @@
+/*
+ * March Language - Compiler IR
+ * Typed instruction list produced once per word, lowered to blob or cells
+ */
+
+#ifndef MARCH_IR_H
+#define MARCH_IR_H
+
+#include "types.h"
+#include "cells.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Every instruction but IR_LABEL lowers to one cell (IR_BRANCH to two:
+ * the branch primitive and its offset), so branch offsets are computed
+ * from labels by the lowering passes instead of by each compile routine. */
+typedef enum {
+    IR_PRIM,        /* Primitive call */
+    IR_LIT,         /* Inline literal (blob tag PRIM_LIT) */
+    IR_REF,         /* CID reference: BLOB_DATA push, BLOB_WORD call, BLOB_QUOTATION
+                     * and BLOB_STATIC push address */
+    IR_BRANCH,      /* branch / 0branch primitive to label */
+    IR_LABEL,       /* Branch target (emits nothing) */
+    IR_RECURSE      /* Call of the word being compiled: its CID is not known
+                     * yet, so it is a loop (eliminate_tail_calls) or, in
+                     * blobs, PRIM_RECURSE linked to the word's own XT */
+} ir_op_t;
+
+typedef struct {
+    ir_op_t op;
+    uint16_t prim_id;               /* IR_PRIM, IR_BRANCH */
+    void* addr;                     /* IR_PRIM, IR_BRANCH: XT for threaded cells */
+    int64_t value;                  /* IR_LIT, IR_REF BLOB_DATA: value; IR_BRANCH, IR_LABEL: label */
+    type_id_t type;                 /* Type pushed (IR_LIT, IR_REF data), else TYPE_UNKNOWN */
+    uint16_t ref_kind;              /* IR_REF */
+    unsigned char cid[CID_SIZE];    /* IR_REF */
+} ir_instr_t;
+
+typedef struct {
+    ir_instr_t* instrs;
+    size_t count;
+    size_t capacity;
+    int label_count;
+} ir_buffer_t;
+
+ir_buffer_t* ir_buffer_create(void);
+void ir_buffer_free(ir_buffer_t* ir);
+void ir_buffer_clear(ir_buffer_t* ir);
+
+/* Emit (false only on allocation failure) */
+bool ir_emit_prim(ir_buffer_t* ir, uint16_t prim_id, void* addr);
+bool ir_emit_lit(ir_buffer_t* ir, int64_t value);
+bool ir_emit_ref(ir_buffer_t* ir, uint16_t kind, const unsigned char* cid,
+                 type_id_t type, int64_t value);
+bool ir_emit_branch(ir_buffer_t* ir, uint16_t prim_id, void* addr, int label);
+bool ir_emit_label(ir_buffer_t* ir, int label);
+bool ir_emit_recurse(ir_buffer_t* ir);
+
+/* Copy an instruction as is (labels are not renumbered) */
+bool ir_emit(ir_buffer_t* ir, const ir_instr_t* instr);
+
+/* Allocate a label id (placed later with ir_emit_label) */
+int ir_new_label(ir_buffer_t* ir);
+
+/* Inline src at the end of dst, renumbering its labels */
+bool ir_append(ir_buffer_t* dst, const ir_buffer_t* src);
+
+/* Number of cells the instructions lower to (labels excluded) */
+size_t ir_cell_count(const ir_buffer_t* ir);
+
+/* Inverse of ir_lower_blob: append the instructions of a stored code
+ * blob, with labels for its branch targets. Decoded IR_PRIM carry no XT
+ * and IR_REF no value or type; false if the blob is malformed. */
+bool ir_decode_blob(ir_buffer_t* ir, const uint8_t* data, size_t size);
+
+/* Lowering passes: append to buf (offsets in cells, relative to the
+ * cell after the offset). Cells get a trailing EXIT. */
+bool ir_lower_blob(const ir_buffer_t* ir, blob_buffer_t* buf);
+bool ir_lower_cells(const ir_buffer_t* ir, cell_buffer_t* buf);
+
+#endif /* MARCH_IR_H */
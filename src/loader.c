@@ -9,14 +9,19 @@
 #include "cells.h"
 #include "primitives.h"
 #include "debug.h"
+#include "bundle.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <sys/mman.h>  /* For mmap/mprotect to create executable memory */
 
 /* External reference to DOCOL (from docol.asm) */
 extern void docol(void);
 
+/* Static data region size (larger blobs get a region of their own size) */
+#define LOADER_DATA_REGION_SIZE (64 * 1024)
+
 /* ============================================================================ */
 /* CID Cache Management */
 /* ============================================================================ */
@@ -108,6 +113,13 @@ loader_t* loader_create(march_db_t* db, dictionary_t* dict) {
         return NULL;
     }
 
+    /* No static data region until the first constant array */
+    loader->data_region = NULL;
+    loader->data_region_size = 0;
+    loader->data_region_used = 0;
+    loader->data_sealed = false;
+    loader->link_depth = 0;
+
     /* Legacy word list */
     loader->word_capacity = 64;
     loader->word_count = 0;
@@ -146,7 +158,7 @@ void loader_free(loader_t* loader) {
         }
         free(loader->allocated_buffers);
 
-        /* Free mmap'd buffers (DOCOL wrappers) */
+        /* Free mmap'd buffers (DOCOL wrappers, static data) */
         for (size_t i = 0; i < loader->mmap_count; i++) {
             munmap(loader->mmap_buffers[i], loader->mmap_sizes[i]);
         }
@@ -258,6 +270,69 @@ static void track_mmap_buffer(loader_t* loader, void* buffer, size_t size) {
     loader->mmap_count++;
 }
 
+/* Make the static data region read-only (it filled, or a link finished) */
+static void seal_static_data(loader_t* loader) {
+    if (!loader->data_region || loader->data_sealed) return;
+    if (mprotect(loader->data_region, loader->data_region_size, PROT_READ) != 0) {
+        fprintf(stderr, "Error: Failed to make static data read-only\n");
+        return;
+    }
+    loader->data_sealed = true;
+}
+
+/* Link a BLOB_DATA blob. A literal value is only read while linking the
+ * code that references it; anything larger is laid-out data (a constant
+ * array) whose address is pushed. Those are packed, 8-byte aligned, into
+ * a shared region so small arrays do not take a page each. */
+static void* link_data(loader_t* loader, const uint8_t* data, size_t len) {
+    if (len <= sizeof(int64_t)) {
+        void* copy = malloc(len);
+        if (copy) {
+            memcpy(copy, data, len);
+            track_buffer(loader, copy);
+        }
+        return copy;
+    }
+
+    size_t need = (len + 7) & ~(size_t)7;
+    if (!loader->data_region || loader->data_region_used + need > loader->data_region_size) {
+        seal_static_data(loader);
+
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t size = LOADER_DATA_REGION_SIZE;
+        if (need > size) size = (need + page - 1) & ~(page - 1);
+        void* region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            fprintf(stderr, "Error: Failed to map %zu bytes of static data\n", size);
+            return NULL;
+        }
+        track_mmap_buffer(loader, region, size);
+        loader->data_region = region;
+        loader->data_region_size = size;
+        loader->data_region_used = 0;
+        loader->data_sealed = false;
+    } else if (loader->data_sealed) {
+        /* An earlier link sealed the region: reopen the pages from the
+         * bump pointer on (the ones before it stay read-only) */
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t from = loader->data_region_used & ~(page - 1);
+        if (mprotect(loader->data_region + from, loader->data_region_size - from,
+                     PROT_READ | PROT_WRITE) != 0) {
+            fprintf(stderr, "Error: Failed to reopen static data\n");
+            return NULL;
+        }
+        loader->data_sealed = false;
+    }
+
+    uint8_t* addr = loader->data_region + loader->data_region_used;
+    memcpy(addr, data, len);
+    loader->data_region_used += need;
+    if (loader->data_region_used == loader->data_region_size) {
+        seal_static_data(loader);
+    }
+    return addr;
+}
+
 /* Create a machine code wrapper for a user word
  * The wrapper loads the cell stream address into rax and jumps to docol
  * Returns: executable memory containing the wrapper code
@@ -327,7 +402,7 @@ void* loader_get_primitive_addr(loader_t* loader, uint16_t prim_id) {
 /* Core linking function - recursively link a CID
  * Implements the algorithm from LINKING.md
  */
-void* loader_link_cid(loader_t* loader, const unsigned char* cid) {
+static void* link_cid(loader_t* loader, const unsigned char* cid) {
     /* Check cache first */
     void* cached = cid_cache_get(loader->cid_cache, cid);
     if (cached) {
@@ -366,12 +441,7 @@ void* loader_link_cid(loader_t* loader, const unsigned char* cid) {
             break;
 
         case BLOB_DATA:
-            /* Literal value - allocate and copy */
-            result = malloc(blob_len);
-            if (result) {
-                memcpy(result, blob_data, blob_len);
-                track_buffer(loader, result);
-            }
+            result = link_data(loader, blob_data, blob_len);
             break;
 
         default:
@@ -395,6 +465,15 @@ void* loader_link_cid(loader_t* loader, const unsigned char* cid) {
     return result;
 }
 
+void* loader_link_cid(loader_t* loader, const unsigned char* cid) {
+    loader->link_depth++;
+    void* result = link_cid(loader, cid);
+    if (--loader->link_depth == 0) {
+        seal_static_data(loader);
+    }
+    return result;
+}
+
 /* Link a code blob (CID sequence) into runtime cells
  * Implements the algorithm from LINKING.md
  */
@@ -407,6 +486,11 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
     cell_t* cells = malloc(capacity * sizeof(cell_t));
     if (!cells) return NULL;
 
+    /* Self calls (PRIM_RECURSE): the word's own XT exists only once the
+     * wrapper is made, so these cells are patched after linking */
+    size_t* self_calls = NULL;
+    size_t self_count = 0;
+
     const uint8_t* ptr = blob_data;
     const uint8_t* end = blob_data + blob_len;
 
@@ -435,10 +519,22 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
                 }
                 DEBUG_LOADER("  Literal: value=%ld", value);
                 cells[count++] = encode_lit(value);
+            } else if (id_or_kind == PRIM_RECURSE) {
+                size_t* grown = realloc(self_calls, (self_count + 1) * sizeof(size_t));
+                if (!grown) {
+                    free(self_calls);
+                    free(cells);
+                    return NULL;
+                }
+                self_calls = grown;
+                self_calls[self_count++] = count;
+                DEBUG_LOADER("  Self call");
+                cells[count++] = encode_exit();     /* Patched below */
             } else {
                 /* Regular primitive: look up runtime address by ID */
                 void* prim_addr = loader_get_primitive_addr(loader, id_or_kind);
                 if (!prim_addr) {
+                    free(self_calls);
                     free(cells);
                     return NULL;
                 }
@@ -451,6 +547,7 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
             DEBUG_LOADER("  CID reference kind=%u", id_or_kind);
             void* addr = loader_link_cid(loader, cid);
             if (!addr) {
+                free(self_calls);
                 free(cells);
                 return NULL;
             }
@@ -465,6 +562,7 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
                     break;
 
                 case BLOB_QUOTATION:
+                case BLOB_STATIC:
                     /* Push its address */
                     cells[count++] = encode_lit((int64_t)addr);
                     break;
@@ -480,6 +578,7 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
 
                 default:
                     fprintf(stderr, "Error: Unknown blob kind %u in linking\n", id_or_kind);
+                    free(self_calls);
                     free(cells);
                     return NULL;
             }
@@ -507,12 +606,93 @@ void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_l
         void* wrapper = create_docol_wrapper(loader, (void*)cells);
         if (!wrapper) {
             fprintf(stderr, "Error: Failed to create DOCOL wrapper\n");
+            free(self_calls);
             return NULL;
         }
+        for (size_t i = 0; i < self_count; i++) {
+            cells[self_calls[i]] = encode_xt(wrapper);
+        }
+        free(self_calls);
         DEBUG_LOADER("Created wrapper for %s", kind == BLOB_WORD ? "user word" : "quotation");
         return wrapper;
     }
 
     /* For other kinds, return cells directly */
+    free(self_calls);
     return (void*)cells;
 }
+
+/* One words row: an entry carrying the bound CID, no source */
+static bool add_bound_word(void* ctx, const char* name, const char* namespace,
+                           const unsigned char* def_cid, const char* type_sig) {
+    (void)namespace;
+    loader_t* loader = ctx;
+    type_sig_t sig;
+    type_sig_t* parsed = (type_sig && parse_type_sig(type_sig, &sig)) ? &sig : NULL;
+
+    if (!dict_add(loader->dict, name, NULL, def_cid, 0, parsed, false, false, NULL, NULL)) {
+        fprintf(stderr, "Error: Cannot add word '%s' to dictionary\n", name);
+        return false;
+    }
+    DEBUG_LOADER("Bound %s : %s", name, type_sig ? type_sig : "?");
+    return true;
+}
+
+int loader_load_dictionary(loader_t* loader) {
+    size_t before = dict_entry_count(loader->dict);
+    if (!db_foreach_word(loader->db, add_bound_word, loader)) {
+        return -1;
+    }
+    return (int)(dict_entry_count(loader->dict) - before);
+}
+
+bool loader_stack_depth(loader_t* loader, const unsigned char* cid, stack_depth_t* depth) {
+    return loader->db &&
+           db_load_def_depth(loader->db, cid, &depth->data_max, &depth->data_effect,
+                             &depth->return_max);
+}
+
+/* Link a deploy bundle without touching the database */
+void* loader_link_bundle(loader_t* loader, const char* path) {
+    bundle_reader_t* reader = bundle_reader_open(path);
+    if (!reader) return NULL;
+
+    void* root = NULL;
+    bundle_blob_t blob;
+    loader->link_depth++;
+    while (bundle_reader_next(reader, &blob)) {
+        void* addr = cid_cache_get(loader->cid_cache, blob.cid);
+        if (!addr) {
+            switch (blob.kind) {
+                case BLOB_WORD:
+                case BLOB_QUOTATION:
+                    addr = loader_link_code(loader, blob.data, blob.len, blob.kind);
+                    break;
+
+                case BLOB_DATA:
+                    addr = link_data(loader, blob.data, blob.len);
+                    break;
+
+                default:
+                    fprintf(stderr, "Error: Unknown blob kind %d in bundle\n", blob.kind);
+                    break;
+            }
+            if (!addr) break;
+            cid_cache_put(loader->cid_cache, blob.cid, addr);
+        }
+        root = addr;
+    }
+
+    if (--loader->link_depth == 0) {
+        seal_static_data(loader);
+    }
+
+    if (!bundle_reader_done(reader)) {
+        fprintf(stderr, "Error: Failed to link bundle: %s\n", path);
+        root = NULL;
+    }
+
+    DEBUG_LOADER("Linked bundle %s: %u blobs", path, reader->blob_count);
+    bundle_reader_close(reader);
+    return root;
+}
@@ -9,6 +9,7 @@
 #include "types.h"
 #include "database.h"
 #include "dictionary.h"
+#include "depth.h"
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -51,6 +52,14 @@ typedef struct {
     size_t mmap_count;
     size_t mmap_capacity;
 
+    /* Static data (constant arrays), bump-allocated into a shared region
+     * that is read-only whenever no link is in progress */
+    uint8_t* data_region;
+    size_t data_region_size;
+    size_t data_region_used;
+    bool data_sealed;           /* Region is currently read-only */
+    int link_depth;             /* Nesting of loader_link_cid/loader_link_bundle */
+
     /* Legacy: loaded words list (deprecated in favor of CID cache) */
     loaded_word_t** words;
     size_t word_count;
@@ -87,6 +96,20 @@ void* loader_link_cid(loader_t* loader, const unsigned char* cid);
  */
 void* loader_link_code(loader_t* loader, const uint8_t* blob_data, size_t blob_len, int kind);
 
+/* Link every blob of a deploy bundle in one forward pass (dependencies
+ * precede dependents, so references always hit the CID cache).
+ * Returns runtime address of the bundle's root word. */
+void* loader_link_bundle(loader_t* loader, const char* path);
+
+/* Rebuild the dictionary from the database's word bindings, without
+ * source: each bound name gets an entry with its CID and signature, for
+ * runner_execute to link directly. Returns the number of words, -1 on error. */
+int loader_load_dictionary(loader_t* loader);
+
+/* Stack depth the compiler recorded for a word's code (defs); false if
+ * it was never analyzed */
+bool loader_stack_depth(loader_t* loader, const unsigned char* cid, stack_depth_t* depth);
+
 /* Helper: get primitive runtime address by ID */
 void* loader_get_primitive_addr(loader_t* loader, uint16_t prim_id);
 
@@ -11,11 +11,17 @@
 #include "database.h"
 #include "dictionary.h"
 #include "debug.h"
+#include "gc.h"
+#include "bundle.h"
+#include "threadpool.h"
+#include "memo.h"
+#include "server.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
 #include <ctype.h>
+#include <unistd.h>
 
 static void print_usage(const char* prog) {
     printf("March Language Compiler (C version)\n\n");
@@ -25,8 +31,23 @@ static void print_usage(const char* prog) {
     printf("  -v            Verbose output\n");
     printf("  -d <cats>     Enable debug output (comma-separated: compiler,dict,types,cid,loader,db,all)\n");
     printf("  -r <word>     Run word after compilation\n");
+    printf("  -e <word>     Whole program: compile only what <word> reaches (repeatable;\n");
+    printf("                the -r word is an entry too)\n");
     printf("  -s            Show stack after execution\n");
+    printf("  -H <hash>     CID hash for a new database (sha256, blake2s)\n");
+    printf("  -j <n>        Compile typed words on n threads (0 = one per CPU)\n");
+    printf("  -O <level>    Optimization level (0 = none, 1 = peephole and constant folding,\n");
+    printf("                2 = also inline small words and literal quotations)\n");
+    printf("  -M <entries>  Memo table capacity for `$ memo` words (default %d, 0 = off)\n",
+           MEMO_DEFAULT_CAPACITY);
     printf("  -h            Show this help\n\n");
+    printf("Commands:\n");
+    printf("  %s gc [-n] [-V] [-b <rows>] [db]   Collect unreachable blobs\n", prog);
+    printf("  %s export <word> -o <bundle> [db]  Write word's CID closure to a bundle\n", prog);
+    printf("  %s import <bundle> [db]            Load a bundle into a database\n", prog);
+    printf("  %s run [-s] <db> <word>            Run a compiled word, no source needed\n", prog);
+    printf("  %s --serve [-o db] [socket]        Keep a warm compiler serving requests\n", prog);
+    printf("  %s client <socket> <request> [arg] Send compile/run/stack/stop to a server\n\n", prog);
     printf("Examples:\n");
     printf("  %s hello.march                    # Compile to march.db\n", prog);
     printf("  %s -v -o my.db hello.march        # Verbose, custom DB\n", prog);
@@ -34,34 +55,369 @@ static void print_usage(const char* prog) {
     printf("  %s -d all hello.march             # Debug all categories\n", prog);
     printf("  %s -r main hello.march            # Compile and run 'main'\n", prog);
     printf("  %s -r main -s hello.march         # Run and show stack\n", prog);
+    printf("  %s -j 0 big.march                 # Parallel compilation\n", prog);
+    printf("  %s -e main -j 0 lib.march         # Compile only what main reaches\n", prog);
+    printf("  %s -O 1 -r main hello.march       # Optimize, report dispatches saved\n", prog);
+    printf("  %s --serve -j 0 dev.sock &        # Then: %s client dev.sock compile x.march\n",
+           prog, prog);
 }
 
-int main(int argc, char** argv) {
-    fprintf(stderr, "TRACE: main() entry\n");
-    fflush(stderr);
+/* marchc gc: sweep blobs unreachable from words/modules/state */
+static int cmd_gc(const char* prog, int argc, char** argv) {
+    gc_options_t opts;
+    gc_options_init(&opts);
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt(argc, argv, "nVb:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                opts.dry_run = true;
+                break;
+            case 'V':
+                opts.vacuum = true;
+                break;
+            case 'b':
+                opts.batch_size = atoi(optarg);
+                break;
+            case 'h':
+                printf("Usage: %s gc [options] [db]\n\n", prog);
+                printf("  -n            Dry run (report only)\n");
+                printf("  -V            VACUUM after sweeping\n");
+                printf("  -b <rows>     Rows deleted per transaction (default %d)\n", GC_DEFAULT_BATCH_SIZE);
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    const char* db_file = optind < argc ? argv[optind] : "march.db";
+    march_db_t* db = db_open(db_file);
+    if (!db) {
+        fprintf(stderr, "Error: Cannot open database: %s\n", db_file);
+        return 1;
+    }
+
+    gc_stats_t stats;
+    bool ok = gc_collect(db, &opts, &stats);
+    db_close(db);
+    if (!ok) {
+        fprintf(stderr, "GC failed\n");
+        return 1;
+    }
+
+    printf("%s%s: %lld live blobs, %lld unreachable (%lld bytes), %lld type signatures",
+           opts.dry_run ? "[dry run] " : "", db_file,
+           (long long)stats.live_blobs, (long long)stats.dead_blobs,
+           (long long)stats.bytes_reclaimed, (long long)stats.dead_sigs);
+    if (stats.dead_modules > 0) {
+        printf(", %lld modules", (long long)stats.dead_modules);
+    }
+    printf("\n");
+    if (opts.vacuum) {
+        printf("File size: %lld -> %lld bytes (%lld reclaimed)\n",
+               (long long)stats.file_bytes_before, (long long)stats.file_bytes_after,
+               (long long)(stats.file_bytes_before - stats.file_bytes_after));
+    }
+
+    return 0;
+}
+
+/* marchc export <word> [-t <sig>] -o <bundle> [db] */
+static int cmd_export(const char* prog, int argc, char** argv) {
+    const char* bundle_file = NULL;
+    const char* type_sig = NULL;
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt(argc, argv, "o:t:h")) != -1) {
+        switch (opt) {
+            case 'o':
+                bundle_file = optarg;
+                break;
+            case 't':
+                type_sig = optarg;
+                break;
+            case 'h':
+                printf("Usage: %s export <word> [-t <sig>] -o <bundle> [db]\n"
+                       "  -t <sig>  Binding to export when the word has several, e.g. \"i64 -> i64\"\n",
+                       prog);
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc || !bundle_file) {
+        fprintf(stderr, "Usage: %s export <word> [-t <sig>] -o <bundle> [db]\n", prog);
+        return 1;
+    }
+
+    const char* word = argv[optind];
+    const char* db_file = optind + 1 < argc ? argv[optind + 1] : "march.db";
+    march_db_t* db = db_open_ex(db_file, DB_OPEN_READONLY);
+    if (!db) {
+        fprintf(stderr, "Error: Cannot open database: %s\n", db_file);
+        return 1;
+    }
+
+    bundle_stats_t stats;
+    bool ok = bundle_export(db, word, type_sig, bundle_file, &stats);
+    db_close(db);
+    if (!ok) return 1;
+
+    printf("Exported %s: %u blobs, %u type signatures (%llu bytes) -> %s\n",
+           word, stats.blob_count, stats.sig_count,
+           (unsigned long long)stats.raw_bytes, bundle_file);
+    return 0;
+}
+
+/* marchc import <bundle> [db] */
+static int cmd_import(const char* prog, int argc, char** argv) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0) {
+        fprintf(stderr, "Usage: %s import <bundle> [db]\n", prog);
+        return argc < 2 ? 1 : 0;
+    }
+
+    const char* bundle_file = argv[1];
+    const char* db_file = argc > 2 ? argv[2] : "march.db";
+    march_db_t* db = db_open(db_file);
+    if (!db) {
+        fprintf(stderr, "Error: Cannot open database: %s\n", db_file);
+        return 1;
+    }
+    db_init_schema(db, NULL);
+
+    bundle_stats_t stats;
+    bool ok = bundle_import(db, bundle_file, &stats);
+    db_close(db);
+    if (!ok) {
+        fprintf(stderr, "Import failed\n");
+        return 1;
+    }
+
+    printf("Imported %u blobs, %u type signatures (%llu bytes) into %s\n",
+           stats.blob_count, stats.sig_count, (unsigned long long)stats.raw_bytes, db_file);
+    return 0;
+}
+
+/* Report the stacks a word needs (-v) */
+static void print_stack_depth(runner_t* runner, const char* word) {
+    stack_depth_t depth;
+    if (!runner_stack_depth(runner, word, &depth)) return;
+    if (stack_depth_bounded(&depth)) {
+        printf("Stack depth: data %d, return %d\n", depth.data_max, depth.return_max);
+    } else {
+        printf("Stack depth: unbounded\n");
+    }
+}
+
+/* marchc run [-s] <db> <word>: link and run prebuilt code, no compiler */
+static int cmd_run(const char* prog, int argc, char** argv) {
+    bool show_stack = false;
+    bool verbose = false;
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt(argc, argv, "svh")) != -1) {
+        switch (opt) {
+            case 's':
+                show_stack = true;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                printf("Usage: %s run [-s] [-v] <db> <word>\n\n", prog);
+                printf("  -s            Show stack after execution\n");
+                printf("  -v            Verbose output\n");
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind + 2 > argc) {
+        fprintf(stderr, "Usage: %s run [-s] [-v] <db> <word>\n", prog);
+        return 1;
+    }
+
+    const char* db_file = argv[optind];
+    const char* word = argv[optind + 1];
+    march_db_t* db = db_open_ex(db_file, DB_OPEN_READONLY);
+    if (!db) {
+        fprintf(stderr, "Error: Cannot open database: %s\n", db_file);
+        return 1;
+    }
+
+    dictionary_t* dict = dict_create();
+    loader_t* loader = dict ? loader_create(db, dict) : NULL;
+    runner_t* runner = NULL;
+    int status = 1;
+
+    crash_context_set_phase("load_dictionary");
+    int words = loader ? loader_load_dictionary(loader) : -1;
+    if (words < 0) {
+        fprintf(stderr, "Error: Cannot load words from %s\n", db_file);
+    } else if (!dict_lookup(dict, word)) {
+        fprintf(stderr, "Error: No word '%s' in %s (compile it first)\n", word, db_file);
+    } else if (!(runner = runner_create(loader, NULL))) {
+        fprintf(stderr, "Error: Cannot create runner\n");
+    } else {
+        if (verbose) {
+            printf("Loaded %d words from %s\nExecuting: %s\n", words, db_file, word);
+            print_stack_depth(runner, word);
+        }
 
+        crash_context_set_phase("execute");
+        crash_context_set_word(word);
+        if (runner_execute(runner, word)) {
+            if (show_stack) runner_print_stack(runner);
+            status = 0;
+        } else {
+            fprintf(stderr, "Execution failed\n");
+        }
+    }
+
+    if (runner) runner_free(runner);
+    if (loader) loader_free(loader);
+    if (dict) dict_free(dict);
+    db_close(db);
+    return status;
+}
+
+/* marchc --serve [options] [socket] */
+static int cmd_serve(const char* prog, int argc, char** argv) {
+    server_options_t opts;
+    server_options_init(&opts);
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt(argc, argv, "o:H:j:O:M:vh")) != -1) {
+        switch (opt) {
+            case 'o':
+                opts.db_path = optarg;
+                break;
+            case 'H':
+                opts.cid_hash = optarg;
+                break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                if (opts.jobs <= 0) opts.jobs = thread_pool_cpu_count();
+                break;
+            case 'O':
+                opts.opt_level = atoi(optarg);
+                if (opts.opt_level < OPT_NONE) opts.opt_level = OPT_NONE;
+                if (opts.opt_level > OPT_INLINE) opts.opt_level = OPT_INLINE;
+                break;
+            case 'M':
+                memo_set_capacity((size_t)strtoull(optarg, NULL, 10));
+                break;
+            case 'v':
+                opts.verbose = true;
+                break;
+            case 'h':
+                printf("Usage: %s --serve [options] [socket]\n\n", prog);
+                printf("  -o <db>       Database kept open (default: march.db)\n");
+                printf("  -H <hash>     CID hash for a new database (sha256, blake2s)\n");
+                printf("  -j <n>        Specialize typed words on n threads after each compile\n");
+                printf("  -O <level>    Optimization level (0-2)\n");
+                printf("  -M <entries>  Memo table capacity (default %d, 0 = off)\n",
+                       MEMO_DEFAULT_CAPACITY);
+                printf("  -v            Log requests\n\n");
+                printf("Socket defaults to %s. Requests: compile <file>, run <word>, stack, stop\n",
+                       SERVER_DEFAULT_SOCKET);
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind < argc) opts.socket_path = argv[optind];
+    return server_run(&opts);
+}
+
+/* marchc client <socket> <request> [arg] */
+static int cmd_client(const char* prog, int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s client <socket> compile <file> | run <word> | stack | stop\n", prog);
+        return 1;
+    }
+
+    const char* request = argv[2];
+    const char* arg = argc > 3 ? argv[3] : "";
+
+    /* The server has its own working directory */
+    char* path = NULL;
+    if (strcmp(request, "compile") == 0 && *arg && arg[0] != '/') {
+        char cwd[4096];
+        if (!getcwd(cwd, sizeof(cwd))) {
+            perror("getcwd");
+            return 1;
+        }
+        size_t path_len = strlen(cwd) + strlen(arg) + 2;
+        path = malloc(path_len);
+        if (!path) return 1;
+        snprintf(path, path_len, "%s/%s", cwd, arg);
+        arg = path;
+    }
+
+    size_t len = strlen(request) + strlen(arg) + 2;
+    char* line = malloc(len);
+    if (!line) {
+        free(path);
+        return 1;
+    }
+    snprintf(line, len, "%s%s%s", request, *arg ? " " : "", arg);
+
+    int status = server_request(argv[1], line);
+    free(line);
+    free(path);
+    return status;
+}
+
+int main(int argc, char** argv) {
     const char* output_db = "march.db";
     const char* run_word = NULL;
     bool verbose = false;
     bool show_stack = false;
+    const char* cid_hash_opt = NULL;
+    int jobs = 1;
+    int opt_level = OPT_NONE;
+    const char** entries = calloc((size_t)argc, sizeof(char*));
+    int entry_count = 0;
     int opt;
 
-    fprintf(stderr, "TRACE: Installing crash handler\n");
-    fflush(stderr);
-
     /* Install crash handler first */
     crash_handler_install();
     crash_context_set_phase("init");
 
-    fprintf(stderr, "TRACE: Crash handler installed\n");
-    fflush(stderr);
-
     /* Initialize debug system from environment */
     debug_init();
     trace_init();
 
+    /* Subcommands */
+    if (argc > 1 && strcmp(argv[1], "gc") == 0) {
+        return cmd_gc(argv[0], argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "export") == 0) {
+        return cmd_export(argv[0], argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "import") == 0) {
+        return cmd_import(argv[0], argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "run") == 0) {
+        return cmd_run(argv[0], argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        return cmd_serve(argv[0], argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "client") == 0) {
+        return cmd_client(argv[0], argc - 1, argv + 1);
+    }
+
     /* Parse options */
-    while ((opt = getopt(argc, argv, "o:r:d:vsh")) != -1) {
+    while ((opt = getopt(argc, argv, "o:r:e:d:H:j:O:M:vsh")) != -1) {
         switch (opt) {
             case 'o':
                 output_db = optarg;
@@ -69,6 +425,9 @@ int main(int argc, char** argv) {
             case 'r':
                 run_word = optarg;
                 break;
+            case 'e':
+                if (entries) entries[entry_count++] = optarg;
+                break;
             case 'd':
                 {
                     /* Parse comma-separated debug categories */
@@ -105,6 +464,21 @@ int main(int argc, char** argv) {
                     free(str);
                 }
                 break;
+            case 'H':
+                cid_hash_opt = optarg;
+                break;
+            case 'j':
+                jobs = atoi(optarg);
+                if (jobs <= 0) jobs = thread_pool_cpu_count();
+                break;
+            case 'O':
+                opt_level = atoi(optarg);
+                if (opt_level < OPT_NONE) opt_level = OPT_NONE;
+                if (opt_level > OPT_INLINE) opt_level = OPT_INLINE;
+                break;
+            case 'M':
+                memo_set_capacity((size_t)strtoull(optarg, NULL, 10));
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -137,10 +511,24 @@ int main(int argc, char** argv) {
     }
 
     /* Initialize schema if new database */
-    if (!db_init_schema(db, "schema.sql")) {
+    if (!db_init_schema(db, NULL)) {
         /* Schema might already exist, that's okay */
     }
 
+    /* Select CID hash (only allowed before any blobs are stored) */
+    if (cid_hash_opt) {
+        cid_hash_t hash;
+        if (!cid_hash_parse(cid_hash_opt, &hash)) {
+            fprintf(stderr, "Error: Unknown CID hash '%s' (expected sha256 or blake2s)\n", cid_hash_opt);
+            db_close(db);
+            return 1;
+        }
+        if (!db_set_cid_hash(db, hash)) {
+            db_close(db);
+            return 1;
+        }
+    }
+
     /* Create dictionary and compiler */
     dictionary_t* dict = dict_create();
     if (!dict) {
@@ -158,23 +546,17 @@ int main(int argc, char** argv) {
     }
 
     comp->verbose = verbose;
-
-    fprintf(stderr, "TRACE: About to register primitives\n");
-    fflush(stderr);
+    comp->opt_level = opt_level;
 
     /* Register primitives */
     crash_context_set_phase("register_primitives");
     compiler_register_primitives(comp);
 
-    fprintf(stderr, "TRACE: Primitives registered\n");
-    fflush(stderr);
-
     if (verbose) {
         printf("Compiling: %s → %s\n", input_file, output_db);
     }
 
-    fprintf(stderr, "TRACE: Starting compilation of %s\n", input_file);
-    fflush(stderr);
+    TRACE_PHASE(DEBUG_COMPILER, "compiling %s into %s", input_file, output_db);
 
     /* Compile file */
     crash_context_set_phase("compile");
@@ -187,6 +569,53 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    /* Whole program: nothing the entries cannot reach is compiled */
+    if (entry_count > 0) {
+        bool listed = !run_word;
+        for (int i = 0; i < entry_count && !listed; i++) {
+            listed = strcmp(entries[i], run_word) == 0;
+        }
+        if (!listed) entries[entry_count++] = run_word;
+
+        int reachable = compiler_mark_reachable(comp, entries, entry_count);
+        if (reachable < 0) {
+            free(entries);
+            compiler_free(comp);
+            dict_free(dict);
+            db_close(db);
+            return 1;
+        }
+        if (verbose) {
+            printf("Whole program: %d of %d definitions reachable from %d entries\n",
+                   reachable, comp->word_def_count, entry_count);
+        }
+    }
+
+    /* Specialize typed words ahead of use on a thread pool */
+    if (jobs > 1 && !compiler_compile_parallel(comp, jobs)) {
+        fprintf(stderr, "Compilation failed\n");
+        free(entries);
+        compiler_free(comp);
+        dict_free(dict);
+        db_close(db);
+        return 1;
+    }
+
+    /* Entries, and everything they call, are compiled now */
+    for (int i = 0; i < entry_count; i++) {
+        crash_context_set_word(entries[i]);
+        dict_entry_t* entry = dict_lookup(dict, entries[i]);
+        if (!entry || !compiler_compile_entry(comp, entry)) {
+            fprintf(stderr, "Compilation failed\n");
+            free(entries);
+            compiler_free(comp);
+            dict_free(dict);
+            db_close(db);
+            return 1;
+        }
+    }
+    free(entries);
+
     if (verbose) {
         printf("✓ Compilation successful\n");
     }
@@ -219,6 +648,8 @@ int main(int argc, char** argv) {
             return 1;
         }
 
+        if (verbose) print_stack_depth(runner, run_word);
+
         if (!runner_execute(runner, run_word)) {
             fprintf(stderr, "Execution failed\n");
             runner_free(runner);
@@ -233,10 +664,30 @@ int main(int argc, char** argv) {
             runner_print_stack(runner);
         }
 
+        memo_stats_t memo_stats;
+        memo_get_stats(&memo_stats);
+        if (memo_stats.hits + memo_stats.misses > 0) {
+            fprintf(stderr, "Memo: %llu hits, %llu misses, %llu evictions (%zu of %zu entries)\n",
+                    (unsigned long long)memo_stats.hits, (unsigned long long)memo_stats.misses,
+                    (unsigned long long)memo_stats.evictions, memo_stats.entries,
+                    memo_stats.capacity);
+        }
+
         runner_free(runner);
         loader_free(loader);
     }
 
+    /* Per pass through the words compiled in this run (static count) */
+    if (opt_level > OPT_NONE) {
+        const optimizer_stats_t* st = &comp->opt_stats;
+        fprintf(stderr, "Optimizer: %zu -> %zu cells, %zu dispatches saved "
+                "(%d folded, %d cancelled, %d strength-reduced, %d inlined, %d tail calls, "
+                "%d dead if arms, %d calls evaluated)\n",
+                st->cells_before, st->cells_after, optimizer_dispatches_saved(st),
+                st->folded, st->cancelled, st->reduced, st->inlined, st->tail_calls,
+                st->dead_arms, st->evaluated);
+    }
+
     /* Clean up */
     compiler_free(comp);
     dict_free(dict);
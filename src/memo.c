@@ -0,0 +1,170 @@
+/*
+ * March Language - Memo Table Implementation
+ *
+ * A HAMT maps a 64-bit digest of (word, inputs) to the chain of entries
+ * with that digest; the full key is compared on lookup. The table owns
+ * its only root, so replaced HAMT paths are released on every update.
+ * Entries are also on a recency list, oldest evicted first.
+ */
+
+#include "memo.h"
+#include "hamt.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct memo_entry {
+    uint64_t digest;
+    const void* word;
+    struct memo_entry* chain;       /* Next entry with the same digest */
+    struct memo_entry* newer;
+    struct memo_entry* older;
+    uint8_t inputs;
+    uint8_t outputs;
+    uint64_t cells[MEMO_MAX_CELLS]; /* Inputs, then outputs; deepest first */
+} memo_entry_t;
+
+static struct {
+    void* root;
+    memo_entry_t* newest;
+    memo_entry_t* oldest;
+    size_t capacity;
+    memo_stats_t stats;
+} memo = { NULL, NULL, NULL, MEMO_DEFAULT_CAPACITY, {0, 0, 0, 0, 0} };
+
+static uint64_t memo_digest(const void* word, const uint64_t* cells, int count) {
+    uint64_t h = (uint64_t)(uintptr_t)word * 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < count; i++) {
+        h = (h ^ cells[i]) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static void memo_set_root(void* root, uint64_t digest) {
+    hamt_release(memo.root, root, digest);
+    memo.root = root;
+}
+
+static void lru_unlink(memo_entry_t* e) {
+    if (e->newer) e->newer->older = e->older; else memo.newest = e->older;
+    if (e->older) e->older->newer = e->newer; else memo.oldest = e->newer;
+    e->newer = e->older = NULL;
+}
+
+static void lru_push(memo_entry_t* e) {
+    e->newer = NULL;
+    e->older = memo.newest;
+    if (memo.newest) memo.newest->newer = e; else memo.oldest = e;
+    memo.newest = e;
+}
+
+static memo_entry_t* memo_find(uint64_t digest, const void* word,
+                               const uint64_t* inputs, int count) {
+    memo_entry_t* e = (memo_entry_t*)(uintptr_t)hamt_get(memo.root, digest);
+    for (; e; e = e->chain) {
+        if (e->word == word && e->inputs == count &&
+            memcmp(e->cells, inputs, sizeof(uint64_t) * (size_t)count) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void memo_evict(memo_entry_t* e) {
+    memo_entry_t* head = (memo_entry_t*)(uintptr_t)hamt_get(memo.root, e->digest);
+    if (head == e) {
+        memo_set_root(e->chain ? hamt_set(memo.root, e->digest, (uint64_t)(uintptr_t)e->chain)
+                               : hamt_remove(memo.root, e->digest),
+                      e->digest);
+    } else {
+        while (head && head->chain != e) head = head->chain;
+        if (head) head->chain = e->chain;
+    }
+    lru_unlink(e);
+    free(e);
+    memo.stats.entries--;
+}
+
+uint64_t memo_enter(uint64_t* dsp, const void* word, uint64_t arity) {
+    int inputs = (int)(arity & 0xff);
+    int outputs = (int)((arity >> 8) & 0xff);
+    if (inputs + outputs > MEMO_MAX_CELLS) return 0;
+
+    uint64_t key[MEMO_MAX_CELLS];
+    for (int i = 0; i < inputs; i++) {
+        key[i] = dsp[inputs - 1 - i];
+    }
+    uint64_t digest = memo_digest(word, key, inputs);
+
+    memo_entry_t* e = memo_find(digest, word, key, inputs);
+    if (e) {
+        memo.stats.hits++;
+        lru_unlink(e);
+        lru_push(e);
+        uint64_t* out = dsp + inputs - outputs;
+        for (int i = 0; i < outputs; i++) {
+            out[outputs - 1 - i] = e->cells[inputs + i];
+        }
+        return MEMO_HIT;
+    }
+
+    memo.stats.misses++;
+    if (memo.capacity == 0) return 0;
+    e = calloc(1, sizeof(memo_entry_t));
+    if (!e) return 0;
+    e->digest = digest;
+    e->word = word;
+    e->inputs = (uint8_t)inputs;
+    e->outputs = (uint8_t)outputs;
+    memcpy(e->cells, key, sizeof(uint64_t) * (size_t)inputs);
+    return (uint64_t)(uintptr_t)e;
+}
+
+void memo_exit(uint64_t handle, const uint64_t* dsp) {
+    memo_entry_t* e = (memo_entry_t*)(uintptr_t)handle;
+    if (!e) return;
+
+    for (int i = 0; i < e->outputs; i++) {
+        e->cells[e->inputs + i] = dsp[e->outputs - 1 - i];
+    }
+
+    /* The same call finished inside the body (or capacity dropped to 0) */
+    if (memo.capacity == 0 || memo_find(e->digest, e->word, e->cells, e->inputs)) {
+        free(e);
+        return;
+    }
+
+    while (memo.stats.entries >= memo.capacity && memo.oldest) {
+        memo_evict(memo.oldest);
+        memo.stats.evictions++;
+    }
+
+    e->chain = (memo_entry_t*)(uintptr_t)hamt_get(memo.root, e->digest);
+    memo_set_root(hamt_set(memo.root, e->digest, (uint64_t)(uintptr_t)e), e->digest);
+    lru_push(e);
+    memo.stats.entries++;
+}
+
+void memo_set_capacity(size_t capacity) {
+    memo.capacity = capacity;
+    while (memo.stats.entries > capacity && memo.oldest) {
+        memo_evict(memo.oldest);
+        memo.stats.evictions++;
+    }
+}
+
+void memo_get_stats(memo_stats_t* stats) {
+    *stats = memo.stats;
+    stats->capacity = memo.capacity;
+}
+
+void memo_reset(void) {
+    while (memo.oldest) {
+        memo_entry_t* e = memo.oldest;
+        lru_unlink(e);
+        free(e);
+    }
+    hamt_free(memo.root);
+    memo.root = NULL;
+    memset(&memo.stats, 0, sizeof(memo.stats));
+}
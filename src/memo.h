@@ -0,0 +1,52 @@
+/*
+ * March Language - Memo Table
+ * Run-time results of `$ memo` words, keyed by (word, input cells)
+ */
+
+#ifndef MARCH_MEMO_H
+#define MARCH_MEMO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Entries kept before the least recently used one is evicted */
+#define MEMO_DEFAULT_CAPACITY 65536
+
+/* Inputs plus outputs of a memoized word (larger words are not memoized) */
+#define MEMO_MAX_CELLS 16
+
+/* memo_enter result when the outputs were found */
+#define MEMO_HIT 1
+
+/* Arity literal that follows memo-enter in a memoized word */
+static inline uint64_t memo_arity(int inputs, int outputs) {
+    return (uint64_t)inputs | ((uint64_t)outputs << 8);
+}
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t capacity;
+} memo_stats_t;
+
+/* memo-enter: dsp points at the word's inputs (dsp[0] is the top), word
+ * identifies the linked word (one per CID). On a hit the outputs are
+ * written where the inputs end and MEMO_HIT is returned; otherwise an
+ * entry handle for memo_exit (0 if the call cannot be recorded). */
+uint64_t memo_enter(uint64_t* dsp, const void* word, uint64_t arity);
+
+/* memo-exit: record the outputs at dsp under the handle's key */
+void memo_exit(uint64_t handle, const uint64_t* dsp);
+
+/* Table size (0 disables recording); shrinking evicts */
+void memo_set_capacity(size_t capacity);
+
+void memo_get_stats(memo_stats_t* stats);
+
+/* Drop every entry and zero the counters */
+void memo_reset(void);
+
+#endif /* MARCH_MEMO_H */
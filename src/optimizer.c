@@ -0,0 +1,391 @@
+/*
+ * March Language - Peephole Optimizer Implementation
+ *
+ * Instructions are copied into an output window one at a time; after each
+ * copy the tail of the window is rewritten until no pattern matches, so
+ * folds cascade ("2 3 + 4 *" becomes "20" in one pass).
+ */
+
+#include "optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    ir_instr_t* out;
+    size_t n;
+    dictionary_t* dict;
+    optimizer_stats_t* stats;
+} window_t;
+
+/* Known i64 constant pushed by an instruction */
+static bool is_const(const ir_instr_t* in, int64_t* value) {
+    bool constant = in->op == IR_LIT ||
+                    (in->op == IR_REF && in->ref_kind == BLOB_DATA && in->type == TYPE_I64);
+    if (constant && value) *value = in->value;
+    return constant;
+}
+
+bool optimizer_const_value(const ir_instr_t* in, int64_t* value) {
+    return is_const(in, value);
+}
+
+static bool is_prim(const ir_instr_t* in, uint16_t prim_id) {
+    return in->op == IR_PRIM && in->prim_id == prim_id;
+}
+
+/* Pushes one value without side effects (dropping it undoes it) */
+static bool is_pure_push(const ir_instr_t* in) {
+    if (in->op == IR_LIT) return true;
+    if (in->op == IR_REF) {
+        return in->ref_kind == BLOB_DATA || in->ref_kind == BLOB_QUOTATION ||
+               in->ref_kind == BLOB_STATIC;
+    }
+    if (in->op != IR_PRIM) return false;
+    switch (in->prim_id) {
+        case PRIM_DUP:
+        case PRIM_OVER:
+        case PRIM_RFETCH:
+        case PRIM_I0:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Produces a value known to be >= 0 (signed division by 2^k is a shift) */
+static bool is_nonneg_push(const ir_instr_t* in) {
+    int64_t value;
+    if (is_const(in, &value)) return value >= 0;
+    if (in->op != IR_PRIM) return false;
+    switch (in->prim_id) {
+        case PRIM_ARRAY_LEN:
+        case PRIM_STR_LEN:
+        case PRIM_CFETCH:
+        case PRIM_I0:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static ir_instr_t make_lit(int64_t value) {
+    ir_instr_t in;
+    memset(&in, 0, sizeof(in));
+    in.op = IR_LIT;
+    in.value = value;
+    in.type = TYPE_I64;
+    return in;
+}
+
+/* Replacement primitive, only if name still resolves to it */
+static bool make_prim(dictionary_t* dict, const char* name, uint16_t prim_id, ir_instr_t* in) {
+    dict_entry_t* entry = dict_lookup(dict, name);
+    if (!entry || !entry->is_primitive || entry->prim_id != prim_id) return false;
+    memset(in, 0, sizeof(*in));
+    in->op = IR_PRIM;
+    in->prim_id = prim_id;
+    in->addr = entry->addr;
+    in->type = TYPE_UNKNOWN;
+    return true;
+}
+
+static int64_t flag(bool b) {
+    return b ? -1 : 0;
+}
+
+/* Evaluate a binary primitive on constants the way the VM would */
+static bool fold_binary(uint16_t prim_id, int64_t a, int64_t b, int64_t* result) {
+    uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+    switch (prim_id) {
+        case PRIM_ADD:     *result = (int64_t)(ua + ub); break;
+        case PRIM_SUB:     *result = (int64_t)(ua - ub); break;
+        case PRIM_MUL:     *result = (int64_t)(ua * ub); break;
+        case PRIM_DIV:
+        case PRIM_MOD:
+            /* Leave traps (division by zero, overflow) to run time */
+            if (b == 0 || (a == INT64_MIN && b == -1)) return false;
+            *result = (prim_id == PRIM_DIV) ? a / b : a % b;
+            break;
+        case PRIM_EQ:      *result = flag(a == b); break;
+        case PRIM_NE:      *result = flag(a != b); break;
+        case PRIM_LT:      *result = flag(a < b); break;
+        case PRIM_GT:      *result = flag(a > b); break;
+        case PRIM_LE:      *result = flag(a <= b); break;
+        case PRIM_GE:      *result = flag(a >= b); break;
+        case PRIM_AND:     *result = a & b; break;
+        case PRIM_OR:      *result = a | b; break;
+        case PRIM_XOR:     *result = a ^ b; break;
+        /* x86 masks shift counts to 6 bits */
+        case PRIM_LSHIFT:  *result = (int64_t)(ua << (ub & 63)); break;
+        case PRIM_RSHIFT:  *result = (int64_t)(ua >> (ub & 63)); break;
+        case PRIM_ARSHIFT: *result = a >> (ub & 63); break;
+        case PRIM_LAND:    *result = flag(a != 0 && b != 0); break;
+        case PRIM_LOR:     *result = flag(a != 0 || b != 0); break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+static bool fold_unary(uint16_t prim_id, int64_t a, int64_t* result) {
+    switch (prim_id) {
+        case PRIM_NOT:    *result = ~a; break;
+        case PRIM_LNOT:   *result = flag(a == 0); break;
+        case PRIM_ZEROP:  *result = flag(a == 0); break;
+        case PRIM_ZEROGT: *result = flag(a > 0); break;
+        case PRIM_ZEROLT: *result = flag(a < 0); break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+bool optimizer_fold_binary(uint16_t prim_id, int64_t a, int64_t b, int64_t* result) {
+    return fold_binary(prim_id, a, b, result);
+}
+
+bool optimizer_fold_unary(uint16_t prim_id, int64_t a, int64_t* result) {
+    return fold_unary(prim_id, a, result);
+}
+
+/* "x c op" is x for these (op, c) pairs */
+static bool is_identity(uint16_t prim_id, int64_t c) {
+    switch (prim_id) {
+        case PRIM_ADD:
+        case PRIM_SUB:
+        case PRIM_OR:
+        case PRIM_XOR:
+        case PRIM_LSHIFT:
+        case PRIM_RSHIFT:
+        case PRIM_ARSHIFT:
+            return c == 0;
+        case PRIM_MUL:
+        case PRIM_DIV:
+            return c == 1;
+        default:
+            return false;
+    }
+}
+
+/* log2 of c if it is a power of two >= 2, else -1 */
+static int power_of_two(int64_t c) {
+    if (c < 2 || (c & (c - 1)) != 0) return -1;
+    int k = 0;
+    while ((INT64_C(1) << k) != c) k++;
+    return k;
+}
+
+/* Apply one rewrite to the tail of the window; false if none matched */
+static bool reduce_tail(window_t* w) {
+    if (w->n < 2) return false;
+    ir_instr_t* last = &w->out[w->n - 1];
+    ir_instr_t* prev = &w->out[w->n - 2];
+    ir_instr_t* prev2 = w->n >= 3 ? &w->out[w->n - 3] : NULL;
+    int64_t a, b, result;
+
+    /* c 0branch: taken or not is known */
+    if (last->op == IR_BRANCH && last->prim_id == PRIM_0BRANCH && is_const(prev, &a)) {
+        if (a != 0) {
+            w->n -= 2;
+        } else {
+            ir_instr_t branch;
+            if (!make_prim(w->dict, "branch", PRIM_BRANCH, &branch)) return false;
+            branch.op = IR_BRANCH;
+            branch.value = last->value;
+            *prev = branch;
+            w->n -= 1;
+        }
+        w->stats->folded++;
+        return true;
+    }
+
+    if (last->op != IR_PRIM) return false;
+
+    /* Constant folding */
+    if (prev2 && is_const(prev2, &a) && is_const(prev, &b) &&
+        fold_binary(last->prim_id, a, b, &result) &&
+        result >= LIT_MIN && result <= LIT_MAX) {
+        *prev2 = make_lit(result);
+        w->n -= 2;
+        w->stats->folded++;
+        return true;
+    }
+    if (is_const(prev, &a) && fold_unary(last->prim_id, a, &result) &&
+        result >= LIT_MIN && result <= LIT_MAX) {
+        *prev = make_lit(result);
+        w->n -= 1;
+        w->stats->folded++;
+        return true;
+    }
+
+    /* Shuffles that cancel, pushes that are dropped */
+    if ((is_prim(last, PRIM_DROP) && is_pure_push(prev)) ||
+        (is_prim(last, PRIM_SWAP) && is_prim(prev, PRIM_SWAP))) {
+        w->n -= 2;
+        w->stats->cancelled++;
+        return true;
+    }
+    if (prev2 && is_prim(last, PRIM_ROT) && is_prim(prev, PRIM_ROT) && is_prim(prev2, PRIM_ROT)) {
+        w->n -= 3;
+        w->stats->cancelled++;
+        return true;
+    }
+
+    /* Algebraic identities: 0 +, 1 *, ... */
+    if (is_const(prev, &b) && is_identity(last->prim_id, b)) {
+        w->n -= 2;
+        w->stats->cancelled++;
+        return true;
+    }
+
+    /* Strength reduction: 2^k * → k <<, and 2^k / → k >> on non-negative values */
+    int k;
+    if (is_const(prev, &b) && (k = power_of_two(b)) > 0) {
+        ir_instr_t shift;
+        bool reduce = false;
+        if (last->prim_id == PRIM_MUL) {
+            reduce = make_prim(w->dict, "<<", PRIM_LSHIFT, &shift);
+        } else if (last->prim_id == PRIM_DIV && prev2 && is_nonneg_push(prev2)) {
+            reduce = make_prim(w->dict, ">>", PRIM_RSHIFT, &shift);
+        }
+        if (reduce) {
+            *prev = make_lit(k);
+            *last = shift;
+            w->stats->reduced++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool optimize_ir(ir_buffer_t* ir, dictionary_t* dict, int level, optimizer_stats_t* stats) {
+    optimizer_stats_t local;
+    memset(&local, 0, sizeof(local));
+    if (!stats) stats = &local;
+
+    size_t before = ir_cell_count(ir);
+    stats->cells_before += before;
+    if (level < OPT_PEEPHOLE || ir->count == 0) {
+        stats->cells_after += before;
+        return true;
+    }
+
+    ir_instr_t* out = malloc(sizeof(ir_instr_t) * ir->count);
+    if (!out) {
+        stats->cells_after += before;
+        return false;
+    }
+
+    window_t w = {out, 0, dict, stats};
+    for (size_t i = 0; i < ir->count; i++) {
+        w.out[w.n++] = ir->instrs[i];
+        while (reduce_tail(&w)) {
+            /* Rewrite until the tail is stable */
+        }
+    }
+
+    /* Window never grows past the input */
+    memcpy(ir->instrs, w.out, sizeof(ir_instr_t) * w.n);
+    ir->count = w.n;
+    free(out);
+
+    stats->cells_after += ir_cell_count(ir);
+    return true;
+}
+
+void optimizer_stats_add(optimizer_stats_t* dst, const optimizer_stats_t* src) {
+    dst->cells_before += src->cells_before;
+    dst->cells_after += src->cells_after;
+    dst->folded += src->folded;
+    dst->cancelled += src->cancelled;
+    dst->reduced += src->reduced;
+    dst->inlined += src->inlined;
+    dst->tail_calls += src->tail_calls;
+    dst->dead_arms += src->dead_arms;
+    dst->evaluated += src->evaluated;
+}
+
+size_t optimizer_dispatches_saved(const optimizer_stats_t* stats) {
+    return stats->cells_before - stats->cells_after + 2 * (size_t)stats->inlined;
+}
+
+/* Control reaches the end of the code from instrs[i] without executing
+ * anything but unconditional branches */
+static bool in_tail_position(const ir_buffer_t* ir, const size_t* label_pos, size_t i) {
+    size_t steps = 0;
+    size_t j = i + 1;
+    while (j < ir->count) {
+        if (++steps > ir->count) return false;      /* Branch cycle */
+        const ir_instr_t* in = &ir->instrs[j];
+        if (in->op == IR_LABEL) {
+            j++;
+        } else if (in->op == IR_BRANCH && in->prim_id == PRIM_BRANCH) {
+            j = label_pos[in->value];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool eliminate_tail_calls(ir_buffer_t* ir, dictionary_t* dict, bool self_loop,
+                          bool jump_calls, optimizer_stats_t* stats) {
+    ir_instr_t branch, tailcall;
+    bool has_branch = make_prim(dict, "branch", PRIM_BRANCH, &branch);
+    bool has_tailcall = jump_calls && make_prim(dict, "tailcall", PRIM_TAILCALL, &tailcall);
+    branch.op = IR_BRANCH;
+
+    size_t* label_pos = malloc(sizeof(size_t) * (ir->label_count > 0 ? ir->label_count : 1));
+    if (!label_pos) return false;
+    for (int l = 0; l < ir->label_count; l++) {
+        label_pos[l] = ir->count;               /* Unplaced: never reached */
+    }
+    for (size_t i = 0; i < ir->count; i++) {
+        if (ir->instrs[i].op == IR_LABEL) label_pos[ir->instrs[i].value] = i;
+    }
+
+    /* Rewrite into a copy: self loops need a label before the first instruction */
+    ir_buffer_t* out = ir_buffer_create();
+    if (!out) {
+        free(label_pos);
+        return false;
+    }
+    out->label_count = ir->label_count;
+    int start = ir_new_label(out);
+    bool ok = ir_emit_label(out, start);
+    int rewritten = 0;
+
+    for (size_t i = 0; ok && i < ir->count; i++) {
+        const ir_instr_t* in = &ir->instrs[i];
+        bool tail = (in->op == IR_RECURSE ||
+                     (in->op == IR_REF && in->ref_kind == BLOB_WORD)) &&
+                    in_tail_position(ir, label_pos, i);
+
+        if (in->op == IR_RECURSE && tail && self_loop && has_branch) {
+            /* Inputs are already in place: loop back to the start */
+            branch.value = start;
+            ok = ir_emit(out, &branch);
+            rewritten++;
+        } else if (in->op == IR_REF && tail && has_tailcall) {
+            ok = ir_emit(out, &tailcall) && ir_emit(out, in);
+            rewritten++;
+        } else {
+            ok = ir_emit(out, in);
+        }
+    }
+    free(label_pos);
+
+    if (ok && rewritten > 0) {
+        ir_instr_t* instrs = ir->instrs;
+        ir->instrs = out->instrs;
+        ir->count = out->count;
+        ir->capacity = out->capacity;
+        ir->label_count = out->label_count;
+        out->instrs = instrs;
+        if (stats) stats->tail_calls += rewritten;
+    }
+    ir_buffer_free(out);
+    return ok;
+}
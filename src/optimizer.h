@@ -0,0 +1,64 @@
+/*
+ * March Language - Peephole Optimizer
+ * Constant folding and stack-shuffle cancellation over a word's IR
+ */
+
+#ifndef MARCH_OPTIMIZER_H
+#define MARCH_OPTIMIZER_H
+
+#include "ir.h"
+#include "dictionary.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Literal cells carry 62 bits; larger results stay runtime computations */
+#define LIT_MIN (-(INT64_C(1) << 61))
+#define LIT_MAX ((INT64_C(1) << 61) - 1)
+
+/* Optimization levels (marchc -O) */
+#define OPT_NONE      0
+#define OPT_PEEPHOLE  1
+#define OPT_INLINE    2     /* Peephole, after inlining small callees (inliner.h) */
+
+/* Running totals (summed over every word and quotation optimized) */
+typedef struct {
+    size_t cells_before;            /* Cells before optimization */
+    size_t cells_after;             /* Cells after: the difference is dispatches saved */
+    int folded;                     /* Constant expressions evaluated */
+    int cancelled;                  /* Shuffles and dead pushes removed */
+    int reduced;                    /* Multiplies/divides turned into shifts */
+    int inlined;                    /* Calls and executes replaced by the callee body */
+    int tail_calls;                 /* Calls in tail position turned into jumps */
+    int dead_arms;                  /* if arms never compiled (literal flag) */
+    int evaluated;                  /* Pure calls run at compile time (evaluator.h) */
+} optimizer_stats_t;
+
+/* Known i64 constant pushed by in (a literal or i64 data reference) */
+bool optimizer_const_value(const ir_instr_t* in, int64_t* value);
+
+/* Evaluate a primitive on constants the way the VM would: binary
+ * operators take a (deeper) and b, unary ones a. False if prim_id is not
+ * an arithmetic, comparison or logic primitive, or would trap. */
+bool optimizer_fold_binary(uint16_t prim_id, int64_t a, int64_t b, int64_t* result);
+bool optimizer_fold_unary(uint16_t prim_id, int64_t a, int64_t* result);
+
+/* Rewrite ir in place. Patterns never match across labels or branches,
+ * so straight-line runs are optimized independently. dict supplies the
+ * replacement primitives; stats may be NULL. */
+bool optimize_ir(ir_buffer_t* ir, dictionary_t* dict, int level, optimizer_stats_t* stats);
+
+/* Calls in tail position (followed only by unconditional branches to the
+ * end, as at the end of if branches): with self_loop, a recursive call
+ * (IR_RECURSE) becomes a branch to the start of the code; with jump_calls,
+ * a word call gets a tailcall prefix so it reuses the caller's frame. */
+bool eliminate_tail_calls(ir_buffer_t* ir, dictionary_t* dict, bool self_loop,
+                          bool jump_calls, optimizer_stats_t* stats);
+
+/* Add src totals into dst */
+void optimizer_stats_add(optimizer_stats_t* dst, const optimizer_stats_t* src);
+
+/* Dispatches saved per pass through the optimized code: cells removed,
+ * plus the call and EXIT of every inlined callee */
+size_t optimizer_dispatches_saved(const optimizer_stats_t* stats);
+
+#endif /* MARCH_OPTIMIZER_H */
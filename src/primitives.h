@@ -73,6 +73,13 @@ extern void op_i0(void);
 /* Quotation execution */
 extern void op_execute(void);
 
+/* Tail call (compiler-emitted, before a word call in tail position) */
+extern void op_tailcall(void);
+
+/* Memo table around `$ memo` words (compiler-emitted) */
+extern void op_memo_enter(void);
+extern void op_memo_exit(void);
+
 /* Memory management */
 extern void op_alloc(void);
 extern void op_free(void);
@@ -105,7 +112,11 @@ extern void op_map_free(void);
  */
 extern void* primitive_dispatch_table[256];
 
-/* Register all primitives in dictionary */
+/* Primitives of primitives.def as builtin words (generated, see primtab.h) */
+extern const dict_builtins_t primitive_builtins;
+
+/* Register all primitives in dictionary (no startup work: the dictionary
+ * consults primitive_builtins) */
 void register_primitives(dictionary_t* dict);
 
 #endif /* MARCH_PRIMITIVES_H */
@@ -0,0 +1,81 @@
+/*
+ * March Language - Compiler Server Protocol Implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "protocol.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+bool protocol_write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool protocol_read_request(int fd, char* line, size_t size) {
+    size_t len = 0;
+    while (len + 1 < size) {
+        ssize_t n = read(fd, line + len, size - 1 - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += (size_t)n;
+        if (memchr(line, '\n', len)) break;
+    }
+    line[len] = '\0';
+
+    char* end = strchr(line, '\n');
+    if (end) *end = '\0';
+    else if (len + 1 >= size) return false;
+    if (len > 0 && line[strlen(line) - 1] == '\r') line[strlen(line) - 1] = '\0';
+    return line[0] != '\0';
+}
+
+bool protocol_write_status(int fd, bool ok) {
+    char status[2] = { '\0', ok ? '0' : '1' };
+    return protocol_write_all(fd, status, sizeof(status));
+}
+
+int protocol_copy_reply(int fd, FILE* out) {
+    /* The last two bytes seen are held back: at the end they are the NUL
+     * separator and the status */
+    char buf[4096];
+    char tail[2];
+    size_t held = 0;
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        size_t len = (size_t)n;
+        if (held + len <= 2) {
+            memcpy(tail + held, buf, len);
+            held += len;
+            continue;
+        }
+
+        /* All but the last two of tail + buf go out, oldest first */
+        size_t release = held + len - 2;
+        size_t from_tail = release < held ? release : held;
+        fwrite(tail, 1, from_tail, out);
+        memmove(tail, tail + from_tail, held - from_tail);
+        held -= from_tail;
+
+        size_t from_buf = release - from_tail;
+        fwrite(buf, 1, from_buf, out);
+        memcpy(tail + held, buf + from_buf, len - from_buf);
+        held += len - from_buf;
+    }
+    fflush(out);
+
+    if (held < 2 || tail[0] != '\0') return -1;
+    return tail[1] == '0' ? 0 : 1;
+}
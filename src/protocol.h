@@ -0,0 +1,29 @@
+/*
+ * March Language - Compiler Server Protocol
+ * Request and reply framing shared by marchc --serve and its clients
+ */
+
+#ifndef MARCH_PROTOCOL_H
+#define MARCH_PROTOCOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Write all of data, retrying short writes. False if the peer is gone. */
+bool protocol_write_all(int fd, const char* data, size_t len);
+
+/* Read one request line (command and argument, without the newline or a
+ * trailing CR). False if the client sent nothing usable or the line does
+ * not fit in size. */
+bool protocol_read_request(int fd, char* line, size_t size);
+
+/* End a reply: a NUL byte and the status ('0' ok, '1' failed) */
+bool protocol_write_status(int fd, bool ok);
+
+/* Copy a reply to out up to its NUL and status byte, however the reads
+ * split it. Returns the status (0 ok, 1 failed), or -1 if the connection
+ * closed without one. */
+int protocol_copy_reply(int fd, FILE* out);
+
+#endif /* MARCH_PROTOCOL_H */
@@ -6,6 +6,7 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "types.h"
+#include "debug.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -75,22 +76,13 @@ void ref_graph_clear(ref_graph_t* graph) {
 /* ============================================================================ */
 
 node_id_t ref_graph_alloc_node(ref_graph_t* graph, type_id_t obj_type, int slot_id) {
-    fprintf(stderr, "TRACE: ref_graph_alloc_node(graph=%p, type=%d, slot=%d)\n",
-            (void*)graph, obj_type, slot_id);
-    fflush(stderr);
-
     if (!graph) {
         /* Gracefully handle NULL graph (compilation contexts without ref_graph) */
-        fprintf(stderr, "TRACE: ref_graph_alloc_node - NULL graph, returning INVALID\n");
-        fflush(stderr);
         return NODE_ID_INVALID;
     }
 
     /* Allocate new node ID */
     node_id_t new_id = graph->next_node_id++;
-    fprintf(stderr, "TRACE: Allocated node_id=%u, will add to graph with %zu existing nodes\n",
-            new_id, graph->node_count);
-    fflush(stderr);
 
     /* Grow node array if needed */
     if (graph->node_count >= graph->node_capacity) {
@@ -140,9 +132,8 @@ node_id_t ref_graph_alloc_node(ref_graph_t* graph, type_id_t obj_type, int slot_
     /* Update index mapping */
     graph->node_index[new_id] = idx;
 
-    fprintf(stderr, "TRACE: Successfully added node_id=%u at index=%zu, graph now has %zu nodes\n",
-            new_id, idx, graph->node_count);
-    fflush(stderr);
+    TRACE_TOKEN(DEBUG_COMPILER, "ref_graph: node %u (type=%d slot=%d) at index %zu of %zu",
+                new_id, obj_type, slot_id, idx, graph->node_count);
 
     return new_id;
 }
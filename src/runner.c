@@ -4,7 +4,6 @@
 
 #include "runner.h"
 #include "cells.h"  /* For encode_xt, encode_exit */
-#include "database.h"  /* For db_store_blob, db_store_type_sig */
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -34,73 +33,22 @@ bool runner_execute(runner_t* runner, const char* name) {
     /* Lookup word in dictionary */
     dict_entry_t* entry = dict_lookup(runner->loader->dict, name);
 
-    /* Phase 5: Check if word has tokens but no compiled code (Design B) */
-    if (entry && entry->word_def && !entry->cid) {
-        if (runner->comp->verbose) {
-            printf("\nOn-demand compilation: %s\n", name);
-        }
-
-        /* For top-level execution words, use empty input types (no args expected) */
-        /* The word will be compiled with whatever types it produces */
-        type_id_t empty_inputs[1];  /* Unused, but need valid array */
-        int input_count = entry->signature.input_count;
-
-        /* Compile the word with its defined signature */
-        blob_buffer_t* compiled_blob = word_compile_with_context(
-            runner->comp, entry->word_def, empty_inputs, input_count
-        );
-
-        if (!compiled_blob) {
-            fprintf(stderr, "Error: Failed to compile word '%s' on-demand\n", name);
-            return false;
-        }
-
-        /* Build type signature string from word's signature */
-        char type_sig_str[256] = "-> ";  /* Top-level words have no inputs */
-        char* p = type_sig_str + 3;
-        for (int i = 0; i < entry->signature.output_count; i++) {
-            type_id_t t = entry->signature.outputs[i];
-            switch (t) {
-                case TYPE_I64: p += sprintf(p, "i64 "); break;
-                case TYPE_U64: p += sprintf(p, "u64 "); break;
-                case TYPE_F64: p += sprintf(p, "f64 "); break;
-                case TYPE_PTR: p += sprintf(p, "ptr "); break;
-                case TYPE_BOOL: p += sprintf(p, "bool "); break;
-                case TYPE_STR: p += sprintf(p, "str "); break;
-                case TYPE_STR_MUT: p += sprintf(p, "str! "); break;
-                case TYPE_ARRAY: p += sprintf(p, "array "); break;
-                case TYPE_ARRAY_MUT: p += sprintf(p, "array! "); break;
-                default: p += sprintf(p, "? "); break;
-            }
-        }
-
-        /* Store the compiled blob in database */
-        unsigned char* sig_cid = db_store_type_sig(runner->loader->db, NULL, type_sig_str);
-        if (!sig_cid) {
-            fprintf(stderr, "Error: Failed to store type signature for on-demand compilation\n");
-            blob_buffer_free(compiled_blob);
-            return false;
-        }
-
-        unsigned char* cid = db_store_blob(runner->loader->db, BLOB_WORD, sig_cid,
-                                           compiled_blob->data, compiled_blob->size);
-        free(sig_cid);
-        blob_buffer_free(compiled_blob);
-
-        if (!cid) {
-            fprintf(stderr, "Error: Failed to store compiled word\n");
-            return false;
-        }
-
-        /* Update dictionary entry with the new CID */
-        if (entry->cid) {
-            free(entry->cid);
-        }
-        entry->cid = cid;
+    /* Phase 5: Tokens but no compiled code yet (Design B). Without a
+     * compiler (marchc run) every entry comes bound to its CID. */
+    if (entry && runner->comp && !compiler_compile_entry(runner->comp, entry)) {
+        return false;
+    }
 
-        if (runner->comp->verbose) {
-            printf("  Stored compiled version in database\n");
-        }
+    /* Known not to fit: fail here instead of overflowing the VM stacks.
+     * The bootstrap call below adds one return address. */
+    stack_depth_t depth;
+    if (entry && entry->cid && loader_stack_depth(runner->loader, entry->cid, &depth) &&
+        stack_depth_bounded(&depth) &&
+        (depth.data_max > VM_DATA_STACK_CELLS || depth.return_max + 1 > VM_RETURN_STACK_CELLS)) {
+        fprintf(stderr, "Error: '%s' needs %d data and %d return stack cells (VM has %d and %d)\n",
+                name, depth.data_max, depth.return_max + 1,
+                VM_DATA_STACK_CELLS, VM_RETURN_STACK_CELLS);
+        return false;
     }
 
     /* Try CID-based linking */
@@ -140,6 +88,14 @@ bool runner_execute(runner_t* runner, const char* name) {
     return true;
 }
 
+bool runner_stack_depth(runner_t* runner, const char* name, stack_depth_t* depth) {
+    dict_entry_t* entry = dict_lookup(runner->loader->dict, name);
+    if (entry && runner->comp && !compiler_compile_entry(runner->comp, entry)) {
+        return false;
+    }
+    return entry && entry->cid && loader_stack_depth(runner->loader, entry->cid, depth);
+}
+
 /* Get stack contents after execution */
 int runner_get_stack(runner_t* runner, int64_t* stack, int max_depth) {
     (void)runner;  /* Unused - VM is global state */
@@ -18,19 +18,29 @@ extern void vm_run(uint64_t* code);
 extern uint64_t* vm_get_dsp(void);
 extern uint64_t data_stack_base[1024];  /* BSS array, not pointer */
 
+/* VM stack sizes in cells (vm.asm) */
+#define VM_DATA_STACK_CELLS   1024
+#define VM_RETURN_STACK_CELLS 1024
+
 /* Runner context */
 typedef struct {
     loader_t* loader;
-    compiler_t* comp;  /* For on-demand compilation of token-based words (Phase 5) */
+    compiler_t* comp;  /* For on-demand compilation of token-based words (Phase 5);
+                          NULL when running prebuilt code from a database */
 } runner_t;
 
 /* Create/free runner */
 runner_t* runner_create(loader_t* loader, compiler_t* comp);
 void runner_free(runner_t* runner);
 
-/* Execute a word by name */
+/* Execute a word by name. A word whose recorded stack depth exceeds the
+ * VM stacks is rejected before it runs. */
 bool runner_execute(runner_t* runner, const char* name);
 
+/* Stack depth recorded for a word (compiled on demand first); false if
+ * the word is unknown or its depth was never analyzed */
+bool runner_stack_depth(runner_t* runner, const char* name, stack_depth_t* depth);
+
 /* Get stack contents after execution */
 int runner_get_stack(runner_t* runner, int64_t* stack, int max_depth);
 
@@ -0,0 +1,317 @@
+/*
+ * March Language - Compiler Server
+ * A warm compiler (database, dictionary, specialization cache, linked
+ * loader) answering requests on a Unix domain socket (marchc --serve)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "server.h"
+#include "protocol.h"
+#include "compiler.h"
+#include "loader.h"
+#include "runner.h"
+#include "database.h"
+#include "dictionary.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Everything kept warm between requests */
+typedef struct {
+    march_db_t* db;
+    dictionary_t* dict;
+    compiler_t* comp;
+    loader_t* loader;        /* Created on the first run, dropped when a compile changes words */
+    runner_t* runner;
+    char* current_file;      /* Crash context keeps a pointer to it */
+    int jobs;
+    bool verbose;
+} server_t;
+
+void server_options_init(server_options_t* opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->socket_path = SERVER_DEFAULT_SOCKET;
+    opts->db_path = "march.db";
+    opts->jobs = 1;
+    opts->opt_level = OPT_NONE;
+}
+
+static bool unix_address(const char* path, struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Error: Socket path too long: %s\n", path);
+        return false;
+    }
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+static void server_drop_runner(server_t* srv) {
+    if (srv->runner) runner_free(srv->runner);
+    if (srv->loader) loader_free(srv->loader);
+    srv->runner = NULL;
+    srv->loader = NULL;
+}
+
+static void server_free(server_t* srv) {
+    server_drop_runner(srv);
+    if (srv->comp) compiler_free(srv->comp);
+    if (srv->dict) dict_free(srv->dict);
+    if (srv->db) db_close(srv->db);
+    crash_context_set_file(NULL);
+    free(srv->current_file);
+}
+
+static bool server_init(server_t* srv, const server_options_t* opts) {
+    memset(srv, 0, sizeof(*srv));
+    srv->jobs = opts->jobs;
+    srv->verbose = opts->verbose;
+
+    srv->db = db_open(opts->db_path);
+    if (!srv->db) {
+        fprintf(stderr, "Error: Cannot open database: %s\n", opts->db_path);
+        return false;
+    }
+    db_init_schema(srv->db, NULL);
+
+    if (opts->cid_hash) {
+        cid_hash_t hash;
+        if (!cid_hash_parse(opts->cid_hash, &hash)) {
+            fprintf(stderr, "Error: Unknown CID hash '%s' (expected sha256 or blake2s)\n",
+                    opts->cid_hash);
+            return false;
+        }
+        if (!db_set_cid_hash(srv->db, hash)) return false;
+    }
+
+    srv->dict = dict_create();
+    if (!srv->dict) {
+        fprintf(stderr, "Error: Cannot create dictionary\n");
+        return false;
+    }
+    srv->comp = compiler_create(srv->dict, srv->db);
+    if (!srv->comp) {
+        fprintf(stderr, "Error: Cannot create compiler\n");
+        return false;
+    }
+    srv->comp->verbose = opts->verbose;
+    srv->comp->opt_level = opts->opt_level;
+
+    crash_context_set_phase("register_primitives");
+    compiler_register_primitives(srv->comp);
+    return true;
+}
+
+/* compile <file>: definitions whose source is unchanged are skipped by
+ * the compiler, so only edits cost anything */
+static bool handle_compile(server_t* srv, const char* path) {
+    if (!*path) {
+        fprintf(stderr, "Error: compile needs a file\n");
+        return false;
+    }
+
+    char* file = strdup(path);
+    if (!file) return false;
+    crash_context_set_file(file);
+    free(srv->current_file);
+    srv->current_file = file;
+
+    int defs_before = srv->comp->word_def_count;
+    crash_context_set_phase("compile");
+    bool ok = compiler_compile_file(srv->comp, file);
+    if (ok && srv->jobs > 1) ok = compiler_compile_parallel(srv->comp, srv->jobs);
+    if (!ok) fprintf(stderr, "Compilation failed\n");
+
+    /* A linked word may have been redefined: recompile its callers and
+     * relink on the next run */
+    int changed = srv->comp->word_def_count - defs_before;
+    if (changed > 0) {
+        compiler_forget_entries(srv->comp);
+        server_drop_runner(srv);
+    }
+
+    if (ok && srv->verbose) {
+        printf("✓ %s: %d definitions new or changed\n", file, changed);
+    }
+    return ok;
+}
+
+static bool handle_run(server_t* srv, const char* word) {
+    if (!*word) {
+        fprintf(stderr, "Error: run needs a word\n");
+        return false;
+    }
+
+    if (!srv->runner) {
+        srv->loader = loader_create(srv->db, srv->dict);
+        if (!srv->loader) {
+            fprintf(stderr, "Error: Cannot create loader\n");
+            return false;
+        }
+        srv->runner = runner_create(srv->loader, srv->comp);
+        if (!srv->runner) {
+            fprintf(stderr, "Error: Cannot create runner\n");
+            server_drop_runner(srv);
+            return false;
+        }
+    }
+
+    crash_context_set_phase("execute");
+    crash_context_set_word(word);
+    bool ok = runner_execute(srv->runner, word);
+    crash_context_set_word(NULL);
+    if (!ok) fprintf(stderr, "Execution failed\n");
+    return ok;
+}
+
+static bool handle_stack(server_t* srv) {
+    if (!srv->runner) {
+        fprintf(stderr, "Error: Nothing has run yet\n");
+        return false;
+    }
+    runner_print_stack(srv->runner);
+    return true;
+}
+
+/* Serve one connection with stdout and stderr redirected to it */
+static bool serve_client(server_t* srv, int client, bool* stop) {
+    char line[SERVER_MAX_REQUEST];
+    if (!protocol_read_request(client, line, sizeof(line))) {
+        const char reply[] = "Error: Bad request\n\0" "1";
+        protocol_write_all(client, reply, sizeof(reply) - 1);
+        return false;
+    }
+
+    char* arg = strchr(line, ' ');
+    if (arg) {
+        *arg++ = '\0';
+        while (*arg == ' ') arg++;
+    } else {
+        arg = line + strlen(line);
+    }
+
+    if (srv->verbose) fprintf(stderr, "marchc: %s %s\n", line, arg);
+
+    fflush(stdout);
+    fflush(stderr);
+    int saved_out = dup(STDOUT_FILENO);
+    int saved_err = dup(STDERR_FILENO);
+    dup2(client, STDOUT_FILENO);
+    dup2(client, STDERR_FILENO);
+
+    bool ok;
+    if (strcmp(line, "compile") == 0) {
+        ok = handle_compile(srv, arg);
+    } else if (strcmp(line, "run") == 0) {
+        ok = handle_run(srv, arg);
+    } else if (strcmp(line, "stack") == 0) {
+        ok = handle_stack(srv);
+    } else if (strcmp(line, "stop") == 0) {
+        *stop = true;
+        ok = true;
+    } else {
+        fprintf(stderr, "Error: Unknown request '%s' (compile, run, stack, stop)\n", line);
+        ok = false;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_out);
+    close(saved_err);
+
+    protocol_write_status(client, ok);
+    return ok;
+}
+
+int server_run(const server_options_t* opts) {
+    struct sockaddr_un addr;
+    if (!unix_address(opts->socket_path, &addr)) return 1;
+
+    server_t srv;
+    if (!server_init(&srv, opts)) {
+        server_free(&srv);
+        return 1;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        server_free(&srv);
+        return 1;
+    }
+
+    /* A socket left behind by a server that did not stop cleanly */
+    unlink(opts->socket_path);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 16) < 0) {
+        fprintf(stderr, "Error: Cannot listen on %s: %s\n", opts->socket_path, strerror(errno));
+        close(listener);
+        server_free(&srv);
+        return 1;
+    }
+
+    /* A client that hangs up early must not take the server with it */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (opts->verbose) {
+        printf("Serving %s on %s\n", opts->db_path, opts->socket_path);
+        fflush(stdout);
+    }
+
+    /* One request at a time: the compiler state is shared */
+    bool stop = false;
+    while (!stop) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        serve_client(&srv, client, &stop);
+        close(client);
+    }
+
+    close(listener);
+    unlink(opts->socket_path);
+    server_free(&srv);
+    return stop ? 0 : 1;
+}
+
+int server_request(const char* socket_path, const char* request) {
+    struct sockaddr_un addr;
+    if (!unix_address(socket_path, &addr)) return 1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Error: Cannot connect to %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return 1;
+    }
+
+    if (!protocol_write_all(fd, request, strlen(request)) || !protocol_write_all(fd, "\n", 1)) {
+        fprintf(stderr, "Error: Cannot send request to %s\n", socket_path);
+        close(fd);
+        return 1;
+    }
+
+    int status = protocol_copy_reply(fd, stdout);
+    close(fd);
+    if (status < 0) {
+        fprintf(stderr, "Error: Server closed the connection without a status\n");
+        return 1;
+    }
+    return status;
+}
@@ -0,0 +1,46 @@
+/*
+ * March Language - Compiler Server
+ * A warm compiler (database, dictionary, specialization cache, linked
+ * loader) answering requests on a Unix domain socket (marchc --serve)
+ */
+
+#ifndef MARCH_SERVER_H
+#define MARCH_SERVER_H
+
+#include <stdbool.h>
+
+/* Server options */
+typedef struct {
+    const char* socket_path;
+    const char* db_path;
+    const char* cid_hash;    /* For a new database, or NULL */
+    int jobs;                /* Threads specializing typed words after a compile */
+    int opt_level;
+    bool verbose;
+} server_options_t;
+
+#define SERVER_DEFAULT_SOCKET "march.sock"
+
+/* Request line limit (command and argument) */
+#define SERVER_MAX_REQUEST 4096
+
+/* Fill options with defaults */
+void server_options_init(server_options_t* opts);
+
+/* Serve requests one at a time until a "stop" request. Each request is one
+ * line on its own connection:
+ *
+ *   compile <file>   Compile a file (absolute path) into the warm compiler
+ *   run <word>       Compile the word if needed and execute it
+ *   stack            Print the data stack left by the last run
+ *   stop             Stop serving
+ *
+ * The reply is everything the request wrote to stdout and stderr, then a
+ * NUL byte and the status ('0' ok, '1' failed). Returns the exit status. */
+int server_run(const server_options_t* opts);
+
+/* Client: send one request and copy the reply to stdout. Returns the
+ * request's status (1 if the server cannot be reached). */
+int server_request(const char* socket_path, const char* request);
+
+#endif /* MARCH_SERVER_H */
@@ -0,0 +1,177 @@
+/*
+ * March Language - Deploy Bundle Tests
+ */
+
+#include "test_framework.h"
+#include "database.h"
+#include "bundle.h"
+#include "cells.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/* Store a code blob referencing the given CIDs */
+static unsigned char* store_code(march_db_t* db, unsigned char** refs, uint16_t* kinds,
+                                 int count, int64_t salt) {
+    blob_buffer_t* buf = blob_buffer_create();
+    encode_inline_literal(buf, salt);
+    encode_primitive(buf, 2);
+    for (int i = 0; i < count; i++) {
+        encode_cid_ref(buf, kinds[i], refs[i]);
+    }
+    unsigned char* sig = db_store_type_sig(db, NULL, "i64");
+    unsigned char* cid = db_store_blob(db, BLOB_WORD, sig, buf->data, buf->size);
+    free(sig);
+    blob_buffer_free(buf);
+    return cid;
+}
+
+/* Index of cid in the order blobs were read (-1 if absent) */
+static int read_position(unsigned char order[][CID_SIZE], int count, const unsigned char* cid) {
+    for (int i = 0; i < count; i++) {
+        if (memcmp(order[i], cid, CID_SIZE) == 0) return i;
+    }
+    return -1;
+}
+
+/* Rewrite a bundle's decompressed stream: drop its last 'cut' bytes, then
+ * flip a bit 'flip_from_end' bytes before the new end (0: no flip) */
+static bool damage_bundle(const char* path, size_t cut, size_t flip_from_end) {
+    static uint8_t stream[1 << 20];
+    gzFile in = gzopen(path, "rb");
+    if (!in) return false;
+    int len = gzread(in, stream, sizeof(stream));
+    gzclose(in);
+    if (len <= 0 || (size_t)len <= cut + flip_from_end) return false;
+    len -= (int)cut;
+    if (flip_from_end) stream[len - flip_from_end] ^= 0x01;
+
+    gzFile out = gzopen(path, "wb");
+    if (!out) return false;
+    bool ok = gzwrite(out, stream, (unsigned)len) == len;
+    return gzclose(out) == Z_OK && ok;
+}
+
+/* Blobs a bundle reader returns before stopping */
+static int count_readable(const char* path) {
+    bundle_reader_t* reader = bundle_reader_open(path);
+    if (!reader) return -1;
+    bundle_blob_t blob;
+    int n = 0;
+    while (bundle_reader_next(reader, &blob)) n++;
+    bundle_reader_close(reader);
+    return n;
+}
+
+int main(void) {
+    TEST_SUITE("Deploy Bundles");
+
+    const char* src_db = "test_bundle_src.db";
+    const char* dst_db = "test_bundle_dst.db";
+    const char* bundle = "test_bundle.mb";
+    unlink(src_db);
+    unlink(dst_db);
+    unlink(bundle);
+
+    march_db_t* db = db_open(src_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    /* main -> helper -> lit ; main -> lit ; unrelated word stays behind */
+    unsigned char* lit = db_store_literal(db, 7, "i64");
+    unsigned char* helper_refs[] = {lit};
+    uint16_t helper_kinds[] = {BLOB_DATA};
+    unsigned char* helper = store_code(db, helper_refs, helper_kinds, 1, 1);
+    unsigned char* main_refs[] = {helper, lit};
+    uint16_t main_kinds[] = {BLOB_WORD, BLOB_DATA};
+    unsigned char* main_cid = store_code(db, main_refs, main_kinds, 2, 2);
+    unsigned char* other = store_code(db, NULL, NULL, 0, 3);
+    ASSERT(db_bind_word(db, "main", NULL, main_cid, "-> i64"));
+    ASSERT(db_bind_word(db, "other", NULL, other, "-> i64"));
+
+    bundle_stats_t stats;
+    ASSERT(bundle_export(db, "main", NULL, bundle, &stats));
+    ASSERT_EQ(stats.blob_count, 3);
+    ASSERT(!bundle_export(db, "missing", NULL, bundle, &stats));
+    db_close(db);
+
+    /* Dependencies precede dependents, root last */
+    bundle_reader_t* reader = bundle_reader_open(bundle);
+    ASSERT_NOT_NULL(reader);
+    ASSERT_STR_EQ(reader->name, "main");
+    unsigned char order[8][CID_SIZE];
+    int n = 0;
+    bundle_blob_t blob;
+    while (n < 8 && bundle_reader_next(reader, &blob)) {
+        memcpy(order[n++], blob.cid, CID_SIZE);
+    }
+    ASSERT(bundle_reader_done(reader));
+    ASSERT(read_position(order, n, lit) < read_position(order, n, helper));
+    ASSERT(read_position(order, n, helper) < read_position(order, n, main_cid));
+    ASSERT_EQ(read_position(order, n, main_cid), n - 1);
+    ASSERT_EQ(read_position(order, n, other), -1);
+    bundle_reader_close(reader);
+
+    /* Import into a fresh database */
+    db = db_open(dst_db);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+    ASSERT(bundle_import(db, bundle, &stats));
+    ASSERT(db_get_blob_kind(db, main_cid) == BLOB_WORD);
+    ASSERT(db_get_blob_kind(db, lit) == BLOB_DATA);
+    ASSERT(db_get_blob_kind(db, other) < 0);
+    db_close(db);
+
+    /* Overloads: the root is chosen by signature, never guessed */
+    db = db_open(src_db);
+    ASSERT(db_bind_word(db, "main", NULL, other, "i64 -> i64"));
+    ASSERT(db_bind_word(db, "main", NULL, main_cid, "-> i64"));   /* Rebound in place */
+    ASSERT(!bundle_export(db, "main", NULL, bundle, &stats));
+    ASSERT(bundle_export(db, "main", "-> i64", bundle, &stats));
+    ASSERT_EQ(stats.blob_count, 3);
+    ASSERT(bundle_export(db, "main", "i64 -> i64", bundle, &stats));
+    ASSERT_EQ(stats.blob_count, 1);
+    ASSERT(!bundle_export(db, "main", "f64 -> f64", bundle, &stats));
+    db_close(db);
+
+    /* A chain longer than the reader's batch window */
+    const int chain_len = BUNDLE_READ_BATCH * 2 + 5;
+    db = db_open(src_db);
+    unsigned char* link = NULL;
+    for (int i = 0; i < chain_len; i++) {
+        uint16_t kind = BLOB_WORD;
+        unsigned char* next = store_code(db, link ? &link : NULL, &kind, link ? 1 : 0, 100 + i);
+        free(link);
+        link = next;
+    }
+    ASSERT(db_bind_word(db, "chain", NULL, link, "-> i64"));
+    ASSERT(bundle_export(db, "chain", NULL, bundle, &stats));
+    db_close(db);
+    ASSERT_EQ(count_readable(bundle), chain_len);
+
+    db = db_open(dst_db);
+    ASSERT(bundle_import(db, bundle, &stats));
+    ASSERT_EQ(stats.blob_count, (uint32_t)chain_len);
+    ASSERT(db_get_blob_kind(db, link) == BLOB_WORD);
+    db_close(db);
+
+    /* A damaged root blob is rejected after every blob before it */
+    ASSERT(damage_bundle(bundle, 0, 1));
+    ASSERT_EQ(count_readable(bundle), chain_len - 1);
+
+    /* So is a bundle cut off inside its last blob */
+    ASSERT(damage_bundle(bundle, 4, 0));
+    ASSERT_EQ(count_readable(bundle), chain_len - 1);
+    free(link);
+
+    free(lit);
+    free(helper);
+    free(main_cid);
+    free(other);
+    unlink(src_db);
+    unlink(dst_db);
+    unlink(bundle);
+
+    TEST_SUMMARY();
+}
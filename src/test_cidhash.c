@@ -0,0 +1,75 @@
+/*
+ * Tests for cidhash.c
+ */
+
+#include "test_framework.h"
+#include "cidhash.h"
+
+/* SHA-256("abc") */
+static const unsigned char sha256_abc[CID_SIZE] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+/* Batch of blobs with lengths around every padding boundary */
+#define BATCH_COUNT 21
+static const size_t batch_lens[BATCH_COUNT] = {
+    0, 1, 16, 55, 56, 63, 64, 65, 119, 120, 128, 200,
+    1000, 1024, 4095, 4096, 4097, 8192, 3, 33, 70000
+};
+
+int main(void) {
+    TEST_SUITE("CID Hashing");
+
+    /* Names */
+    cid_hash_t h;
+    ASSERT(cid_hash_parse("sha256", &h) && h == CID_HASH_SHA256);
+    ASSERT(cid_hash_parse("blake2s", &h) && h == CID_HASH_BLAKE2S);
+    ASSERT(!cid_hash_parse("md5", &h));
+    ASSERT_STR_EQ(cid_hash_name(CID_HASH_BLAKE2S), "blake2s");
+
+    /* Known vector */
+    unsigned char out[CID_SIZE];
+    cid_hash_into(CID_HASH_SHA256, (const uint8_t*)"abc", 3, out);
+    ASSERT(memcmp(out, sha256_abc, CID_SIZE) == 0);
+
+    /* Different hashes give different CIDs */
+    unsigned char out_b2[CID_SIZE];
+    cid_hash_into(CID_HASH_BLAKE2S, (const uint8_t*)"abc", 3, out_b2);
+    ASSERT(memcmp(out, out_b2, CID_SIZE) != 0);
+
+    /* Batch must match single-buffer hashing for every length */
+    uint8_t* bufs[BATCH_COUNT];
+    const uint8_t* data[BATCH_COUNT];
+    for (size_t i = 0; i < BATCH_COUNT; i++) {
+        bufs[i] = malloc(batch_lens[i] + 1);
+        for (size_t j = 0; j < batch_lens[i]; j++) {
+            bufs[i][j] = (uint8_t)(i * 31 + j * 7);
+        }
+        data[i] = bufs[i];
+    }
+
+    unsigned char batch_out[BATCH_COUNT * CID_SIZE];
+    cid_hash_t hashes[2] = {CID_HASH_SHA256, CID_HASH_BLAKE2S};
+    for (int k = 0; k < 2; k++) {
+        cid_hash_batch(hashes[k], data, batch_lens, BATCH_COUNT, batch_out);
+
+        int mismatches = 0;
+        for (size_t i = 0; i < BATCH_COUNT; i++) {
+            cid_hash_into(hashes[k], data[i], batch_lens[i], out);
+            if (memcmp(out, batch_out + i * CID_SIZE, CID_SIZE) != 0) mismatches++;
+        }
+        ASSERT_EQ(mismatches, 0);
+    }
+
+    /* Partial lane group (2 blobs) */
+    cid_hash_batch(CID_HASH_SHA256, data, batch_lens, 2, batch_out);
+    cid_hash_into(CID_HASH_SHA256, data[1], batch_lens[1], out);
+    ASSERT(memcmp(out, batch_out + CID_SIZE, CID_SIZE) == 0);
+
+    for (size_t i = 0; i < BATCH_COUNT; i++) {
+        free(bufs[i]);
+    }
+
+    TEST_SUMMARY();
+}
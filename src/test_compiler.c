@@ -7,6 +7,7 @@
 #include "database.h"
 #include "dictionary.h"
 #include "cells.h"
+#include "optimizer.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
@@ -54,6 +55,60 @@ void op_twofromr(void) {}
 void op_branch(void) {}
 void op_0branch(void) {}
 
+/* Write source to path and compile it */
+static bool compile_source(compiler_t* comp, const char* path, const char* source) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fputs(source, f);
+    fclose(f);
+    return compiler_compile_file(comp, path);
+}
+
+/* Blobs of a kind stored in the database */
+static int count_blobs(march_db_t* db, int kind) {
+    sqlite3_stmt* stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(db->db, "SELECT COUNT(*) FROM blobs WHERE kind = ?;",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, kind);
+        if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+/* Bindings of a word name in the words table */
+static int count_bindings(march_db_t* db, const char* name) {
+    sqlite3_stmt* stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(db->db, "SELECT COUNT(*) FROM words WHERE name = ?;",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+/* One build as a separate marchc run would do it: a fresh compiler over
+ * db compiles source and then word, whose CID is copied to cid */
+static bool build_word(march_db_t* db, const char* path, const char* source,
+                       const char* word, unsigned char* cid) {
+    dictionary_t* dict = dict_create();
+    compiler_t* comp = dict ? compiler_create(dict, db) : NULL;
+    bool ok = comp != NULL;
+    if (ok) {
+        compiler_register_primitives(comp);
+        dict_entry_t* entry = NULL;
+        ok = compile_source(comp, path, source) && (entry = dict_lookup(dict, word)) &&
+             compiler_compile_entry(comp, entry) && entry->cid;
+        if (ok) memcpy(cid, entry->cid, CID_SIZE);
+    }
+    if (comp) compiler_free(comp);
+    if (dict) dict_free(dict);
+    return ok;
+}
+
 int main(void) {
     TEST_SUITE("One-Pass Compiler");
 
@@ -76,7 +131,7 @@ int main(void) {
     ASSERT(comp->dict == dict);
     ASSERT(comp->db == db);
     ASSERT(comp->type_stack_depth == 0);
-    ASSERT(comp->cells != NULL);
+    ASSERT(comp->ir != NULL);
 
     /* Test 2: Register primitives */
     compiler_register_primitives(comp);
@@ -141,6 +196,79 @@ int main(void) {
     ASSERT(is_exit(cells[5]));
     free(cells);
 
+    /* Test 9: Quotation cache - a repeated body is compiled and stored once
+     * (q2 differs outside the quotation, so it is compiled rather than
+     * answered from the specialization cache) */
+    comp->verbose = false;
+    ASSERT(compile_source(comp, test_source,
+                          "$ -> i64 ;\n: q1 ( 1 2 + ) execute ;\n"
+                          "$ -> i64 ;\n: q2 0 drop ( 1 2 + ) execute ;\n"));
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "q1")));
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "q2")));
+    ASSERT_EQ(comp->specs->quot_hits, 1);
+    ASSERT_EQ(comp->specs->quot_count, 1);
+    ASSERT_EQ(count_blobs(db, BLOB_QUOTATION), 1);
+
+    /* Test 10: Redefining a word the body calls misses the cache */
+    ASSERT(compile_source(comp, test_source,
+                          "$ -> i64 ;\n: three 3 ;\n"
+                          "$ -> i64 ;\n: q3 ( three ) execute ;\n"));
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "q3")));
+    ASSERT_EQ(count_blobs(db, BLOB_QUOTATION), 2);
+    ASSERT(compile_source(comp, test_source,
+                          "$ -> i64 ;\n: three 4 ;\n"
+                          "$ -> i64 ;\n: q4 0 drop ( three ) execute ;\n"));
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "q4")));
+    ASSERT_EQ(comp->specs->quot_hits, 1);
+    ASSERT_EQ(count_blobs(db, BLOB_QUOTATION), 3);
+
+    /* Test 11: if with a literal flag compiles only the arm it selects */
+    comp->opt_level = OPT_PEEPHOLE;
+    int dead_arms = comp->opt_stats.dead_arms;
+    ASSERT(compile_source(comp, test_source,
+                          "$ -> i64 ;\n: pick 1 ( 42 ) ( 99 ) if ;\n"
+                          "$ i64 -> i64 ;\n: choose ( 42 ) ( 99 ) if ;\n"));
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "pick")));
+    ASSERT_EQ(comp->opt_stats.dead_arms, dead_arms + 1);
+    ASSERT(compiler_compile_entry(comp, dict_lookup(dict, "choose")));
+    ASSERT_EQ(comp->opt_stats.dead_arms, dead_arms + 1);
+
+    /* Test 12: Whole program - -j skips what the entry cannot reach */
+    ASSERT(compile_source(comp, test_source,
+                          "$ -> i64 ;\n: leaf 1 ;\n"
+                          "$ -> i64 ;\n: root leaf ;\n"
+                          "$ -> i64 ;\n: stray 2 ;\n"));
+    const char* entries[] = {"root"};
+    ASSERT_EQ(compiler_mark_reachable(comp, entries, 1), 2);
+    const char* missing[] = {"nowhere"};
+    ASSERT_EQ(compiler_mark_reachable(comp, missing, 1), -1);
+    ASSERT_EQ(compiler_mark_reachable(comp, entries, 1), 2);
+    ASSERT(compiler_compile_parallel(comp, 2));
+    ASSERT_EQ(count_bindings(db, "root"), 1);
+    ASSERT_EQ(count_bindings(db, "leaf"), 1);
+    ASSERT_EQ(count_bindings(db, "stray"), 0);
+
+    /* Test 13: Editing a typed callee recompiles its typed caller in a
+     * later build, as a build on a fresh database would */
+    const char* callee_v1 = "$ -> i64 ;\n: callee 1 ;\n$ -> i64 ;\n: caller callee 1 + ;\n";
+    const char* callee_v2 = "$ -> i64 ;\n: callee 2 ;\n$ -> i64 ;\n: caller callee 1 + ;\n";
+    unsigned char first[CID_SIZE], again[CID_SIZE], edited[CID_SIZE], fresh[CID_SIZE];
+    ASSERT(build_word(db, test_source, callee_v1, "caller", first));
+    ASSERT(build_word(db, test_source, callee_v1, "caller", again));
+    ASSERT(memcmp(first, again, CID_SIZE) == 0);
+    ASSERT(build_word(db, test_source, callee_v2, "caller", edited));
+    ASSERT(memcmp(first, edited, CID_SIZE) != 0);
+
+    const char* fresh_db = "test_compiler_fresh.db";
+    unlink(fresh_db);
+    march_db_t* db2 = db_open(fresh_db);
+    ASSERT(db2 != NULL);
+    ASSERT(db_init_schema(db2, schema_file));
+    ASSERT(build_word(db2, test_source, callee_v2, "caller", fresh));
+    ASSERT(memcmp(edited, fresh, CID_SIZE) == 0);
+    db_close(db2);
+    unlink(fresh_db);
+
     /* Clean up */
     compiler_free(comp);
     dict_free(dict);
@@ -10,6 +10,25 @@
 #include <string.h>
 #include <unistd.h>
 
+typedef struct {
+    const char* name;
+    int count;
+} word_count_t;
+
+static bool count_word(void* ctx, const char* name, const char* namespace,
+                       const unsigned char* def_cid, const char* type_sig) {
+    (void)namespace; (void)def_cid; (void)type_sig;
+    word_count_t* wc = ctx;
+    if (!wc->name || strcmp(wc->name, name) == 0) wc->count++;
+    return true;
+}
+
+/* Bindings named name (NULL: all) */
+static int count_words(march_db_t* db, const char* name) {
+    word_count_t wc = {name, 0};
+    return db_foreach_word(db, count_word, &wc) ? wc.count : -1;
+}
+
 int main(void) {
     TEST_SUITE("Database Operations");
 
@@ -30,9 +49,11 @@ int main(void) {
 
     /* Test 3: Compute SHA256 */
     const uint8_t test_data[] = {0x01, 0x02, 0x03, 0x04};
-    char* hash = compute_sha256(test_data, 4);
+    unsigned char* hash = compute_sha256(test_data, 4);
     ASSERT(hash != NULL);
-    ASSERT_EQ(strlen(hash), 64);  /* SHA256 = 64 hex chars */
+    char* hex = cid_to_hex(hash);
+    ASSERT_EQ(strlen(hex), 64);  /* SHA256 = 32 bytes, 64 hex chars */
+    free(hex);
     free(hash);
 
     /* Test 4: Store word with simple cells */
@@ -118,6 +139,113 @@ int main(void) {
     db_close(db);
     unlink(test_db);
 
+    /* Read-only mode: metadata is read, the schema left alone, writes refused */
+    const char* ro_db = "test_march_ro.db";
+    unlink(ro_db);
+    db = db_open(ro_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, NULL));
+    ASSERT(db_set_cid_hash(db, CID_HASH_BLAKE2S));
+    const uint8_t ro_data[] = {0x10, 0x20};
+    unsigned char* ro_cid = db_store_blob(db, BLOB_DATA, NULL, ro_data, sizeof(ro_data));
+    ASSERT_NOT_NULL(ro_cid);
+    db_close(db);
+
+    march_db_t* ro = db_open_ex(ro_db, DB_OPEN_READONLY);
+    ASSERT(ro != NULL);
+    ASSERT(ro->readonly);
+    ASSERT_EQ(ro->cid_hash, CID_HASH_BLAKE2S);
+    ASSERT_EQ(ro->schema_version, MARCH_SCHEMA_VERSION);
+    ASSERT_NOT_NULL(ro->schema_hash);
+    ASSERT(db_init_schema(ro, "missing-schema.sql"));     /* Not even read */
+
+    int kind = -1;
+    uint8_t* data = NULL;
+    size_t len = 0;
+    ASSERT(db_load_blob_ex(ro, ro_cid, &kind, NULL, &data, &len));
+    ASSERT_EQ(kind, BLOB_DATA);
+    ASSERT_EQ(len, sizeof(ro_data));
+    free(data);
+
+    const uint8_t new_data[] = {0x30};
+    ASSERT_NULL(db_store_blob(ro, BLOB_DATA, NULL, new_data, sizeof(new_data)));
+    ASSERT(!db_bind_word(ro, "ro", NULL, ro_cid, "->"));
+    ASSERT(!db_set_metadata(ro, "cid_hash", "sha256"));
+    db_close(ro);
+
+    /* Nothing changed on disk */
+    ro = db_open_ex(ro_db, DB_OPEN_READONLY);
+    ASSERT_EQ(ro->cid_hash, CID_HASH_BLAKE2S);
+    unsigned char new_cid[CID_SIZE];
+    db_compute_cid(ro, new_data, sizeof(new_data), new_cid);
+    ASSERT(!db_load_blob_ex(ro, new_cid, &kind, NULL, &data, &len));
+    db_close(ro);
+    free(ro_cid);
+    unlink(ro_db);
+
+    /* Version 0 database (the old src/schema.sql): words keyed by
+     * (name, namespace), defs without effect columns */
+    const char* v0_db = "test_march_v0.db";
+    unlink(v0_db);
+    db = db_open(v0_db);
+    ASSERT(db != NULL);
+    ASSERT_EQ(sqlite3_exec(db->db,
+        "CREATE TABLE type_signatures (sig_cid BLOB PRIMARY KEY, input_sig TEXT, output_sig TEXT);"
+        "CREATE TABLE blobs (cid BLOB PRIMARY KEY, kind INTEGER NOT NULL, sig_cid BLOB,"
+        "    flags INTEGER DEFAULT 0, len INTEGER NOT NULL, data BLOB NOT NULL,"
+        "    FOREIGN KEY (sig_cid) REFERENCES type_signatures(sig_cid));"
+        "CREATE TABLE words (name TEXT NOT NULL, namespace TEXT NOT NULL DEFAULT 'user',"
+        "    def_cid BLOB, type_sig TEXT, is_primitive INTEGER DEFAULT 0,"
+        "    PRIMARY KEY (name, namespace), FOREIGN KEY (def_cid) REFERENCES blobs(cid));"
+        "CREATE TABLE defs (cid BLOB PRIMARY KEY, bytecode_version INTEGER DEFAULT 1,"
+        "    sig_cid BLOB, source_text TEXT, source_hash BLOB,"
+        "    FOREIGN KEY (sig_cid) REFERENCES type_signatures(sig_cid));"
+        "CREATE INDEX idx_words_name ON words(name);",
+        NULL, NULL, NULL), SQLITE_OK);
+    const uint8_t v0_data[] = {0x05};
+    unsigned char* v0_cid = db_store_blob(db, BLOB_WORD, NULL, v0_data, sizeof(v0_data));
+    ASSERT_NOT_NULL(v0_cid);
+    sqlite3_stmt* stmt = NULL;
+    ASSERT_EQ(sqlite3_prepare_v2(db->db,
+        "INSERT INTO words (name, def_cid, type_sig) VALUES ('five', ?1, '-> i64');"
+        , -1, &stmt, NULL), SQLITE_OK);
+    sqlite3_bind_blob(stmt, 1, v0_cid, CID_SIZE, SQLITE_STATIC);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    db_close(db);
+
+    db = db_open(v0_db);
+    ASSERT(db != NULL);
+    ASSERT_EQ(db->schema_version, 0);
+    ASSERT(db_init_schema(db, NULL));
+    char* version = db_get_metadata(db, "schema_version");
+    ASSERT_NOT_NULL(version);
+    ASSERT_EQ(atoi(version), MARCH_SCHEMA_VERSION);
+    free(version);
+
+    /* Overloads bind side by side, next to the migrated word */
+    const uint8_t i64_data[] = {0x06};
+    const uint8_t f64_data[] = {0x07};
+    unsigned char* i64_cid = db_store_blob(db, BLOB_WORD, NULL, i64_data, sizeof(i64_data));
+    unsigned char* f64_cid = db_store_blob(db, BLOB_WORD, NULL, f64_data, sizeof(f64_data));
+    ASSERT(db_bind_word(db, "sq", NULL, i64_cid, "i64 -> i64"));
+    ASSERT(db_bind_word(db, "sq", NULL, f64_cid, "f64 -> f64"));
+    ASSERT_EQ(count_words(db, NULL), 3);
+    ASSERT_EQ(count_words(db, "sq"), 2);
+    ASSERT_EQ(count_words(db, "five"), 1);
+
+    /* defs has the effect columns */
+    ASSERT(db_store_def_source(db, i64_cid, ": sq dup * ;", "00"));
+    ASSERT(db_store_def_effects(db, i64_cid, 0, true));
+    uint32_t effects = 1;
+    ASSERT(db_load_def_effects(db, i64_cid, &effects));
+    ASSERT_EQ(effects, 0);
+    db_close(db);
+    free(v0_cid);
+    free(i64_cid);
+    free(f64_cid);
+    unlink(v0_db);
+
     TEST_SUMMARY();
     return 0;
 }
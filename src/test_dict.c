@@ -4,6 +4,9 @@
 
 #include "test_framework.h"
 #include "dictionary.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 
 int main(void) {
     TEST_SUITE("Dictionary Operations");
@@ -31,11 +34,11 @@ int main(void) {
     /* Test adding words */
     type_sig_t add_sig;
     parse_type_sig("i64 i64 -> i64", &add_sig);
-    ASSERT(dict_add(dict, "+", (void*)0x1000, NULL, 0, &add_sig, true, false, NULL));
+    ASSERT(dict_add(dict, "+", (void*)0x1000, NULL, 0, &add_sig, true, false, NULL, NULL));
 
     type_sig_t dup_sig;
     parse_type_sig("i64 -> i64 i64", &dup_sig);
-    ASSERT(dict_add(dict, "dup", (void*)0x2000, NULL, 0, &dup_sig, true, false, NULL));
+    ASSERT(dict_add(dict, "dup", (void*)0x2000, NULL, 0, &dup_sig, true, false, NULL, NULL));
 
     /* Test lookup */
     dict_entry_t* entry = dict_lookup(dict, "+");
@@ -60,7 +63,7 @@ int main(void) {
     /* Add overloaded word */
     type_sig_t add_f64_sig;
     parse_type_sig("f64 f64 -> f64", &add_f64_sig);
-    ASSERT(dict_add(dict, "+", (void*)0x3000, NULL, 0, &add_f64_sig, true, false, NULL));
+    ASSERT(dict_add(dict, "+", (void*)0x3000, NULL, 0, &add_f64_sig, true, false, NULL, NULL));
 
     /* Lookup should now pick the right overload */
     type_id_t i64_stack[8] = {TYPE_I64, TYPE_I64};
@@ -73,6 +76,105 @@ int main(void) {
     ASSERT_NOT_NULL(entry);
     ASSERT_EQ(entry->addr, (void*)0x3000);  /* Should get f64 version */
 
+    /* Overloads of different arity: the stack depth limits the candidates,
+     * a deeper match scores higher */
+    type_sig_t one_sig, two_sig;
+    parse_type_sig("i64 -> i64", &one_sig);
+    parse_type_sig("i64 i64 -> i64", &two_sig);
+    ASSERT(dict_add(dict, "f", (void*)0x4000, NULL, 0, &one_sig, false, false, NULL, NULL));
+    ASSERT(dict_add(dict, "f", (void*)0x5000, NULL, 0, &two_sig, false, false, NULL, NULL));
+    entry = dict_lookup_typed(dict, "f", i64_stack, 1);
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x4000);
+    entry = dict_lookup_typed(dict, "f", i64_stack, 2);
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x5000);
+    ASSERT_NULL(dict_lookup_typed(dict, "f", i64_stack, 0));
+    ASSERT_NULL(dict_lookup_typed(dict, "f", f64_stack, 2));
+
+    /* One group per name; the latest definition wins a full tie */
+    ASSERT(dict_add(dict, "f", (void*)0x6000, NULL, 0, &one_sig, false, false, NULL, NULL));
+    dict_group_t* group = dict_lookup_group(dict, "f");
+    ASSERT_NOT_NULL(group);
+    ASSERT_EQ(group->count, 3);
+    ASSERT_EQ(group->latest->addr, (void*)0x6000);
+    ASSERT_EQ(group->latest->next->addr, (void*)0x5000);
+    entry = dict_group_select(group, i64_stack, 1);
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x6000);
+
+    /* CIDs are copied into the entry */
+    unsigned char cid[CID_SIZE];
+    memset(cid, 0xab, sizeof(cid));
+    dict_set_cid(entry, cid);
+    cid[0] = 0;
+    ASSERT_EQ(entry->cid[0], 0xab);
+
+    /* The table grows: every name stays reachable */
+    size_t before = dict->entry_count;
+    char name[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(name, sizeof(name), "word%d", i);
+        ASSERT(dict_add(dict, name, (void*)(uintptr_t)(i + 1), NULL, 0, &one_sig, false, false, NULL, NULL));
+    }
+    ASSERT_EQ(dict->entry_count, before + 5000);
+    ASSERT(dict->group_capacity >= 2 * dict->group_count);
+    bool all_found = true;
+    for (int i = 0; i < 5000; i++) {
+        snprintf(name, sizeof(name), "word%d", i);
+        entry = dict_lookup(dict, name);
+        all_found = all_found && entry && entry->addr == (void*)(uintptr_t)(i + 1);
+    }
+    ASSERT(all_found);
+    entry = dict_lookup_typed(dict, "+", f64_stack, 2);
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x3000);
+
+    dict_free(dict);
+
+    /* Builtins: found without registration, shadowed by later definitions */
+    static dict_entry_t builtin_entries[1] = {
+        { .name = (char*)"sq", .addr = (void*)0x7000, .prim_id = 3,
+          .signature = { {TYPE_I64}, 1, {TYPE_I64}, 1 }, .is_primitive = true,
+          .priority = 100, .order = 0 },
+    };
+    static dict_entry_t* builtin_dispatch[1] = { &builtin_entries[0] };
+    static dict_group_t builtin_group = {
+        .name = "sq", .latest = &builtin_entries[0], .dispatch = builtin_dispatch,
+        .count = 1, .capacity = 1, .arity_end = {0, 1, 1, 1, 1, 1, 1, 1, 1},
+    };
+    static const uint16_t builtin_seeds[1] = {0};
+    dict_group_t* builtin_slots[4] = {NULL};
+    builtin_group.hash = dict_hash_name("sq");
+    builtin_slots[dict_builtin_slot(builtin_group.hash, 0, 4)] = &builtin_group;
+    dict_builtins_t builtins = {
+        .slots = builtin_slots, .seeds = builtin_seeds, .slot_count = 4, .seed_count = 1,
+        .entries = builtin_entries, .entry_count = 1,
+    };
+
+    dict = dict_create();
+    ASSERT(dict_use_builtins(dict, &builtins));
+    entry = dict_lookup(dict, "sq");
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x7000);
+    ASSERT_NULL(dict_lookup(dict, "cube"));
+    ASSERT_EQ(dict_entry_count(dict), 1);
+    ASSERT(dict_entry_at(dict, 0) == &builtin_entries[0]);
+
+    ASSERT(dict_add(dict, "sq", (void*)0x8000, NULL, 0, &one_sig, false, false, NULL, NULL));
+    ASSERT(!dict_use_builtins(dict, &builtins));
+    group = dict_lookup_group(dict, "sq");
+    ASSERT(group != &builtin_group);
+    ASSERT_EQ(group->count, 2);
+    ASSERT_EQ(group->latest->addr, (void*)0x8000);
+    ASSERT(group->latest->next == &builtin_entries[0]);
+    entry = dict_lookup_typed(dict, "sq", i64_stack, 1);
+    ASSERT_NOT_NULL(entry);
+    ASSERT_EQ(entry->addr, (void*)0x8000);
+    ASSERT_EQ(builtin_group.count, 1);
+    ASSERT_EQ(dict_entry_count(dict), 2);
+    ASSERT_EQ(dict_entry_at(dict, 1)->order, 1);
+
     dict_free(dict);
 
     TEST_SUMMARY();
@@ -0,0 +1,243 @@
+/*
+ * March Language - Effect Inference, Stack Depth and Compile-Time Evaluator Tests
+ */
+
+#include "test_framework.h"
+#include "effects.h"
+#include "depth.h"
+#include "evaluator.h"
+#include "memo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Store a word blob built from ir */
+static unsigned char* store_word(march_db_t* db, const ir_buffer_t* ir) {
+    blob_buffer_t* buf = blob_buffer_create();
+    ir_lower_blob(ir, buf);
+    unsigned char* cid = db_store_blob(db, BLOB_WORD, NULL, buf->data, buf->size);
+    blob_buffer_free(buf);
+    return cid;
+}
+
+int main(void) {
+    TEST_SUITE("Effects and Evaluator");
+
+    const char* test_db = "test_evaluator.db";
+    unlink(test_db);
+    march_db_t* db = db_open(test_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    /* Primitive effects */
+    ASSERT(effects_pure(effects_of_prim(PRIM_ADD)));
+    ASSERT(effects_pure(effects_of_prim(PRIM_TOR)));
+    ASSERT(effects_pure(effects_of_prim(PRIM_DIV)));
+    ASSERT_EQ(effects_of_prim(PRIM_DIV), EFFECT_ERR);
+    ASSERT(!effects_pure(effects_of_prim(PRIM_FETCH)));
+    ASSERT(!effects_pure(effects_of_prim(PRIM_ALLOC)));
+    ASSERT(effects_of_prim(PRIM_MAP_SET) & EFFECT_MAP);
+    ASSERT_EQ(effects_of_prim(PRIM_EXECUTE), EFFECT_DYNAMIC);
+    ASSERT_EQ(effects_of_prim(200), EFFECT_UNKNOWN);
+
+    /* sq: dup *  (pure, effects recorded) */
+    ir_buffer_t* ir = ir_buffer_create();
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ASSERT_EQ(effects_of_ir(ir, db), 0);
+    unsigned char* sq = store_word(db, ir);
+    ASSERT_NOT_NULL(sq);
+    uint32_t effects = 99;
+    ASSERT(!db_load_def_effects(db, sq, &effects));
+    ASSERT(db_store_def_source(db, sq, "dup *", "00"));
+    ASSERT(!db_load_def_effects(db, sq, &effects));     /* Not inferred yet */
+    ASSERT(db_store_def_effects(db, sq, 0, true));
+    ASSERT(db_load_def_effects(db, sq, &effects));
+    ASSERT_EQ(effects, 0);
+
+    /* peek: @ (memory) */
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_FETCH, NULL);
+    unsigned char* peek = store_word(db, ir);
+    db_store_def_source(db, peek, "@", "01");
+    db_store_def_effects(db, peek, effects_of_ir(ir, db), false);
+
+    /* Callers take on their callees' effects; unrecorded callees are unknown */
+    ir_buffer_clear(ir);
+    ir_emit_ref(ir, BLOB_WORD, sq, TYPE_UNKNOWN, 0);
+    ASSERT_EQ(effects_of_ir(ir, db), 0);
+    ir_emit_ref(ir, BLOB_WORD, peek, TYPE_UNKNOWN, 0);
+    ASSERT_EQ(effects_of_ir(ir, db), EFFECT_MEMORY);
+    unsigned char unknown[CID_SIZE] = {1};
+    ir_buffer_clear(ir);
+    ir_emit_ref(ir, BLOB_WORD, unknown, TYPE_UNKNOWN, 0);
+    ASSERT_EQ(effects_of_ir(ir, db), EFFECT_UNKNOWN);
+
+    /* Straight-line code and calls: 3 sq 7 +  → 16 */
+    int64_t args[2] = {3, 4};
+    int64_t results[2] = {0, 0};
+    ASSERT(evaluate_word(db, sq, args, 1, results, 1));
+    ASSERT_EQ(results[0], 9);
+
+    ir_buffer_clear(ir);
+    ir_emit_ref(ir, BLOB_WORD, sq, TYPE_UNKNOWN, 0);
+    unsigned char* seven = db_store_literal(db, 7, "i64");
+    ir_emit_ref(ir, BLOB_DATA, seven, TYPE_I64, 7);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    unsigned char* sq7 = store_word(db, ir);
+    ASSERT(evaluate_word(db, sq7, args, 1, results, 1));
+    ASSERT_EQ(results[0], 16);
+
+    /* The result count must match */
+    ASSERT(!evaluate_word(db, sq7, args, 2, results, 1));
+
+    /* Counted loop on the return stack, as times compiles it:
+     * fact: 1 swap >r L: r@ 0branch D r> 1 - >r i0 1 + * branch L D: rdrop */
+    ir_buffer_clear(ir);
+    int loop = ir_new_label(ir);
+    int done = ir_new_label(ir);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_SWAP, NULL);
+    ir_emit_prim(ir, PRIM_TOR, NULL);
+    ir_emit_label(ir, loop);
+    ir_emit_prim(ir, PRIM_RFETCH, NULL);
+    ir_emit_branch(ir, PRIM_0BRANCH, NULL, done);
+    ir_emit_prim(ir, PRIM_FROMR, NULL);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_SUB, NULL);
+    ir_emit_prim(ir, PRIM_TOR, NULL);
+    ir_emit_prim(ir, PRIM_I0, NULL);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ir_emit_branch(ir, PRIM_BRANCH, NULL, loop);
+    ir_emit_label(ir, done);
+    ir_emit_prim(ir, PRIM_RDROP, NULL);
+    unsigned char* fact = store_word(db, ir);
+    args[0] = 10;
+    ASSERT(evaluate_word(db, fact, args, 1, results, 1));
+    ASSERT_EQ(results[0], 3628800);
+
+    /* Memoized recursion: memo-enter 1:1 dup 0branch Z dup 1 - RECURSE + Z: memo-exit */
+    ir_buffer_clear(ir);
+    int zero = ir_new_label(ir);
+    ir_emit_prim(ir, PRIM_MEMO_ENTER, NULL);
+    ir_emit_lit(ir, (int64_t)memo_arity(1, 1));
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_branch(ir, PRIM_0BRANCH, NULL, zero);
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_SUB, NULL);
+    ir_emit_recurse(ir);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    ir_emit_label(ir, zero);
+    ir_emit_prim(ir, PRIM_MEMO_EXIT, NULL);
+    ASSERT_EQ(effects_of_ir(ir, db), 0);
+    unsigned char* tri = store_word(db, ir);
+    args[0] = 10;
+    ASSERT(evaluate_word(db, tri, args, 1, results, 1));
+    ASSERT_EQ(results[0], 55);
+    args[0] = 100;
+    ASSERT(!evaluate_word(db, tri, args, 1, results, 1));  /* Too deep */
+
+    /* A loop that never ends runs out of steps */
+    ir_buffer_clear(ir);
+    loop = ir_new_label(ir);
+    ir_emit_label(ir, loop);
+    ir_emit_branch(ir, PRIM_BRANCH, NULL, loop);
+    unsigned char* spin = store_word(db, ir);
+    ASSERT(!evaluate_word(db, spin, args, 0, results, 0));
+
+    /* Leaving the sandbox: memory access, traps, the caller's return stack */
+    ASSERT(!evaluate_word(db, peek, args, 1, results, 1));
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, 0);
+    ir_emit_prim(ir, PRIM_DIV, NULL);
+    unsigned char* div0 = store_word(db, ir);
+    ASSERT(!evaluate_word(db, div0, args, 1, results, 1));
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_FROMR, NULL);
+    unsigned char* rpop = store_word(db, ir);
+    ASSERT(!evaluate_word(db, rpop, args, 0, results, 1));
+
+    /* Stack depth: dup * peaks one cell above its input, net 0 */
+    int inputs, outputs;
+    ASSERT(stack_depth_of_prim(PRIM_SWAP, &inputs, &outputs));
+    ASSERT_EQ(inputs, 2);
+    ASSERT_EQ(outputs, 2);
+    ASSERT(!stack_depth_of_prim(200, &inputs, &outputs));
+    stack_depth_t depth;
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT_EQ(depth.data_max, 1);
+    ASSERT_EQ(depth.data_effect, 0);
+    ASSERT_EQ(depth.return_max, 0);
+    int data_max = 99, data_effect = 99, return_max = 99;
+    ASSERT(!db_load_def_depth(db, sq, &data_max, &data_effect, &return_max));
+    ASSERT(db_store_def_depth(db, sq, depth.data_max, depth.data_effect, depth.return_max));
+    ASSERT(db_load_def_depth(db, sq, &data_max, &data_effect, &return_max));
+    ASSERT_EQ(data_max, 1);
+
+    /* Callers add the callee's depth where it is called, plus a return address */
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, 1);
+    ir_emit_lit(ir, 2);
+    ir_emit_ref(ir, BLOB_WORD, sq, TYPE_UNKNOWN, 0);
+    ir_emit_prim(ir, PRIM_TOR, NULL);
+    ir_emit_prim(ir, PRIM_FROMR, NULL);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT_EQ(depth.data_max, 3);
+    ASSERT_EQ(depth.data_effect, 1);
+    ASSERT_EQ(depth.return_max, 1);
+
+    /* Branches: the deeper arm wins */
+    ir_buffer_clear(ir);
+    int else_label = ir_new_label(ir);
+    int end_label = ir_new_label(ir);
+    ir_emit_branch(ir, PRIM_0BRANCH, NULL, else_label);
+    ir_emit_lit(ir, 1);
+    ir_emit_lit(ir, 2);
+    ir_emit_lit(ir, 3);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ir_emit_branch(ir, PRIM_BRANCH, NULL, end_label);
+    ir_emit_label(ir, else_label);
+    ir_emit_lit(ir, 4);
+    ir_emit_label(ir, end_label);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT_EQ(depth.data_max, 2);
+    ASSERT_EQ(depth.data_effect, 0);
+
+    /* Recursion, execute and unanalyzed callees have no bound */
+    ir_buffer_clear(ir);
+    ir_emit_recurse(ir);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT(!stack_depth_bounded(&depth));
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_EXECUTE, NULL);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT(!stack_depth_bounded(&depth));
+    ir_buffer_clear(ir);
+    ir_emit_ref(ir, BLOB_WORD, peek, TYPE_UNKNOWN, 0);
+    stack_depth_of_ir(ir, db, &depth);
+    ASSERT_EQ(depth.data_max, STACK_DEPTH_UNBOUNDED);
+
+    free(sq);
+    free(peek);
+    free(seven);
+    free(sq7);
+    free(fact);
+    free(tri);
+    free(spin);
+    free(div0);
+    free(rpop);
+    ir_buffer_free(ir);
+    db_close(db);
+    unlink(test_db);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,120 @@
+/*
+ * March Language - Garbage Collector Tests
+ */
+
+#include "test_framework.h"
+#include "database.h"
+#include "gc.h"
+#include "cells.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Store a code blob calling/pushing the given CIDs */
+static unsigned char* store_code(march_db_t* db, int kind, unsigned char** refs,
+                                 uint16_t* ref_kinds, int ref_count, int64_t salt) {
+    blob_buffer_t* buf = blob_buffer_create();
+    encode_inline_literal(buf, salt);
+    for (int i = 0; i < ref_count; i++) {
+        encode_cid_ref(buf, ref_kinds[i], refs[i]);
+    }
+    unsigned char* cid = db_store_blob(db, kind, NULL, buf->data, buf->size);
+    if (cid) db_store_edges(db, cid, buf->data, buf->size);
+    blob_buffer_free(buf);
+    return cid;
+}
+
+static int blob_exists(march_db_t* db, const unsigned char* cid) {
+    return db_get_blob_kind(db, cid) >= 0;
+}
+
+int main(void) {
+    TEST_SUITE("Garbage Collector");
+
+    const char* test_db = "test_gc.db";
+    unlink(test_db);
+
+    march_db_t* db = db_open(test_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    /* live: root -> callee -> lit ; root -> quot
+     * dead: orphan -> dead_lit, plus an unused type signature */
+    unsigned char* lit = db_store_literal(db, 42, "i64");
+    unsigned char* dead_lit = db_store_literal(db, 99, "dead");
+    ASSERT_NOT_NULL(lit);
+
+    unsigned char* callee_refs[] = {lit};
+    uint16_t callee_kinds[] = {BLOB_DATA};
+    unsigned char* callee = store_code(db, BLOB_WORD, callee_refs, callee_kinds, 1, 1);
+    unsigned char* quot = store_code(db, BLOB_QUOTATION, NULL, NULL, 0, 2);
+
+    unsigned char* root_refs[] = {callee, quot};
+    uint16_t root_kinds[] = {BLOB_WORD, BLOB_QUOTATION};
+    unsigned char* root = store_code(db, BLOB_WORD, root_refs, root_kinds, 2, 3);
+    ASSERT(db_bind_word(db, "main", NULL, root, "->"));
+
+    unsigned char* orphan_refs[] = {dead_lit};
+    uint16_t orphan_kinds[] = {BLOB_DATA};
+    unsigned char* orphan = store_code(db, BLOB_WORD, orphan_refs, orphan_kinds, 1, 4);
+
+    /* Persisted specializations; rebinding from root replaces the stale
+     * callee binding, so orphan stays unreachable */
+    unsigned char hash_a[CID_SIZE] = {1}, hash_b[CID_SIZE] = {2}, hash_c[CID_SIZE] = {3};
+    uint8_t i64_input[] = {TYPE_I64};
+    unsigned char found[CID_SIZE];
+    ASSERT(db_store_specialization(db, hash_a, NULL, 0, root, "main", "->"));
+    ASSERT(db_store_specialization(db, hash_b, i64_input, 1, callee, "callee", "i64 -> i64"));
+    ASSERT(db_store_specialization(db, hash_c, NULL, 0, orphan, "orphan", "->"));
+    ASSERT(db_lookup_specialization(db, hash_b, i64_input, 1, found));
+    ASSERT(memcmp(found, callee, CID_SIZE) == 0);
+    ASSERT(!db_lookup_specialization(db, hash_b, NULL, 0, found));
+    ASSERT(db_bind_word(db, "callee", NULL, orphan, "i64 -> i64"));
+    ASSERT(db_rebind_specializations(db, root));
+
+    /* Dry run reports but deletes nothing */
+    gc_options_t opts;
+    gc_options_init(&opts);
+    opts.dry_run = true;
+    gc_stats_t stats;
+    ASSERT(gc_collect(db, &opts, &stats));
+    ASSERT_EQ(stats.live_blobs, 4);
+    ASSERT_EQ(stats.dead_blobs, 2);
+    ASSERT_EQ(stats.dead_sigs, 1);
+    ASSERT(blob_exists(db, orphan));
+
+    /* Real collection, one row per batch */
+    opts.dry_run = false;
+    opts.batch_size = 1;
+    opts.vacuum = true;
+    ASSERT(gc_collect(db, &opts, &stats));
+    ASSERT_EQ(stats.dead_blobs, 2);
+    ASSERT(stats.bytes_reclaimed > 0);
+
+    ASSERT(blob_exists(db, root));
+    ASSERT(blob_exists(db, callee));
+    ASSERT(blob_exists(db, quot));
+    ASSERT(blob_exists(db, lit));
+    ASSERT(!blob_exists(db, orphan));
+    ASSERT(!blob_exists(db, dead_lit));
+    ASSERT(db_lookup_specialization(db, hash_a, NULL, 0, found));
+    ASSERT(!db_lookup_specialization(db, hash_c, NULL, 0, found));
+
+    /* Second pass finds nothing */
+    opts.vacuum = false;
+    ASSERT(gc_collect(db, &opts, &stats));
+    ASSERT_EQ(stats.dead_blobs, 0);
+    ASSERT_EQ(stats.dead_sigs, 0);
+
+    free(lit);
+    free(dead_lit);
+    free(callee);
+    free(quot);
+    free(root);
+    free(orphan);
+    db_close(db);
+    unlink(test_db);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,142 @@
+/*
+ * March Language - Incremental Compilation Tests
+ */
+
+#include "test_framework.h"
+#include "database.h"
+#include "cells.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Store a compiled word calling the given CIDs, as the compiler would:
+ * blob, edges, binding, defs source hash and specialization row */
+static unsigned char* store_typed_word(march_db_t* db, const char* name, const char* type_sig,
+                                       const char* hash, unsigned char** callees,
+                                       int callee_count, int64_t salt) {
+    blob_buffer_t* buf = blob_buffer_create();
+    encode_inline_literal(buf, salt);
+    for (int i = 0; i < callee_count; i++) {
+        encode_cid_ref(buf, BLOB_WORD, callees[i]);
+    }
+    unsigned char* cid = db_store_blob(db, BLOB_WORD, NULL, buf->data, buf->size);
+    db_store_edges(db, cid, buf->data, buf->size);
+    blob_buffer_free(buf);
+
+    unsigned char key[CID_SIZE] = {0};
+    memcpy(key, hash, strlen(hash) < CID_SIZE ? strlen(hash) : CID_SIZE);
+    db_bind_word(db, name, NULL, cid, type_sig);
+    db_store_specialization(db, key, NULL, 0, cid, name, type_sig);
+    db_store_def_source(db, cid, name, hash);
+    return cid;
+}
+
+static unsigned char* store_word(march_db_t* db, const char* name, const char* hash,
+                                 unsigned char** callees, int callee_count, int64_t salt) {
+    return store_typed_word(db, name, "->", hash, callees, callee_count, salt);
+}
+
+static bool has_specialization(march_db_t* db, const char* hash) {
+    unsigned char key[CID_SIZE] = {0};
+    unsigned char cid[CID_SIZE];
+    memcpy(key, hash, strlen(hash) < CID_SIZE ? strlen(hash) : CID_SIZE);
+    return db_lookup_specialization(db, key, NULL, 0, cid);
+}
+
+/* Invalidation for a name with a single current definition */
+static int invalidate(march_db_t* db, const char* name, const char* hash) {
+    return db_invalidate_dependents(db, name, &hash, 1);
+}
+
+/* Collects bound word names, stopping after limit */
+typedef struct {
+    char names[8][16];
+    int count;
+    int limit;
+} word_list_t;
+
+static bool collect_word(void* ctx, const char* name, const char* namespace,
+                         const unsigned char* def_cid, const char* type_sig) {
+    (void)namespace;
+    (void)def_cid;
+    (void)type_sig;
+    word_list_t* list = ctx;
+    snprintf(list->names[list->count++], sizeof(list->names[0]), "%s", name);
+    return list->count < list->limit;
+}
+
+int main(void) {
+    TEST_SUITE("Incremental Compilation");
+
+    const char* test_db = "test_incremental.db";
+    unlink(test_db);
+
+    march_db_t* db = db_open(test_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    /* main -> quad -> sq ; main -> other */
+    unsigned char* sq = store_word(db, "sq", "sq-v1", NULL, 0, 1);
+    unsigned char* quad = store_word(db, "quad", "quad-v1", &sq, 1, 2);
+    unsigned char* other = store_word(db, "other", "other-v1", NULL, 0, 3);
+    unsigned char* main_refs[] = {quad, other};
+    unsigned char* main_cid = store_word(db, "main", "main-v1", main_refs, 2, 4);
+
+    /* Unchanged definitions invalidate nothing */
+    ASSERT_EQ(invalidate(db, "sq", "sq-v1"), 0);
+    ASSERT_EQ(invalidate(db, "main", "main-v1"), 0);
+    ASSERT_EQ(invalidate(db, "unknown", "x"), 0);
+
+    /* Editing sq drops its transitive callers, not sq itself or other */
+    ASSERT_EQ(invalidate(db, "sq", "sq-v2"), 2);
+    ASSERT(has_specialization(db, "sq-v1"));
+    ASSERT(!has_specialization(db, "quad-v1"));
+    ASSERT(!has_specialization(db, "main-v1"));
+    ASSERT(has_specialization(db, "other-v1"));
+
+    /* Nothing left to drop the second time */
+    ASSERT_EQ(invalidate(db, "sq", "sq-v2"), 0);
+
+    /* Bindings are listed oldest first; a visitor can stop early */
+    word_list_t list = { .limit = 8 };
+    ASSERT(db_foreach_word(db, collect_word, &list));
+    ASSERT_EQ(list.count, 4);
+    ASSERT_STR_EQ(list.names[0], "sq");
+    ASSERT_STR_EQ(list.names[3], "main");
+
+    word_list_t first = { .limit = 1 };
+    ASSERT(!db_foreach_word(db, collect_word, &first));
+    ASSERT_EQ(first.count, 1);
+
+    /* Overloads: bindings carry call-site signatures, so a changed
+     * definition spares only the bindings of overloads still defined */
+    unsigned char* sqr_i = store_typed_word(db, "sqr", "i64 -> i64", "sqr-i-v1", NULL, 0, 5);
+    unsigned char* sqr_f = store_typed_word(db, "sqr", "f64 ->", "sqr-f-v1", NULL, 0, 6);
+    unsigned char* use_i = store_word(db, "use_i", "use-i-v1", &sqr_i, 1, 7);
+    unsigned char* use_f = store_word(db, "use_f", "use-f-v1", &sqr_f, 1, 8);
+    const char* unchanged[] = {"sqr-i-v1", "sqr-f-v1"};
+    ASSERT_EQ(db_invalidate_dependents(db, "sqr", unchanged, 2), 0);
+    ASSERT_EQ(invalidate(db, "sqr", "sqr-i-v1"), 0);
+    const char* edited[] = {"sqr-f-v2", "sqr-i-v1"};
+    ASSERT_EQ(db_invalidate_dependents(db, "sqr", edited, 2), 1);
+    ASSERT(has_specialization(db, "use-i-v1"));
+    ASSERT(!has_specialization(db, "use-f-v1"));
+
+    /* Overloads not yet defined again are compared too */
+    ASSERT_EQ(invalidate(db, "sqr", "sqr-i-v2"), 1);
+    ASSERT(!has_specialization(db, "use-i-v1"));
+
+    free(sqr_i);
+    free(sqr_f);
+    free(use_i);
+    free(use_f);
+    free(sq);
+    free(quad);
+    free(other);
+    free(main_cid);
+    db_close(db);
+    unlink(test_db);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,136 @@
+/*
+ * March Language - Inliner Tests
+ */
+
+#include "test_framework.h"
+#include "inliner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Store a code blob built from ir */
+static unsigned char* store_code(march_db_t* db, int kind, const ir_buffer_t* ir) {
+    blob_buffer_t* buf = blob_buffer_create();
+    ir_lower_blob(ir, buf);
+    unsigned char* cid = db_store_blob(db, kind, NULL, buf->data, buf->size);
+    blob_buffer_free(buf);
+    return cid;
+}
+
+static int count_op(const ir_buffer_t* ir, ir_op_t op, uint16_t prim_id) {
+    int n = 0;
+    for (size_t i = 0; i < ir->count; i++) {
+        if (ir->instrs[i].op == op && (op != IR_PRIM || ir->instrs[i].prim_id == prim_id)) n++;
+    }
+    return n;
+}
+
+int main(void) {
+    TEST_SUITE("Inliner");
+
+    const char* test_db = "test_inliner.db";
+    unlink(test_db);
+    march_db_t* db = db_open(test_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    dictionary_t* dict = dict_create();
+    type_sig_t sig;
+    memset(&sig, 0, sizeof(sig));
+    dict_add(dict, "dup", (void*)0x1000, NULL, PRIM_DUP, &sig, true, false, NULL, NULL);
+    dict_add(dict, "*", (void*)0x2000, NULL, PRIM_MUL, &sig, true, false, NULL, NULL);
+
+    /* sq: dup *  (two cells, inlined) */
+    ir_buffer_t* body = ir_buffer_create();
+    ir_emit_prim(body, PRIM_DUP, NULL);
+    ir_emit_prim(body, PRIM_MUL, NULL);
+    unsigned char* sq = store_code(db, BLOB_WORD, body);
+    ASSERT_NOT_NULL(sq);
+
+    /* uses-r: >r r> (return stack, stays a call) */
+    ir_buffer_clear(body);
+    ir_emit_prim(body, PRIM_TOR, NULL);
+    ir_emit_prim(body, PRIM_FROMR, NULL);
+    unsigned char* uses_r = store_code(db, BLOB_WORD, body);
+
+    /* big: nine cells (over the size limit) */
+    ir_buffer_clear(body);
+    for (int i = 0; i < INLINE_MAX_CELLS + 1; i++) {
+        ir_emit_prim(body, PRIM_DUP, NULL);
+    }
+    unsigned char* big = store_code(db, BLOB_WORD, body);
+
+    /* quotation: 0branch over a literal */
+    ir_buffer_clear(body);
+    int skip = ir_new_label(body);
+    ir_emit_branch(body, PRIM_0BRANCH, NULL, skip);
+    ir_emit_lit(body, 1);
+    ir_emit_label(body, skip);
+    unsigned char* quot = store_code(db, BLOB_QUOTATION, body);
+
+    /* caller: 3 sq uses-r big (quot) execute */
+    ir_buffer_t* ir = ir_buffer_create();
+    int top = ir_new_label(ir);
+    ir_emit_label(ir, top);
+    ir_emit_lit(ir, 3);
+    ir_emit_ref(ir, BLOB_WORD, sq, TYPE_UNKNOWN, 0);
+    ir_emit_ref(ir, BLOB_WORD, uses_r, TYPE_UNKNOWN, 0);
+    ir_emit_ref(ir, BLOB_WORD, big, TYPE_UNKNOWN, 0);
+    ir_emit_ref(ir, BLOB_QUOTATION, quot, TYPE_PTR, 0);
+    ir_emit_prim(ir, PRIM_EXECUTE, NULL);
+
+    optimizer_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    inline_deps_t deps = {0};
+    ASSERT(inline_ir(ir, db, dict, &deps, &stats));
+    ASSERT_EQ(stats.inlined, 2);
+    ASSERT_EQ(deps.count, 2);
+    ASSERT(memcmp(deps.cids[0], sq, CID_SIZE) == 0);
+    ASSERT(memcmp(deps.cids[1], quot, CID_SIZE) == 0);
+
+    /* lit dup * ref ref 0branch lit, labels renumbered past the caller's */
+    ASSERT_EQ(count_op(ir, IR_REF, 0), 2);
+    ASSERT_EQ(count_op(ir, IR_PRIM, PRIM_EXECUTE), 0);
+    ASSERT_EQ(ir->instrs[2].prim_id, PRIM_DUP);
+    ASSERT_EQ(ir->instrs[2].addr, (void*)0x1000);
+    ASSERT_EQ(ir->instrs[3].prim_id, PRIM_MUL);
+    ASSERT_EQ(ir->label_count, 2);
+    ASSERT_EQ(ir_cell_count(ir), 8);
+
+    blob_buffer_t* blob = blob_buffer_create();
+    ASSERT(ir_lower_blob(ir, blob));
+
+    /* Inline edges let a changed callee invalidate the caller */
+    unsigned char* caller = db_store_blob(db, BLOB_WORD, NULL, blob->data, blob->size);
+    ASSERT_NOT_NULL(caller);
+    inline_deps_store(db, caller, &deps);
+    sqlite3_stmt* stmt = NULL;
+    sqlite3_prepare_v2(db->db, "SELECT COUNT(*) FROM edges WHERE edge_type = 'inline';",
+                       -1, &stmt, NULL);
+    ASSERT(sqlite3_step(stmt) == SQLITE_ROW);
+    ASSERT_EQ(sqlite3_column_int(stmt, 0), 2);
+    sqlite3_finalize(stmt);
+
+    /* Nothing to inline leaves ir untouched */
+    ir_buffer_clear(ir);
+    ir_emit_ref(ir, BLOB_WORD, big, TYPE_UNKNOWN, 0);
+    ir_emit_ref(ir, BLOB_QUOTATION, quot, TYPE_PTR, 0);
+    ASSERT(inline_ir(ir, db, dict, NULL, NULL));
+    ASSERT_EQ(ir->count, 2);
+
+    blob_buffer_free(blob);
+    inline_deps_free(&deps);
+    ir_buffer_free(ir);
+    ir_buffer_free(body);
+    free(sq);
+    free(uses_r);
+    free(big);
+    free(quot);
+    free(caller);
+    dict_free(dict);
+    db_close(db);
+    unlink(test_db);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,110 @@
+/*
+ * March Language - Compiler IR Tests
+ */
+
+#include "test_framework.h"
+#include "ir.h"
+#include <string.h>
+
+/* Inline literal stored at blob entry (entries are 2 bytes or 10 bytes) */
+static int64_t blob_literal_at(const blob_buffer_t* buf, size_t offset) {
+    int64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (int64_t)buf->data[offset + 2 + i] << (i * 8);
+    }
+    return value;
+}
+
+int main(void) {
+    TEST_SUITE("Compiler IR");
+
+    /* flag ( dup ) ( 7 ) if  →  0branch F dup branch E F: 7 E: */
+    ir_buffer_t* true_ir = ir_buffer_create();
+    ASSERT_NOT_NULL(true_ir);
+    ASSERT(ir_emit_prim(true_ir, PRIM_DUP, (void*)0x1000));
+
+    ir_buffer_t* false_ir = ir_buffer_create();
+    ASSERT(ir_emit_lit(false_ir, 7));
+
+    ir_buffer_t* ir = ir_buffer_create();
+    int false_label = ir_new_label(ir);
+    int end_label = ir_new_label(ir);
+    ASSERT(ir_emit_branch(ir, PRIM_0BRANCH, (void*)0x2000, false_label));
+    ASSERT(ir_append(ir, true_ir));
+    ASSERT(ir_emit_branch(ir, PRIM_BRANCH, (void*)0x3000, end_label));
+    ASSERT(ir_emit_label(ir, false_label));
+    ASSERT(ir_append(ir, false_ir));
+    ASSERT(ir_emit_label(ir, end_label));
+    ASSERT_EQ(ir_cell_count(ir), 6);
+
+    /* Cells: offsets count from the cell after the offset */
+    cell_buffer_t* cells = cell_buffer_create();
+    ASSERT(ir_lower_cells(ir, cells));
+    ASSERT_EQ(cells->count, 7);
+    ASSERT_EQ(decode_xt(cells->cells[0]), (void*)0x2000);
+    ASSERT_EQ(decode_lit(cells->cells[1]), 3);
+    ASSERT_EQ(decode_xt(cells->cells[2]), (void*)0x1000);
+    ASSERT_EQ(decode_lit(cells->cells[4]), 1);
+    ASSERT_EQ(decode_lit(cells->cells[5]), 7);
+    ASSERT(is_exit(cells->cells[6]));
+
+    /* Blob: same offsets, in cells; no EXIT */
+    blob_buffer_t* blob = blob_buffer_create();
+    ASSERT(ir_lower_blob(ir, blob));
+    ASSERT_EQ(blob->size, 2 + 10 + 2 + 2 + 10 + 10);
+    ASSERT_EQ(blob->data[0], PRIM_0BRANCH << 1);
+    ASSERT_EQ(blob_literal_at(blob, 2), 3);
+    ASSERT_EQ(blob_literal_at(blob, 16), 1);
+    ASSERT_EQ(blob_literal_at(blob, 26), 7);
+
+    /* Backward branch: loop with an appended body keeps its own labels */
+    ir_buffer_t* loop = ir_buffer_create();
+    int top = ir_new_label(loop);
+    ASSERT(ir_emit_label(loop, top));
+    ASSERT(ir_append(loop, ir));
+    ASSERT_EQ(loop->label_count, 3);
+    ASSERT(ir_emit_branch(loop, PRIM_BRANCH, (void*)0x3000, top));
+    cell_buffer_clear(cells);
+    ASSERT(ir_lower_cells(loop, cells));
+    ASSERT_EQ(decode_lit(cells->cells[1]), 3);
+    ASSERT_EQ(decode_lit(cells->cells[7]), -8);
+
+    /* Unplaced label is an error */
+    ir_buffer_t* bad = ir_buffer_create();
+    ASSERT(ir_emit_branch(bad, PRIM_BRANCH, NULL, ir_new_label(bad)));
+    blob_buffer_clear(blob);
+    ASSERT(!ir_lower_blob(bad, blob));
+
+    /* Decoding a lowered blob gives back the same code */
+    blob_buffer_clear(blob);
+    ASSERT(ir_lower_blob(loop, blob));
+    ir_buffer_t* decoded = ir_buffer_create();
+    ASSERT(ir_decode_blob(decoded, blob->data, blob->size));
+    ASSERT_EQ(ir_cell_count(decoded), ir_cell_count(loop));
+    ASSERT_EQ(decoded->label_count, 3);
+    blob_buffer_t* again = blob_buffer_create();
+    ASSERT(ir_lower_blob(decoded, again));
+    ASSERT_EQ(again->size, blob->size);
+    ASSERT(memcmp(again->data, blob->data, blob->size) == 0);
+
+    /* Truncated entries and branches into an offset cell are rejected */
+    ir_buffer_clear(decoded);
+    ASSERT(!ir_decode_blob(decoded, blob->data, blob->size - 1));
+    blob_buffer_clear(again);
+    encode_primitive(again, PRIM_BRANCH);
+    encode_inline_literal(again, -1);
+    ir_buffer_clear(decoded);
+    ASSERT(!ir_decode_blob(decoded, again->data, again->size));
+
+    blob_buffer_free(again);
+    ir_buffer_free(decoded);
+    ir_buffer_free(true_ir);
+    ir_buffer_free(false_ir);
+    ir_buffer_free(ir);
+    ir_buffer_free(loop);
+    ir_buffer_free(bad);
+    cell_buffer_free(cells);
+    blob_buffer_free(blob);
+
+    TEST_SUMMARY();
+}
@@ -12,6 +12,8 @@
 #include "database.h"
 #include "dictionary.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 /* Real primitives are in build/libmarch_vm.a - no stubs needed! */
@@ -111,6 +113,26 @@ int main(void) {
     ASSERT_EQ(depth, 1);
     ASSERT_EQ(stack[0], 20);  /* Should be 10 + 10 = 20 with real primitive! */
 
+    /* Test 12: Constant arrays share a region, read-only after linking */
+    uint8_t array_a[24], array_b[40];
+    for (size_t i = 0; i < sizeof(array_b); i++) {
+        if (i < sizeof(array_a)) array_a[i] = (uint8_t)i;
+        array_b[i] = (uint8_t)(100 + i);
+    }
+    unsigned char* cid_a = db_store_blob(db, BLOB_DATA, NULL, array_a, sizeof(array_a));
+    unsigned char* cid_b = db_store_blob(db, BLOB_DATA, NULL, array_b, sizeof(array_b));
+    uint8_t* addr_a = loader_link_cid(loader, cid_a);
+    ASSERT(addr_a != NULL);
+    ASSERT(loader->data_sealed);
+    uint8_t* addr_b = loader_link_cid(loader, cid_b);
+    ASSERT(addr_b == addr_a + sizeof(array_a));
+    ASSERT(loader->data_sealed);
+    ASSERT(memcmp(addr_a, array_a, sizeof(array_a)) == 0);
+    ASSERT(memcmp(addr_b, array_b, sizeof(array_b)) == 0);
+    ASSERT(loader_link_cid(loader, cid_a) == addr_a);
+    free(cid_a);
+    free(cid_b);
+
     /* Clean up */
     runner_free(runner);
     loader_free(loader);
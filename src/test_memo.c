@@ -0,0 +1,112 @@
+/*
+ * March Language - Memo Table Tests
+ */
+
+#include "test_framework.h"
+#include "memo.h"
+#include <stdint.h>
+#include <string.h>
+
+/* A call as memo-enter / memo-exit see it: stack[] holds the inputs with
+ * the top at the lowest index, and gets the outputs the same way */
+static uint64_t stack[MEMO_MAX_CELLS];
+
+static uint64_t* push_inputs(const uint64_t* inputs, int count) {
+    uint64_t* dsp = stack + MEMO_MAX_CELLS - count;
+    for (int i = 0; i < count; i++) {
+        dsp[count - 1 - i] = inputs[i];     /* Deepest first */
+    }
+    return dsp;
+}
+
+/* One call of word (a, b -- a+b  a*b); returns true on a hit */
+static bool call(const void* word, uint64_t a, uint64_t b, uint64_t* sum, uint64_t* product) {
+    uint64_t inputs[2] = {a, b};
+    uint64_t* dsp = push_inputs(inputs, 2);
+    uint64_t handle = memo_enter(dsp, word, memo_arity(2, 2));
+    if (handle != MEMO_HIT) {
+        dsp[1] = a + b;
+        dsp[0] = a * b;
+        memo_exit(handle, dsp);
+    }
+    *sum = dsp[1];
+    *product = dsp[0];
+    return handle == MEMO_HIT;
+}
+
+int main(void) {
+    TEST_SUITE("Memo Table");
+
+    static const char word_a, word_b;
+    uint64_t sum = 0, product = 0;
+    memo_stats_t stats;
+
+    /* Miss, then hit with the same outputs */
+    ASSERT(!call(&word_a, 3, 4, &sum, &product));
+    ASSERT(call(&word_a, 3, 4, &sum, &product));
+    ASSERT_EQ(sum, 7);
+    ASSERT_EQ(product, 12);
+
+    /* Keys are (word, inputs): input order and the word both matter */
+    ASSERT(!call(&word_a, 4, 3, &sum, &product));
+    ASSERT(!call(&word_b, 3, 4, &sum, &product));
+    memo_get_stats(&stats);
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.misses, 3);
+    ASSERT_EQ(stats.entries, 3);
+
+    /* Fewer outputs than inputs: a hit leaves the stack where the word would */
+    uint64_t inputs[3] = {10, 20, 30};
+    uint64_t* dsp = push_inputs(inputs, 3);
+    uint64_t handle = memo_enter(dsp, &word_b, memo_arity(3, 1));
+    ASSERT(handle != MEMO_HIT && handle != 0);
+    dsp[2] = 60;
+    memo_exit(handle, dsp + 2);
+    dsp = push_inputs(inputs, 3);
+    ASSERT_EQ(memo_enter(dsp, &word_b, memo_arity(3, 1)), MEMO_HIT);
+    ASSERT_EQ(dsp[2], 60);
+
+    /* Least recently used entries go first when the table is full */
+    memo_reset();
+    memo_set_capacity(2);
+    call(&word_a, 1, 1, &sum, &product);
+    call(&word_a, 2, 2, &sum, &product);
+    ASSERT(call(&word_a, 1, 1, &sum, &product));        /* (2,2) is now oldest */
+    ASSERT(!call(&word_a, 3, 3, &sum, &product));
+    memo_get_stats(&stats);
+    ASSERT_EQ(stats.evictions, 1);
+    ASSERT_EQ(stats.entries, 2);
+    ASSERT(call(&word_a, 1, 1, &sum, &product));
+    ASSERT(!call(&word_a, 2, 2, &sum, &product));
+
+    /* Many entries through the HAMT, with eviction all along */
+    memo_reset();
+    memo_set_capacity(1000);
+    for (uint64_t i = 0; i < 5000; i++) {
+        call(&word_a, i, i + 1, &sum, &product);
+    }
+    memo_get_stats(&stats);
+    ASSERT_EQ(stats.entries, 1000);
+    ASSERT_EQ(stats.evictions, 4000);
+    ASSERT(call(&word_a, 4999, 5000, &sum, &product));
+    ASSERT_EQ(sum, 9999);
+    ASSERT(!call(&word_a, 0, 1, &sum, &product));
+
+    /* Shrinking evicts; capacity 0 records nothing */
+    memo_set_capacity(10);
+    memo_get_stats(&stats);
+    ASSERT_EQ(stats.entries, 10);
+    memo_set_capacity(0);
+    ASSERT_EQ(memo_enter(push_inputs(inputs, 2), &word_b, memo_arity(2, 2)), 0);
+
+    /* Too many cells to key */
+    memo_set_capacity(MEMO_DEFAULT_CAPACITY);
+    ASSERT_EQ(memo_enter(stack, &word_b, memo_arity(MEMO_MAX_CELLS, 1)), 0);
+
+    memo_reset();
+    memo_get_stats(&stats);
+    ASSERT_EQ(stats.entries, 0);
+    ASSERT_EQ(stats.hits, 0);
+
+    TEST_SUMMARY();
+}
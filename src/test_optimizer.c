@@ -0,0 +1,218 @@
+/*
+ * March Language - Peephole Optimizer Tests
+ */
+
+#include "test_framework.h"
+#include "optimizer.h"
+#include <string.h>
+
+static dictionary_t* make_dict(void) {
+    dictionary_t* dict = dict_create();
+    type_sig_t sig;
+    memset(&sig, 0, sizeof(sig));
+    dict_add(dict, "branch", (void*)0x1000, NULL, PRIM_BRANCH, &sig, true, false, NULL, NULL);
+    dict_add(dict, "<<", (void*)0x2000, NULL, PRIM_LSHIFT, &sig, true, false, NULL, NULL);
+    dict_add(dict, ">>", (void*)0x3000, NULL, PRIM_RSHIFT, &sig, true, false, NULL, NULL);
+    dict_add(dict, "tailcall", (void*)0x5000, NULL, PRIM_TAILCALL, &sig, true, false, NULL, NULL);
+    return dict;
+}
+
+static bool lit_at(const ir_buffer_t* ir, size_t i, int64_t value) {
+    return ir->instrs[i].op == IR_LIT && ir->instrs[i].value == value;
+}
+
+static bool is_prim_at(const ir_buffer_t* ir, size_t i, uint16_t prim_id) {
+    return ir->instrs[i].op == IR_PRIM && ir->instrs[i].prim_id == prim_id;
+}
+
+int main(void) {
+    TEST_SUITE("Peephole Optimizer");
+
+    dictionary_t* dict = make_dict();
+    ir_buffer_t* ir = ir_buffer_create();
+    optimizer_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    /* Folds cascade: 2 3 + 4 *  →  20 */
+    ir_emit_lit(ir, 2);
+    ir_emit_lit(ir, 3);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    ir_emit_lit(ir, 4);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, &stats));
+    ASSERT_EQ(ir->count, 1);
+    ASSERT(lit_at(ir, 0, 20));
+    ASSERT_EQ(stats.folded, 2);
+    ASSERT_EQ(stats.cells_before - stats.cells_after, 4);
+
+    /* Comparisons fold to flags; unary folds */
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, 3);
+    ir_emit_lit(ir, 5);
+    ir_emit_prim(ir, PRIM_LT, NULL);
+    ir_emit_lit(ir, 0);
+    ir_emit_prim(ir, PRIM_ZEROP, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 2);
+    ASSERT(lit_at(ir, 0, -1));
+    ASSERT(lit_at(ir, 1, -1));
+
+    /* Division by zero is left to run time */
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, 7);
+    ir_emit_lit(ir, 0);
+    ir_emit_prim(ir, PRIM_DIV, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 3);
+
+    /* Results outside the 62-bit literal range are not folded */
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, INT64_C(1) << 31);
+    ir_emit_lit(ir, INT64_C(1) << 30);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 3);
+
+    /* Shuffles cancel, dropped pushes vanish, identities disappear */
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_SWAP, NULL);
+    ir_emit_prim(ir, PRIM_SWAP, NULL);
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ir_emit_prim(ir, PRIM_ROT, NULL);
+    ir_emit_prim(ir, PRIM_ROT, NULL);
+    ir_emit_prim(ir, PRIM_ROT, NULL);
+    ir_emit_lit(ir, 0);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 0);
+
+    /* A dropped constant array is never linked */
+    ir_buffer_clear(ir);
+    unsigned char array_cid[CID_SIZE] = {7};
+    ir_emit_ref(ir, BLOB_STATIC, array_cid, TYPE_ARRAY, 0);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 0);
+
+    /* Side-effecting calls are never dropped */
+    ir_buffer_clear(ir);
+    ir_emit_prim(ir, PRIM_FETCH, NULL);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 2);
+
+    /* Strength reduction: x 8 * → x 3 <<; signed / only for x >= 0 */
+    ir_buffer_clear(ir);
+    memset(&stats, 0, sizeof(stats));
+    ir_emit_prim(ir, PRIM_OVER, NULL);
+    ir_emit_lit(ir, 8);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ir_emit_prim(ir, PRIM_OVER, NULL);
+    ir_emit_lit(ir, 4);
+    ir_emit_prim(ir, PRIM_DIV, NULL);
+    ir_emit_prim(ir, PRIM_STR_LEN, NULL);
+    ir_emit_lit(ir, 4);
+    ir_emit_prim(ir, PRIM_DIV, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, &stats));
+    ASSERT_EQ(ir->count, 9);
+    ASSERT(lit_at(ir, 1, 3));
+    ASSERT(is_prim_at(ir, 2, PRIM_LSHIFT));
+    ASSERT_EQ(ir->instrs[2].addr, (void*)0x2000);
+    ASSERT(is_prim_at(ir, 5, PRIM_DIV));
+    ASSERT(lit_at(ir, 7, 2));
+    ASSERT(is_prim_at(ir, 8, PRIM_RSHIFT));
+    ASSERT_EQ(stats.reduced, 2);
+
+    /* Constant conditions: true 0branch falls through, false becomes branch */
+    ir_buffer_clear(ir);
+    int label = ir_new_label(ir);
+    ir_emit_lit(ir, -1);
+    ir_emit_branch(ir, PRIM_0BRANCH, (void*)0x4000, label);
+    ir_emit_lit(ir, 0);
+    ir_emit_branch(ir, PRIM_0BRANCH, (void*)0x4000, label);
+    ir_emit_label(ir, label);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 2);
+    ASSERT_EQ(ir->instrs[0].op, IR_BRANCH);
+    ASSERT_EQ(ir->instrs[0].prim_id, PRIM_BRANCH);
+    ASSERT_EQ(ir->instrs[0].value, label);
+
+    /* Labels are barriers: 5 L: drop keeps both */
+    ir_buffer_clear(ir);
+    label = ir_new_label(ir);
+    ir_emit_lit(ir, 5);
+    ir_emit_label(ir, label);
+    ir_emit_prim(ir, PRIM_DROP, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_PEEPHOLE, NULL));
+    ASSERT_EQ(ir->count, 3);
+
+    /* -O0 leaves the IR alone */
+    ir_buffer_clear(ir);
+    ir_emit_lit(ir, 2);
+    ir_emit_lit(ir, 3);
+    ir_emit_prim(ir, PRIM_ADD, NULL);
+    ASSERT(optimize_ir(ir, dict, OPT_NONE, NULL));
+    ASSERT_EQ(ir->count, 3);
+
+    /* Self tail recursion at the end of an if arm loops back to the start:
+     * dup 0branch F 1 - RECURSE branch E F: E: */
+    ir_buffer_clear(ir);
+    memset(&stats, 0, sizeof(stats));
+    int false_label = ir_new_label(ir);
+    int end_label = ir_new_label(ir);
+    ir_emit_prim(ir, PRIM_DUP, NULL);
+    ir_emit_branch(ir, PRIM_0BRANCH, (void*)0x4000, false_label);
+    ir_emit_lit(ir, 1);
+    ir_emit_prim(ir, PRIM_SUB, NULL);
+    ir_emit_recurse(ir);
+    ir_emit_branch(ir, PRIM_BRANCH, (void*)0x1000, end_label);
+    ir_emit_label(ir, false_label);
+    ir_emit_label(ir, end_label);
+    ASSERT(eliminate_tail_calls(ir, dict, true, false, &stats));
+    ASSERT_EQ(stats.tail_calls, 1);
+    ASSERT_EQ(ir->instrs[0].op, IR_LABEL);
+    ASSERT_EQ(ir->instrs[5].op, IR_BRANCH);
+    ASSERT_EQ(ir->instrs[5].prim_id, PRIM_BRANCH);
+    ASSERT_EQ(ir->instrs[5].value, ir->instrs[0].value);
+    blob_buffer_t* blob = blob_buffer_create();
+    ASSERT(ir_lower_blob(ir, blob));
+
+    /* Recursion followed by more work stays a call: a self call in the blob */
+    ir_buffer_clear(ir);
+    blob_buffer_clear(blob);
+    ir_emit_recurse(ir);
+    ir_emit_prim(ir, PRIM_MUL, NULL);
+    ASSERT(eliminate_tail_calls(ir, dict, true, true, NULL));
+    ASSERT_EQ(ir->count, 2);
+    ASSERT(ir_lower_blob(ir, blob));
+    ASSERT_EQ(blob->size, 4);
+    ASSERT_EQ(blob->data[0], PRIM_RECURSE << 1);
+    ir_buffer_clear(ir);
+    ASSERT(ir_decode_blob(ir, blob->data, blob->size));
+    ASSERT_EQ(ir->instrs[0].op, IR_RECURSE);
+
+    /* Other calls in tail position jump (and leave earlier calls alone) */
+    ir_buffer_clear(ir);
+    memset(&stats, 0, sizeof(stats));
+    unsigned char cid[CID_SIZE] = {0};
+    ir_emit_ref(ir, BLOB_WORD, cid, TYPE_UNKNOWN, 0);
+    ir_emit_ref(ir, BLOB_WORD, cid, TYPE_UNKNOWN, 0);
+    ASSERT(eliminate_tail_calls(ir, dict, true, false, &stats));
+    ASSERT_EQ(stats.tail_calls, 0);
+    ASSERT(eliminate_tail_calls(ir, dict, true, true, &stats));
+    ASSERT_EQ(stats.tail_calls, 1);
+    ASSERT_EQ(ir->count, 4);
+    ASSERT_EQ(ir->instrs[1].op, IR_REF);
+    ASSERT(is_prim_at(ir, 2, PRIM_TAILCALL));
+    ASSERT_EQ(ir->instrs[2].addr, (void*)0x5000);
+    ASSERT_EQ(ir->instrs[3].op, IR_REF);
+
+    blob_buffer_free(blob);
+    ir_buffer_free(ir);
+    dict_free(dict);
+
+    TEST_SUMMARY();
+}
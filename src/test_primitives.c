@@ -169,12 +169,8 @@ int main(void) {
 
     /* Verify we have exactly 39 primitives registered */
     int count = 0;
-    for (size_t i = 0; i < dict->bucket_count; i++) {
-        dict_entry_t* e = dict->buckets[i];
-        while (e) {
-            if (e->is_primitive) count++;
-            e = e->next;
-        }
+    for (size_t i = 0; i < dict_entry_count(dict); i++) {
+        if (dict_entry_at(dict, i)->is_primitive) count++;
     }
     ASSERT_EQ(count, 42);  /* 39 + branch + 0branch + execute */
 
@@ -0,0 +1,98 @@
+/*
+ * March Language - Compiler Server Protocol Tests
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test_framework.h"
+#include "protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/* Send each chunk as its own record (a seqpacket read returns exactly one),
+ * so the reader sees the reply split wherever the test says */
+static int send_chunks(const char* const* chunks, int count) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) return -1;
+    for (int i = 0; i < count; i++) {
+        /* Chunks may contain the NUL separator: "" stands for one NUL byte */
+        size_t len = chunks[i][0] ? strlen(chunks[i]) : 1;
+        protocol_write_all(fds[1], chunks[i], len);
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+/* Copy the reply made of chunks; text receives the output */
+static int copy_reply(const char* const* chunks, int count, char* text, size_t size) {
+    int fd = send_chunks(chunks, count);
+    FILE* out = tmpfile();
+    int status = protocol_copy_reply(fd, out);
+    close(fd);
+
+    rewind(out);
+    size_t n = fread(text, 1, size - 1, out);
+    text[n] = '\0';
+    fclose(out);
+    return status;
+}
+
+static bool read_request(const char* const* chunks, int count, char* line, size_t size) {
+    int fd = send_chunks(chunks, count);
+    bool ok = protocol_read_request(fd, line, size);
+    close(fd);
+    return ok;
+}
+
+int main(void) {
+    TEST_SUITE("Compiler Server Protocol");
+    char text[256];
+
+    /* Output and status arriving together */
+    const char* whole[] = { "hello\n", "", "0" };
+    ASSERT_EQ(copy_reply(whole, 3, text, sizeof(text)), 0);
+    ASSERT_STR_EQ(text, "hello\n");
+
+    /* Status bytes split from the output, one read each */
+    const char* split[] = { "hello", "", "1" };
+    ASSERT_EQ(copy_reply(split, 3, text, sizeof(text)), 1);
+    ASSERT_STR_EQ(text, "hello");
+
+    /* One byte per read throughout */
+    const char* bytes[] = { "o", "k", "\n", "", "0" };
+    ASSERT_EQ(copy_reply(bytes, 5, text, sizeof(text)), 0);
+    ASSERT_STR_EQ(text, "ok\n");
+
+    /* Nothing but the status */
+    const char* empty[] = { "", "0" };
+    ASSERT_EQ(copy_reply(empty, 2, text, sizeof(text)), 0);
+    ASSERT_STR_EQ(text, "");
+
+    /* Connection closed without a status */
+    const char* cut[] = { "partial output" };
+    ASSERT_EQ(copy_reply(cut, 1, text, sizeof(text)), -1);
+    ASSERT_EQ(copy_reply(NULL, 0, text, sizeof(text)), -1);
+
+    /* Requests: newline and CR stripped, split reads joined */
+    char line[16];
+    const char* run[] = { "run main\r\n" };
+    ASSERT(read_request(run, 1, line, sizeof(line)));
+    ASSERT_STR_EQ(line, "run main");
+    const char* parts[] = { "comp", "ile a", "\n" };
+    ASSERT(read_request(parts, 3, line, sizeof(line)));
+    ASSERT_STR_EQ(line, "compile a");
+    const char* unterminated[] = { "stop" };
+    ASSERT(read_request(unterminated, 1, line, sizeof(line)));
+    ASSERT_STR_EQ(line, "stop");
+
+    /* Blank and oversized requests are refused */
+    const char* blank[] = { "\n" };
+    ASSERT(!read_request(blank, 1, line, sizeof(line)));
+    const char* oversized[] = { "compile /a/long/path.march\n" };
+    ASSERT(!read_request(oversized, 1, line, sizeof(line)));
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,120 @@
+/*
+ * March Language - Compiler Server Tests
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test_framework.h"
+#include "server.h"
+#include "protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+static const char* test_socket = "test_server.sock";
+
+/* Send one request line; text receives the reply output. Returns the
+ * status, or -1 if the server cannot be reached. */
+static int request(const char* line, char* text, size_t size) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, test_socket);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        !protocol_write_all(fd, line, strlen(line)) || !protocol_write_all(fd, "\n", 1)) {
+        close(fd);
+        return -1;
+    }
+
+    FILE* out = tmpfile();
+    int status = protocol_copy_reply(fd, out);
+    close(fd);
+
+    rewind(out);
+    size_t n = fread(text, 1, size - 1, out);
+    text[n] = '\0';
+    fclose(out);
+    return status;
+}
+
+static void write_source(const char* path, const char* source) {
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    fputs(source, f);
+    fclose(f);
+}
+
+int main(void) {
+    TEST_SUITE("Compiler Server");
+
+    const char* test_db = "test_server.db";
+    char source[1024];
+    char line[1100];
+    char text[4096];
+    unlink(test_db);
+    unlink(test_socket);
+
+    /* compile takes an absolute path */
+    ASSERT(getcwd(source, sizeof(source) - 32) != NULL);
+    strcat(source, "/test_server.march");
+    snprintf(line, sizeof(line), "compile %s", source);
+
+    pid_t server = fork();
+    ASSERT(server >= 0);
+    if (server == 0) {
+        server_options_t opts;
+        server_options_init(&opts);
+        opts.socket_path = test_socket;
+        opts.db_path = test_db;
+        _exit(server_run(&opts));
+    }
+
+    /* The server is up once it answers */
+    int status = -1;
+    for (int i = 0; i < 200 && status < 0; i++) {
+        status = request("stack", text, sizeof(text));
+        if (status < 0) usleep(10000);
+    }
+    ASSERT_EQ(status, 1);
+
+    /* compile, run */
+    write_source(source, ": b 1 ;\n: a b ;\n");
+    ASSERT_EQ(request(line, text, sizeof(text)), 0);
+    ASSERT_EQ(request("run a", text, sizeof(text)), 0);
+    ASSERT_EQ(request("stack", text, sizeof(text)), 0);
+    ASSERT(strstr(text, "[0] = 1") != NULL);
+
+    /* Editing the callee recompiles the warm caller */
+    write_source(source, ": b 2 ;\n: a b ;\n");
+    ASSERT_EQ(request(line, text, sizeof(text)), 0);
+    ASSERT_EQ(request("run a", text, sizeof(text)), 0);
+    ASSERT_EQ(request("stack", text, sizeof(text)), 0);
+    ASSERT(strstr(text, "[0] = 2") != NULL);
+    ASSERT(strstr(text, "[0] = 1") == NULL);
+
+    /* Compiling it again unchanged keeps the edit */
+    ASSERT_EQ(request(line, text, sizeof(text)), 0);
+    ASSERT_EQ(request("run a", text, sizeof(text)), 0);
+    ASSERT_EQ(request("stack", text, sizeof(text)), 0);
+    ASSERT(strstr(text, "Stack (1 items)") != NULL);
+    ASSERT(strstr(text, "[0] = 2") != NULL);
+
+    ASSERT_EQ(request("bogus", text, sizeof(text)), 1);
+    ASSERT_EQ(request("stop", text, sizeof(text)), 0);
+    int exit_status = -1;
+    ASSERT_EQ(waitpid(server, &exit_status, 0), server);
+    ASSERT(WIFEXITED(exit_status) && WEXITSTATUS(exit_status) == 0);
+
+    unlink(test_db);
+    unlink(source);
+
+    TEST_SUMMARY();
+    return 0;
+}
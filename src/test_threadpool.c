@@ -0,0 +1,98 @@
+/*
+ * March Language - Thread Pool Tests
+ */
+
+#include "test_framework.h"
+#include "threadpool.h"
+#include "database.h"
+#include "cells.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define JOB_COUNT 64
+
+typedef struct {
+    march_db_t* db;
+    int64_t value;              /* Jobs with equal values store the same blob */
+    unsigned char cid[CID_SIZE];
+    bool ok;
+} store_job_t;
+
+static pthread_mutex_t counter_lock = PTHREAD_MUTEX_INITIALIZER;
+static int counter = 0;
+
+static void count_job(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&counter_lock);
+    counter++;
+    pthread_mutex_unlock(&counter_lock);
+}
+
+/* Store a word blob, its edges and a binding from a worker thread */
+static void store_job(void* arg) {
+    store_job_t* job = arg;
+    blob_buffer_t* buf = blob_buffer_create();
+    encode_inline_literal(buf, job->value);
+    unsigned char* cid = db_store_blob(job->db, BLOB_WORD, NULL, buf->data, buf->size);
+    job->ok = cid != NULL &&
+              db_store_edges(job->db, cid, buf->data, buf->size) &&
+              db_bind_word(job->db, "w", NULL, cid, "->");
+    if (cid) memcpy(job->cid, cid, CID_SIZE);
+    free(cid);
+    blob_buffer_free(buf);
+}
+
+int main(void) {
+    TEST_SUITE("Thread Pool");
+
+    ASSERT(thread_pool_cpu_count() >= 1);
+
+    /* Every job runs before wait returns; the pool is reusable after wait */
+    thread_pool_t* pool = thread_pool_create(4);
+    ASSERT_NOT_NULL(pool);
+    for (int i = 0; i < 100; i++) {
+        ASSERT(thread_pool_submit(pool, count_job, NULL));
+    }
+    thread_pool_wait(pool);
+    ASSERT_EQ(counter, 100);
+    ASSERT(thread_pool_submit(pool, count_job, NULL));
+    thread_pool_wait(pool);
+    ASSERT_EQ(counter, 101);
+
+    /* Concurrent writers through one handle, inside one transaction */
+    const char* test_db = "test_threadpool.db";
+    unlink(test_db);
+    march_db_t* db = db_open(test_db);
+    ASSERT(db != NULL);
+    ASSERT(db_init_schema(db, "../schema.sql"));
+
+    static store_job_t jobs[JOB_COUNT];
+    ASSERT(db_begin(db));
+    for (int i = 0; i < JOB_COUNT; i++) {
+        jobs[i].db = db;
+        jobs[i].value = i % (JOB_COUNT / 2);
+        jobs[i].ok = false;
+        ASSERT(thread_pool_submit(pool, store_job, &jobs[i]));
+    }
+    thread_pool_wait(pool);
+    ASSERT(db_commit(db));
+
+    int failed = 0;
+    for (int i = 0; i < JOB_COUNT; i++) {
+        if (!jobs[i].ok) failed++;
+        if (db_get_blob_kind(db, jobs[i].cid) != BLOB_WORD) failed++;
+    }
+    ASSERT_EQ(failed, 0);
+
+    /* Duplicate stores are content-identical */
+    ASSERT(memcmp(jobs[0].cid, jobs[JOB_COUNT / 2].cid, CID_SIZE) == 0);
+    ASSERT(memcmp(jobs[0].cid, jobs[1].cid, CID_SIZE) != 0);
+
+    thread_pool_free(pool);
+    db_close(db);
+    unlink(test_db);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,108 @@
+/*
+ * March Language - Token Stream Tests
+ */
+
+#include "test_framework.h"
+#include "tokens.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_SOURCE "test_tokens.march"
+
+static token_stream_t* open_source(const char* text) {
+    FILE* f = fopen(TEST_SOURCE, "w");
+    if (!f) return NULL;
+    fputs(text, f);
+    fclose(f);
+    return token_stream_create(TEST_SOURCE);
+}
+
+int main(void) {
+    TEST_SUITE("Token Stream");
+
+    token_t tok;
+
+    /* Delimiters, numbers and words; comments skipped */
+    token_stream_t* s = open_source(": sq ( dup * ) -- squares\n  0x10 -5 [ $ ] ;\n");
+    ASSERT_NOT_NULL(s);
+    token_type_t expected[] = {
+        TOK_COLON, TOK_WORD, TOK_LPAREN, TOK_WORD, TOK_WORD, TOK_RPAREN,
+        TOK_NUMBER, TOK_NUMBER, TOK_LBRACKET, TOK_DOLLAR, TOK_RBRACKET, TOK_SEMICOLON
+    };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        ASSERT(token_stream_next(s, &tok));
+        ASSERT_EQ(tok.type, expected[i]);
+        if (i == 6) {
+            ASSERT_EQ(tok.number, 16);
+            ASSERT_EQ(tok.line, 2);
+            ASSERT_EQ(tok.column, 3);
+            ASSERT_EQ(tok.offset, 28);
+            ASSERT_EQ(tok.length, 4);
+        }
+        if (i == 7) ASSERT_EQ(tok.number, -5);
+    }
+    ASSERT(!token_stream_next(s, &tok));
+    ASSERT_EQ(tok.type, TOK_EOF);
+    token_stream_free(s);
+
+    /* Equal spellings share one symbol and its text */
+    uint32_t dup_sym = token_intern("dup", 3);
+    ASSERT_EQ(token_intern("dup", 3), dup_sym);
+    ASSERT(token_intern("drop", 4) != dup_sym);
+    ASSERT_STR_EQ(token_symbol_text(dup_sym), "dup");
+    size_t symbols = token_symbol_count();
+
+    s = open_source("dup dup\tdup\n");
+    ASSERT(token_stream_next(s, &tok));
+    const char* first_text = tok.text;
+    ASSERT_EQ(tok.sym, dup_sym);
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_EQ(tok.sym, dup_sym);
+    ASSERT(tok.text == first_text);
+    ASSERT(token_is(&tok, "dup"));
+    ASSERT_EQ(token_symbol_count(), symbols);
+    token_stream_free(s);
+
+    /* Long tokens and runs of whitespace cross the 16-byte scan blocks */
+    s = open_source("                    \n\n\n   a-rather-long-word-name-over-sixteen  x");
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_STR_EQ(tok.text, "a-rather-long-word-name-over-sixteen");
+    ASSERT_EQ(tok.line, 4);
+    ASSERT_EQ(tok.column, 4);
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_STR_EQ(tok.text, "x");
+    ASSERT(!token_stream_next(s, &tok));
+    token_stream_free(s);
+
+    /* Strings: escapes, inner quotes, spaces; same text as a word, different type */
+    s = open_source("\"say \\\"hi\\\"\" \"a\"b\" \"dup\" dup");
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_EQ(tok.type, TOK_STRING);
+    ASSERT_STR_EQ(tok.text, "say \"hi\"");
+    ASSERT_EQ(tok.length, 12);
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_STR_EQ(tok.text, "a\"b");
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_EQ(tok.type, TOK_STRING);
+    ASSERT_EQ(tok.sym, dup_sym);
+    ASSERT(token_stream_next(s, &tok));
+    ASSERT_EQ(tok.type, TOK_WORD);
+    token_stream_free(s);
+
+    /* Unterminated string */
+    s = open_source("\"open");
+    ASSERT(!token_stream_next(s, &tok));
+    token_stream_free(s);
+
+    /* Empty source and missing file */
+    s = open_source("");
+    ASSERT_NOT_NULL(s);
+    ASSERT(!token_stream_next(s, &tok));
+    ASSERT_EQ(tok.type, TOK_EOF);
+    token_stream_free(s);
+    ASSERT_NULL(token_stream_create("no-such-file.march"));
+
+    remove(TEST_SOURCE);
+    TEST_SUMMARY();
+}
@@ -0,0 +1,48 @@
+/*
+ * March Language - Thread Pool
+ * Fixed set of worker threads draining a FIFO queue of jobs
+ */
+
+#ifndef MARCH_THREADPOOL_H
+#define MARCH_THREADPOOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/* Job function */
+typedef void (*thread_pool_fn)(void* arg);
+
+typedef struct thread_pool_job {
+    thread_pool_fn fn;
+    void* arg;
+    struct thread_pool_job* next;
+} thread_pool_job_t;
+
+typedef struct {
+    pthread_t* threads;
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;      /* Signalled when a job is queued or on shutdown */
+    pthread_cond_t work_done;       /* Signalled when the pool becomes idle */
+    thread_pool_job_t* head;        /* FIFO: jobs run in submission order */
+    thread_pool_job_t* tail;
+    int pending;                    /* Queued + running jobs */
+    bool shutdown;
+} thread_pool_t;
+
+/* Number of online CPUs (at least 1) */
+int thread_pool_cpu_count(void);
+
+/* Create a pool with thread_count workers */
+thread_pool_t* thread_pool_create(int thread_count);
+
+/* Queue fn(arg); jobs may submit further jobs */
+bool thread_pool_submit(thread_pool_t* pool, thread_pool_fn fn, void* arg);
+
+/* Block until every submitted job has finished */
+void thread_pool_wait(thread_pool_t* pool);
+
+/* Wait for outstanding jobs, stop and free the pool */
+void thread_pool_free(thread_pool_t* pool);
+
+#endif /* MARCH_THREADPOOL_H */
@@ -1,5 +1,11 @@
 /*
  * March Language - Token Stream Implementation
+ *
+ * The source is mapped whole and scanned in place: whitespace runs and
+ * token ends are found 16 bytes at a time (SSE2 on x86-64). Token text is
+ * interned once per distinct spelling, along with how it lexes (number,
+ * word, delimiter), so a token costs a scan and a hash probe and no heap
+ * allocation. String literals are unescaped into a reused scratch buffer.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -7,254 +13,409 @@
 #include "tokens.h"
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define TOKENS_HAVE_SSE2 1
+#endif
+
+#define NO_SYMBOL UINT32_MAX
+#define SYMBOL_CHUNK_SIZE 65536
+
+/* ============================================================================ */
+/* Symbol table */
+/* ============================================================================ */
+
+typedef struct {
+    const char* text;       /* NUL-terminated, in a chunk (never moves) */
+    uint32_t length;
+    uint32_t hash;
+    token_type_t type;      /* As a bare (unquoted) token */
+    int64_t number;         /* TOK_NUMBER value */
+} symbol_t;
+
+static struct {
+    symbol_t* symbols;
+    size_t count;
+    size_t capacity;
+    uint32_t* index;        /* Open addressing: symbol id + 1, 0 = empty */
+    size_t index_size;      /* Power of two, at most half full */
+    char* chunk;            /* Text storage being filled */
+    size_t chunk_used;
+    size_t chunk_size;
+} symtab;
+
+static uint32_t symbol_hash(const char* text, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    }
+    return hash;
+}
 
-#define BUFFER_SIZE 4096
+/* How the text lexes as a bare token */
+static void symbol_classify(symbol_t* symbol) {
+    const char* text = symbol->text;
+    symbol->number = 0;
+
+    if (strcmp(text, ":") == 0) {
+        symbol->type = TOK_COLON;
+    } else if (strcmp(text, ";") == 0) {
+        symbol->type = TOK_SEMICOLON;
+    } else if (strcmp(text, "(") == 0) {
+        symbol->type = TOK_LPAREN;
+    } else if (strcmp(text, ")") == 0) {
+        symbol->type = TOK_RPAREN;
+    } else if (strcmp(text, "[") == 0) {
+        symbol->type = TOK_LBRACKET;
+    } else if (strcmp(text, "]") == 0) {
+        symbol->type = TOK_RBRACKET;
+    } else if (strcmp(text, "$") == 0) {
+        symbol->type = TOK_DOLLAR;
+    } else if (strcmp(text, "--") == 0) {
+        symbol->type = TOK_COMMENT;
+    } else {
+        char* endptr;
+        errno = 0;
+        int64_t num = strtoll(text, &endptr, 0);  /* Base 0 = auto-detect (dec/hex/oct) */
+        if (symbol->length > 0 && *endptr == '\0' && errno == 0) {
+            symbol->type = TOK_NUMBER;
+            symbol->number = num;
+        } else {
+            symbol->type = TOK_WORD;
+        }
+    }
+}
 
-token_stream_t* token_stream_create(const char* filename) {
-    token_stream_t* stream = malloc(sizeof(token_stream_t));
-    if (!stream) return NULL;
+static bool symtab_grow_index(void) {
+    size_t size = symtab.index_size ? symtab.index_size * 2 : 1024;
+    uint32_t* index = calloc(size, sizeof(uint32_t));
+    if (!index) return false;
+    for (size_t i = 0; i < symtab.count; i++) {
+        size_t slot = symtab.symbols[i].hash & (size - 1);
+        while (index[slot]) slot = (slot + 1) & (size - 1);
+        index[slot] = (uint32_t)i + 1;
+    }
+    free(symtab.index);
+    symtab.index = index;
+    symtab.index_size = size;
+    return true;
+}
 
-    stream->file = fopen(filename, "r");
-    if (!stream->file) {
-        free(stream);
-        return NULL;
+static char* symtab_store_text(const char* text, size_t length) {
+    if (symtab.chunk_used + length + 1 > symtab.chunk_size) {
+        size_t size = length + 1 > SYMBOL_CHUNK_SIZE ? length + 1 : SYMBOL_CHUNK_SIZE;
+        char* chunk = malloc(size);
+        if (!chunk) return NULL;
+        symtab.chunk = chunk;
+        symtab.chunk_used = 0;
+        symtab.chunk_size = size;
     }
+    char* copy = symtab.chunk + symtab.chunk_used;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    symtab.chunk_used += length + 1;
+    return copy;
+}
 
-    stream->filename = strdup(filename);
-    stream->line = 1;
-    stream->column = 1;
-    stream->eof = false;
+uint32_t token_intern(const char* text, size_t length) {
+    if (length >= UINT32_MAX || symtab.count >= NO_SYMBOL - 1) return NO_SYMBOL;
+    if ((symtab.count + 1) * 2 > symtab.index_size && !symtab_grow_index()) {
+        return NO_SYMBOL;
+    }
 
-    stream->buffer = malloc(BUFFER_SIZE);
-    stream->buffer_size = BUFFER_SIZE;
-    stream->buffer_pos = 0;
+    uint32_t hash = symbol_hash(text, length);
+    size_t mask = symtab.index_size - 1;
+    size_t slot = hash & mask;
+    for (; symtab.index[slot]; slot = (slot + 1) & mask) {
+        const symbol_t* symbol = &symtab.symbols[symtab.index[slot] - 1];
+        if (symbol->hash == hash && symbol->length == length &&
+            memcmp(symbol->text, text, length) == 0) {
+            return symtab.index[slot] - 1;
+        }
+    }
 
-    return stream;
+    if (symtab.count >= symtab.capacity) {
+        size_t capacity = symtab.capacity ? symtab.capacity * 2 : 1024;
+        symbol_t* symbols = realloc(symtab.symbols, capacity * sizeof(symbol_t));
+        if (!symbols) return NO_SYMBOL;
+        symtab.symbols = symbols;
+        symtab.capacity = capacity;
+    }
+    char* copy = symtab_store_text(text, length);
+    if (!copy) return NO_SYMBOL;
+
+    symbol_t* symbol = &symtab.symbols[symtab.count];
+    symbol->text = copy;
+    symbol->length = (uint32_t)length;
+    symbol->hash = hash;
+    symbol_classify(symbol);
+    symtab.index[slot] = (uint32_t)symtab.count + 1;
+    return (uint32_t)symtab.count++;
 }
 
-void token_stream_free(token_stream_t* stream) {
-    if (stream) {
-        if (stream->file) fclose(stream->file);
-        free(stream->filename);
-        free(stream->buffer);
-        free(stream);
-    }
+const char* token_symbol_text(uint32_t sym) {
+    return sym < symtab.count ? symtab.symbols[sym].text : NULL;
 }
 
-void token_free(token_t* token) {
-    if (token && token->text) {
-        free(token->text);
-        token->text = NULL;
-    }
+size_t token_symbol_count(void) {
+    return symtab.count;
 }
 
-/* Read next character, tracking position */
-static int next_char(token_stream_t* stream) {
-    int c = fgetc(stream->file);
+/* ============================================================================ */
+/* Scanning */
+/* ============================================================================ */
 
-    if (c == '\n') {
-        stream->line++;
-        stream->column = 1;
-    } else if (c != EOF) {
-        stream->column++;
-    } else {
-        stream->eof = true;
-    }
+/* isspace() in the C locale */
+static inline bool is_space(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') < 5;
+}
 
-    return c;
+#ifdef TOKENS_HAVE_SSE2
+/* Bit i set if p[i] is whitespace */
+static inline unsigned space_mask16(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i blank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i ctl = _mm_sub_epi8(v, _mm_set1_epi8('\t'));            /* \t..\r -> 0..4 */
+    ctl = _mm_cmpeq_epi8(_mm_min_epu8(ctl, _mm_set1_epi8(4)), ctl);
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(blank, ctl));
 }
 
-/* Skip whitespace */
-static void skip_whitespace(token_stream_t* stream) {
-    int c;
-    while ((c = fgetc(stream->file)) != EOF && isspace(c)) {
-        if (c == '\n') {
-            stream->line++;
-            stream->column = 1;
-        } else {
-            stream->column++;
-        }
+static inline unsigned newline_mask16(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+}
+#endif
+
+/* First whitespace byte at or after pos (size if none) */
+static size_t scan_to_space(const char* data, size_t pos, size_t size) {
+#ifdef TOKENS_HAVE_SSE2
+    for (; pos + 16 <= size; pos += 16) {
+        unsigned mask = space_mask16(data + pos);
+        if (mask) return pos + (size_t)__builtin_ctz(mask);
     }
+#endif
+    while (pos < size && !is_space((unsigned char)data[pos])) pos++;
+    return pos;
+}
 
-    if (c != EOF) {
-        ungetc(c, stream->file);
-    } else {
-        stream->eof = true;
+/* First non-whitespace byte at or after pos, counting the lines passed */
+static size_t skip_space(token_stream_t* stream, size_t pos) {
+    const char* data = stream->data;
+    size_t size = stream->size;
+
+#ifdef TOKENS_HAVE_SSE2
+    for (; pos + 16 <= size; pos += 16) {
+        unsigned text = space_mask16(data + pos) ^ 0xFFFFu;
+        unsigned newlines = newline_mask16(data + pos);
+        if (text) newlines &= (1u << __builtin_ctz(text)) - 1;
+        if (newlines) {
+            stream->line += __builtin_popcount(newlines);
+            stream->line_start = pos + (size_t)(31 - __builtin_clz(newlines)) + 1;
+        }
+        if (text) return pos + (size_t)__builtin_ctz(text);
     }
+#endif
+    for (; pos < size && is_space((unsigned char)data[pos]); pos++) {
+        if (data[pos] == '\n') {
+            stream->line++;
+            stream->line_start = pos + 1;
+        }
+    }
+    return pos;
 }
 
-/* Read a word token */
-/* Read string literal: "..." with escape sequences */
-static bool read_string(token_stream_t* stream, token_t* token) {
-    char buffer[1024];  /* Larger buffer for strings */
-    int pos = 0;
-    int c;
-
-    token->line = stream->line;
-    token->column = stream->column;
-
-    /* Skip opening " */
-    c = fgetc(stream->file);
-    if (c != '"') {
-        fprintf(stderr, "Internal error: read_string called without opening quote\n");
-        return false;
+static bool scratch_append(token_stream_t* stream, size_t* len, char c) {
+    if (*len + 1 >= stream->scratch_size) {
+        size_t size = stream->scratch_size ? stream->scratch_size * 2 : 256;
+        char* scratch = realloc(stream->scratch, size);
+        if (!scratch) return false;
+        stream->scratch = scratch;
+        stream->scratch_size = size;
     }
-    stream->column++;
+    stream->scratch[(*len)++] = c;
+    return true;
+}
 
-    /* Read until closing " followed by whitespace */
-    while ((c = fgetc(stream->file)) != EOF) {
-        stream->column++;
+/* String literal at pos: "..." with \" and \\ escapes, closed by a quote
+ * followed by whitespace or the end of the source */
+static bool read_string(token_stream_t* stream, token_t* token, size_t pos) {
+    const char* data = stream->data;
+    size_t size = stream->size;
+    size_t len = 0;
+    bool ok = true;
 
+    for (size_t i = pos + 1; ok && i < size; ) {
+        char c = data[i];
         if (c == '\\') {
-            /* Escape sequence */
-            int next = fgetc(stream->file);
-            if (next == EOF) {
+            if (i + 1 >= size) {
                 fprintf(stderr, "Line %d: Unexpected EOF after backslash in string\n", stream->line);
                 return false;
             }
-            stream->column++;
-
-            if (next == '"') {
-                /* Escaped quote */
-                if (pos < 1023) buffer[pos++] = '"';
-            } else if (next == '\\') {
-                /* Escaped backslash */
-                if (pos < 1023) buffer[pos++] = '\\';
+            char next = data[i + 1];
+            if (next == '"' || next == '\\') {
+                ok = scratch_append(stream, &len, next);
             } else {
                 /* Unknown escape - keep both characters */
-                if (pos < 1023) buffer[pos++] = '\\';
-                if (pos < 1023) buffer[pos++] = next;
-            }
-        } else if (c == '"') {
-            /* Potential closing quote - check for whitespace after */
-            int next = fgetc(stream->file);
-            if (next == EOF || isspace(next)) {
-                /* Valid string end */
-                if (next != EOF) {
-                    ungetc(next, stream->file);
-                }
-                buffer[pos] = '\0';
-                token->type = TOK_STRING;
-                token->text = strdup(buffer);
-                return true;
-            } else {
-                /* Quote not followed by whitespace - include it */
-                if (pos < 1023) buffer[pos++] = '"';
-                ungetc(next, stream->file);
+                ok = scratch_append(stream, &len, '\\') && scratch_append(stream, &len, next);
             }
+            i += 2;
+        } else if (c == '"' && (i + 1 == size || is_space((unsigned char)data[i + 1]))) {
+            uint32_t sym = token_intern(stream->scratch ? stream->scratch : "", len);
+            if (sym == NO_SYMBOL) return false;
+            token->type = TOK_STRING;
+            token->sym = sym;
+            token->text = symtab.symbols[sym].text;
+            token->number = 0;
+            token->length = (uint32_t)(i + 1 - pos);
+            stream->pos = i + 1;
+            return true;
         } else {
-            /* Regular character */
-            if (pos < 1023) buffer[pos++] = c;
+            /* A quote not followed by whitespace is part of the text */
+            if (c == '\n') {
+                stream->line++;
+                stream->line_start = i + 1;
+            }
+            ok = scratch_append(stream, &len, c);
+            i++;
         }
     }
 
-    fprintf(stderr, "Line %d: Unterminated string literal\n", stream->line);
+    if (ok) {
+        fprintf(stderr, "Line %d: Unterminated string literal\n", stream->line);
+    }
     return false;
 }
 
-static bool read_word(token_stream_t* stream, token_t* token) {
-    char buffer[256];
-    int pos = 0;
-    int c;
+/* ============================================================================ */
+/* Streams */
+/* ============================================================================ */
+
+/* Sources that cannot be mapped (pipes, devices) are read whole */
+static bool read_all(token_stream_t* stream, int fd) {
+    size_t capacity = 65536;
+    char* data = malloc(capacity);
+    size_t size = 0;
+    ssize_t n;
+    while (data && (n = read(fd, data + size, capacity - size)) > 0) {
+        size += (size_t)n;
+        if (size == capacity) {
+            char* grown = realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                return false;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    stream->data = data;
+    stream->size = size;
+    return data != NULL;
+}
 
-    token->line = stream->line;
-    token->column = stream->column;
+token_stream_t* token_stream_create(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
 
-    /* Check for string literal */
-    c = fgetc(stream->file);
-    if (c == '"') {
-        ungetc(c, stream->file);
-        return read_string(stream, token);
+    token_stream_t* stream = calloc(1, sizeof(token_stream_t));
+    if (!stream) {
+        close(fd);
+        return NULL;
     }
-    ungetc(c, stream->file);
+    stream->filename = strdup(filename);
+    stream->line = 1;
 
-    while ((c = fgetc(stream->file)) != EOF && !isspace(c)) {
-        if (pos < 255) {
-            buffer[pos++] = c;
+    struct stat st;
+    bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    if (regular && st.st_size > 0) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            stream->data = map;
+            stream->size = (size_t)st.st_size;
+            stream->mapped = true;
         }
-        stream->column++;
     }
+    bool ok = stream->filename &&
+              (stream->mapped || (regular && st.st_size == 0) || read_all(stream, fd));
+    close(fd);
 
-    if (c != EOF) {
-        ungetc(c, stream->file);
+    if (!ok) {
+        token_stream_free(stream);
+        return NULL;
     }
+    return stream;
+}
 
-    buffer[pos] = '\0';
-
-    /* Check for special tokens */
-    if (strcmp(buffer, ":") == 0) {
-        token->type = TOK_COLON;
-    } else if (strcmp(buffer, ";") == 0) {
-        token->type = TOK_SEMICOLON;
-    } else if (strcmp(buffer, "(") == 0) {
-        token->type = TOK_LPAREN;
-    } else if (strcmp(buffer, ")") == 0) {
-        token->type = TOK_RPAREN;
-    } else if (strcmp(buffer, "[") == 0) {
-        token->type = TOK_LBRACKET;
-    } else if (strcmp(buffer, "]") == 0) {
-        token->type = TOK_RBRACKET;
-    } else if (strcmp(buffer, "$") == 0) {
-        token->type = TOK_DOLLAR;
-    } else if (strcmp(buffer, "--") == 0) {
-        /* Comment - skip to end of line */
-        while ((c = fgetc(stream->file)) != EOF && c != '\n') {
-            stream->column++;
-        }
-        if (c == '\n') {
-            stream->line++;
-            stream->column = 1;
-        }
-        token->type = TOK_COMMENT;
-    } else {
-        /* Try to parse as number */
-        char* endptr;
-        errno = 0;
-        int64_t num = strtoll(buffer, &endptr, 0);  /* Base 0 = auto-detect (dec/hex/oct) */
-
-        if (*endptr == '\0' && errno == 0) {
-            /* Valid number */
-            token->type = TOK_NUMBER;
-            token->number = num;
+void token_stream_free(token_stream_t* stream) {
+    if (stream) {
+        if (stream->mapped) {
+            munmap((void*)stream->data, stream->size);
         } else {
-            /* Word/identifier */
-            token->type = TOK_WORD;
+            free((void*)stream->data);
         }
+        free(stream->filename);
+        free(stream->scratch);
+        free(stream);
     }
-
-    token->text = strdup(buffer);
-    return true;
 }
 
-bool token_stream_next(token_stream_t* stream, token_t* token) {
-    if (stream->eof) {
-        token->type = TOK_EOF;
+void token_free(token_t* token) {
+    if (token) {
         token->text = NULL;
-        return false;
     }
+}
 
-    skip_whitespace(stream);
+bool token_stream_next(token_stream_t* stream, token_t* token) {
+    const char* data = stream->data;
+    size_t size = stream->size;
+
+    for (;;) {
+        size_t pos = skip_space(stream, stream->pos);
+        if (pos >= size) {
+            stream->pos = size;
+            token->type = TOK_EOF;
+            token->text = NULL;
+            return false;
+        }
 
-    if (stream->eof) {
-        token->type = TOK_EOF;
-        token->text = NULL;
-        return false;
-    }
+        token->offset = pos;
+        token->line = stream->line;
+        token->column = (int)(pos - stream->line_start) + 1;
 
-    /* Read token */
-    if (!read_word(stream, token)) {
-        return false;
-    }
+        if (data[pos] == '"') {
+            return read_string(stream, token, pos);
+        }
 
-    /* Skip comments */
-    if (token->type == TOK_COMMENT) {
-        token_free(token);
-        return token_stream_next(stream, token);
-    }
+        size_t end = scan_to_space(data, pos, size);
+        uint32_t sym = token_intern(data + pos, end - pos);
+        if (sym == NO_SYMBOL) {
+            fprintf(stderr, "Line %d: Out of memory interning token\n", stream->line);
+            return false;
+        }
+        const symbol_t* symbol = &symtab.symbols[sym];
+        stream->pos = end;
 
-    return true;
+        /* Comment - skip to end of line */
+        if (symbol->type == TOK_COMMENT) {
+            const char* newline = memchr(data + end, '\n', size - end);
+            stream->pos = newline ? (size_t)(newline - data) : size;
+            continue;
+        }
+
+        token->type = symbol->type;
+        token->sym = sym;
+        token->text = symbol->text;
+        token->number = symbol->number;
+        token->length = (uint32_t)(end - pos);
+        return true;
+    }
 }
 
 bool token_is(token_t* token, const char* text) {
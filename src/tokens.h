@@ -1,6 +1,6 @@
 /*
  * March Language - Token Stream Reader
- * Simple whitespace-delimited token reading
+ * Whitespace-delimited tokens over a memory-mapped source, with interned text
  */
 
 #ifndef MARCH_TOKENS_H
@@ -27,25 +27,31 @@ typedef enum {
     TOK_COMMENT,     /* -- comment (skip) */
 } token_type_t;
 
-/* Token structure */
+/* Token structure. Tokens own nothing: text is the interned symbol's
+ * text, valid for the life of the process, so tokens are copied freely
+ * (word and quotation definitions store them as they are). */
 typedef struct {
     token_type_t type;
-    char* text;          /* Token text (owned, must free) */
+    const char* text;    /* Interned text (string literals unescaped) */
+    uint32_t sym;        /* Interned symbol id */
+    uint32_t length;     /* Source bytes of the token */
+    size_t offset;       /* Source byte offset */
     int64_t number;      /* For TOK_NUMBER */
     int line;            /* Line number for errors */
     int column;          /* Column for errors */
 } token_t;
 
-/* Token stream */
+/* Token stream over the whole source (mmapped when it is a regular file) */
 typedef struct {
-    FILE* file;
+    const char* data;
+    size_t size;
+    size_t pos;
+    bool mapped;         /* data is a mapping, else a malloc'd copy */
     char* filename;
     int line;
-    int column;
-    char* buffer;        /* Read buffer */
-    size_t buffer_size;
-    size_t buffer_pos;
-    bool eof;
+    size_t line_start;   /* Offset of the current line's first byte */
+    char* scratch;       /* Unescaped string literal, reused */
+    size_t scratch_size;
 } token_stream_t;
 
 /* Create/destroy token stream */
@@ -55,10 +61,16 @@ void token_stream_free(token_stream_t* stream);
 /* Read next token */
 bool token_stream_next(token_stream_t* stream, token_t* token);
 
-/* Free token data */
+/* Release a token (nothing to free; clears its text) */
 void token_free(token_t* token);
 
 /* Check if token matches */
 bool token_is(token_t* token, const char* text);
 
+/* Symbol table shared by all streams. Interning is not thread-safe (the
+ * lexer runs on one thread); the returned text never moves. */
+uint32_t token_intern(const char* text, size_t length);
+const char* token_symbol_text(uint32_t sym);
+size_t token_symbol_count(void);
+
 #endif /* MARCH_TOKENS_H */
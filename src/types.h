@@ -29,73 +29,18 @@
 #define BLOB_WORD       1    /* User-defined word (CID sequence) */
 #define BLOB_QUOTATION  2    /* Quotation (CID sequence, push address not call) */
 #define BLOB_DATA       3    /* Literal data (serialized value) */
+#define BLOB_STATIC     4    /* Reference kind only: a BLOB_DATA laid out as an
+                              * object (constant array), linked read-only; the
+                              * reference pushes its address, not its value */
 
 /* Fixed primitive ID table (LINKING.md design) */
-/* These IDs are stable and never change - assembly can be updated without breaking compiled code */
-#define PRIM_LIT        0    /* i64 literal (8 bytes follow tag) */
-#define PRIM_ADD        1    /* + */
-#define PRIM_SUB        2    /* - */
-#define PRIM_MUL        3    /* * */
-#define PRIM_DIV        4    /* / */
-#define PRIM_MOD        5    /* % */
-#define PRIM_DUP        6    /* dup */
-#define PRIM_DROP       7    /* drop */
-#define PRIM_SWAP       8    /* swap */
-#define PRIM_OVER       9    /* over */
-#define PRIM_ROT        10   /* rot */
-#define PRIM_EQ         11   /* = */
-#define PRIM_NE         12   /* != */
-#define PRIM_LT         13   /* < */
-#define PRIM_GT         14   /* > */
-#define PRIM_LE         15   /* <= */
-#define PRIM_GE         16   /* >= */
-#define PRIM_AND        17   /* & (bitwise) */
-#define PRIM_OR         18   /* | (bitwise) */
-#define PRIM_XOR        19   /* ^ (bitwise) */
-#define PRIM_NOT        20   /* ~ (bitwise) */
-#define PRIM_LSHIFT     21   /* << */
-#define PRIM_RSHIFT     22   /* >> (logical) */
-#define PRIM_ARSHIFT    23   /* >>> (arithmetic) */
-#define PRIM_LAND       24   /* and (logical) */
-#define PRIM_LOR        25   /* or (logical) */
-#define PRIM_LNOT       26   /* not (logical) */
-#define PRIM_ZEROP      27   /* 0? */
-#define PRIM_ZEROGT     28   /* 0> */
-#define PRIM_ZEROLT     29   /* 0< */
-#define PRIM_FETCH      30   /* @ */
-#define PRIM_STORE      31   /* ! */
-#define PRIM_CFETCH     32   /* c@ */
-#define PRIM_CSTORE     33   /* c! */
-#define PRIM_TOR        34   /* >r */
-#define PRIM_FROMR      35   /* r> */
-#define PRIM_RFETCH     36   /* r@ */
-#define PRIM_RDROP      37   /* rdrop */
-#define PRIM_TWOTOR     38   /* 2>r */
-#define PRIM_TWOFROMR   39   /* 2r> */
-#define PRIM_BRANCH     40   /* branch */
-#define PRIM_0BRANCH    41   /* 0branch */
-#define PRIM_EXECUTE    42   /* execute */
-#define PRIM_I0         43   /* i0 - loop counter */
-#define PRIM_FREE       44   /* free - deallocate slot */
-#define PRIM_ALLOC      45   /* alloc - allocate memory */
-#define PRIM_IDENTITY   46   /* _ - identity function */
-#define PRIM_MEMCPY     47   /* memcpy - copy memory block */
-#define PRIM_ARRAY_LEN  48   /* array-length - get array count */
-#define PRIM_STR_LEN    49   /* str-length - get string count */
-#define PRIM_MUT        50   /* mut - create mutable copy */
-#define PRIM_ARRAY_AT   51   /* march.array.at - read array element */
-#define PRIM_ARRAY_SET  52   /* march.array.set! - write array element */
-#define PRIM_ARRAY_FILL 53   /* march.array.fill! - fill with value */
-#define PRIM_ARRAY_REV  54   /* march.array.reverse! - reverse in place */
-#define PRIM_ARRAY_CONCAT 55 /* march.array.concat - concatenate arrays */
-
-/* Map operations (HAMT - persistent hash maps) */
-#define PRIM_MAP_NEW    56   /* march.map.new - create empty map */
-#define PRIM_MAP_GET    57   /* march.map.get - lookup value by key */
-#define PRIM_MAP_SET    58   /* march.map.set - insert/update key-value */
-#define PRIM_MAP_REMOVE 59   /* march.map.remove - delete key */
-#define PRIM_MAP_SIZE   60   /* march.map.size - get element count */
-#define PRIM_MAP_FREE   61   /* march.map.free - free map memory */
+/* These IDs are stable and never change - assembly can be updated without breaking compiled code.
+ * IDs, names and signatures are declared together in primitives.def */
+enum {
+#define PRIMITIVE(id, value, name, op, sig) PRIM_##id = value,
+#define PRIMITIVE_ID(id, value) PRIM_##id = value,
+#include "primitives.def"
+};
 
 /* Cell type */
 typedef uint64_t cell_t;